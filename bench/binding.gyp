@@ -0,0 +1,543 @@
+{
+  "targets": [
+    {
+      "target_name": "orionix_pipeline",
+      "type": "static_library",
+      "sources": [
+        "../src/input_pipeline.cpp",
+        "../src/input_stats.cpp",
+        "../src/frame_scheduler.cpp",
+        "../src/input_trace.cpp",
+        "../src/device_registry.cpp",
+        "../src/motion_engine.cpp",
+        "../src/motion_filter.cpp",
+        "../src/event_subscriptions.cpp",
+        "../src/monitor_layout.cpp",
+        "../src/cursor_lock.cpp"
+      ],
+      "cflags": [
+        "-fPIC"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "link_settings": {
+            "libraries": [
+              "-lpthread"
+            ]
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_input_bench",
+      "type": "executable",
+      "dependencies": [
+        "orionix_pipeline"
+      ],
+      "sources": [
+        "input_bench.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "libraries": [
+            "-lpsapi.lib"
+          ],
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lpthread"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_filter_eval",
+      "type": "executable",
+      "dependencies": [
+        "orionix_pipeline"
+      ],
+      "sources": [
+        "filter_eval.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lpthread"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_event_ring_test",
+      "type": "executable",
+      "dependencies": [
+        "orionix_pipeline"
+      ],
+      "sources": [
+        "event_ring_test.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lpthread"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_motion_engine_test",
+      "type": "executable",
+      "dependencies": [
+        "orionix_pipeline"
+      ],
+      "sources": [
+        "motion_engine_test.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lpthread"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_cursor_lock_test",
+      "type": "executable",
+      "dependencies": [
+        "orionix_pipeline"
+      ],
+      "sources": [
+        "cursor_lock_test.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lpthread"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_monitor_layout_test",
+      "type": "executable",
+      "sources": [
+        "monitor_layout_test.cpp",
+        "../src/monitor_layout.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_frame_pacing_test",
+      "type": "executable",
+      "sources": [
+        "frame_pacing_test.cpp",
+        "../src/frame_scheduler.cpp",
+        "../src/input_stats.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_cursor_bench",
+      "type": "executable",
+      "sources": [
+        "cursor_bench.cpp",
+        "../src/cursor_image.cpp",
+        "../src/cursor_cache.cpp",
+        "../src/cursor_raster.cpp",
+        "../src/cursor_bitmaps.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_cursor_robustness_test",
+      "type": "executable",
+      "sources": [
+        "cursor_robustness_test.cpp",
+        "../src/cursor_image.cpp",
+        "../src/cursor_cache.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_cursor_raster_test",
+      "type": "executable",
+      "sources": [
+        "cursor_raster_test.cpp",
+        "../src/cursor_raster.cpp",
+        "../src/cursor_bitmaps.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_compositor_bench",
+      "type": "executable",
+      "sources": [
+        "compositor_bench.cpp",
+        "../src/cursor_image.cpp",
+        "../src/cursor_cache.cpp",
+        "../src/cursor_raster.cpp",
+        "../src/cursor_bitmaps.cpp",
+        "../src/cursor_compositor.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_compositor_test",
+      "type": "executable",
+      "sources": [
+        "compositor_test.cpp",
+        "../src/cursor_compositor.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_raw_input_records_test",
+      "type": "executable",
+      "sources": [
+        "raw_input_records_test.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_shared_memory_test",
+      "type": "executable",
+      "sources": [
+        "shared_memory_test.cpp",
+        "../src/shared_event_ring.cpp",
+        "../src/cursor_state_table.cpp"
+      ],
+      "cflags_cc": [
+        "-std=c++17",
+        "-O2"
+      ],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-lrt",
+            "-lpthread"
+          ]
+        }]
+      ]
+    }
+  ],
+  "conditions": [
+    ["OS!='win'", {
+      "targets": [
+        {
+          "target_name": "orionix_cursor_table_stress",
+          "type": "executable",
+          "sources": [
+            "cursor_table_stress.cpp",
+            "../src/cursor_state_table.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lrt"
+          ]
+        }
+      ]
+    }],
+    ["OS=='linux'", {
+      "targets": [
+        {
+          "target_name": "orionix_evdev_flood",
+          "type": "executable",
+          "dependencies": [
+            "orionix_pipeline"
+          ],
+          "sources": [
+            "evdev_flood.cpp",
+            "../src/evdev_backend_linux.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lpthread"
+          ]
+        },
+        {
+          "target_name": "orionix_evdev_backend_test",
+          "type": "executable",
+          "dependencies": [
+            "orionix_pipeline"
+          ],
+          "sources": [
+            "evdev_backend_test.cpp",
+            "../src/evdev_backend_linux.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lpthread"
+          ]
+        },
+        {
+          "target_name": "orionix_evdev_hotplug_test",
+          "type": "executable",
+          "dependencies": [
+            "orionix_pipeline"
+          ],
+          "sources": [
+            "evdev_hotplug_test.cpp",
+            "../src/evdev_backend_linux.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-ldl",
+            "-lpthread"
+          ]
+        },
+        {
+          "target_name": "orionix_push_latency_test",
+          "type": "executable",
+          "dependencies": [
+            "orionix_pipeline"
+          ],
+          "sources": [
+            "push_latency_test.cpp",
+            "../src/evdev_backend_linux.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lpthread"
+          ]
+        },
+        {
+          "target_name": "orionix_cursor_shape_test",
+          "type": "executable",
+          "sources": [
+            "cursor_shape_test.cpp",
+            "../src/cursor_shape_x11.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lX11",
+            "-lXfixes",
+            "-lpthread"
+          ]
+        },
+        {
+          "target_name": "orionix_service_reconnect_test",
+          "type": "executable",
+          "dependencies": [
+            "orionix_pipeline"
+          ],
+          "sources": [
+            "service_reconnect_test.cpp",
+            "../src/input_service.cpp",
+            "../src/shared_event_ring.cpp",
+            "../src/evdev_backend_linux.cpp"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lrt",
+            "-lpthread"
+          ]
+        },
+        {
+          "target_name": "orionix_addon_node",
+          "dependencies": [
+            "orionix_pipeline"
+          ],
+          "sources": [
+            "../src/orionix_addon.cpp",
+            "../src/cursor_image.cpp",
+            "../src/cursor_cache.cpp",
+            "../src/cursor_raster.cpp",
+            "../src/cursor_bitmaps.cpp",
+            "../src/cursor_compositor.cpp",
+            "../src/cursor_state_table.cpp",
+            "../src/shared_event_ring.cpp",
+            "../src/input_service.cpp",
+            "../src/evdev_backend_linux.cpp",
+            "../src/cursor_shape_x11.cpp"
+          ],
+          "include_dirs": [
+            "<!(node -e \"require('nan')\")"
+          ],
+          "cflags_cc": [
+            "-std=c++17",
+            "-O2"
+          ],
+          "libraries": [
+            "-lX11",
+            "-lXfixes",
+            "-lrt"
+          ]
+        }
+      ]
+    }]
+  ]
+}
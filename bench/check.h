@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdio>
+
+// Harness of the bench tests: every Check prints one "ok" or "FAIL" line, and main returns
+// failures == 0 ? 0 : 1 so a failed check fails the run.
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+    printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) {
+        failures++;
+    }
+}
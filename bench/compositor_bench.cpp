@@ -0,0 +1,247 @@
+// Frame cost of the native cursor compositor, headless: moves N cursors across M offscreen
+// displays, composes each frame with dirty rects and with a full repaint, checks that both give
+// the same pixels, and prints a JSON report on stdout (or --out). --dump writes the last frame of
+// each display as a PAM image (straight alpha) for golden-image comparisons.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "../src/cursor_bitmaps.h"
+#include "../src/cursor_cache.h"
+#include "../src/cursor_compositor.h"
+
+struct BenchConfig {
+    std::string directory = "assets/default";
+    int cursors = 4;
+    int displays = 2;
+    int width = 1920;
+    int height = 1080;
+    int size = 32;
+    int frames = 2000;
+    std::string outPath;
+    std::string dumpPrefix;
+};
+
+static int64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::vector<std::string> ListCursorFiles(const std::string& directory) {
+    std::vector<std::string> files;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((directory + "\\*.cur").c_str(), &entry);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            files.push_back(directory + "\\" + entry.cFileName);
+        } while (FindNextFileA(find, &entry));
+        FindClose(find);
+    }
+#else
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".cur") == 0) files.push_back(directory + "/" + name);
+        }
+        closedir(dir);
+    }
+#endif
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+struct Timings {
+    std::vector<int64_t> samples;
+
+    void Add(int64_t nanos) { samples.push_back(nanos); }
+
+    double PercentileMicros(double p) {
+        std::sort(samples.begin(), samples.end());
+        return samples.empty() ? 0.0 : samples[std::min(samples.size() - 1, (size_t)(p * samples.size()))] / 1000.0;
+    }
+};
+
+static bool ParseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--dir") {
+            config.directory = value;
+        } else if (arg == "--cursors") {
+            config.cursors = atoi(value);
+        } else if (arg == "--displays") {
+            config.displays = atoi(value);
+        } else if (arg == "--width") {
+            config.width = atoi(value);
+        } else if (arg == "--height") {
+            config.height = atoi(value);
+        } else if (arg == "--size") {
+            config.size = atoi(value);
+        } else if (arg == "--frames") {
+            config.frames = atoi(value);
+        } else if (arg == "--out") {
+            config.outPath = value;
+        } else if (arg == "--dump") {
+            config.dumpPrefix = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.cursors < 1 || config.displays < 1 || config.width < 1 || config.height < 1 || config.frames < 1 ||
+        config.size < 1 || config.size > kMaxCursorBitmapSize) {
+        fprintf(stderr, "Counts and sizes must be positive (size at most %d)\n", kMaxCursorBitmapSize);
+        return false;
+    }
+    return true;
+}
+
+// Deterministic Lissajous path over the whole desktop, one phase per cursor.
+static void CursorPosition(int cursor, int frame, int32_t desktopWidth, int32_t desktopHeight, int32_t* x, int32_t* y) {
+    double t = frame * 0.01 + cursor * 1.7;
+    *x = (int32_t)std::lround((0.5 + 0.48 * std::sin(t * (1.0 + cursor * 0.13))) * desktopWidth);
+    *y = (int32_t)std::lround((0.5 + 0.48 * std::sin(t * 1.31 + cursor)) * desktopHeight);
+}
+
+static bool WritePam(const std::string& path, const CursorCompositor& compositor, size_t surface) {
+    const CompositorRect& bounds = compositor.SurfaceBounds(surface);
+    std::vector<uint8_t> pixels((size_t)bounds.width * bounds.height * 4);
+    compositor.CopyRect(surface, { 0, 0, bounds.width, bounds.height }, pixels.data(), true);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", bounds.width, bounds.height);
+    bool ok = fwrite(pixels.data(), 1, pixels.size(), file) == pixels.size();
+    return fclose(file) == 0 && ok;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr, "Usage: orionix_compositor_bench [--dir assets/default] [--cursors N] [--displays N] [--width px] [--height px]\n"
+                        "                                [--size px] [--frames N] [--out report.json] [--dump prefix]\n");
+        return 2;
+    }
+
+    std::vector<std::string> files = ListCursorFiles(config.directory);
+    CursorCache cursorCache;
+    std::vector<std::shared_ptr<const CursorBitmap>> bitmaps;
+    static const uint32_t kColors[] = { 0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00 };
+    for (const std::string& file : files) {
+        CursorView view;
+        bool cached;
+        if (!cursorCache.Load(file, &view, &cached)) {
+            for (uint32_t rgb : kColors) {
+                bitmaps.push_back(BakeCursorBitmap(view.frames[0], view.pixels + view.frames[0].pixelOffset, config.size, rgb, 255));
+            }
+        }
+    }
+    if (bitmaps.empty()) {
+        fprintf(stderr, "No cursor files in %s\n", config.directory.c_str());
+        return 1;
+    }
+
+    // Displays side by side, the way overlays cover a horizontal multi-monitor desktop.
+    std::vector<CompositorRect> surfaces;
+    for (int i = 0; i < config.displays; i++) {
+        surfaces.push_back({ i * config.width, 0, config.width, config.height });
+    }
+    CursorCompositor dirty, full;
+    dirty.SetSurfaces(surfaces);
+    full.SetSurfaces(surfaces);
+    int32_t desktopWidth = config.displays * config.width;
+
+    Timings dirtyTimings, fullTimings;
+    uint64_t repaintedPixels = 0, rects = 0, mismatches = 0;
+    for (int frame = 0; frame < config.frames; frame++) {
+        // Every cursor moves each frame; the shape changes every 120 frames.
+        for (int cursor = 0; cursor < config.cursors; cursor++) {
+            int32_t x, y;
+            CursorPosition(cursor, frame, desktopWidth, config.height, &x, &y);
+            size_t shape = (size_t)(cursor + frame / 120) % (bitmaps.size() / 4);
+            size_t bitmap = shape * 4 + cursor % 4;
+            dirty.SetSprite((uint32_t)cursor, bitmaps[bitmap], x, y);
+            full.SetSprite((uint32_t)cursor, bitmaps[bitmap], x, y);
+        }
+
+        int64_t start = NowNanos();
+        for (size_t surface = 0; surface < dirty.SurfaceCount(); surface++) {
+            for (const CompositorRect& rect : dirty.Compose(surface)) {
+                repaintedPixels += (uint64_t)rect.width * rect.height;
+                rects++;
+            }
+        }
+        dirtyTimings.Add(NowNanos() - start);
+
+        start = NowNanos();
+        for (size_t surface = 0; surface < full.SurfaceCount(); surface++) {
+            full.Invalidate(surface);
+            full.Compose(surface);
+        }
+        fullTimings.Add(NowNanos() - start);
+
+        bool same = true;
+        for (size_t surface = 0; surface < dirty.SurfaceCount(); surface++) {
+            const CompositorRect& bounds = dirty.SurfaceBounds(surface);
+            same = same && memcmp(dirty.SurfacePixels(surface), full.SurfacePixels(surface), (size_t)bounds.width * bounds.height * 4) == 0;
+        }
+        mismatches += !same;
+    }
+
+    if (!config.dumpPrefix.empty()) {
+        for (size_t surface = 0; surface < dirty.SurfaceCount(); surface++) {
+            std::string path = config.dumpPrefix + "-" + std::to_string(surface) + ".pam";
+            if (!WritePam(path, dirty, surface)) {
+                fprintf(stderr, "Cannot write %s\n", path.c_str());
+                return 1;
+            }
+        }
+    }
+
+    FILE* out = stdout;
+    if (!config.outPath.empty()) {
+        out = fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", config.outPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"cursors\": %d, \"displays\": %d, \"width\": %d, \"height\": %d, \"size\": %d, \"frames\": %d},\n",
+        config.cursors, config.displays, config.width, config.height, config.size, config.frames);
+    fprintf(out, "  \"dirtyRects\": {\"perFrame\": %.2f, \"pixelsPerFrame\": %.0f, \"surfacePixels\": %lld},\n",
+        (double)rects / config.frames, (double)repaintedPixels / config.frames, (long long)config.displays * config.width * config.height);
+    for (auto phase : { std::make_pair("dirtyFrameMicros", &dirtyTimings), std::make_pair("fullFrameMicros", &fullTimings) }) {
+        fprintf(out, "  \"%s\": {\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f},\n", phase.first,
+            phase.second->PercentileMicros(0.50), phase.second->PercentileMicros(0.99), phase.second->PercentileMicros(1.0));
+    }
+    fprintf(out, "  \"mismatchedFrames\": %llu\n", (unsigned long long)mismatches);
+    fprintf(out, "}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,313 @@
+// Dirty-rect tests for the cursor compositor (src/cursor_compositor.h). A consumer that only copies
+// the rects Compose hands out must always hold the same pixels as an independent full redraw, through
+// scripted cases (small and large moves, sprites straddling or leaving displays, overlaps in id order,
+// removal, invalidation, the rect cap) and seeded random frames. Returned rects must lie inside their
+// surface and never overlap. Exits non-zero on any failure.
+//
+//   orionix_compositor_test [--frames 3000] [--seed 1]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/cursor_compositor.h"
+#include "check.h"
+
+typedef std::vector<uint8_t> Pixels;
+
+// A premultiplied sprite with an opaque core, a translucent ring and transparent corners, so every
+// branch of source-over is drawn.
+static std::shared_ptr<const CursorBitmap> MakeSprite(int width, int height, uint8_t r, uint8_t g, uint8_t b, int hotspotX, int hotspotY) {
+    std::shared_ptr<CursorBitmap> bitmap = std::make_shared<CursorBitmap>();
+    bitmap->width = (uint16_t)width;
+    bitmap->height = (uint16_t)height;
+    bitmap->hotspotX = (uint16_t)hotspotX;
+    bitmap->hotspotY = (uint16_t)hotspotY;
+    bitmap->pixels.resize((size_t)width * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const int edge = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+            const uint32_t alpha = edge == 0 && (x == 0 || x == width - 1) && (y == 0 || y == height - 1) ? 0 : edge < 2 ? 96 + edge * 60 : 255;
+            uint8_t* p = &bitmap->pixels[((size_t)y * width + x) * 4];
+            p[0] = (uint8_t)(r * alpha / 255);
+            p[1] = (uint8_t)(g * alpha / 255);
+            p[2] = (uint8_t)(b * alpha / 255);
+            p[3] = (uint8_t)alpha;
+        }
+    }
+    return bitmap;
+}
+
+struct SpriteState {
+    std::shared_ptr<const CursorBitmap> bitmap;
+    int32_t x, y;
+};
+
+// Independent full redraw of one surface: every sprite, in id order, source-over in floating point
+// rounded once per blend, like the compositor's integer Div255.
+static Pixels FullRedraw(const CompositorRect& bounds, const std::vector<std::pair<uint32_t, SpriteState>>& sprites) {
+    Pixels pixels((size_t)bounds.width * bounds.height * 4, 0);
+    for (const auto& entry : sprites) {
+        const CursorBitmap& bitmap = *entry.second.bitmap;
+        const int32_t left = entry.second.x - bitmap.hotspotX - bounds.x;
+        const int32_t top = entry.second.y - bitmap.hotspotY - bounds.y;
+        for (int32_t y = 0; y < bitmap.height; y++) {
+            for (int32_t x = 0; x < bitmap.width; x++) {
+                const int32_t sx = left + x, sy = top + y;
+                if (sx < 0 || sy < 0 || sx >= bounds.width || sy >= bounds.height) {
+                    continue;
+                }
+                const uint8_t* s = &bitmap.pixels[((size_t)y * bitmap.width + x) * 4];
+                uint8_t* d = &pixels[((size_t)sy * bounds.width + sx) * 4];
+                for (int c = 0; c < 4; c++) {
+                    d[c] = (uint8_t)(s[c] + (int)(d[c] * (255 - s[3]) / 255.0 + 0.5));
+                }
+            }
+        }
+    }
+    return pixels;
+}
+
+// Plays the overlay: keeps its own copy of each surface and updates it only from composed rects.
+struct Harness {
+    CursorCompositor compositor;
+    std::vector<CompositorRect> bounds;
+    std::vector<Pixels> consumers;
+    std::vector<std::pair<uint32_t, SpriteState>> sprites;  // sorted by id
+    std::vector<std::vector<CompositorRect>> lastRects;
+    int64_t repaintedArea = 0;
+
+    explicit Harness(const std::vector<CompositorRect>& surfaces) : bounds(surfaces) {
+        compositor.SetSurfaces(surfaces);
+        for (const CompositorRect& surface : surfaces) {
+            consumers.emplace_back((size_t)surface.width * surface.height * 4, 0xCD);
+        }
+        lastRects.resize(surfaces.size());
+    }
+
+    void Set(uint32_t id, std::shared_ptr<const CursorBitmap> bitmap, int32_t x, int32_t y) {
+        compositor.SetSprite(id, bitmap, x, y);
+        auto found = std::lower_bound(sprites.begin(), sprites.end(), id,
+            [](const std::pair<uint32_t, SpriteState>& entry, uint32_t key) { return entry.first < key; });
+        if (found != sprites.end() && found->first == id) {
+            found->second = { bitmap, x, y };
+        } else {
+            sprites.insert(found, { id, { bitmap, x, y } });
+        }
+    }
+
+    void Remove(uint32_t id) {
+        compositor.RemoveSprite(id);
+        sprites.erase(std::remove_if(sprites.begin(), sprites.end(),
+            [id](const std::pair<uint32_t, SpriteState>& entry) { return entry.first == id; }), sprites.end());
+    }
+
+    void Clear() {
+        compositor.ClearSprites();
+        sprites.clear();
+    }
+
+    // Composes every surface; false when a rect is out of bounds or overlaps another, or the
+    // consumer's copy differs from a full redraw.
+    bool Frame() {
+        bool ok = true;
+        for (size_t i = 0; i < bounds.size(); i++) {
+            const std::vector<CompositorRect>& rects = compositor.Compose(i);
+            lastRects[i] = rects;
+            const int32_t stride = bounds[i].width * 4;
+            for (size_t r = 0; r < rects.size(); r++) {
+                const CompositorRect& rect = rects[r];
+                if (rect.Empty() || rect.x < 0 || rect.y < 0 || rect.x + rect.width > bounds[i].width || rect.y + rect.height > bounds[i].height) {
+                    ok = false;
+                    continue;
+                }
+                for (size_t other = 0; other < r; other++) {
+                    const CompositorRect& o = rects[other];
+                    if (rect.x < o.x + o.width && o.x < rect.x + rect.width && rect.y < o.y + o.height && o.y < rect.y + rect.height) {
+                        ok = false;
+                    }
+                }
+                Pixels copy((size_t)rect.width * rect.height * 4);
+                compositor.CopyRect(i, rect, copy.data(), false);
+                for (int32_t y = 0; y < rect.height; y++) {
+                    memcpy(&consumers[i][(size_t)(rect.y + y) * stride + rect.x * 4], &copy[(size_t)y * rect.width * 4], (size_t)rect.width * 4);
+                }
+                repaintedArea += (int64_t)rect.width * rect.height;
+            }
+            const Pixels expected = FullRedraw(bounds[i], sprites);
+            ok = ok && consumers[i] == expected &&
+                memcmp(compositor.SurfacePixels(i), expected.data(), expected.size()) == 0;
+        }
+        return ok;
+    }
+
+    bool Rects(size_t surface, const std::vector<CompositorRect>& expected) const {
+        const std::vector<CompositorRect>& actual = lastRects[surface];
+        if (actual.size() != expected.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < actual.size(); i++) {
+            if (memcmp(&actual[i], &expected[i], sizeof(CompositorRect)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+static void TestScripted() {
+    // Two 200x100 displays side by side; the left one starts at a negative origin.
+    Harness h({ { -200, 0, 200, 100 }, { 0, 0, 200, 100 } });
+    const auto red = MakeSprite(16, 16, 255, 0, 0, 0, 0);
+    const auto blue = MakeSprite(12, 20, 0, 0, 255, 6, 10);
+
+    Check(h.Frame() && h.Rects(0, { { 0, 0, 200, 100 } }) && h.Rects(1, { { 0, 0, 200, 100 } }),
+        "the first Compose hands out each whole surface");
+    Check(h.Frame() && h.Rects(0, {}) && h.Rects(1, {}), "nothing changed, nothing composed");
+
+    h.Set(1, red, 50, 40);
+    Check(h.Frame() && h.Rects(0, {}) && h.Rects(1, { { 50, 40, 16, 16 } }), "a new sprite damages only its bounds");
+    h.Set(1, red, 50, 40);
+    Check(h.Frame() && h.Rects(1, {}), "setting the same bitmap at the same place damages nothing");
+    h.Set(1, red, 53, 42);
+    Check(h.Frame() && h.Rects(1, { { 50, 40, 19, 18 } }), "a small move repaints one merged rect");
+    h.Set(1, red, 150, 60);
+    Check(h.Frame() && h.Rects(1, { { 53, 42, 16, 16 }, { 150, 60, 16, 16 } }), "a long move repaints the old and new bounds apart");
+    h.Set(1, red, 166, 60);
+    Check(h.Frame() && h.Rects(1, { { 150, 60, 32, 16 } }), "abutting old and new bounds merge");
+
+    h.Set(2, blue, 4, 50);
+    Check(h.Frame() && h.Rects(0, { { 198, 40, 2, 20 } }) && h.Rects(1, { { 0, 40, 10, 20 } }),
+        "a sprite across two displays damages both, in each surface's coordinates");
+    h.Set(2, blue, -300, 50);
+    Check(h.Frame() && h.Rects(0, { { 198, 40, 2, 20 } }) && h.Rects(1, { { 0, 40, 10, 20 } }),
+        "a sprite moved off every display damages only where it was");
+    h.Set(2, blue, 195, 95);
+    Check(h.Frame() && h.Rects(1, { { 189, 85, 11, 15 } }), "a sprite past the bottom-right corner is clipped");
+
+    h.Set(3, blue, 175, 70);
+    h.Set(1, red, 170, 65);
+    Check(h.Frame(), "overlapping sprites draw in id order");
+    h.Remove(3);
+    Check(h.Frame() && h.Rects(1, { { 169, 60, 12, 20 } }), "removing a sprite uncovers the ones below it");
+
+    h.compositor.Invalidate(0);
+    Check(h.Frame() && h.Rects(0, { { 0, 0, 200, 100 } }) && h.Rects(1, {}), "Invalidate repaints one whole surface");
+
+    // Far-apart sprites that cannot merge: past the cap the damage becomes their bounding box.
+    const auto dot = MakeSprite(3, 3, 0, 255, 0, 0, 0);
+    for (uint32_t i = 0; i < kMaxDamageRects + 2; i++) {
+        h.Set(10 + i, dot, (int32_t)(i % 6) * 30 + 2, (int32_t)(i / 6) * 30 + 2);
+    }
+    Check(h.Frame() && h.Rects(1, { { 2, 2, 153, 63 } }), "more damage rects than the cap repaint their bounding box");
+    for (uint32_t i = 0; i < 4; i++) {
+        h.Remove(10 + i);
+    }
+    Check(h.Frame() && h.lastRects[1].size() == 4, "under the cap each rect is repainted on its own");
+
+    h.Clear();
+    Check(h.Frame() && h.compositor.SpriteCount() == 0, "ClearSprites damages every sprite");
+
+    h.compositor.SetSurfaces({ { 0, 0, 64, 32 } });
+    Check(h.compositor.Compose(0).size() == 1 && h.compositor.Compose(0).empty() && h.compositor.SpriteCount() == 0,
+        "SetSurfaces resets the surfaces and starts them whole");
+
+    CursorCompositor straight;
+    straight.SetSurfaces({ { 0, 0, 4, 4 } });
+    std::shared_ptr<CursorBitmap> half = std::make_shared<CursorBitmap>();
+    half->width = half->height = 1;
+    half->hotspotX = half->hotspotY = 0;
+    half->pixels = { 64, 32, 0, 128 };
+    straight.SetSprite(1, half, 1, 1);
+    straight.Compose(0);
+    uint8_t pixel[4];
+    straight.CopyRect(0, { 1, 1, 1, 1 }, pixel, true);
+    Check(pixel[0] == 128 && pixel[1] == 64 && pixel[2] == 0 && pixel[3] == 128, "CopyRect un-premultiplies on request");
+}
+
+static void TestRandomFrames(int frames, uint32_t seed) {
+    Harness h({ { -480, -60, 480, 270 }, { 0, 0, 640, 360 }, { 640, 100, 320, 240 } });
+    std::mt19937 random(seed);
+    const std::vector<std::shared_ptr<const CursorBitmap>> bitmaps = {
+        MakeSprite(32, 32, 255, 255, 255, 0, 0),
+        MakeSprite(48, 48, 255, 128, 0, 24, 24),
+        MakeSprite(24, 40, 0, 200, 255, 2, 39),
+        MakeSprite(5, 5, 80, 80, 80, 4, 4),
+    };
+    struct Walker {
+        int32_t x, y;
+        size_t bitmap;
+    };
+    std::vector<Walker> walkers(8);
+    for (Walker& w : walkers) {
+        w = { (int32_t)(random() % 1520) - 520, (int32_t)(random() % 500) - 100, random() % bitmaps.size() };
+    }
+
+    h.Frame();
+    h.repaintedArea = 0;
+    bool ok = true;
+    for (int frame = 0; frame < frames && ok; frame++) {
+        for (uint32_t id = 0; id < walkers.size(); id++) {
+            Walker& w = walkers[id];
+            switch (random() % 16) {
+                case 0:
+                    h.Remove(id);
+                    continue;
+                case 1:
+                    w.bitmap = random() % bitmaps.size();
+                    break;
+                case 2:
+                    // A jump, e.g. a warp or a routed device switching.
+                    w.x = (int32_t)(random() % 1520) - 520;
+                    w.y = (int32_t)(random() % 500) - 100;
+                    break;
+                case 3:
+                    // Idle: the same position again.
+                    break;
+                default:
+                    w.x += (int32_t)(random() % 21) - 10;
+                    w.y += (int32_t)(random() % 21) - 10;
+                    break;
+            }
+            h.Set(id, bitmaps[w.bitmap], w.x, w.y);
+        }
+        if (random() % 500 == 0) {
+            h.compositor.Invalidate(random() % h.bounds.size());
+        }
+        if (random() % 700 == 0) {
+            h.Clear();
+        }
+        ok = h.Frame();
+    }
+    Check(ok, "random frames: composed rects alone keep every consumer identical to a full redraw");
+
+    int64_t surfaceArea = 0;
+    for (const CompositorRect& bounds : h.bounds) {
+        surfaceArea += (int64_t)bounds.width * bounds.height;
+    }
+    const double share = frames > 0 ? (double)h.repaintedArea / ((double)surfaceArea * frames) : 0.0;
+    printf("  %d frames, %.2f%% of the surfaces repainted per frame\n", frames, share * 100.0);
+    Check(share < 0.05, "dirty rects repaint a small share of the surfaces");
+}
+
+int main(int argc, char** argv) {
+    int frames = 3000;
+    uint32_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--frames") == 0) {
+            frames = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "Usage: orionix_compositor_test [--frames N] [--seed N]\n");
+            return 2;
+        }
+    }
+    TestScripted();
+    TestRandomFrames(frames, seed);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+// Startup cost of the cursor theme: decodes every .cur/.ani in a directory directly, through a
+// cold decoded-cursor cache (decode + write) and through a warm one (map + lookup), then bakes
+// every frame at the overlay sizes with each SIMD level the CPU supports, and prints a JSON
+// report on stdout (or --out).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "../src/cursor_bitmaps.h"
+#include "../src/cursor_cache.h"
+#include "../src/cursor_raster.h"
+
+struct BenchConfig {
+    std::string directory = "assets/default";
+    std::string cachePath = "cursor_bench.cache";
+    int iterations = 50;
+    std::string outPath;
+};
+
+static int64_t NowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool IsCursorFile(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = name.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return extension == ".cur" || extension == ".ani" || extension == ".ico";
+}
+
+static std::vector<std::string> ListCursorFiles(const std::string& directory) {
+    std::vector<std::string> files;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &entry);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            if (IsCursorFile(entry.cFileName)) files.push_back(directory + "\\" + entry.cFileName);
+        } while (FindNextFileA(find, &entry));
+        FindClose(find);
+    }
+#else
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (IsCursorFile(entry->d_name)) files.push_back(directory + "/" + entry->d_name);
+        }
+        closedir(dir);
+    }
+#endif
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+struct Timings {
+    std::vector<int64_t> samples;
+
+    void Add(int64_t micros) { samples.push_back(micros); }
+
+    int64_t Percentile(double p) {
+        std::sort(samples.begin(), samples.end());
+        return samples.empty() ? 0 : samples[std::min(samples.size() - 1, (size_t)(p * samples.size()))];
+    }
+};
+
+static bool ParseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--dir") {
+            config.directory = value;
+        } else if (arg == "--cache") {
+            config.cachePath = value;
+        } else if (arg == "--iterations") {
+            config.iterations = atoi(value);
+        } else if (arg == "--out") {
+            config.outPath = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.iterations < 1) {
+        fprintf(stderr, "--iterations must be positive\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr, "Usage: orionix_cursor_bench [--dir assets/default] [--cache file] [--iterations N] [--out report.json]\n");
+        return 2;
+    }
+
+    std::vector<std::string> files = ListCursorFiles(config.directory);
+    if (files.empty()) {
+        fprintf(stderr, "No cursor files in %s\n", config.directory.c_str());
+        return 1;
+    }
+
+    Timings decode, cold, warm;
+    size_t failed = 0, frames = 0, pixelBytes = 0;
+    for (int iteration = 0; iteration < config.iterations; iteration++) {
+        int64_t start = NowMicros();
+        for (const std::string& file : files) {
+            MappedFile mapped;
+            CursorImage image;
+            if (!mapped.Open(file) || DecodeCursorImage(mapped.view, mapped.size, &image)) {
+                failed += iteration == 0;
+                continue;
+            }
+            if (iteration == 0) {
+                frames += image.frames.size();
+                for (const CursorFrame& frame : image.frames) pixelBytes += frame.pixels.size();
+            }
+        }
+        decode.Add(NowMicros() - start);
+
+        remove(config.cachePath.c_str());
+        for (Timings* phase : { &cold, &warm }) {
+            start = NowMicros();
+            CursorCache cache;
+            cache.Open(config.cachePath);
+            for (const std::string& file : files) {
+                CursorView view;
+                bool cached;
+                cache.Load(file, &view, &cached);
+            }
+            if (const char* error = cache.Save()) {
+                fprintf(stderr, "%s\n", error);
+                return 1;
+            }
+            phase->Add(NowMicros() - start);
+        }
+    }
+
+    // Resample + tint of every frame at each size, as for a theme switch with one colour per device.
+    static const int kBakeSizes[] = { 24, 32, 48, 64, 96, 128 };
+    static const uint32_t kBakeColors[] = { 0xFF0000, 0x00FF00, 0x0000FF, 0xFFFF00 };
+    CursorCache warmCache;
+    warmCache.Open(config.cachePath);
+    std::vector<CursorView> views;
+    for (const std::string& file : files) {
+        CursorView view;
+        bool cached;
+        if (!warmCache.Load(file, &view, &cached)) views.push_back(view);
+    }
+
+    SimdLevel detected = DetectSimdLevel();
+    std::vector<std::pair<SimdLevel, Timings>> bakes;
+    size_t bakedBitmaps = 0;
+    for (int level = (int)SimdLevel::Scalar; level <= (int)detected; level++) {
+        SetSimdLevel((SimdLevel)level);
+        Timings timings;
+        for (int iteration = 0; iteration < config.iterations; iteration++) {
+            bakedBitmaps = 0;
+            int64_t start = NowMicros();
+            for (const CursorView& view : views) {
+                for (uint32_t f = 0; f < view.frameCount; f++) {
+                    for (int size : kBakeSizes) {
+                        for (uint32_t rgb : kBakeColors) {
+                            BakeCursorBitmap(view.frames[f], view.pixels + view.frames[f].pixelOffset, size, rgb, 230);
+                            bakedBitmaps++;
+                        }
+                    }
+                }
+            }
+            timings.Add(NowMicros() - start);
+        }
+        bakes.emplace_back((SimdLevel)level, timings);
+    }
+    SetSimdLevel(detected);
+
+    MappedFile cacheFile;
+    size_t cacheBytes = cacheFile.Open(config.cachePath) ? cacheFile.size : 0;
+
+    FILE* out = stdout;
+    if (!config.outPath.empty()) {
+        out = fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", config.outPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"dir\": \"%s\", \"iterations\": %d},\n", config.directory.c_str(), config.iterations);
+    fprintf(out, "  \"files\": {\"count\": %zu, \"failed\": %zu, \"frames\": %zu, \"pixelBytes\": %zu, \"cacheBytes\": %zu},\n",
+        files.size(), failed, frames, pixelBytes, cacheBytes);
+    for (auto phase : { std::make_pair("decodeMicros", &decode), std::make_pair("coldCacheMicros", &cold), std::make_pair("warmCacheMicros", &warm) }) {
+        fprintf(out, "  \"%s\": {\"p50\": %lld, \"p99\": %lld, \"max\": %lld},\n", phase.first,
+            (long long)phase.second->Percentile(0.50), (long long)phase.second->Percentile(0.99), (long long)phase.second->Percentile(1.0));
+    }
+    int64_t scalarBake = bakes[0].second.Percentile(0.50);
+    fprintf(out, "  \"bakeMicros\": {\"detected\": \"%s\", \"bitmaps\": %zu, \"levels\": [\n", SimdLevelName(detected), bakedBitmaps);
+    for (size_t i = 0; i < bakes.size(); i++) {
+        int64_t p50 = bakes[i].second.Percentile(0.50);
+        fprintf(out, "    {\"level\": \"%s\", \"p50\": %lld, \"p99\": %lld, \"max\": %lld, \"speedup\": %.2f}%s\n",
+            SimdLevelName(bakes[i].first), (long long)p50, (long long)bakes[i].second.Percentile(0.99),
+            (long long)bakes[i].second.Percentile(1.0), p50 > 0 ? (double)scalarBake / p50 : 0.0, i + 1 < bakes.size() ? "," : "");
+    }
+    fprintf(out, "  ]}\n");
+    fprintf(out, "}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Arbitration tests for the cursor lock and routing (src/cursor_lock.h) against a recording
+// CursorSink instead of the OS cursor: the owner keeps the cursor while other mice nudge it, at most
+// one MoveTo per producer flush and none when the cursor is already on target, routing follows the
+// last mover, the lock ends with its owner, and engine positions reach the sink in physical pixels.
+// Exits non-zero on any failure.
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../src/input_pipeline.h"
+#include "check.h"
+
+struct Point {
+    int32_t x, y;
+};
+
+class RecordingSink : public CursorSink {
+public:
+    explicit RecordingSink(std::vector<Point>& moves) : moves_(moves) {}
+    void MoveTo(int32_t x, int32_t y) override { moves_.push_back({ x, y }); }
+
+private:
+    std::vector<Point>& moves_;
+};
+
+static bool Moved(const std::vector<Point>& moves, size_t count, int32_t x, int32_t y) {
+    return moves.size() == count && moves.back().x == x && moves.back().y == y;
+}
+
+// The test thread plays the backend's input thread: it ingests events and flushes the batch.
+struct Harness {
+    std::unique_ptr<InputPipeline> pipeline{ new InputPipeline() };
+    std::vector<Point> moves;
+
+    Harness() {
+        pipeline->Subscriptions().SetDefault(0);
+        pipeline->Cursor().SetSink(std::unique_ptr<CursorSink>(new RecordingSink(moves)));
+    }
+
+    uint32_t Add(uint64_t handle) { return pipeline->InternDevice(handle, "mouse"); }
+
+    // Without the engine, x/y are where the OS put its cursor.
+    void Move(uint32_t id, int32_t x, int32_t y, int32_t dx = 1, int32_t dy = 0) {
+        pipeline->IngestEvent(MakeEvent(id, EventType::Move, EventAction::None, x, y, dx, dy, 0));
+    }
+
+    void Flush() { pipeline->FlushProducer(); }
+};
+
+static void TestLockWithoutEngine() {
+    Harness h;
+    CursorLock& lock = h.pipeline->Cursor();
+    const uint32_t a = h.Add(0xA);
+    const uint32_t b = h.Add(0xB);
+
+    h.Move(a, 10, 10);
+    h.Move(b, 20, 20);
+    h.Flush();
+    Check(h.moves.empty(), "without lock or routing the cursor is left alone");
+
+    lock.Lock(0xA, 100, 100);
+    h.Flush();
+    Check(Moved(h.moves, 1, 100, 100), "locking moves the cursor to the owner's position");
+    h.Flush();
+    Check(h.moves.size() == 1, "an idle flush does not move the cursor again");
+
+    h.Move(b, 150, 120);
+    h.Move(b, 160, 130);
+    h.Move(b, 170, 140);
+    h.Flush();
+    Check(Moved(h.moves, 2, 100, 100), "another mouse's nudges are undone with one MoveTo per flush");
+
+    h.Move(a, 110, 100);
+    h.Flush();
+    Check(h.moves.size() == 2 && lock.SkippedRepositions() == 1, "the owner moving the cursor itself needs no MoveTo");
+
+    h.Move(b, 300, 300);
+    h.Move(a, 120, 100);
+    h.Flush();
+    Check(h.moves.size() == 2, "the owner's last report wins over an earlier nudge in the same batch");
+
+    h.Move(a, 130, 100);
+    h.Move(b, 400, 400);
+    h.Flush();
+    Check(Moved(h.moves, 3, 130, 100), "a nudge after the owner's move is pinned back to the owner");
+    Check(lock.Repositions() == 3, "repositions count every MoveTo");
+
+    lock.Unlock();
+    h.Move(b, 500, 500);
+    h.Flush();
+    Check(h.moves.size() == 3, "after Unlock other mice move the cursor freely");
+}
+
+static void TestOwnerLifetime() {
+    Harness h;
+    CursorLock& lock = h.pipeline->Cursor();
+    const uint32_t b = h.Add(0xB);
+
+    lock.Lock(0xC, 50, 60);
+    h.Flush();
+    Check(Moved(h.moves, 1, 50, 60), "a lock may name a device that has not reported yet");
+    h.Move(b, 70, 70);
+    h.Flush();
+    Check(Moved(h.moves, 2, 50, 60), "the cursor stays pinned until the owner appears");
+
+    const uint32_t c = h.Add(0xC);
+    h.Move(c, 80, 90);
+    h.Flush();
+    Check(h.moves.size() == 2, "the owner is resolved once it appears and then leads");
+    h.Move(b, 10, 10);
+    h.Flush();
+    Check(Moved(h.moves, 3, 80, 90), "and is held at the owner's latest position");
+
+    h.pipeline->IngestEvent(MakeEvent(c, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0));
+    h.Move(b, 20, 20);
+    h.Flush();
+    Check(h.moves.size() == 3, "unplugging the owner releases the lock");
+
+    lock.Lock(0xB, 0, 0);
+    lock.Lock(0xC, 5, 5);
+    h.Flush();
+    Check(Moved(h.moves, 4, 5, 5), "the latest Lock decides the owner");
+    h.Move(b, 30, 30);
+    h.Flush();
+    Check(Moved(h.moves, 5, 5, 5), "the previous owner no longer leads");
+}
+
+static void TestRouting() {
+    Harness h;
+    CursorLock& lock = h.pipeline->Cursor();
+    const uint32_t a = h.Add(0xA);
+    const uint32_t b = h.Add(0xB);
+
+    lock.SetRouting(true);
+    h.Move(a, 10, 10);
+    h.Flush();
+    Check(h.moves.empty(), "without the engine, routing leaves the OS cursor where the OS put it");
+
+    MotionConfig config;
+    config.enabled = true;
+    config.maxX = 3839;
+    config.maxY = 2159;
+    config.originX = 1000;
+    config.originY = 500;
+    h.pipeline->Motion().Configure(config);
+
+    h.Move(a, 0, 0, 10, 0);
+    h.Flush();
+    Check(Moved(h.moves, 1, 1010, 500), "routing follows the engine position of the device that moved");
+    h.Move(b, 0, 0, 0, 20);
+    h.Flush();
+    Check(Moved(h.moves, 2, 1000, 520), "and switches to the next device that moves");
+    h.Move(a, 0, 0, 5, 0);
+    h.Move(b, 0, 0, 0, 5);
+    h.Move(a, 0, 0, 5, 0);
+    h.Flush();
+    Check(Moved(h.moves, 3, 1020, 500), "one MoveTo per flush, to the last mover");
+    h.Flush();
+    Check(h.moves.size() == 3, "an idle flush under routing moves nothing");
+
+    lock.Lock(0xB, 1000, 525);
+    h.Move(a, 0, 0, 5, 0);
+    h.Flush();
+    Check(Moved(h.moves, 4, 1000, 525), "a lock overrides routing");
+    h.Move(b, 0, 0, 0, 5);
+    h.Flush();
+    Check(Moved(h.moves, 5, 1000, 530), "the locked owner's engine moves are applied");
+
+    lock.Unlock();
+    lock.SetRouting(false);
+    h.Move(a, 0, 0, 5, 0);
+    h.Flush();
+    Check(h.moves.size() == 5, "routing off and unlocked: the engine no longer drives the cursor");
+}
+
+static void TestPhysicalTargets() {
+    Harness h;
+    CursorLock& lock = h.pipeline->Cursor();
+    const uint32_t a = h.Add(0xA);
+
+    // A 100% monitor and a 200% monitor to its right.
+    MonitorLayout layout;
+    layout.Build({ { 1, 0, 0, 1920, 1080, 1.0, 0, 0 }, { 2, 1920, 0, 1280, 720, 2.0, 1920, 0 } });
+    MotionConfig config;
+    config.enabled = true;
+    config.maxX = 3199;
+    config.maxY = 1079;
+    config.originX = 1900;
+    config.originY = 100;
+    h.pipeline->Motion().Configure(config);
+    h.pipeline->Motion().SetLayout(layout);
+
+    lock.SetRouting(true);
+    h.Move(a, 0, 0, 10, 0);
+    h.Flush();
+    Check(Moved(h.moves, 1, 1910, 100), "on the 100% monitor logical and physical agree");
+    h.Move(a, 0, 0, 110, 0);
+    h.Flush();
+    Check(Moved(h.moves, 2, 2120, 200), "on the 200% monitor the sink gets physical pixels");
+
+    lock.SetRouting(false);
+    lock.Lock(0xA, 2000, 300);
+    h.Flush();
+    Check(Moved(h.moves, 3, 2080, 600), "a lock target on the 200% monitor is converted to physical pixels");
+    lock.Lock(0xA, 500, 300);
+    h.Flush();
+    Check(Moved(h.moves, 4, 500, 300), "a lock target on the 100% monitor is unchanged");
+}
+
+static void TestNoSink() {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->Subscriptions().SetDefault(0);
+    const uint32_t a = pipeline->InternDevice(0xA, "mouse");
+    pipeline->Cursor().Lock(0xA, 1, 1);
+    pipeline->IngestEvent(MakeEvent(a, EventType::Move, EventAction::None, 5, 5, 1, 0, 0));
+    pipeline->FlushProducer();
+    Check(pipeline->Cursor().Repositions() == 0, "without a sink the lock is inert");
+}
+
+int main() {
+    TestLockWithoutEngine();
+    TestOwnerLifetime();
+    TestRouting();
+    TestPhysicalTargets();
+    TestNoSink();
+    return failures == 0 ? 0 : 1;
+}
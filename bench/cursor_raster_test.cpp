@@ -0,0 +1,321 @@
+// Golden-image tests for the cursor resampler and tinter (src/cursor_raster.h) and the baked
+// bitmap cache (src/cursor_bitmaps.h). Every resample and tint case must match its recorded output
+// digest, stay within one step of a double-precision reference, and be bit-identical at every SIMD
+// level the CPU supports. Widths are picked to hit the vector loops' tails. Exits non-zero on any
+// failure.
+//
+//   orionix_cursor_raster_test [--print-golden]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../src/cursor_bitmaps.h"
+#include "../src/cursor_raster.h"
+#include "check.h"
+
+typedef std::vector<uint8_t> Pixels;
+
+enum Pattern { Gradient, Arrow, Noise, Solid };
+
+// Premultiplied test images. Noise uses raw mt19937 output, which is the same on every platform.
+static Pixels MakePattern(Pattern pattern, int width, int height) {
+    Pixels pixels((size_t)width * height * 4);
+    std::mt19937 random(11);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = &pixels[((size_t)y * width + x) * 4];
+            uint32_t r = 0, g = 0, b = 0, a = 0;
+            switch (pattern) {
+                case Gradient:
+                    a = (uint32_t)((x + y) * 255 / std::max(1, width + height - 2));
+                    r = 255;
+                    g = (uint32_t)(y * 255 / std::max(1, height - 1));
+                    b = ((x / 3 + y / 3) & 1) ? 255 : 40;
+                    break;
+                case Arrow: {
+                    // A white arrow with a black outline on transparency: hard edges that ring.
+                    const bool inside = x <= y && x + y / 2 < width;
+                    const bool outline = inside && (x == 0 || x == y || x + y / 2 >= width - 2 || y == height - 1);
+                    a = inside ? 255 : 0;
+                    r = g = b = inside && !outline ? 255 : 0;
+                    break;
+                }
+                case Noise: {
+                    const uint32_t bits = random();
+                    a = bits & 0xFF;
+                    r = (bits >> 8) & 0xFF;
+                    g = (bits >> 16) & 0xFF;
+                    b = bits >> 24;
+                    break;
+                }
+                default:
+                    r = 200;
+                    g = 120;
+                    b = 30;
+                    a = 255;
+                    break;
+            }
+            p[0] = (uint8_t)(r * a / 255);
+            p[1] = (uint8_t)(g * a / 255);
+            p[2] = (uint8_t)(b * a / 255);
+            p[3] = (uint8_t)a;
+        }
+    }
+    return pixels;
+}
+
+static uint64_t Digest(const Pixels& pixels) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (uint8_t byte : pixels) {
+        hash = (hash ^ byte) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+static bool Premultiplied(const Pixels& pixels) {
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        if (pixels[i] > pixels[i + 3] || pixels[i + 1] > pixels[i + 3] || pixels[i + 2] > pixels[i + 3]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double Bicubic(double x) {
+    x = std::fabs(x);
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+// One pass of the filter in doubles, along rows or down columns of `lines` lines,
+// rounded to bytes like the kernels' intermediate image.
+static Pixels ReferencePass(const Pixels& src, int srcSize, int dstSize, int lines, bool horizontal) {
+    const double scale = (double)srcSize / dstSize;
+    const double filterScale = std::max(scale, 1.0);
+    const double support = 2.0 * filterScale;
+    Pixels dst((size_t)dstSize * lines * 4);
+    for (int i = 0; i < dstSize; i++) {
+        const double center = (i + 0.5) * scale;
+        const int first = std::max(0, (int)(center - support + 0.5));
+        const int last = std::max(first + 1, std::min(srcSize, (int)(center + support + 0.5)));
+        double total = 0.0;
+        for (int k = first; k < last; k++) {
+            total += Bicubic((k - center + 0.5) / filterScale);
+        }
+        for (int line = 0; line < lines; line++) {
+            double acc[4] = { 0, 0, 0, 0 };
+            for (int k = first; k < last; k++) {
+                const double weight = Bicubic((k - center + 0.5) / filterScale) / total;
+                const size_t at = horizontal ? ((size_t)line * srcSize + k) * 4 : ((size_t)k * lines + line) * 4;
+                for (int c = 0; c < 4; c++) acc[c] += weight * src[at + c];
+            }
+            const size_t out = horizontal ? ((size_t)line * dstSize + i) * 4 : ((size_t)i * lines + line) * 4;
+            const double alpha = std::min(255.0, std::max(0.0, std::round(acc[3])));
+            for (int c = 0; c < 3; c++) dst[out + c] = (uint8_t)std::min(alpha, std::max(0.0, std::round(acc[c])));
+            dst[out + 3] = (uint8_t)alpha;
+        }
+    }
+    return dst;
+}
+
+static Pixels ReferenceResample(const Pixels& src, int srcWidth, int srcHeight, int dstWidth, int dstHeight) {
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        return src;
+    }
+    const Pixels columns = ReferencePass(src, srcWidth, dstWidth, srcHeight, true);
+    return ReferencePass(columns, srcHeight, dstHeight, dstWidth, false);
+}
+
+static int MaxDifference(const Pixels& a, const Pixels& b) {
+    int worst = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        worst = std::max(worst, std::abs((int)a[i] - (int)b[i]));
+    }
+    return worst;
+}
+
+static Pixels Resample(const Pixels& src, int srcWidth, int srcHeight, int dstWidth, int dstHeight, SimdLevel level) {
+    SetSimdLevel(level);
+    Pixels dst((size_t)dstWidth * dstHeight * 4);
+    ResampleRgba(src.data(), srcWidth, srcHeight, dst.data(), dstWidth, dstHeight);
+    return dst;
+}
+
+struct ResampleCase {
+    Pattern pattern;
+    int srcWidth, srcHeight, dstWidth, dstHeight;
+    uint64_t golden;
+};
+
+// Recorded with the scalar kernels; regenerate with --print-golden after an intended change.
+static const ResampleCase kResampleCases[] = {
+    { Arrow, 32, 32, 24, 24, 0x6e656005f6a54f69ull },
+    { Arrow, 32, 32, 48, 48, 0x6db546666fcb246cull },
+    { Arrow, 32, 32, 17, 17, 0x9825de8ecd6edcbbull },
+    { Arrow, 256, 256, 24, 24, 0x88e4cfc1b09eb357ull },
+    { Gradient, 64, 48, 96, 72, 0x0a89ed585dd3575aull },
+    { Gradient, 48, 48, 13, 9, 0xe9d2d87bc04ae4b0ull },
+    { Gradient, 7, 5, 64, 41, 0xaad0747b03eb68b5ull },
+    { Noise, 33, 31, 19, 21, 0x55b49ecf4d873935ull },
+    { Noise, 16, 16, 1, 1, 0x6f4e7a8b9082c291ull },
+    { Noise, 1, 1, 9, 5, 0x2c7b9e7ffd619328ull },
+    { Noise, 128, 3, 31, 11, 0x249488314c0a2efdull },
+};
+
+static void TestResample(bool printGolden) {
+    const SimdLevel detected = DetectSimdLevel();
+    bool golden = true, reference = true, identical = true, premultiplied = true;
+    for (const ResampleCase& c : kResampleCases) {
+        const Pixels src = MakePattern(c.pattern, c.srcWidth, c.srcHeight);
+        const Pixels scalar = Resample(src, c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight, SimdLevel::Scalar);
+        const uint64_t digest = Digest(scalar);
+        if (printGolden) {
+            printf("    { %s, %d, %d, %d, %d, 0x%016llxull },\n", c.pattern == Arrow ? "Arrow" : c.pattern == Gradient ? "Gradient" : "Noise",
+                c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight, (unsigned long long)digest);
+            continue;
+        }
+        if (digest != c.golden) {
+            printf("  %dx%d -> %dx%d: digest 0x%016llx, golden 0x%016llx\n", c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight,
+                (unsigned long long)digest, (unsigned long long)c.golden);
+            golden = false;
+        }
+        const int difference = MaxDifference(scalar, ReferenceResample(src, c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight));
+        if (difference > 1) {
+            printf("  %dx%d -> %dx%d: %d steps from the reference\n", c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight, difference);
+            reference = false;
+        }
+        premultiplied = premultiplied && Premultiplied(scalar);
+        for (int level = (int)SimdLevel::Sse2; level <= (int)detected; level++) {
+            if (Resample(src, c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight, (SimdLevel)level) != scalar) {
+                printf("  %dx%d -> %dx%d: %s differs from scalar\n", c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight,
+                    SimdLevelName((SimdLevel)level));
+                identical = false;
+            }
+        }
+    }
+    SetSimdLevel(detected);
+    if (printGolden) {
+        return;
+    }
+    Check(golden, "resampled images match their golden digests");
+    Check(reference, "resampled images are within one step of a double-precision reference");
+    Check(premultiplied, "ringing never pushes colour above alpha");
+    Check(identical, detected == SimdLevel::Scalar ? "no SIMD level on this CPU; scalar only" : "every SIMD level matches scalar bit for bit");
+
+    const Pixels arrow = MakePattern(Arrow, 32, 32);
+    Check(Resample(arrow, 32, 32, 32, 32, detected) == arrow, "a same-size resample copies the image");
+    const Pixels solid = MakePattern(Solid, 20, 20);
+    Check(Resample(solid, 20, 20, 37, 11, detected) == MakePattern(Solid, 37, 11) &&
+        Resample(solid, 20, 20, 3, 5, detected) == MakePattern(Solid, 3, 5), "a solid colour stays exactly that colour at any size");
+    Check(Resample(Pixels(16 * 16 * 4, 0), 16, 16, 27, 27, detected) == Pixels(27 * 27 * 4, 0), "transparent stays transparent");
+}
+
+// Exact: Div255 rounds to nearest, so the reference can use round().
+static uint8_t ReferenceTint(uint8_t value, uint32_t channel, uint8_t opacity) {
+    const uint32_t multiplier = (uint32_t)std::lround(channel * opacity / 255.0);
+    return (uint8_t)std::lround(value * multiplier / 255.0);
+}
+
+static void TestTint() {
+    const SimdLevel detected = DetectSimdLevel();
+    static const struct {
+        uint32_t rgb;
+        uint8_t opacity;
+    } kTints[] = { { 0xFF0000, 255 }, { 0x00FF00, 230 }, { 0x3366CC, 128 }, { 0xFFFFFF, 77 }, { 0x000000, 255 }, { 0x808080, 1 } };
+
+    bool exact = true, identical = true, premultiplied = true;
+    // 37 pixels: one AVX2 block of 8, SSE2 blocks of 4 and a scalar tail either way.
+    const Pixels noise = MakePattern(Noise, 37, 3);
+    for (const auto& tint : kTints) {
+        Pixels expected = noise;
+        for (size_t i = 0; i < expected.size(); i += 4) {
+            expected[i] = ReferenceTint(noise[i], (tint.rgb >> 16) & 0xFF, tint.opacity);
+            expected[i + 1] = ReferenceTint(noise[i + 1], (tint.rgb >> 8) & 0xFF, tint.opacity);
+            expected[i + 2] = ReferenceTint(noise[i + 2], tint.rgb & 0xFF, tint.opacity);
+            expected[i + 3] = ReferenceTint(noise[i + 3], 255, tint.opacity);
+        }
+        for (int level = (int)SimdLevel::Scalar; level <= (int)detected; level++) {
+            SetSimdLevel((SimdLevel)level);
+            Pixels pixels = noise;
+            TintRgba(pixels.data(), pixels.size() / 4, tint.rgb, tint.opacity);
+            if (level == (int)SimdLevel::Scalar) {
+                exact = exact && pixels == expected;
+                premultiplied = premultiplied && Premultiplied(pixels);
+            } else if (pixels != expected) {
+                identical = false;
+            }
+        }
+    }
+    SetSimdLevel(detected);
+    Check(exact, "tinted pixels match the exact rounded products");
+    Check(premultiplied, "tinting keeps colour at or below alpha");
+    Check(identical, "every SIMD level tints bit for bit like scalar");
+
+    Pixels pixels = noise;
+    TintRgba(pixels.data(), pixels.size() / 4, 0xFFFFFF, 255);
+    Check(pixels == noise, "white at full opacity leaves the image untouched");
+    TintRgba(pixels.data(), pixels.size() / 4, 0xFFFFFF, 0);
+    Check(pixels == Pixels(noise.size(), 0), "zero opacity clears everything");
+
+    uint8_t pixel[4] = { 200, 100, 50, 220 };
+    TintRgba(pixel, 1, 0x8040FF, 128);
+    Check(pixel[0] == 50 && pixel[1] == 13 && pixel[2] == 25 && pixel[3] == 110, "a hand-computed pixel");
+}
+
+static void TestBake() {
+    const Pixels source = MakePattern(Arrow, 32, 48);
+    CachedCursorFrame frame = {};
+    frame.width = 32;
+    frame.height = 48;
+    frame.hotspotX = 31;
+    frame.hotspotY = 10;
+
+    std::shared_ptr<const CursorBitmap> bitmap = BakeCursorBitmap(frame, source.data(), 24, 0xFFFFFF, 255);
+    Check(bitmap->width == 16 && bitmap->height == 24, "a bake fits the longer side to the size and keeps the aspect ratio");
+    Check(bitmap->hotspotX == 15 && bitmap->hotspotY == 5, "the hotspot scales with the frame and stays inside it");
+    Check(bitmap->pixels == Resample(source, 32, 48, 16, 24, DetectSimdLevel()), "an untinted bake is the plain resample");
+
+    bitmap = BakeCursorBitmap(frame, source.data(), 4096, 0x00FF00, 255);
+    Check(bitmap->width == 341 && bitmap->height == kMaxCursorBitmapSize, "sizes are clamped to the largest bitmap");
+    bitmap = BakeCursorBitmap(frame, source.data(), 0, 0x00FF00, 255);
+    Check(bitmap->width == 1 && bitmap->height == 1 && bitmap->hotspotX == 0, "and to at least one pixel");
+
+    CursorBitmapCache cache(2 * 16 * 24 * 4);
+    bool cached = true;
+    CursorBitmapKey key = { 1, 0, 0xFFFFFF, 24, 255 };
+    std::shared_ptr<const CursorBitmap> first = cache.Get(key, frame, source.data(), &cached);
+    Check(!cached && cache.Get(key, frame, source.data(), &cached) == first && cached, "a baked variant is served from the cache");
+    key.rgb = 0xFF0000;
+    cache.Get(key, frame, source.data());
+    key.rgb = 0xFFFFFF;
+    cache.Get(key, frame, source.data());
+    key.rgb = 0x0000FF;
+    cache.Get(key, frame, source.data());
+    key.rgb = 0xFF0000;
+    cache.Get(key, frame, source.data(), &cached);
+    Check(!cached && cache.Count() == 2 && cache.Bytes() <= 2 * 16 * 24 * 4, "the least recently used variant is evicted at capacity");
+    key.rgb = 0x0000FF;
+    cache.Get(key, frame, source.data(), &cached);
+    Check(cached && cache.Hits() == 3 && cache.Misses() == 4, "hits and misses are counted");
+}
+
+int main(int argc, char** argv) {
+    const bool printGolden = argc > 1 && strcmp(argv[1], "--print-golden") == 0;
+    if (argc > 1 && !printGolden) {
+        fprintf(stderr, "Usage: orionix_cursor_raster_test [--print-golden]\n");
+        return 2;
+    }
+    printf("simd: %s\n", SimdLevelName(DetectSimdLevel()));
+    TestResample(printGolden);
+    if (printGolden) {
+        return 0;
+    }
+    TestTint();
+    TestBake();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,599 @@
+// Robustness tests for the cursor file decoder (src/cursor_image.h) and the decoded-cursor cache
+// file (src/cursor_cache.h). Builds .cur and .ani fixtures in memory, then feeds the decoder every
+// truncation, hand-made oversized and malformed headers and chunks, and seeded random mutations,
+// each from a heap buffer of exactly its size so a sanitizer build flags any read past the end.
+// Cache files get the same treatment for their header, entry table and blobs. Anything decoded or
+// served from a damaged cache must still be a well-formed image. Exits non-zero on any failure.
+//
+//   orionix_cursor_robustness_test [--mutations 20000] [--seed 1]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/cursor_cache.h"
+#include "../src/cursor_image.h"
+#include "check.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static void PutU16(Bytes& out, size_t at, uint16_t value) {
+    out[at] = (uint8_t)value;
+    out[at + 1] = (uint8_t)(value >> 8);
+}
+
+static void PutU32(Bytes& out, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[at + i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+static void AppendU32(Bytes& out, uint32_t value) {
+    out.resize(out.size() + 4);
+    PutU32(out, out.size() - 4, value);
+}
+
+static void AppendChunk(Bytes& out, const char* id, const Bytes& body) {
+    out.insert(out.end(), id, id + 4);
+    AppendU32(out, (uint32_t)body.size());
+    out.insert(out.end(), body.begin(), body.end());
+    if (body.size() & 1) {
+        out.push_back(0);
+    }
+}
+
+// BITMAPINFOHEADER, palette, bottom-up colour rows, bottom-up AND mask; pixels follow a pattern.
+static Bytes MakeBitmap(int width, int height, int bits) {
+    const size_t colors = bits <= 8 ? (size_t)1 << bits : 0;
+    const size_t xorStride = ((size_t)width * bits + 31) / 32 * 4;
+    const size_t andStride = ((size_t)width + 31) / 32 * 4;
+    Bytes dib(40 + colors * 4 + (xorStride + andStride) * height, 0);
+    PutU32(dib, 0, 40);
+    PutU32(dib, 4, (uint32_t)width);
+    PutU32(dib, 8, (uint32_t)(height * 2));
+    PutU16(dib, 12, 1);
+    PutU16(dib, 14, (uint16_t)bits);
+    for (size_t i = 0; i < colors; i++) {
+        dib[40 + i * 4] = (uint8_t)(i * 37);
+        dib[40 + i * 4 + 1] = (uint8_t)(i * 91);
+        dib[40 + i * 4 + 2] = (uint8_t)(255 - i);
+    }
+    uint8_t* rows = &dib[40 + colors * 4];
+    for (size_t i = 0; i < xorStride * height; i++) {
+        rows[i] = (uint8_t)(i * 7 + 3);
+    }
+    if (bits == 32) {
+        for (size_t y = 0; y < (size_t)height; y++) {
+            for (size_t x = 0; x < (size_t)width; x++) {
+                rows[y * xorStride + x * 4 + 3] = (uint8_t)(x * 255 / (width - 1 > 0 ? width - 1 : 1));
+            }
+        }
+    }
+    uint8_t* mask = rows + xorStride * height;
+    for (size_t i = 0; i < andStride * height; i++) {
+        mask[i] = (uint8_t)(i % 3 == 0 ? 0xF0 : 0x00);
+    }
+    return dib;
+}
+
+// .cur (type 2) or .ico (type 1) with one directory entry per bitmap.
+static Bytes MakeIcon(uint16_t type, const std::vector<Bytes>& bitmaps, uint16_t hotspotX, uint16_t hotspotY) {
+    Bytes file(6 + 16 * bitmaps.size(), 0);
+    PutU16(file, 2, type);
+    PutU16(file, 4, (uint16_t)bitmaps.size());
+    for (size_t i = 0; i < bitmaps.size(); i++) {
+        const size_t entry = 6 + 16 * i;
+        PutU16(file, entry + 4, hotspotX);
+        PutU16(file, entry + 6, hotspotY);
+        PutU32(file, entry + 8, (uint32_t)bitmaps[i].size());
+        PutU32(file, entry + 12, (uint32_t)file.size());
+        file.insert(file.end(), bitmaps[i].begin(), bitmaps[i].end());
+    }
+    return file;
+}
+
+static Bytes MakeAniHeader(uint32_t frames, uint32_t steps, uint32_t jiffies, uint32_t flags) {
+    Bytes header(36, 0);
+    PutU32(header, 0, 36);
+    PutU32(header, 4, frames);
+    PutU32(header, 8, steps);
+    PutU32(header, 28, jiffies);
+    PutU32(header, 32, flags);
+    return header;
+}
+
+static Bytes MakeTable(const std::vector<uint32_t>& values) {
+    Bytes table;
+    for (uint32_t value : values) {
+        AppendU32(table, value);
+    }
+    return table;
+}
+
+static Bytes MakeFrameList(const std::vector<Bytes>& frames) {
+    Bytes list = { 'f', 'r', 'a', 'm' };
+    for (const Bytes& frame : frames) {
+        AppendChunk(list, "icon", frame);
+    }
+    return list;
+}
+
+static Bytes MakeRiff(const Bytes& chunks) {
+    Bytes file = { 'R', 'I', 'F', 'F' };
+    AppendU32(file, (uint32_t)(chunks.size() + 4));
+    file.insert(file.end(), { 'A', 'C', 'O', 'N' });
+    file.insert(file.end(), chunks.begin(), chunks.end());
+    return file;
+}
+
+// Three frames of different depths played as 0, 2, 1, 2 with per-step rates.
+static Bytes MakeAni() {
+    std::vector<Bytes> frames = {
+        MakeIcon(2, { MakeBitmap(32, 32, 32) }, 1, 2),
+        MakeIcon(2, { MakeBitmap(24, 24, 8) }, 3, 4),
+        MakeIcon(2, { MakeBitmap(15, 17, 1) }, 5, 6),
+    };
+    Bytes chunks;
+    AppendChunk(chunks, "anih", MakeAniHeader(3, 4, 10, 3));
+    AppendChunk(chunks, "rate", MakeTable({ 6, 12, 0, 7200 }));
+    AppendChunk(chunks, "seq ", MakeTable({ 0, 2, 1, 2 }));
+    AppendChunk(chunks, "LIST", MakeFrameList(frames));
+    return MakeRiff(chunks);
+}
+
+static const char* Decode(const Bytes& bytes, CursorImage* image) {
+    // Exactly sized, so a sanitizer catches a read one byte past the end.
+    std::unique_ptr<uint8_t[]> data(new uint8_t[bytes.size() + (bytes.empty() ? 1 : 0)]);
+    if (!bytes.empty()) {
+        memcpy(data.get(), bytes.data(), bytes.size());
+    }
+    return DecodeCursorImage(data.get(), bytes.size(), image);
+}
+
+// What every successful decode must hand out, whatever the input was.
+static bool WellFormed(const CursorImage& image) {
+    if (image.frames.empty() || image.frames.size() > kMaxCursorFrames || image.steps.size() > kMaxCursorSteps) {
+        return false;
+    }
+    for (const CursorFrame& frame : image.frames) {
+        if (frame.width == 0 || frame.width > kMaxCursorDimension || frame.height == 0 || frame.height > kMaxCursorDimension ||
+            frame.hotspotX >= frame.width || frame.hotspotY >= frame.height || frame.pixels.size() != (size_t)frame.width * frame.height * 4) {
+            return false;
+        }
+        for (size_t i = 0; i < frame.pixels.size(); i += 4) {
+            const uint8_t alpha = frame.pixels[i + 3];
+            if (frame.pixels[i] > alpha || frame.pixels[i + 1] > alpha || frame.pixels[i + 2] > alpha) {
+                return false;
+            }
+        }
+    }
+    for (const CursorStep& step : image.steps) {
+        if (step.frame >= image.frames.size() || step.durationMs == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool Fails(const Bytes& bytes, const char* expected) {
+    CursorImage image;
+    const char* error = Decode(bytes, &image);
+    if (!error || strcmp(error, expected) != 0) {
+        printf("  expected \"%s\", got \"%s\"\n", expected, error ? error : "success");
+        return false;
+    }
+    return image.frames.empty() && image.steps.empty();
+}
+
+static void TestFixtures(const std::vector<Bytes>& fixtures) {
+    CursorImage image;
+    Check(!Decode(fixtures[0], &image) && WellFormed(image) && image.frames[0].width == 48 && image.frames[0].hotspotX == 7,
+        "a two-image .cur decodes its largest image and hotspot");
+    Check(!Decode(fixtures[1], &image) && WellFormed(image) && image.frames[0].hotspotX == 8 && image.frames[0].hotspotY == 8,
+        "a 4-bpp .ico decodes with its centre as hotspot");
+    Check(!Decode(fixtures[2], &image) && WellFormed(image) && image.frames.size() == 3 && image.steps.size() == 4 &&
+        image.steps[1].frame == 2 && image.steps[0].durationMs == 100 && image.steps[2].durationMs == 16 && image.steps[3].durationMs == 60000,
+        "an .ani decodes its frames, sequence and clamped rates");
+}
+
+static void TestTruncation(const std::vector<Bytes>& fixtures) {
+    bool wellFormed = true;
+    bool headersRejected = true;
+    size_t decoded = 0;
+    size_t cases = 0;
+    for (const Bytes& fixture : fixtures) {
+        for (size_t length = 0; length < fixture.size(); length++) {
+            const Bytes prefix(fixture.begin(), fixture.begin() + length);
+            CursorImage image;
+            const char* error = Decode(prefix, &image);
+            cases++;
+            if (!error) {
+                decoded++;
+                wellFormed = wellFormed && WellFormed(image);
+            }
+            // Nothing can be decoded before the first image's colour rows are complete.
+            if (length < 6 + 16 + 40) {
+                headersRejected = headersRejected && error;
+            }
+        }
+    }
+    Check(headersRejected, "truncated headers and directories are rejected");
+    Check(wellFormed, "truncations that still decode give well-formed images");
+    printf("  %zu truncations, %zu still decoded from the images before the cut\n", cases, decoded);
+}
+
+static void TestMalformedIcons() {
+    Bytes cur = MakeIcon(2, { MakeBitmap(32, 32, 32) }, 1, 1);
+    Bytes bad = cur;
+    PutU16(bad, 2, 3);
+    Check(Fails(bad, "Not a cursor or icon file"), "an unknown resource type is rejected");
+    bad = cur;
+    PutU16(bad, 4, 0xFFFF);
+    Check(Fails(bad, "Truncated cursor directory"), "a directory count past the end is rejected");
+    bad = cur;
+    PutU32(bad, 6 + 12, 0xFFFFFFF0);
+    Check(Fails(bad, "No usable image in cursor file"), "an image offset past the end is skipped");
+    bad = cur;
+    PutU32(bad, 6 + 8, 0xFFFFFFFF);
+    Check(Fails(bad, "No usable image in cursor file"), "an image size past the end is skipped");
+
+    const size_t dib = 6 + 16;
+    bad = cur;
+    PutU32(bad, dib + 4, 257);
+    Check(Fails(bad, "Cursor bitmap dimensions out of range"), "a width over 256 is rejected");
+    bad = cur;
+    PutU32(bad, dib + 8, (uint32_t)-64);
+    Check(Fails(bad, "No usable image in cursor file"), "a negative height is rejected");
+    bad = cur;
+    PutU32(bad, dib + 4, 0x7FFFFFFF);
+    PutU32(bad, dib + 8, 0x7FFFFFFE);
+    Check(Fails(bad, "Cursor bitmap dimensions out of range"), "huge dimensions are rejected before any allocation");
+    bad = cur;
+    PutU32(bad, dib, 0xFFFFFFFF);
+    Check(Fails(bad, "Unsupported cursor bitmap header"), "a header size past the end is rejected");
+    bad = cur;
+    PutU32(bad, dib + 16, 1);
+    Check(Fails(bad, "Compressed cursor bitmaps are not supported"), "RLE bitmaps are rejected");
+    bad = cur;
+    PutU16(bad, dib + 14, 16);
+    Check(Fails(bad, "Unsupported cursor bit depth"), "16 bpp is rejected");
+
+    Bytes paletted = MakeIcon(2, { MakeBitmap(16, 16, 4) }, 0, 0);
+    bad = paletted;
+    PutU32(bad, dib + 32, 300);
+    Check(Fails(bad, "Cursor palette too large"), "a palette over 256 colours is rejected");
+    bad = paletted;
+    PutU32(bad, dib + 32, 2);
+    Check(Fails(bad, "Cursor palette index out of range"), "a pixel past a short palette is rejected");
+    bad = paletted;
+    bad.resize(bad.size() - 16 * 4 - 1);
+    PutU32(bad, 6 + 8, (uint32_t)(bad.size() - dib));
+    Check(Fails(bad, "Truncated cursor bitmap"), "a paletted bitmap without its full mask is rejected");
+
+    Bytes png(6 + 16 + 64, 0);
+    PutU16(png, 2, 2);
+    PutU16(png, 4, 1);
+    PutU32(png, 6 + 8, 64);
+    PutU32(png, 6 + 12, 6 + 16);
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    memcpy(&png[6 + 16], signature, sizeof(signature));
+    Check(Fails(png, "PNG-compressed cursor images are not supported"), "PNG images are reported as such");
+
+    CursorImage image;
+    bad = cur;
+    PutU16(bad, 6 + 4, 5000);
+    PutU16(bad, 6 + 6, 5000);
+    Check(!Decode(bad, &image) && image.frames[0].hotspotX == 31 && image.frames[0].hotspotY == 31, "an out-of-range hotspot is clamped");
+}
+
+static void TestMalformedAni() {
+    const Bytes frame = MakeIcon(2, { MakeBitmap(8, 8, 32) }, 0, 0);
+    auto ani = [&](const Bytes& header, const std::vector<uint32_t>& rates, const std::vector<uint32_t>& sequence, size_t frames) {
+        Bytes chunks;
+        AppendChunk(chunks, "anih", header);
+        if (!rates.empty()) AppendChunk(chunks, "rate", MakeTable(rates));
+        if (!sequence.empty()) AppendChunk(chunks, "seq ", MakeTable(sequence));
+        AppendChunk(chunks, "LIST", MakeFrameList(std::vector<Bytes>(frames, frame)));
+        return MakeRiff(chunks);
+    };
+    const Bytes header = MakeAniHeader(2, 2, 6, 1);
+
+    Check(Fails(ani(Bytes(header.begin(), header.begin() + 20), {}, {}, 2), "Truncated ANI header"), "a short anih chunk is rejected");
+    Check(Fails(ani(MakeAniHeader(2, 2, 6, 0), {}, {}, 2), "Raw-bitmap ANI frames are not supported"), "raw-bitmap frames are rejected");
+    Check(Fails(ani(header, { 6, 6, 6 }, {}, 2), "ANI rate table does not match its steps"), "a rate table of the wrong length is rejected");
+    Check(Fails(ani(header, {}, { 0, 2 }, 2), "ANI sequence references a missing frame"), "a sequence past the frames is rejected");
+    Check(Fails(ani(header, {}, std::vector<uint32_t>(kMaxCursorSteps + 1, 0), 2), "Too many ANI steps"), "more than 1024 steps are rejected");
+    Check(Fails(ani(header, {}, {}, kMaxCursorFrames + 1), "Too many ANI frames"), "more than 256 frames are rejected");
+    Check(Fails(ani(header, {}, {}, 0), "ANI file has no frames"), "an empty frame list is rejected");
+
+    Bytes noHeader;
+    AppendChunk(noHeader, "LIST", MakeFrameList({ frame }));
+    Check(Fails(MakeRiff(noHeader), "Missing ANI header"), "a missing anih chunk is rejected");
+
+    // 256 frames of 256x256 would need 64 MiB of pixels.
+    Bytes big = MakeIcon(2, { MakeBitmap(256, 256, 32) }, 0, 0);
+    Bytes bigChunks;
+    AppendChunk(bigChunks, "anih", header);
+    AppendChunk(bigChunks, "LIST", MakeFrameList(std::vector<Bytes>(80, big)));
+    Check(Fails(MakeRiff(bigChunks), "Animated cursor too large"), "the total pixel budget is enforced");
+
+    Bytes chunk = ani(header, {}, {}, 2);
+    Bytes bad = chunk;
+    PutU32(bad, 16, 0xFFFFFFF0);
+    Check(Fails(bad, "Truncated ANI chunk"), "a chunk length past the end is rejected");
+    bad = chunk;
+    // First "icon" sub-chunk length inside LIST fram: RIFF(12) + anih(8 + 36) + LIST(8) + "fram".
+    PutU32(bad, 12 + 44 + 8 + 4 + 4, 0x7FFFFFFF);
+    Check(Fails(bad, "Truncated ANI frame"), "a frame length past its list is rejected");
+    bad = chunk;
+    PutU32(bad, 4, 20);
+    Check(Fails(bad, "Truncated ANI chunk"), "a RIFF size shorter than its chunks is rejected");
+    bad = chunk;
+    PutU32(bad, 4, 0xFFFFFFFF);
+    CursorImage image;
+    Check(!Decode(bad, &image) && WellFormed(image), "a RIFF size past the end is clipped to the file");
+    bad = chunk;
+    PutU16(bad, 12 + 44 + 8 + 4 + 8 + 4, 0xFFFF);
+    Check(Fails(bad, "Truncated cursor directory"), "a damaged frame fails the whole file");
+}
+
+static void TestMutations(const std::vector<Bytes>& fixtures, int mutations, uint32_t seed) {
+    std::mt19937 random(seed);
+    static const uint32_t kInteresting[] = { 0, 1, 2, 0x7F, 0x80, 0xFF, 0x100, 0x101, 0x7FFF, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF };
+    bool wellFormed = true;
+    int decoded = 0;
+    for (int i = 0; i < mutations; i++) {
+        Bytes bytes = fixtures[random() % fixtures.size()];
+        const int edits = 1 + (int)(random() % 4);
+        for (int e = 0; e < edits; e++) {
+            const size_t at = random() % bytes.size();
+            switch (random() % 4) {
+                case 0:
+                    bytes[at] ^= (uint8_t)(1 << (random() % 8));
+                    break;
+                case 1:
+                    bytes[at] = (uint8_t)random();
+                    break;
+                case 2:
+                    if (at + 4 <= bytes.size()) {
+                        PutU32(bytes, at, kInteresting[random() % (sizeof(kInteresting) / sizeof(kInteresting[0]))]);
+                    }
+                    break;
+                default:
+                    bytes.resize(at + 1);
+                    break;
+            }
+        }
+        CursorImage image;
+        if (!Decode(bytes, &image)) {
+            decoded++;
+            wellFormed = wellFormed && WellFormed(image);
+        } else {
+            wellFormed = wellFormed && image.frames.empty() && image.steps.empty();
+        }
+    }
+    Check(wellFormed, "random mutations either fail cleanly or decode well-formed images");
+    printf("  %d mutations, %d still decoded\n", mutations, decoded);
+}
+
+static bool WriteFile(const std::string& path, const Bytes& bytes) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+static Bytes ReadFile(const std::string& path) {
+    Bytes bytes;
+    if (FILE* file = fopen(path.c_str(), "rb")) {
+        uint8_t buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            bytes.insert(bytes.end(), buffer, buffer + read);
+        }
+        fclose(file);
+    }
+    return bytes;
+}
+
+static bool ViewWellFormed(const CursorView& view) {
+    if (view.frameCount == 0 || view.frameCount > kMaxCursorFrames || view.stepCount > kMaxCursorSteps || !view.frames || !view.pixels) {
+        return false;
+    }
+    for (uint32_t i = 0; i < view.frameCount; i++) {
+        const CachedCursorFrame& frame = view.frames[i];
+        if (frame.width == 0 || frame.width > kMaxCursorDimension || frame.height == 0 || frame.height > kMaxCursorDimension ||
+            frame.hotspotX >= frame.width || frame.hotspotY >= frame.height) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < view.stepCount; i++) {
+        if (view.steps[i].frame >= view.frameCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool SameAsDecoded(const CursorView& view, const CursorImage& image) {
+    if (view.frameCount != image.frames.size() || view.stepCount != image.steps.size()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < view.frameCount; i++) {
+        const CursorFrame& frame = image.frames[i];
+        if (view.frames[i].width != frame.width || view.frames[i].height != frame.height ||
+            memcmp(view.pixels + view.frames[i].pixelOffset, frame.pixels.data(), frame.pixels.size()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Opens `cache` as the cache file and loads every cursor through it. A damaged cache may serve
+// nothing, but whatever it serves must be well-formed, and what it does not serve is decoded.
+static bool LoadThrough(const std::string& cachePath, const Bytes& cache, const std::vector<std::string>& files,
+    const std::vector<CursorImage>& images, int* served, bool exact) {
+    WriteFile(cachePath, cache);
+    CursorCache cursorCache;
+    cursorCache.Open(cachePath);
+    *served = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        CursorView view;
+        bool cached = false;
+        if (cursorCache.Load(files[i], &view, &cached) || !ViewWellFormed(view)) {
+            return false;
+        }
+        if (cached) {
+            (*served)++;
+        }
+        if ((exact || !cached) && !SameAsDecoded(view, images[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestCacheFile(const std::vector<Bytes>& fixtures, int mutations, uint32_t seed) {
+    const std::string prefix = "orionix_robustness_";
+    const std::string cachePath = prefix + "cursors.cache";
+    std::vector<std::string> files;
+    std::vector<CursorImage> images(fixtures.size());
+    for (size_t i = 0; i < fixtures.size(); i++) {
+        files.push_back(prefix + std::to_string(i) + (i == 2 ? ".ani" : ".cur"));
+        WriteFile(files.back(), fixtures[i]);
+        Decode(fixtures[i], &images[i]);
+    }
+
+    remove(cachePath.c_str());
+    CursorCache cold;
+    cold.Open(cachePath);
+    for (const std::string& file : files) {
+        CursorView view;
+        bool cached;
+        cold.Load(file, &view, &cached);
+    }
+    Check(cold.Save() == nullptr, "a cold cache is written");
+    const Bytes valid = ReadFile(cachePath);
+
+    int served = 0;
+    Check(LoadThrough(cachePath, valid, files, images, &served, true) && served == (int)files.size(), "an intact cache serves every cursor exactly");
+
+    const uint32_t count = (uint32_t)fixtures.size();
+    const size_t table = 16;
+    const size_t tableEnd = table + count * sizeof(CursorCacheEntry);
+    auto damaged = [&](const char* what, void (*damage)(Bytes&, size_t, size_t)) {
+        Bytes bytes = valid;
+        damage(bytes, table, tableEnd);
+        const bool ok = LoadThrough(cachePath, bytes, files, images, &served, false);
+        Check(ok && served == 0, what);
+    };
+    damaged("a wrong magic is ignored", [](Bytes& b, size_t, size_t) { b[0] = 'X'; });
+    damaged("another version is ignored", [](Bytes& b, size_t, size_t) { PutU16(b, 6, kCursorCacheVersion + 1); });
+    damaged("an entry count over the limit is ignored", [](Bytes& b, size_t, size_t) { PutU32(b, 8, kMaxCursorCacheEntries + 1); });
+    damaged("a table past the end of the file is ignored", [](Bytes& b, size_t, size_t) { PutU32(b, 8, 1000); });
+    damaged("a header cut short is ignored", [](Bytes& b, size_t, size_t) { b.resize(12); });
+    damaged("a table cut short is ignored", [](Bytes& b, size_t, size_t end) { b.resize(end - 1); });
+    damaged("a blob offset inside the table is ignored", [](Bytes& b, size_t t, size_t) { PutU32(b, t + 8, (uint32_t)t); });
+    damaged("a misaligned blob offset is ignored", [](Bytes& b, size_t t, size_t) { b[t + 8] += 1; });
+    damaged("a blob past the end of the file is ignored", [](Bytes& b, size_t t, size_t) { PutU32(b, t + 16, 0x7FFFFFFF); });
+    damaged("unsorted hashes are ignored", [](Bytes& b, size_t t, size_t) {
+        std::swap_ranges(b.begin() + t, b.begin() + t + 8, b.begin() + t + sizeof(CursorCacheEntry));
+    });
+
+    // Blob damage only costs the damaged entry: it is decoded again, the others are still served.
+    auto blobDamaged = [&](const char* what, size_t field, uint32_t value) {
+        bool all = true;
+        for (uint32_t entry = 0; entry < count; entry++) {
+            Bytes bytes = valid;
+            size_t offset;
+            memcpy(&offset, &bytes[table + entry * sizeof(CursorCacheEntry) + 8], sizeof(offset));
+            PutU32(bytes, offset + field, value);
+            all = all && LoadThrough(cachePath, bytes, files, images, &served, false) && served == (int)count - 1;
+        }
+        Check(all, what);
+    };
+    blobDamaged("a blob without frames is decoded again", 0, 0);
+    blobDamaged("a blob with too many frames is decoded again", 0, kMaxCursorFrames + 1);
+    blobDamaged("a blob with too many steps is decoded again", 4, kMaxCursorSteps + 1);
+    blobDamaged("a blob whose tables overrun it is decoded again", 4, kMaxCursorSteps);
+    blobDamaged("a zero-sized frame is decoded again", 8, 0);
+    blobDamaged("a frame over 256 pixels is decoded again", 8, 0x01000101);
+    blobDamaged("a hotspot outside its frame is decoded again", 12, 0xFFFFFFFF);
+    blobDamaged("pixels past the blob are decoded again", 16, 0x7FFFFFFF);
+
+    bool steps = true;
+    {
+        // The .ani blob: 3 frames, so its first step's frame index follows 8 + 3 * 12 bytes.
+        Bytes bytes = valid;
+        for (uint32_t entry = 0; entry < count; entry++) {
+            size_t offset;
+            uint32_t frames;
+            memcpy(&offset, &bytes[table + entry * sizeof(CursorCacheEntry) + 8], sizeof(offset));
+            memcpy(&frames, &bytes[offset], sizeof(frames));
+            if (frames == 3) {
+                PutU32(bytes, offset + 8 + 3 * sizeof(CachedCursorFrame), 3);
+            }
+        }
+        steps = LoadThrough(cachePath, bytes, files, images, &served, false) && served == (int)count - 1;
+    }
+    Check(steps, "a step naming a missing frame is decoded again");
+
+    std::mt19937 random(seed);
+    bool robust = true;
+    int servedTotal = 0;
+    for (int i = 0; i < mutations && robust; i++) {
+        Bytes bytes = valid;
+        const int edits = 1 + (int)(random() % 4);
+        for (int e = 0; e < edits; e++) {
+            const size_t at = random() % bytes.size();
+            if (random() % 8 == 0) {
+                bytes.resize(at + 1);
+            } else {
+                bytes[at] ^= (uint8_t)(1 + random() % 255);
+            }
+        }
+        robust = LoadThrough(cachePath, bytes, files, images, &served, false);
+        servedTotal += served;
+    }
+    Check(robust, "randomly damaged caches only ever serve well-formed cursors");
+    printf("  %d damaged caches, %d cursors still served from them\n", mutations, servedTotal);
+
+    remove(cachePath.c_str());
+    for (const std::string& file : files) {
+        remove(file.c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    int mutations = 20000;
+    uint32_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--mutations") == 0) {
+            mutations = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "Usage: orionix_cursor_robustness_test [--mutations N] [--seed N]\n");
+            return 2;
+        }
+    }
+
+    const std::vector<Bytes> fixtures = {
+        MakeIcon(2, { MakeBitmap(32, 32, 32), MakeBitmap(48, 48, 24) }, 7, 9),
+        MakeIcon(1, { MakeBitmap(16, 16, 4) }, 0, 0),
+        MakeAni(),
+    };
+    TestFixtures(fixtures);
+    TestTruncation(fixtures);
+    TestMalformedIcons();
+    TestMalformedAni();
+    TestMutations(fixtures, mutations, seed);
+    TestCacheFile(fixtures, mutations / 10, seed);
+    return failures == 0 ? 0 : 1;
+}
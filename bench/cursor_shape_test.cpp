@@ -0,0 +1,181 @@
+// Tests the X11 cursor shape watcher (src/cursor_shape_x11.cpp). Always: the cursor-name table
+// maps every cursor-font name and freedesktop/CSS alias the overlay relies on, unknown names are
+// Custom, and without a display Start fails cleanly. With a display (e.g. under Xvfb): the current
+// shape is reported on Start, a named cursor set on the root window is reported once, a repeat is
+// not, and Stop returns promptly. That part is skipped, with a note, when no display opens.
+// Exits non-zero on any failure. Linux only.
+
+#include <X11/Xlib.h>
+#include <X11/cursorfont.h>
+#include <X11/extensions/Xfixes.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/cursor_shape.h"
+#include "check.h"
+
+static void TestNames() {
+    static const struct {
+        const char* name;
+        CursorType shape;
+    } kExpected[] = {
+        { "left_ptr", CursorType::Arrow }, { "default", CursorType::Arrow },
+        { "xterm", CursorType::IBeam }, { "text", CursorType::IBeam },
+        { "watch", CursorType::Wait }, { "wait", CursorType::Wait },
+        { "left_ptr_watch", CursorType::AppStarting }, { "progress", CursorType::AppStarting },
+        { "crosshair", CursorType::Cross }, { "sb_up_arrow", CursorType::UpArrow },
+        { "hand2", CursorType::Hand }, { "pointer", CursorType::Hand },
+        { "question_arrow", CursorType::Help }, { "help", CursorType::Help },
+        { "crossed_circle", CursorType::No }, { "not-allowed", CursorType::No },
+        { "sb_v_double_arrow", CursorType::SizeNS }, { "ns-resize", CursorType::SizeNS },
+        { "sb_h_double_arrow", CursorType::SizeWE }, { "ew-resize", CursorType::SizeWE },
+        { "bd_double_arrow", CursorType::SizeNWSE }, { "nwse-resize", CursorType::SizeNWSE },
+        { "fd_double_arrow", CursorType::SizeNESW }, { "nesw-resize", CursorType::SizeNESW },
+        { "fleur", CursorType::SizeAll }, { "move", CursorType::SizeAll },
+    };
+
+    bool all = true;
+    bool covered[(int)CursorType::Count] = {};
+    for (const auto& expected : kExpected) {
+        const CursorType shape = ClassifyCursorName(expected.name);
+        if (shape != expected.shape) {
+            printf("  %s -> %s, expected %s\n", expected.name, CursorTypeName(shape), CursorTypeName(expected.shape));
+            all = false;
+        }
+        covered[(int)shape] = true;
+    }
+    Check(all, "cursor-font names and CSS aliases map to their shapes");
+
+    bool complete = true;
+    for (int i = 0; i < (int)CursorType::Count; i++) {
+        const CursorType shape = (CursorType)i;
+        if (shape != CursorType::Hidden && shape != CursorType::Custom) {
+            complete = complete && covered[i];
+        }
+    }
+    Check(complete, "every named shape is reachable from some cursor name");
+
+    Check(ClassifyCursorName("dnd-copy") == CursorType::Custom && ClassifyCursorName("") == CursorType::Custom &&
+        ClassifyCursorName("XTERM") == CursorType::Custom && ClassifyCursorName(nullptr) == CursorType::Custom,
+        "unknown, empty, differently cased and missing names are Custom");
+    Check(strcmp(CursorTypeName(CursorType::SizeNESW), "SizeNESW") == 0 && strcmp(CursorTypeName(CursorType::Count), "Custom") == 0,
+        "shape names match the overlay's cursor types");
+}
+
+static void TestWithoutDisplay() {
+    const char* display = getenv("DISPLAY");
+    const std::string saved = display ? display : "";
+    setenv("DISPLAY", ":orionix-no-such-display", 1);
+
+    std::unique_ptr<CursorShapeSource> source = CreateCursorShapeSource();
+    int calls = 0;
+    const char* error = source->Start([](CursorType, void* context) { (*(int*)context)++; }, &calls);
+    Check(error != nullptr && calls == 0, "Start without a display fails without reporting");
+    source->Stop();
+    Check(source->Start([](CursorType, void*) {}, nullptr) != nullptr, "a failed source can be retried and fails again");
+    source.reset();
+
+    if (display) {
+        setenv("DISPLAY", saved.c_str(), 1);
+    } else {
+        unsetenv("DISPLAY");
+    }
+}
+
+struct Recorder {
+    std::mutex mutex;
+    std::vector<CursorType> shapes;
+
+    static void OnChange(CursorType shape, void* context) {
+        Recorder* recorder = (Recorder*)context;
+        std::lock_guard<std::mutex> lock(recorder->mutex);
+        recorder->shapes.push_back(shape);
+    }
+
+    size_t Count() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return shapes.size();
+    }
+
+    CursorType Last() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return shapes.empty() ? CursorType::Count : shapes.back();
+    }
+
+    bool WaitFor(size_t count) {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (Count() < count && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return Count() >= count;
+    }
+};
+
+// Cursors created from the core font carry no name unless a theme library names them; the
+// watcher classifies by name, so name them the way libXcursor would.
+static void SetRootCursor(Display* display, unsigned int glyph, const char* name) {
+    Cursor cursor = XCreateFontCursor(display, glyph);
+    XFixesSetCursorName(display, cursor, name);
+    XDefineCursor(display, DefaultRootWindow(display), cursor);
+    XFreeCursor(display, cursor);
+    XFlush(display);
+}
+
+static void TestWithDisplay() {
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        printf("skip live watcher: no X display (run under xvfb-run to include it)\n");
+        return;
+    }
+    // The displayed cursor only follows the root window's while the pointer is over it.
+    XWarpPointer(display, None, DefaultRootWindow(display), 0, 0, 0, 0, 1, 1);
+    SetRootCursor(display, XC_left_ptr, "left_ptr");
+    XSync(display, False);
+
+    Recorder recorder;
+    std::unique_ptr<CursorShapeSource> source = CreateCursorShapeSource();
+    const char* error = source->Start(Recorder::OnChange, &recorder);
+    Check(error == nullptr, error ? error : "Start watches the display");
+    if (error) {
+        XCloseDisplay(display);
+        return;
+    }
+    Check(recorder.Count() == 1 && recorder.Last() == CursorType::Arrow, "Start reports the current shape first");
+
+    SetRootCursor(display, XC_xterm, "xterm");
+    Check(recorder.WaitFor(2) && recorder.Last() == CursorType::IBeam, "a cursor change is reported");
+
+    SetRootCursor(display, XC_xterm, "text");
+    SetRootCursor(display, XC_watch, "watch");
+    Check(recorder.WaitFor(3) && recorder.Last() == CursorType::Wait, "the next distinct shape is reported");
+    Check(recorder.Count() == 3, "an alias of the current shape is not reported again");
+
+    SetRootCursor(display, XC_fleur, "dnd-move");
+    Check(recorder.WaitFor(4) && recorder.Last() == CursorType::Custom, "an unknown name is reported as Custom");
+
+    const auto start = std::chrono::steady_clock::now();
+    source->Stop();
+    const auto stopMillis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    Check(stopMillis < 500, "Stop returns promptly");
+
+    const size_t reported = recorder.Count();
+    SetRootCursor(display, XC_hand2, "hand2");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Check(recorder.Count() == reported, "nothing is reported after Stop");
+    XCloseDisplay(display);
+}
+
+int main() {
+    TestNames();
+    TestWithoutDisplay();
+    TestWithDisplay();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+// Multi-process stress of the shared-memory cursor table (Linux/POSIX: shm_open + fork). One
+// writer rewrites every slot as fast as it can, removing and re-adding slots as it goes, while
+// reader processes snapshot the table and check each cursor state against the invariants the
+// writer derives from a single counter. Any mismatch is a torn read. Prints a JSON report on
+// stdout (or --out) and exits non-zero if a reader saw a torn state.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../src/cursor_state_table.h"
+
+struct StressConfig {
+    int readers = 4;
+    int cursors = 16;
+    double seconds = 5.0;
+    std::string outPath;
+};
+
+struct ReaderReport {
+    uint64_t snapshots = 0;
+    uint64_t states = 0;
+    uint64_t torn = 0;
+    uint64_t retries = 0;
+    uint64_t versionRegressions = 0;
+};
+
+static double NowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Every field of the state written for slot `slot` at step `n` follows from those two values.
+static CursorSlotState MakeState(uint32_t slot, uint64_t n) {
+    CursorSlotState state = {};
+    state.x = (double)n;
+    state.y = -(double)n * 0.5;
+    state.flags = kCursorSlotActive | kCursorSlotVisible | ((n & 1) ? kCursorSlotFocused : 0);
+    state.color = (uint32_t)(n * 2654435761u) & 0xFFFFFF;
+    state.inputSeq = (uint32_t)n;
+    state.reserved = slot;
+    snprintf(state.id, sizeof(state.id), "device_%u", slot);
+    snprintf(state.type, sizeof(state.type), "t%llu", (unsigned long long)(n % 1000003));
+    return state;
+}
+
+static bool IsConsistent(const CursorSlotState& state) {
+    CursorSlotState expected = MakeState(state.reserved, (uint64_t)state.x);
+    return memcmp(&state, &expected, sizeof(state)) == 0;
+}
+
+static bool ParseArgs(int argc, char** argv, StressConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--readers") {
+            config.readers = atoi(value);
+        } else if (arg == "--cursors") {
+            config.cursors = atoi(value);
+        } else if (arg == "--seconds") {
+            config.seconds = atof(value);
+        } else if (arg == "--out") {
+            config.outPath = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.readers < 1 || config.cursors < 1 || config.cursors > (int)kCursorTableSlots || config.seconds <= 0) {
+        fprintf(stderr, "--readers and --seconds must be positive, --cursors between 1 and %zu\n", kCursorTableSlots);
+        return false;
+    }
+    return true;
+}
+
+static ReaderReport RunReader(const std::string& name, double until) {
+    ReaderReport report;
+    CursorStateTable table;
+    if (table.Open(name)) {
+        report.torn = 1;
+        return report;
+    }
+
+    CursorSlotState states[kCursorTableSlots];
+    uint32_t lastVersion = 0;
+    while (NowSeconds() < until) {
+        uint32_t version = table.Version();
+        report.versionRegressions += (int32_t)(version - lastVersion) < 0;
+        lastVersion = version;
+
+        size_t count = table.Snapshot(states, kCursorTableSlots);
+        report.snapshots++;
+        report.states += count;
+        for (size_t i = 0; i < count; i++) {
+            report.torn += !IsConsistent(states[i]);
+        }
+    }
+    report.retries = table.Retries();
+    return report;
+}
+
+int main(int argc, char** argv) {
+    StressConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr, "Usage: orionix_cursor_table_stress [--readers N] [--cursors N] [--seconds S] [--out report.json]\n");
+        return 2;
+    }
+
+    std::string name = "orionix-table-stress-" + std::to_string(getpid());
+    CursorStateTable writer;
+    if (const char* error = writer.Create(name)) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+
+    double start = NowSeconds() + 0.2;
+    double until = start + config.seconds;
+    std::vector<std::pair<pid_t, int>> readers;
+    for (int i = 0; i < config.readers; i++) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            ReaderReport report = RunReader(name, until);
+            bool ok = write(fds[1], &report, sizeof(report)) == (ssize_t)sizeof(report);
+            _exit(ok ? 0 : 1);
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        readers.emplace_back(pid, fds[0]);
+    }
+
+    uint64_t writes = 0, removes = 0, n = 0;
+    while (NowSeconds() < start) {
+    }
+    while (NowSeconds() < until) {
+        for (int slot = 0; slot < config.cursors; slot++) {
+            n++;
+            // Churn slot ownership too: a removed cursor must vanish, never come back torn.
+            if (n % 4096 == 0) {
+                char id[32];
+                snprintf(id, sizeof(id), "device_%d", slot);
+                removes += writer.Remove(id);
+                continue;
+            }
+            writes += writer.Write(MakeState((uint32_t)slot, n));
+        }
+    }
+
+    ReaderReport total;
+    bool readersOk = true;
+    for (const auto& reader : readers) {
+        ReaderReport report;
+        readersOk = read(reader.second, &report, sizeof(report)) == (ssize_t)sizeof(report) && readersOk;
+        close(reader.second);
+        int status = 0;
+        waitpid(reader.first, &status, 0);
+        readersOk = readersOk && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        total.snapshots += report.snapshots;
+        total.states += report.states;
+        total.torn += report.torn;
+        total.retries += report.retries;
+        total.versionRegressions += report.versionRegressions;
+    }
+    writer.Close();
+
+    FILE* out = stdout;
+    if (!config.outPath.empty()) {
+        out = fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", config.outPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"readers\": %d, \"cursors\": %d, \"seconds\": %.1f},\n", config.readers, config.cursors, config.seconds);
+    fprintf(out, "  \"writer\": {\"writes\": %llu, \"removes\": %llu, \"writesPerSecond\": %.0f},\n",
+        (unsigned long long)writes, (unsigned long long)removes, writes / config.seconds);
+    fprintf(out, "  \"readers\": {\"snapshots\": %llu, \"states\": %llu, \"retries\": %llu, \"versionRegressions\": %llu, \"torn\": %llu}\n",
+        (unsigned long long)total.snapshots, (unsigned long long)total.states, (unsigned long long)total.retries,
+        (unsigned long long)total.versionRegressions, (unsigned long long)total.torn);
+    fprintf(out, "}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return readersOk && total.torn == 0 && total.versionRegressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// Compares per-event object delivery with batch mode (enableBatchMode) at several event rates.
+// Runs on the JS thread only, without the input thread: every simulated millisecond it ingests
+// rate/1000 moves through simulateMouseMove and drains them with processMessages, like one async
+// wakeup per millisecond. A third pass with the move subscription off costs the same ingestion but
+// delivers nothing; it is subtracted to give the delivery cost alone. Prints a JSON report.
+//
+//   node bench/delivery_bench.js [--rates 10000,50000,100000] [--seconds 2] [--devices 4] [--module path/to/Orionix_raw_input.node]
+
+const path = require('path');
+
+const BATCH_RECORD_INT32S = 10;
+
+const round1 = (value) => Math.round(value * 10) / 10;
+
+function parseArgs(argv) {
+  const config = {
+    rates: [10000, 50000, 100000],
+    seconds: 2,
+    devices: 4,
+    modulePath: path.join(__dirname, '..', 'build', 'Release', 'Orionix_raw_input.node'),
+  };
+  for (let i = 0; i < argv.length; i += 2) {
+    if (argv[i] === '--rates') config.rates = argv[i + 1].split(',').map(Number);
+    else if (argv[i] === '--seconds') config.seconds = Number(argv[i + 1]);
+    else if (argv[i] === '--devices') config.devices = Number(argv[i + 1]);
+    else if (argv[i] === '--module') config.modulePath = path.resolve(argv[i + 1]);
+    else throw new Error(`Unknown option: ${argv[i]}`);
+  }
+  return config;
+}
+
+// Returns the CPU microseconds one simulated run costs and how many moves reached JS.
+function run(rawInput, mode, rate, seconds, devices) {
+  let delivered = 0;
+  let checksum = 0;
+  rawInput.setSubscription(mode === 'baseline' ? ['button', 'device'] : ['move', 'button', 'device']);
+  rawInput.setCallbacks(
+    (event) => {
+      delivered++;
+      checksum += event.x + event.dx;
+    },
+    () => {}
+  );
+  if (mode === 'batch') {
+    const ints = new Int32Array(
+      rawInput.enableBatchMode((count) => {
+        for (let i = 0; i < count; i++) {
+          const base = i * BATCH_RECORD_INT32S;
+          checksum += ints[base + 2] + ints[base + 4];
+        }
+        delivered += count;
+      }, 1024)
+    );
+  } else {
+    rawInput.disableBatchMode();
+  }
+
+  const perTick = rate / 1000;
+  const ticks = Math.round(seconds * 1000);
+  let owed = 0;
+  let injected = 0;
+  const start = process.cpuUsage();
+  for (let tick = 0; tick < ticks; tick++) {
+    owed += perTick;
+    for (; owed >= 1; owed--) {
+      rawInput.simulateMouseMove(1, -1, 1 + (injected++ % devices));
+    }
+    rawInput.processMessages();
+  }
+  const cpu = process.cpuUsage(start);
+  rawInput.disableBatchMode();
+  return { cpuMicros: cpu.user + cpu.system, injected, delivered, checksum };
+}
+
+function main() {
+  const config = parseArgs(process.argv.slice(2));
+  const rawInput = require(config.modulePath);
+  // Folding would hide the per-event cost this bench is about.
+  rawInput.setCoalescing('off');
+
+  // Warm up both paths so the JIT has settled before anything is measured.
+  for (const mode of ['baseline', 'objects', 'batch']) run(rawInput, mode, 10000, 0.5, config.devices);
+
+  const results = [];
+  let ok = true;
+  for (const rate of config.rates) {
+    const runs = {};
+    for (const mode of ['baseline', 'objects', 'batch']) runs[mode] = run(rawInput, mode, rate, config.seconds, config.devices);
+    const events = runs.objects.injected;
+    const delivery = (mode) => Math.max(0, runs[mode].cpuMicros - runs.baseline.cpuMicros) / events;
+    ok = ok && runs.objects.delivered === events && runs.batch.delivered === events && runs.baseline.delivered === 0;
+    results.push({
+      rate,
+      events,
+      // Share of one core the JS thread needs to keep up with this rate.
+      cpuPercent: {
+        baseline: round1((runs.baseline.cpuMicros / (config.seconds * 1e6)) * 100),
+        objects: round1((runs.objects.cpuMicros / (config.seconds * 1e6)) * 100),
+        batch: round1((runs.batch.cpuMicros / (config.seconds * 1e6)) * 100),
+      },
+      deliveryNsPerEvent: { objects: round1(delivery('objects') * 1000), batch: round1(delivery('batch') * 1000) },
+      speedup: delivery('batch') > 0 ? round1(delivery('objects') / delivery('batch')) : null,
+    });
+  }
+
+  console.log(JSON.stringify({ config: { ...config, modulePath: undefined }, ok, results }, null, 2));
+  process.exit(ok ? 0 : 1);
+}
+
+main();
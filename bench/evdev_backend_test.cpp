@@ -0,0 +1,240 @@
+// Functional test of the evdev backend. Without any device (empty ORIONIX_INPUT_DIR): floods
+// InjectMove from several threads with nobody draining, then checks that Stop returns promptly
+// and that every injected move was ingested; repeats start/stop cycles under load. With write
+// access to /dev/uinput: a virtual mouse sends frames that move and click in the same report,
+// and each button must follow the frame's move and carry its position. That part is skipped,
+// with a note, when /dev/uinput is not writable. Exits non-zero on any failure. Linux only.
+//
+//   orionix_evdev_backend_test [--injections 200000]
+
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/input_backend.h"
+#include "../src/input_pipeline.h"
+#include "check.h"
+
+static const char* kTestMouseName = "Orionix Backend Test Mouse";
+
+// Stops on a helper thread so a hang shows up as a failed check instead of a stuck test.
+static bool StopWithin(InputBackend& backend, int64_t timeoutMicros) {
+    std::atomic<bool> stopped{false};
+    std::thread stopper([&]() {
+        backend.Stop();
+        stopped.store(true);
+    });
+    const int64_t end = NowMicros() + timeoutMicros;
+    while (!stopped.load() && NowMicros() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!stopped.load()) {
+        // Nothing sensible is left to do with a backend that will not stop.
+        fprintf(stderr, "Stop did not return within %lld ms\n", (long long)(timeoutMicros / 1000));
+        fflush(stdout);
+        _exit(1);
+    }
+    stopper.join();
+    return true;
+}
+
+static void TestStopUnderLoad(uint64_t injections) {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->Subscriptions().SetDefault(0);   // ingested and counted, never queued
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+    if (const char* error = backend->Start()) {
+        Check(false, error);
+        return;
+    }
+
+    const int threads = 4;
+    std::vector<std::thread> injectors;
+    for (int t = 0; t < threads; t++) {
+        injectors.emplace_back([&backend, injections, t]() {
+            for (uint64_t i = 0; i < injections / threads; i++) {
+                backend->InjectMove(1 + (uint64_t)t, 1, -1);
+            }
+        });
+    }
+    for (std::thread& injector : injectors) {
+        injector.join();
+    }
+
+    const int64_t start = NowMicros();
+    StopWithin(*backend, 2000000);
+    const int64_t stopMicros = NowMicros() - start;
+    InputStatsSnapshot stats;
+    pipeline->CollectStats(stats);
+    Check(stopMicros < 1000000, "Stop returns promptly after a flood of injections");
+    Check(stats.moves == injections / threads * threads, "every injected move was ingested before Stop returned");
+    printf("  %llu injections, Stop took %.1f ms\n", (unsigned long long)stats.moves, stopMicros / 1000.0);
+}
+
+static void TestStartStopCycles() {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->Subscriptions().SetDefault(0);
+    bool all = true;
+    for (int cycle = 0; cycle < 50 && all; cycle++) {
+        std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+        if (backend->Start()) {
+            all = false;
+            break;
+        }
+        std::atomic<bool> injecting{true};
+        std::thread injector([&]() {
+            while (injecting.load()) {
+                backend->InjectMove(7, 1, 1);
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        all = StopWithin(*backend, 2000000);
+        injecting.store(false);
+        injector.join();
+    }
+    Check(all, "50 start/stop cycles with a concurrent injector all stop");
+}
+
+static int CreateTestMouse() {
+    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
+    ioctl(fd, UI_SET_KEYBIT, BTN_RIGHT);
+    ioctl(fd, UI_SET_EVBIT, EV_REL);
+    ioctl(fd, UI_SET_RELBIT, REL_X);
+    ioctl(fd, UI_SET_RELBIT, REL_Y);
+
+    uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x4f52;
+    setup.id.product = 0x0002;
+    strncpy(setup.name, kTestMouseName, UINPUT_MAX_NAME_SIZE - 1);
+    if (ioctl(fd, UI_DEV_SETUP, &setup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void Emit(std::vector<input_event>& events, uint16_t type, uint16_t code, int32_t value) {
+    input_event event = {};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    events.push_back(event);
+}
+
+static void TestFrameOrder() {
+    const int fd = CreateTestMouse();
+    if (fd < 0) {
+        printf("skip frame order: /dev/uinput is not writable (%s)\n", strerror(errno));
+        return;
+    }
+
+    unsetenv("ORIONIX_INPUT_DIR");
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->Coalescer().Configure(CoalesceMode::Off, 0);
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+    if (const char* error = backend->Start()) {
+        Check(false, error);
+        ioctl(fd, UI_DEV_DESTROY);
+        close(fd);
+        return;
+    }
+
+    uint32_t deviceId = kInvalidDeviceId;
+    const int64_t waitEnd = NowMicros() + 3000000;
+    while (deviceId == kInvalidDeviceId && NowMicros() < waitEnd) {
+        for (const InputDeviceInfo& device : pipeline->Registry().Snapshot()) {
+            if (device.name == kTestMouseName) {
+                deviceId = device.id;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    Check(deviceId != kInvalidDeviceId, "the backend picked up the uinput mouse");
+
+    // Each report moves by (+10, +5) and toggles a button in the same frame.
+    const int frames = 20;
+    std::vector<input_event> events;
+    for (int i = 0; i < frames; i++) {
+        Emit(events, EV_REL, REL_X, 10);
+        Emit(events, EV_REL, REL_Y, 5);
+        Emit(events, EV_KEY, BTN_LEFT, i % 2 == 0 ? 1 : 0);
+        Emit(events, EV_SYN, SYN_REPORT, 0);
+    }
+    const ssize_t bytes = (ssize_t)(events.size() * sizeof(input_event));
+    Check(deviceId != kInvalidDeviceId && write(fd, events.data(), (size_t)bytes) == bytes, "wrote the test frames");
+
+    int moves = 0;
+    int buttons = 0;
+    bool ordered = true;
+    bool positioned = true;
+    int32_t lastX = 0, lastY = 0;
+    MouseEvent event;
+    const int64_t readEnd = NowMicros() + 2000000;
+    while (buttons < frames && NowMicros() < readEnd) {
+        if (!pipeline->Queue().Pop(event)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (event.deviceId != deviceId) {
+            continue;
+        }
+        if (event.type == EventType::Move) {
+            moves++;
+            lastX = event.x;
+            lastY = event.y;
+        } else if (event.type == EventType::Button) {
+            buttons++;
+            ordered = ordered && moves == buttons;
+            positioned = positioned && event.x == lastX && event.y == lastY;
+        }
+    }
+    Check(buttons == frames, "every button of the test frames arrived");
+    Check(ordered, "each button follows the move of its own frame");
+    Check(positioned, "each button carries the position after its frame's move");
+
+    StopWithin(*backend, 2000000);
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+}
+
+int main(int argc, char** argv) {
+    uint64_t injections = 200000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--injections") == 0) {
+            injections = strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "Usage: orionix_evdev_backend_test [--injections N]\n");
+            return 2;
+        }
+    }
+
+    char directory[] = "/tmp/orionix-backend-XXXXXX";
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    setenv("ORIONIX_INPUT_DIR", directory, 1);
+    TestStopUnderLoad(injections);
+    TestStartStopCycles();
+    rmdir(directory);
+
+    TestFrameOrder();
+    return failures == 0 ? 0 : 1;
+}
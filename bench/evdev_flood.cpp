@@ -0,0 +1,357 @@
+// Floods a uinput mouse and measures what the evdev backend spends reading it: read() calls and
+// input-thread CPU per report, once with one read() per record (the old path) and once with the
+// bulk reads. Linux only; needs write access to /dev/uinput.
+
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/input_backend.h"
+#include "../src/input_pipeline.h"
+
+static const char* kFloodName = "Orionix Flood Mouse";
+
+struct FloodConfig {
+    int rateHz = 8000;
+    int burst = 1;
+    double seconds = 3.0;
+    int readRecords = 0;   // 0: compare 1 and the backend default
+    std::string outPath;
+};
+
+struct FloodResult {
+    int readRecords;
+    uint64_t reports;
+    uint64_t records;
+    uint64_t reads;
+    uint64_t moves;
+    int64_t inputCpuNanos;
+};
+
+static std::mutex wakeMutex;
+static std::condition_variable wakeSignal;
+static bool wakeRequested = false;
+
+static void OnWakeup(void*) {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeRequested = true;
+    }
+    wakeSignal.notify_one();
+}
+
+static int CreateFloodDevice() {
+    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
+    ioctl(fd, UI_SET_EVBIT, EV_REL);
+    ioctl(fd, UI_SET_RELBIT, REL_X);
+    ioctl(fd, UI_SET_RELBIT, REL_Y);
+
+    uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x4f52;
+    setup.id.product = 0x0001;
+    strncpy(setup.name, kFloodName, UINPUT_MAX_NAME_SIZE - 1);
+    if (ioctl(fd, UI_DEV_SETUP, &setup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static std::set<int> ThreadIds() {
+    std::set<int> ids;
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return ids;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            ids.insert(atoi(entry->d_name));
+        }
+    }
+    closedir(dir);
+    return ids;
+}
+
+// schedstat's first field is the thread's on-CPU time in nanoseconds, kernel time included.
+static int64_t ThreadCpuNanos(int tid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", tid);
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+    long long nanos = 0;
+    if (fscanf(file, "%lld", &nanos) != 1) {
+        nanos = 0;
+    }
+    fclose(file);
+    return nanos;
+}
+
+static bool FindFloodDevice(InputPipeline& pipeline, uint32_t* id) {
+    for (const InputDeviceInfo& device : pipeline.Registry().Snapshot()) {
+        if (device.name == kFloodName) {
+            *id = device.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool WriteReports(int fd, int count, uint64_t report) {
+    std::vector<input_event> events;
+    events.reserve((size_t)count * 3);
+    for (int i = 0; i < count; i++) {
+        // A small square orbit so the position never drifts far.
+        const int step = (int)((report + (uint64_t)i) % 4);
+        input_event event = {};
+        event.type = EV_REL;
+        event.code = REL_X;
+        event.value = step < 2 ? 1 : -1;
+        events.push_back(event);
+        event.code = REL_Y;
+        event.value = step == 1 || step == 2 ? 1 : -1;
+        events.push_back(event);
+        event.type = EV_SYN;
+        event.code = SYN_REPORT;
+        event.value = 0;
+        events.push_back(event);
+    }
+    const size_t bytes = events.size() * sizeof(input_event);
+    return write(fd, events.data(), bytes) == (ssize_t)bytes;
+}
+
+static bool RunFlood(int uinputFd, const FloodConfig& config, int readRecords, FloodResult& result) {
+    char records[16];
+    snprintf(records, sizeof(records), "%d", readRecords);
+    setenv("ORIONIX_EVDEV_READ_RECORDS", records, 1);
+
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->SetConsumerWakeup(OnWakeup, nullptr);
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+
+    const std::set<int> before = ThreadIds();
+    if (const char* error = backend->Start()) {
+        fprintf(stderr, "Backend failed to start: %s\n", error);
+        return false;
+    }
+    int inputThread = 0;
+    for (int tid : ThreadIds()) {
+        if (!before.count(tid)) {
+            inputThread = tid;
+        }
+    }
+
+    uint32_t deviceId = 0;
+    const int64_t waitEnd = NowMicros() + 2000000;
+    while (!FindFloodDevice(*pipeline, &deviceId)) {
+        if (NowMicros() > waitEnd) {
+            fprintf(stderr, "The backend did not pick up %s; is /dev/input readable?\n", kFloodName);
+            backend->Stop();
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::atomic<bool> flooding{true};
+    std::thread consumer([&]() {
+        MouseEvent event;
+        while (flooding.load() || pipeline->Queue().Size() > 0) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wakeSignal.wait_for(lock, std::chrono::milliseconds(10), []() { return wakeRequested; });
+                wakeRequested = false;
+            }
+            pipeline->BeginDrain();
+            while (pipeline->Queue().Pop(event)) {
+            }
+        }
+    });
+
+    InputStatsSnapshot start;
+    pipeline->CollectStats(start);
+    const int64_t cpuStart = ThreadCpuNanos(inputThread);
+
+    const double period = 1000000.0 * config.burst / config.rateHz;
+    const int64_t floodStart = NowMicros();
+    const int64_t floodEnd = floodStart + (int64_t)(config.seconds * 1000000.0);
+    uint64_t reports = 0;
+    for (uint64_t tick = 0;; tick++) {
+        const int64_t due = floodStart + (int64_t)(tick * period);
+        if (due >= floodEnd) {
+            break;
+        }
+        for (int64_t remaining = due - NowMicros(); remaining > 0; remaining = due - NowMicros()) {
+            if (remaining > 2000) {
+                std::this_thread::sleep_for(std::chrono::microseconds(remaining - 1000));
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (WriteReports(uinputFd, config.burst, reports)) {
+            reports += (uint64_t)config.burst;
+        }
+    }
+
+    // Let the input thread catch up before reading its counters.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const int64_t cpuEnd = ThreadCpuNanos(inputThread);
+    InputStatsSnapshot end;
+    pipeline->CollectStats(end);
+
+    flooding.store(false);
+    OnWakeup(nullptr);
+    consumer.join();
+    backend->Stop();
+
+    uint64_t moves = 0;
+    for (const DeviceStats& device : end.devices) {
+        if (device.id == deviceId) {
+            moves = device.moves;
+        }
+    }
+    for (const DeviceStats& device : start.devices) {
+        if (device.id == deviceId) {
+            moves -= device.moves;
+        }
+    }
+
+    result.readRecords = readRecords;
+    result.reports = reports;
+    result.records = end.messages - start.messages;
+    result.reads = end.reads - start.reads;
+    result.moves = moves;
+    result.inputCpuNanos = cpuEnd - cpuStart;
+    return true;
+}
+
+static bool ParseArgs(int argc, char** argv, FloodConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--rate") {
+            config.rateHz = atoi(value);
+        } else if (arg == "--burst") {
+            config.burst = atoi(value);
+        } else if (arg == "--seconds") {
+            config.seconds = atof(value);
+        } else if (arg == "--read-records") {
+            config.readRecords = atoi(value);
+        } else if (arg == "--out") {
+            config.outPath = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.rateHz < 125 || config.rateHz > 64000) {
+        fprintf(stderr, "--rate must be between 125 and 64000\n");
+        return false;
+    }
+    if (config.burst < 1 || config.burst > 64) {
+        fprintf(stderr, "--burst must be between 1 and 64\n");
+        return false;
+    }
+    if (config.seconds <= 0) {
+        fprintf(stderr, "--seconds must be positive\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    FloodConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr,
+            "Usage: orionix_evdev_flood [--rate reports/s] [--burst reports per write] [--seconds N]\n"
+            "                           [--read-records 1-64] [--out report.json]\n");
+        return 2;
+    }
+
+    int uinputFd = CreateFloodDevice();
+    if (uinputFd < 0) {
+        fprintf(stderr, "Cannot create a uinput device (needs write access to /dev/uinput)\n");
+        return 1;
+    }
+    // udev needs a moment to create the node and set its permissions.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    std::vector<int> modes;
+    if (config.readRecords > 0) {
+        modes.push_back(config.readRecords);
+    } else {
+        modes.push_back(1);
+        modes.push_back(64);
+    }
+
+    std::vector<FloodResult> results;
+    for (int readRecords : modes) {
+        FloodResult result;
+        if (!RunFlood(uinputFd, config, readRecords, result)) {
+            ioctl(uinputFd, UI_DEV_DESTROY);
+            close(uinputFd);
+            return 1;
+        }
+        results.push_back(result);
+    }
+
+    ioctl(uinputFd, UI_DEV_DESTROY);
+    close(uinputFd);
+
+    FILE* out = stdout;
+    if (!config.outPath.empty()) {
+        out = fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", config.outPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"rateHz\": %d, \"burst\": %d, \"seconds\": %.3f},\n", config.rateHz, config.burst, config.seconds);
+    fprintf(out, "  \"runs\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const FloodResult& result = results[i];
+        const double reports = (double)(result.reports ? result.reports : 1);
+        fprintf(out, "    {\"readRecords\": %d, \"reports\": %llu, \"records\": %llu, \"moves\": %llu, \"reads\": %llu, "
+                     "\"readsPerReport\": %.3f, \"inputCpuNsPerReport\": %.1f}%s\n",
+            result.readRecords, (unsigned long long)result.reports, (unsigned long long)result.records,
+            (unsigned long long)result.moves, (unsigned long long)result.reads, result.reads / reports,
+            result.inputCpuNanos / reports, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,262 @@
+// Hot-plug test of the evdev backend against a temporary ORIONIX_INPUT_DIR. First churns event*
+// nodes that are not input devices (create, rename away, delete) while moves are injected, and
+// checks that nothing is registered, nothing is lost and Stop stays prompt. Then plugs FIFOs in as
+// stand-in mice (this binary answers the backend's evdev ioctls for FIFOs) and unlinks each one
+// while the input thread is busy, right before writing it another report, so the removal and the
+// device's readiness land in the same epoll batch. Every removal must be announced exactly once
+// and nothing of a removed device may follow it. Exits non-zero on any failure. Linux only.
+//
+//   orionix_evdev_hotplug_test [--cycles 50]
+
+#include <linux/input.h>
+#include <sys/stat.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/input_backend.h"
+#include "../src/input_pipeline.h"
+#include "check.h"
+
+static const char* kFifoMouseName = "Orionix FIFO Mouse";
+
+// Overrides libc's ioctl for the whole process: FIFOs report a relative pointer's capabilities
+// and a name, everything else goes to the real ioctl.
+extern "C" int ioctl(int fd, unsigned long request, ...) noexcept {
+    va_list args;
+    va_start(args, request);
+    void* arg = va_arg(args, void*);
+    va_end(args);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode) && _IOC_TYPE(request) == 'E') {
+        const unsigned int number = _IOC_NR(request);
+        if (number == _IOC_NR(EVIOCGBIT(0, 0))) {
+            memset(arg, 0, _IOC_SIZE(request));
+            ((unsigned long*)arg)[0] = (1ul << EV_SYN) | (1ul << EV_KEY) | (1ul << EV_REL);
+            return 0;
+        }
+        if (number == _IOC_NR(EVIOCGBIT(EV_REL, 0))) {
+            memset(arg, 0, _IOC_SIZE(request));
+            ((unsigned long*)arg)[0] = (1ul << REL_X) | (1ul << REL_Y);
+            return 0;
+        }
+        if (number == _IOC_NR(EVIOCGNAME(0))) {
+            strncpy((char*)arg, kFifoMouseName, _IOC_SIZE(request));
+            return (int)strlen(kFifoMouseName);
+        }
+        if (request == EVIOCGID) {
+            memset(arg, 0, sizeof(input_id));
+            return 0;
+        }
+        errno = ENOTTY;
+        return -1;
+    }
+    typedef int (*IoctlFunction)(int, unsigned long, ...);
+    static IoctlFunction real = (IoctlFunction)dlsym(RTLD_NEXT, "ioctl");
+    return real(fd, request, arg);
+}
+
+static void Drain(InputPipeline& pipeline, std::vector<MouseEvent>& events) {
+    pipeline.BeginDrain();
+    MouseEvent event;
+    while (pipeline.Queue().Pop(event)) {
+        events.push_back(event);
+    }
+}
+
+static bool Registered(InputPipeline& pipeline, const char* name, uint32_t* id) {
+    for (const InputDeviceInfo& device : pipeline.Registry().Snapshot()) {
+        if (device.name == name) {
+            *id = device.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void TestNodeChurn(const std::string& directory) {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->Subscriptions().SetDefault(0);
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+    if (const char* error = backend->Start()) {
+        Check(false, error);
+        return;
+    }
+
+    const int iterations = 400;
+    for (int i = 0; i < iterations; i++) {
+        const std::string node = directory + "/event" + std::to_string(i % 4);
+        const int fd = open(node.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (i % 3 == 0) {
+            rename(node.c_str(), (directory + "/moved").c_str());
+            unlink((directory + "/moved").c_str());
+        } else if (i % 3 == 1) {
+            unlink(node.c_str());
+        }
+        backend->InjectMove(1, 1, 0);
+    }
+    // Leftover nodes settle and are probed; none of them is a pointer.
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+    const int64_t start = NowMicros();
+    backend->Stop();
+    const int64_t stopMicros = NowMicros() - start;
+    InputStatsSnapshot stats;
+    pipeline->CollectStats(stats);
+    Check(pipeline->Registry().Snapshot().empty(), "nodes that are not input devices are never registered");
+    Check(stats.moves == (uint64_t)iterations, "no injected move is lost while nodes churn");
+    Check(stopMicros < 1000000, "Stop stays prompt after node churn");
+
+    for (int i = 0; i < 4; i++) {
+        unlink((directory + "/event" + std::to_string(i)).c_str());
+    }
+}
+
+static void SendMove(int fd) {
+    input_event events[2] = {};
+    events[0].type = EV_REL;
+    events[0].code = REL_X;
+    events[0].value = 1;
+    events[1].type = EV_SYN;
+    events[1].code = SYN_REPORT;
+    (void)!write(fd, events, sizeof(events));
+}
+
+static void TestRemovalInSameBatch(const std::string& directory, int cycles) {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    pipeline->Coalescer().Configure(CoalesceMode::Off, 0);
+    // The injected flood only keeps the input thread busy; it never reaches the queue.
+    const uint64_t floodHandle = 0xF100D;
+    pipeline->Subscriptions().SetDevice(floodHandle, kSubscribeDevice);
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+    if (const char* error = backend->Start()) {
+        Check(false, error);
+        return;
+    }
+
+    const std::string node = directory + "/event0";
+    std::vector<MouseEvent> events;
+    uint32_t deviceId = kInvalidDeviceId;
+    // A replug may take another released id.
+    std::set<uint32_t> deviceIds;
+    bool plugged = true;
+    bool unplugged = true;
+    for (int cycle = 0; cycle < cycles && plugged && unplugged; cycle++) {
+        mkfifo(node.c_str(), 0600);
+        // Opening the write end only succeeds once the backend holds the read end.
+        int writer = -1;
+        const int64_t addEnd = NowMicros() + 2000000;
+        while ((writer < 0 || !Registered(*pipeline, kFifoMouseName, &deviceId)) && NowMicros() < addEnd) {
+            if (writer < 0) {
+                writer = open(node.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+            }
+            Drain(*pipeline, events);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        plugged = writer >= 0 && Registered(*pipeline, kFifoMouseName, &deviceId);
+        if (plugged) {
+            deviceIds.insert(deviceId);
+        }
+        if (writer >= 0) {
+            // A report the device delivers while it is still plugged in.
+            const size_t before = events.size();
+            SendMove(writer);
+            const int64_t moveEnd = NowMicros() + 2000000;
+            while (events.size() == before && NowMicros() < moveEnd) {
+                Drain(*pipeline, events);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        // Unlink first, then report: the inotify event is queued ahead of the device's.
+        for (int i = 0; i < 20000; i++) {
+            backend->InjectMove(floodHandle, 1, 0);
+        }
+        unlink(node.c_str());
+        if (writer >= 0) {
+            SendMove(writer);
+        }
+        const int64_t removeEnd = NowMicros() + 2000000;
+        while (Registered(*pipeline, kFifoMouseName, &deviceId) && NowMicros() < removeEnd) {
+            Drain(*pipeline, events);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        unplugged = !Registered(*pipeline, kFifoMouseName, &deviceId);
+        if (writer >= 0) {
+            close(writer);
+        }
+    }
+    backend->Stop();
+    Drain(*pipeline, events);
+    unlink(node.c_str());
+
+    int added = 0;
+    int removed = 0;
+    int moves = 0;
+    int strayEvents = 0;
+    std::map<uint32_t, bool> present;
+    for (const MouseEvent& event : events) {
+        if (!deviceIds.count(event.deviceId)) {
+            continue;
+        }
+        if (event.type == EventType::Device && event.action == EventAction::Added) {
+            added++;
+            present[event.deviceId] = true;
+        } else if (event.type == EventType::Device && event.action == EventAction::Removed) {
+            removed++;
+            strayEvents += present[event.deviceId] ? 0 : 1;
+            present[event.deviceId] = false;
+        } else if (!present[event.deviceId]) {
+            strayEvents++;
+        } else {
+            moves++;
+        }
+    }
+    Check(plugged && unplugged, "every plug and unplug of the node was picked up");
+    Check(added == cycles && removed == cycles, "each removal is announced exactly once");
+    Check(strayEvents == 0, "no event of a removed device follows its removal");
+    Check(moves >= cycles, "reports sent while plugged in arrive");
+    printf("  %d cycles: %d added, %d removed, %d moves, %d stray events\n", cycles, added, removed, moves, strayEvents);
+}
+
+int main(int argc, char** argv) {
+    int cycles = 50;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--cycles") == 0) {
+            cycles = atoi(argv[i + 1]);
+        } else {
+            fprintf(stderr, "Usage: orionix_evdev_hotplug_test [--cycles N]\n");
+            return 2;
+        }
+    }
+
+    char directory[] = "/tmp/orionix-hotplug-XXXXXX";
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    setenv("ORIONIX_INPUT_DIR", directory, 1);
+    // Writes to a FIFO whose reader the backend closed must fail, not kill the test.
+    signal(SIGPIPE, SIG_IGN);
+    TestNodeChurn(directory);
+    TestRemovalInSameBatch(directory, cycles);
+    rmdir(directory);
+    return failures == 0 ? 0 : 1;
+}
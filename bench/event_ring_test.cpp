@@ -0,0 +1,273 @@
+// Unit and stress test for the SPSC ring and MouseEventQueue (src/event_ring.h), plus the
+// pipeline's device id table and its reuse of released ids. Checks FIFO order and wraparound,
+// that button and device events survive a full ring through the backlog, and then races a
+// producer against a consumer that keeps stalling: per device, events must arrive in order, no
+// button may be lost and under the merge policy the summed deltas must match what was produced.
+// Exits non-zero on any failure.
+//
+//   orionix_event_ring_test [--events 2000000] [--seed 1]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../src/event_ring.h"
+#include "../src/input_pipeline.h"
+#include "check.h"
+
+static MouseEvent Event(uint32_t deviceId, EventType type, uint32_t seq, int deltaX) {
+    MouseEvent event{};
+    event.deviceId = deviceId;
+    event.type = type;
+    event.action = type == EventType::Button ? EventAction::LeftDown : EventAction::None;
+    event.seq = seq;
+    event.deltaX = deltaX;
+    return event;
+}
+
+static void TestRing() {
+    SpscRing<int, 8> ring;
+    int value = 0;
+    Check(!ring.TryPop(value), "an empty ring pops nothing");
+    bool fits = true;
+    for (int i = 0; i < 8; i++) {
+        fits = fits && ring.TryPush(i);
+    }
+    Check(fits && !ring.TryPush(8), "a ring holds exactly Capacity items");
+
+    bool ordered = true;
+    for (int round = 0; round < 100; round++) {
+        ordered = ordered && ring.TryPop(value) && value == round;
+        ordered = ordered && ring.TryPush(round + 8);
+    }
+    Check(ordered && ring.Size() == 8, "FIFO order holds across wraparound");
+}
+
+static void TestBacklog() {
+    typedef MouseEventQueue<16, 4> Queue;
+    Queue queue;
+    uint32_t seq = 0;
+    for (size_t i = 0; i < Queue::kMoveLimit; i++) {
+        queue.Push(Event(0, EventType::Move, ++seq, 1));
+    }
+    // Fills the reserve, then spills into the backlog.
+    for (int i = 0; i < 10; i++) {
+        queue.Push(Event(1, EventType::Button, ++seq, 0));
+    }
+    Check(queue.Size() == 16 && queue.Backlog() == 10 - (16 - Queue::kMoveLimit), "buttons past the reserve wait in the backlog");
+    Check(queue.Push(Event(1, EventType::Move, ++seq, 5)) && queue.HasPending(), "a move behind the backlog is folded, not queued ahead of it");
+
+    MouseEvent event;
+    uint32_t last = 0;
+    int buttons = 0;
+    int deltaX = 0;
+    bool ordered = true;
+    while (queue.HasPending() || queue.Size() > 0) {
+        if (!queue.Pop(event)) {
+            queue.Flush();
+            continue;
+        }
+        ordered = ordered && event.seq > last;
+        last = event.seq;
+        buttons += event.type == EventType::Button;
+        deltaX += event.deviceId == 1 ? event.deltaX : 0;
+    }
+    Check(ordered && buttons == 10 && deltaX == 5, "the backlog drains in order and loses nothing");
+    Check(queue.DeferredEvents() > 0 && queue.Backlog() == 0, "deferred events are counted and the backlog empties");
+}
+
+struct StressResult {
+    uint64_t producedButtons[4] = {};
+    int64_t producedDelta[4] = {};
+    uint64_t seenButtons[4] = {};
+    int64_t seenDelta[4] = {};
+    uint64_t deferred = 0;
+    bool ordered = true;
+};
+
+static void RunStress(OverflowPolicy policy, uint64_t events, uint32_t seed, StressResult& result) {
+    MouseEventQueue<256, 4> queue;
+    queue.SetOverflowPolicy(policy);
+    std::atomic<bool> done{false};
+
+    std::thread consumer([&]() {
+        std::mt19937 random(seed + 1);
+        uint32_t last[4] = {};
+        MouseEvent event;
+        for (;;) {
+            // Stalls now and then so the ring, the reserve and the backlog all fill up.
+            if (random() % 64 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(random() % 200));
+            }
+            if (!queue.Pop(event)) {
+                if (done.load(std::memory_order_acquire) && queue.Size() == 0) {
+                    break;
+                }
+                continue;
+            }
+            const uint32_t id = event.deviceId;
+            result.ordered = result.ordered && event.seq > last[id];
+            last[id] = event.seq;
+            if (event.type == EventType::Button) {
+                result.seenButtons[id]++;
+            } else {
+                result.seenDelta[id] += event.deltaX;
+            }
+        }
+    });
+
+    std::mt19937 random(seed);
+    for (uint64_t i = 1; i <= events; i++) {
+        const uint32_t id = random() % 4;
+        if (random() % 16 == 0) {
+            queue.Push(Event(id, EventType::Button, (uint32_t)i, 0));
+            result.producedButtons[id]++;
+        } else {
+            const int delta = (int)(random() % 7) - 3;
+            queue.Push(Event(id, EventType::Move, (uint32_t)i, delta));
+            result.producedDelta[id] += delta;
+        }
+        if (i % 32 == 0) {
+            queue.Flush();
+        }
+    }
+    while (queue.HasPending()) {
+        queue.Flush();
+        std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+    consumer.join();
+    result.deferred = queue.DeferredEvents();
+}
+
+static void TestStress(uint64_t events, uint32_t seed) {
+    StressResult merge;
+    RunStress(OverflowPolicy::MergeMoves, events, seed, merge);
+    bool buttons = true;
+    bool deltas = true;
+    for (int id = 0; id < 4; id++) {
+        buttons = buttons && merge.seenButtons[id] == merge.producedButtons[id];
+        deltas = deltas && merge.seenDelta[id] == merge.producedDelta[id];
+    }
+    Check(merge.deferred > 0, "the stalled consumer pushed events into the backlog");
+    Check(merge.ordered, "merge policy: each device's events arrive in order");
+    Check(buttons, "merge policy: no button is lost");
+    Check(deltas, "merge policy: summed deltas match the producer's");
+
+    StressResult drop;
+    RunStress(OverflowPolicy::DropMoves, events, seed + 7, drop);
+    buttons = true;
+    for (int id = 0; id < 4; id++) {
+        buttons = buttons && drop.seenButtons[id] == drop.producedButtons[id];
+    }
+    Check(drop.ordered, "drop policy: each device's events arrive in order");
+    Check(buttons, "drop policy: no button is lost");
+}
+
+static void TestDeviceSlots() {
+    static InputPipeline pipeline;
+    bool dense = true;
+    for (size_t i = 0; i < kMaxDeviceSlots; i++) {
+        dense = dense && pipeline.InternDevice(0x1000 + i, "device") == (uint32_t)i;
+    }
+    Check(dense, "device ids are dense up to kMaxDeviceSlots");
+    Check(pipeline.InternDevice(0x1000, "device") == 0, "a known handle keeps its id once the table is full");
+
+    const uint32_t rejected = pipeline.InternDevice(0x9999, "one too many");
+    Check(rejected == kInvalidDeviceId, "a device past the table is refused instead of aliasing another");
+    Check(pipeline.RegisterDevice(0x9998, "another", "", DeviceIdentity()) == kInvalidDeviceId &&
+          pipeline.Registry().Snapshot().empty(), "a refused device is not registered");
+
+    const size_t before = pipeline.Queue().Size();
+    pipeline.IngestEvent(MakeEvent(rejected, EventType::Move, EventAction::None, 0, 0, 1, 1, 0));
+    InputStatsSnapshot stats;
+    pipeline.CollectStats(stats);
+    Check(pipeline.Queue().Size() == before && stats.moves == 0, "events of a refused device are dropped");
+    Check(stats.rejectedDevices == 2 && stats.rejectedEvents == 1, "refusals and their events are counted");
+}
+
+// Pops everything queued; false if an event of `handle`'s id no longer names `handle`.
+static bool DrainNaming(InputPipeline& pipeline, uint32_t id, uint64_t handle) {
+    bool named = true;
+    MouseEvent event;
+    pipeline.BeginDrain();
+    while (pipeline.Queue().Pop(event)) {
+        named = named && (event.deviceId != id || pipeline.GetDeviceSlot(id).handle == handle);
+    }
+    return named;
+}
+
+static void TestDeviceReplug() {
+    static InputPipeline pipeline;
+    const uint32_t first = pipeline.RegisterDevice(0x100, "steady", "", DeviceIdentity());
+    const uint32_t second = pipeline.RegisterDevice(0x200, "steady", "", DeviceIdentity());
+
+    // A new handle per connection, as Windows gives; more cycles than tombstones fit.
+    uint32_t highest = 0;
+    bool accepted = true, named = true;
+    for (uint64_t cycle = 0; cycle < 3000; cycle++) {
+        const uint64_t handle = 0x10000 + cycle;
+        const uint32_t id = pipeline.RegisterDevice(handle, "replugged", "", DeviceIdentity());
+        if (id == kInvalidDeviceId) {
+            accepted = false;
+            break;
+        }
+        highest = std::max(highest, id);
+        pipeline.IngestEvent(MakeEvent(id, EventType::Device, EventAction::Added, 0, 0, 0, 0, 0));
+        pipeline.IngestEvent(MakeEvent(id, EventType::Move, EventAction::None, 0, 0, 1, 1, 0));
+        pipeline.FlushProducer();
+        named = DrainNaming(pipeline, id, handle) && named;
+        pipeline.Registry().Remove(id);
+        pipeline.IngestEvent(MakeEvent(id, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0));
+        pipeline.ReleaseDevice(id);
+        pipeline.FlushProducer();
+        named = DrainNaming(pipeline, id, handle) && named;
+    }
+    Check(accepted, "replugs never run out of device ids");
+    Check(highest < 8, "replugged devices keep ids dense and under 256");
+    Check(named, "a released id names its old device until its events are drained");
+
+    uint32_t id;
+    Check(pipeline.LookupDevice(0x100, &id) && id == first && pipeline.LookupDevice(0x200, &id) && id == second,
+          "devices that stay keep their ids through the churn");
+    Check(!pipeline.LookupDevice(0x10000, &id), "a released handle is forgotten");
+
+    // Removed without the consumer draining: the id is held until it has.
+    const uint32_t gone = pipeline.RegisterDevice(0x300, "gone", "", DeviceIdentity());
+    pipeline.IngestEvent(MakeEvent(gone, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0));
+    pipeline.ReleaseDevice(gone);
+    pipeline.FlushProducer();
+    const uint32_t next = pipeline.RegisterDevice(0x400, "next", "", DeviceIdentity());
+    Check(next != gone && DrainNaming(pipeline, gone, 0x300), "a released id is not reused before its events are drained");
+    pipeline.FlushProducer();
+    pipeline.BeginDrain();
+    Check(pipeline.InternDevice(0x500, "after") == gone, "a released id is reused once they are");
+}
+
+int main(int argc, char** argv) {
+    uint64_t events = 2000000;
+    uint32_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--events") == 0) {
+            events = strtoull(argv[i + 1], nullptr, 10);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "Usage: orionix_event_ring_test [--events N] [--seed N]\n");
+            return 2;
+        }
+    }
+
+    TestRing();
+    TestBacklog();
+    TestStress(events, seed);
+    TestDeviceSlots();
+    TestDeviceReplug();
+    return failures == 0 ? 0 : 1;
+}
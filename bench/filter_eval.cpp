@@ -0,0 +1,370 @@
+// Offline evaluation of the per-device motion filters. Runs MotionFilter over synthetic mouse
+// tracks (minimum-jerk flicks and pauses, reported as integer counts at 125, 500 and 1000 Hz with
+// optional sensor noise) or over a recorded trace, and measures what the overlay would show: at
+// every display refresh the cursor is drawn at the last position delivered one frame earlier,
+// compared with where the hand actually is. Prints a JSON report on stdout (or --out).
+//
+//   orionix_filter_eval [--trace file.orxtrace] [--refresh 60] [--seconds 20] [--noise 0.3]
+//                       [--min-cutoff 1] [--beta 0.01] [--process-noise 4e7] [--measurement-noise 0.5]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/input_pipeline.h"
+#include "../src/input_trace.h"
+
+// Ground truth is kept at this resolution and interpolated from reports for recorded traces.
+static const int64_t kTruthStepMicros = 100;
+// A recorded device that stays silent longer than this is taken as standing still.
+static const int64_t kHoldGapMicros = 50000;
+
+struct EvalConfig {
+    std::string tracePath;
+    double refreshHz = 60;
+    double seconds = 20;
+    double noise = 0.3;
+    MotionFilterConfig filter;
+    std::string outPath;
+};
+
+struct Sample {
+    int64_t t;
+    int32_t x, y;
+};
+
+struct Track {
+    std::string label;
+    std::vector<Sample> reports;
+    int64_t truthStart = 0;
+    std::vector<double> truthX, truthY;
+
+    bool Truth(int64_t t, double& x, double& y) const {
+        int64_t index = (t - truthStart) / kTruthStepMicros;
+        if (index < 0 || index >= (int64_t)truthX.size()) {
+            return false;
+        }
+        x = truthX[(size_t)index];
+        y = truthY[(size_t)index];
+        return true;
+    }
+};
+
+struct ErrorStats {
+    double mean = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+    double stillJitter = 0;
+    double nsPerEvent = 0;
+    size_t frames = 0;
+};
+
+static bool ParseArgs(int argc, char** argv, EvalConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--trace") {
+            config.tracePath = value;
+        } else if (arg == "--refresh") {
+            config.refreshHz = atof(value);
+        } else if (arg == "--seconds") {
+            config.seconds = atof(value);
+        } else if (arg == "--noise") {
+            config.noise = atof(value);
+        } else if (arg == "--min-cutoff") {
+            config.filter.minCutoff = atof(value);
+        } else if (arg == "--beta") {
+            config.filter.beta = atof(value);
+        } else if (arg == "--process-noise") {
+            config.filter.processNoise = atof(value);
+        } else if (arg == "--measurement-noise") {
+            config.filter.measurementNoise = atof(value);
+        } else if (arg == "--out") {
+            config.outPath = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.refreshHz <= 0 || config.seconds <= 0 || config.noise < 0 || config.filter.minCutoff <= 0 ||
+        config.filter.beta < 0 || config.filter.processNoise <= 0 || config.filter.measurementNoise <= 0) {
+        fprintf(stderr, "--refresh, --seconds, --min-cutoff and the noise terms must be positive\n");
+        return false;
+    }
+    config.filter.leadMicros = (int64_t)std::llround(1e6 / config.refreshHz);
+    return true;
+}
+
+// Minimum-jerk flicks between random targets, separated by pauses: the shape of real pointing.
+static Track SyntheticTrack(double rateHz, double seconds, double noise, uint32_t seed) {
+    Track track;
+    track.label = std::to_string((int)rateHz) + "Hz";
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> sensor(0.0, noise);
+
+    const size_t steps = (size_t)(seconds * 1e6 / kTruthStepMicros);
+    track.truthX.reserve(steps);
+    track.truthY.reserve(steps);
+    double x = 0, y = 0;
+    while (track.truthX.size() < steps) {
+        for (int64_t hold = (int64_t)((0.1 + 0.5 * unit(rng)) * 1e6); hold > 0; hold -= kTruthStepMicros) {
+            track.truthX.push_back(x);
+            track.truthY.push_back(y);
+        }
+        const double distance = 20 + 780 * unit(rng);
+        const double angle = 2 * 3.14159265358979323846 * unit(rng);
+        const double toX = x + distance * std::cos(angle);
+        const double toY = y + distance * std::sin(angle);
+        const int64_t duration = (int64_t)((0.12 + 0.38 * unit(rng)) * 1e6);
+        for (int64_t t = 0; t < duration; t += kTruthStepMicros) {
+            const double s = (double)t / duration;
+            const double blend = s * s * s * (10 - 15 * s + 6 * s * s);
+            track.truthX.push_back(x + (toX - x) * blend);
+            track.truthY.push_back(y + (toY - y) * blend);
+        }
+        x = toX;
+        y = toY;
+    }
+    track.truthX.resize(steps);
+    track.truthY.resize(steps);
+
+    // The mouse reports whole counts, and only when there is motion to report.
+    const int64_t interval = (int64_t)(1e6 / rateHz);
+    int32_t reportedX = 0, reportedY = 0;
+    for (int64_t t = interval; t < (int64_t)steps * kTruthStepMicros; t += interval) {
+        double trueX = 0, trueY = 0;
+        track.Truth(t, trueX, trueY);
+        const int32_t countX = (int32_t)std::floor(trueX + sensor(rng));
+        const int32_t countY = (int32_t)std::floor(trueY + sensor(rng));
+        if (countX != reportedX || countY != reportedY) {
+            reportedX = countX;
+            reportedY = countY;
+            track.reports.push_back({ t, countX, countY });
+        }
+    }
+    return track;
+}
+
+// Replays the trace through a pipeline with the motion engine on, so every device gets its own
+// integrated position, and takes those positions as ground truth between reports.
+static bool RecordedTracks(const std::string& path, std::vector<Track>& tracks) {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    MotionConfig motion;
+    motion.enabled = true;
+    motion.minX = motion.minY = -1000000000;
+    motion.maxX = motion.maxY = 1000000000;
+    motion.originX = motion.originY = 0;
+    pipeline->Motion().Configure(motion);
+
+    std::unique_ptr<InputBackend> replay = CreateReplayBackend(*pipeline, path, false);
+    if (const char* error = replay->Start()) {
+        fprintf(stderr, "%s\n", error);
+        return false;
+    }
+
+    std::vector<Track> byDevice(kMaxDeviceSlots);
+    MouseEvent event;
+    auto idleSince = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - idleSince < std::chrono::milliseconds(500)) {
+        pipeline->BeginDrain();
+        bool popped = false;
+        while (pipeline->Queue().Pop(event)) {
+            popped = true;
+            if (event.type == EventType::Move && event.deviceId < byDevice.size()) {
+                byDevice[event.deviceId].reports.push_back({ event.timestamp, event.x, event.y });
+            }
+        }
+        if (popped) {
+            idleSince = std::chrono::steady_clock::now();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    replay->Stop();
+
+    for (uint32_t id = 0; id < byDevice.size(); id++) {
+        Track& track = byDevice[id];
+        if (track.reports.size() < 2) {
+            continue;
+        }
+        track.label = pipeline->GetDeviceSlot(id).name;
+        track.truthStart = track.reports.front().t;
+        for (size_t i = 0; i + 1 < track.reports.size(); i++) {
+            const Sample& from = track.reports[i];
+            const Sample& to = track.reports[i + 1];
+            for (int64_t t = from.t; t < to.t; t += kTruthStepMicros) {
+                const double s = to.t - from.t > kHoldGapMicros ? 0.0 : (double)(t - from.t) / (to.t - from.t);
+                track.truthX.push_back(from.x + (to.x - from.x) * s);
+                track.truthY.push_back(from.y + (to.y - from.y) * s);
+            }
+        }
+        tracks.push_back(std::move(track));
+    }
+    return true;
+}
+
+// Feeds the reports through a fresh MotionFilter and returns every delivered position, settle
+// moves included, in delivery order.
+static std::vector<Sample> RunFilter(const Track& track, const MotionFilterConfig& config, double* nsPerEvent) {
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    MotionFilter& filter = pipeline->Filter();
+    filter.ConfigureDefault(config);
+    const uint32_t id = pipeline->InternDevice(1, "eval");
+
+    std::vector<Sample> delivered;
+    delivered.reserve(track.reports.size() * 2);
+    MouseEvent settle;
+    auto takeSettles = [&](int64_t until) {
+        for (int64_t due = filter.NextDeadline(); due <= until && filter.TakeSettle(due, settle); due = filter.NextDeadline()) {
+            delivered.push_back({ due, settle.x, settle.y });
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Sample& report : track.reports) {
+        takeSettles(report.t);
+        MouseEvent event = MakeEvent(id, EventType::Move, EventAction::None, report.x, report.y, 0, 0, 0);
+        event.timestamp = report.t;
+        filter.Apply(event);
+        delivered.push_back({ report.t, event.x, event.y });
+    }
+    takeSettles(MotionFilter::kNoDeadline - 1);
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    *nsPerEvent = track.reports.empty() ? 0 : elapsed / track.reports.size();
+    return delivered;
+}
+
+// At each refresh the overlay shows the last position delivered one frame before it.
+static ErrorStats Evaluate(const Track& track, const std::vector<Sample>& delivered, const EvalConfig& config) {
+    ErrorStats stats;
+    std::vector<double> errors;
+    const int64_t frame = config.filter.leadMicros;
+    size_t next = 0;
+    bool shown = false;
+    double shownX = 0, shownY = 0, lastShownX = 0, lastShownY = 0, lastTrueX = 0, lastTrueY = 0;
+    double jitter = 0;
+    size_t stillFrames = 0;
+
+    const int64_t end = track.truthStart + (int64_t)track.truthX.size() * kTruthStepMicros;
+    for (int64_t t = track.truthStart + frame; t < end; t += frame) {
+        while (next < delivered.size() && delivered[next].t <= t - frame) {
+            shownX = delivered[next].x;
+            shownY = delivered[next].y;
+            shown = true;
+            next++;
+        }
+        double trueX, trueY;
+        if (!shown || !track.Truth(t, trueX, trueY)) {
+            continue;
+        }
+        errors.push_back(std::hypot(shownX - trueX, shownY - trueY));
+        if (errors.size() > 1 && std::hypot(trueX - lastTrueX, trueY - lastTrueY) < 0.05) {
+            jitter += std::hypot(shownX - lastShownX, shownY - lastShownY);
+            stillFrames++;
+        }
+        lastShownX = shownX;
+        lastShownY = shownY;
+        lastTrueX = trueX;
+        lastTrueY = trueY;
+    }
+
+    if (errors.empty()) {
+        return stats;
+    }
+    double sum = 0;
+    for (double error : errors) {
+        sum += error;
+    }
+    std::sort(errors.begin(), errors.end());
+    auto percentile = [&errors](double p) { return errors[std::min(errors.size() - 1, (size_t)(p * errors.size()))]; };
+    stats.frames = errors.size();
+    stats.mean = sum / errors.size();
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.max = errors.back();
+    stats.stillJitter = stillFrames ? jitter / stillFrames : 0;
+    return stats;
+}
+
+int main(int argc, char** argv) {
+    EvalConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr, "Usage: orionix_filter_eval [--trace file] [--refresh Hz] [--seconds S] [--noise px] [--min-cutoff Hz] [--beta B]\n"
+                        "                           [--process-noise Q] [--measurement-noise R] [--out report.json]\n");
+        return 2;
+    }
+
+    std::vector<Track> tracks;
+    if (!config.tracePath.empty()) {
+        if (!RecordedTracks(config.tracePath, tracks)) {
+            return 1;
+        }
+    } else {
+        const double rates[] = { 125, 500, 1000 };
+        for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            tracks.push_back(SyntheticTrack(rates[i], config.seconds, config.noise, 1234 + (uint32_t)i));
+        }
+    }
+    if (tracks.empty()) {
+        fprintf(stderr, "No device with at least two moves in the trace\n");
+        return 1;
+    }
+
+    struct Variant {
+        const char* name;
+        bool smoothing, prediction;
+    };
+    const Variant variants[] = { { "off", false, false }, { "oneEuro", true, false }, { "predict", false, true }, { "oneEuroPredict", true, true } };
+
+    FILE* out = stdout;
+    if (!config.outPath.empty()) {
+        out = fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", config.outPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"source\": \"%s\", \"refreshHz\": %.1f, \"leadMicros\": %lld, \"noise\": %.2f, \"minCutoff\": %g, \"beta\": %g, "
+                 "\"processNoise\": %g, \"measurementNoise\": %g},\n",
+        config.tracePath.empty() ? "synthetic" : "trace", config.refreshHz, (long long)config.filter.leadMicros, config.noise,
+        config.filter.minCutoff, config.filter.beta, config.filter.processNoise, config.filter.measurementNoise);
+    fprintf(out, "  \"devices\": [\n");
+    for (size_t i = 0; i < tracks.size(); i++) {
+        const Track& track = tracks[i];
+        fprintf(out, "    {\"device\": \"%s\", \"reports\": %zu, \"frameErrorPx\": {\n", track.label.c_str(), track.reports.size());
+        for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+            MotionFilterConfig filter = config.filter;
+            filter.smoothing = variants[v].smoothing;
+            filter.prediction = variants[v].prediction;
+            double nsPerEvent = 0;
+            std::vector<Sample> delivered = RunFilter(track, filter, &nsPerEvent);
+            ErrorStats stats = Evaluate(track, delivered, config);
+            fprintf(out, "      \"%s\": {\"mean\": %.2f, \"p50\": %.2f, \"p95\": %.2f, \"p99\": %.2f, \"max\": %.2f, \"stillJitter\": %.3f, \"nsPerEvent\": %.1f}%s\n",
+                variants[v].name, stats.mean, stats.p50, stats.p95, stats.p99, stats.max, stats.stillJitter, nsPerEvent,
+                v + 1 < sizeof(variants) / sizeof(variants[0]) ? "," : "");
+        }
+        fprintf(out, "    }}%s\n", i + 1 < tracks.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
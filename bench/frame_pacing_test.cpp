@@ -0,0 +1,307 @@
+// Drives FrameScheduler and the Frame coalescing mode against a fake clock, the way InputPipeline
+// does: events are pushed as they arrive, the deadline is armed when motion becomes pending and
+// every pending move is delivered once it passes. Checks that each device gets at most one move
+// per refresh, that no motion is lost, that deliveries land on the configured or learned schedule
+// and that missed deadlines and jitter are reported, in the stats text too. Prints a JSON report
+// and exits non-zero on any failed check.
+//
+//   orionix_frame_pacing_test [--seconds 10] [--seed 1]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/event_ring.h"
+#include "../src/frame_scheduler.h"
+#include "../src/input_stats.h"
+#include "../src/motion_coalescer.h"
+
+static const size_t kDevices = 4;
+
+struct Delivery {
+    int64_t at;
+    MouseEvent event;
+};
+
+struct RecordingSink {
+    int64_t now = 0;
+    std::vector<Delivery> deliveries;
+    void Push(const MouseEvent& event) { deliveries.push_back({ now, event }); }
+};
+
+// One producer thread's worth of pipeline: the coalescer in Frame mode plus its scheduler.
+struct FakeProducer {
+    MotionCoalescer<kDevices> coalescer;
+    FrameScheduler frames;
+    RecordingSink sink;
+    // The producer sleeps with this granularity, like epoll_wait's millisecond timeout.
+    int64_t wakeGranularity = 0;
+
+    FakeProducer() { coalescer.Configure(CoalesceMode::Frame, 0); }
+
+    void Ingest(const MouseEvent& event) {
+        sink.now = event.timestamp;
+        coalescer.Push(event, event.timestamp, sink);
+        if (!frames.Armed() && coalescer.HasPending()) {
+            frames.Arm(event.timestamp);
+        }
+    }
+
+    void Flush(int64_t now) {
+        sink.now = now;
+        if (frames.Armed() && frames.Due(now)) {
+            frames.Delivered(now);
+            coalescer.FlushAll(sink);
+        }
+    }
+
+    // Time the producer actually wakes for the armed deadline.
+    int64_t WakeFor() const {
+        if (!frames.Armed()) {
+            return FrameScheduler::kNoDeadline;
+        }
+        const int64_t deadline = frames.Deadline();
+        if (wakeGranularity <= 0) {
+            return deadline;
+        }
+        return ((deadline + wakeGranularity - 1) / wakeGranularity) * wakeGranularity;
+    }
+};
+
+struct Check {
+    std::string name;
+    bool ok;
+    std::string detail;
+};
+
+static std::vector<Check> checks;
+
+static void Expect(const std::string& name, bool ok, const std::string& detail) {
+    checks.push_back({ name, ok, detail });
+}
+
+static std::string Format(const char* format, double a, double b = 0) {
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer), format, a, b);
+    return buffer;
+}
+
+static MouseEvent Move(uint32_t device, int64_t at, int dx, int dy) {
+    MouseEvent event = {};
+    event.deviceId = device;
+    event.type = EventType::Move;
+    event.action = EventAction::None;
+    event.deltaX = dx;
+    event.deltaY = dy;
+    event.timestamp = at;
+    return event;
+}
+
+// Feeds 1 kHz motion from every device until `end`, waking for frame deadlines in between, and
+// calls `onTick` at every millisecond for consumer-side events.
+template <typename Tick>
+static void Run(FakeProducer& producer, int64_t start, int64_t end, std::mt19937& rng, int64_t* sentX, Tick onTick) {
+    std::uniform_int_distribution<int> delta(-8, 8);
+    for (int64_t t = start; t < end; t += 1000) {
+        for (int64_t wake = producer.WakeFor(); wake <= t; wake = producer.WakeFor()) {
+            producer.Flush(wake);
+        }
+        onTick(t);
+        for (uint32_t device = 0; device < kDevices; device++) {
+            const int dx = delta(rng);
+            sentX[device] += dx;
+            producer.Ingest(Move(device, t + device * 37, dx, delta(rng)));
+        }
+    }
+    for (int64_t wake = producer.WakeFor(); wake != FrameScheduler::kNoDeadline; wake = producer.WakeFor()) {
+        producer.Flush(wake);
+    }
+}
+
+// Deliveries must be one per device per refresh, and sum to what was sent.
+static void CheckDeliveries(const std::string& scenario, const FakeProducer& producer, const int64_t* sentX, int64_t period) {
+    int64_t receivedX[kDevices] = {};
+    int64_t lastAt[kDevices];
+    size_t tooClose = 0;
+    for (size_t device = 0; device < kDevices; device++) {
+        lastAt[device] = INT64_MIN / 2;
+    }
+    for (const Delivery& delivery : producer.sink.deliveries) {
+        const uint32_t device = delivery.event.deviceId;
+        receivedX[device] += delivery.event.deltaX;
+        tooClose += delivery.at - lastAt[device] < period / 2 ? 1 : 0;
+        lastAt[device] = delivery.at;
+    }
+    bool conserved = true;
+    for (size_t device = 0; device < kDevices; device++) {
+        conserved = conserved && receivedX[device] == sentX[device];
+    }
+    Expect(scenario + ".onePerFrame", tooClose == 0, Format("%.0f deliveries closer than half a frame", (double)tooClose));
+    Expect(scenario + ".motionConserved", conserved, "summed deltas equal what was sent");
+}
+
+// Fixed phase: every delivery sits exactly lead before a refresh of the configured grid.
+static void FixedPhase(double seconds, std::mt19937& rng, FILE* out) {
+    FakeProducer producer;
+    FramePacingConfig config;
+    config.periodMicros = 16667;
+    config.phaseMicros = 5000;
+    config.leadMicros = 2000;
+    producer.frames.Configure(config);
+
+    int64_t sentX[kDevices] = {};
+    Run(producer, 1000000, 1000000 + (int64_t)(seconds * 1e6), rng, sentX, [](int64_t) {});
+
+    size_t offGrid = 0;
+    for (const Delivery& delivery : producer.sink.deliveries) {
+        const int64_t refresh = delivery.at + config.leadMicros;
+        offGrid += (refresh - config.phaseMicros) % config.periodMicros != 0 ? 1 : 0;
+    }
+    const FramePacingStats stats = producer.frames.Stats();
+    CheckDeliveries("fixed", producer, sentX, config.periodMicros);
+    Expect("fixed.onGrid", offGrid == 0, Format("%.0f deliveries off the refresh grid", (double)offGrid));
+    Expect("fixed.noJitter", stats.missed == 0 && stats.jitterMaxMicros == 0, Format("missed %.0f, max jitter %.0f us", (double)stats.missed, (double)stats.jitterMaxMicros));
+    fprintf(out, "    \"fixed\": {\"frames\": %llu, \"missed\": %llu, \"jitterMeanMicros\": %.1f, \"jitterMaxMicros\": %lld, \"deliveries\": %zu},\n",
+        (unsigned long long)stats.frames, (unsigned long long)stats.missed, stats.jitterMeanMicros, (long long)stats.jitterMaxMicros,
+        producer.sink.deliveries.size());
+}
+
+// No vsync source: a consumer presenting at 59.94 Hz with noise, dropped frames and two overlays
+// reporting each frame. The schedule has to learn the true period and phase from 60 Hz.
+static void ConsumerLock(double seconds, std::mt19937& rng, FILE* out) {
+    FakeProducer producer;
+    producer.wakeGranularity = 1000;
+    FramePacingConfig config;
+    config.periodMicros = 16667;
+    config.leadMicros = 3000;
+    producer.frames.Configure(config);
+
+    const double truePeriod = 1e6 / 59.94;
+    const double truePhase = 7321;
+    std::normal_distribution<double> reportNoise(0, 250);
+    std::uniform_real_distribution<double> unit(0, 1);
+    int64_t nextFrame = 0;
+    int64_t frameIndex = (int64_t)((1000000 - truePhase) / truePeriod) + 1;
+    auto frameAt = [&](int64_t index) { return (int64_t)std::llround(truePhase + index * truePeriod); };
+    nextFrame = frameAt(frameIndex);
+
+    int64_t sentX[kDevices] = {};
+    const int64_t start = 1000000;
+    const int64_t end = start + (int64_t)(seconds * 1e6);
+    bool lockedAt2s = false;
+    Run(producer, start, end, rng, sentX, [&](int64_t t) {
+        while (nextFrame <= t) {
+            // The overlay report arrives after the refresh, by a constant hop plus noise.
+            if (unit(rng) > 0.1) {
+                producer.frames.ObserveFrame(nextFrame + 1500 + (int64_t)reportNoise(rng));
+                producer.frames.ObserveFrame(nextFrame + 1900 + (int64_t)reportNoise(rng));
+            }
+            nextFrame = frameAt(++frameIndex);
+        }
+        if (t == start + 2000000) {
+            lockedAt2s = producer.frames.Stats().locked;
+        }
+    });
+
+    // Where deliveries land relative to the (report-shifted) refresh they target.
+    double phaseError = 0;
+    size_t settled = 0;
+    for (const Delivery& delivery : producer.sink.deliveries) {
+        if (delivery.at < start + 3000000) {
+            continue;
+        }
+        const double target = delivery.at + config.leadMicros - 1700 - truePhase;
+        double offset = std::fmod(target, truePeriod);
+        offset = offset > truePeriod / 2 ? offset - truePeriod : offset;
+        phaseError = std::max(phaseError, std::fabs(offset));
+        settled++;
+    }
+
+    const FramePacingStats stats = producer.frames.Stats();
+    CheckDeliveries("consumer", producer, sentX, (int64_t)truePeriod);
+    Expect("consumer.locked", lockedAt2s && stats.locked, "locked within 2 s and still locked at the end");
+    Expect("consumer.period", std::fabs(stats.periodMicros - truePeriod) < 5, Format("period %.0f us, true %.1f us", (double)stats.periodMicros, truePeriod));
+    Expect("consumer.phase", settled > 0 && phaseError < 1500, Format("max phase error %.0f us after 3 s", phaseError));
+    Expect("consumer.jitter", stats.missed == 0 && stats.jitterMaxMicros < 1000, Format("missed %.0f, max jitter %.0f us", (double)stats.missed, (double)stats.jitterMaxMicros));
+    fprintf(out, "    \"consumer\": {\"frames\": %llu, \"missed\": %llu, \"jitterMeanMicros\": %.1f, \"jitterMaxMicros\": %lld, \"periodMicros\": %lld, "
+                 "\"locked\": %s, \"maxPhaseErrorMicros\": %.0f},\n",
+        (unsigned long long)stats.frames, (unsigned long long)stats.missed, stats.jitterMeanMicros, (long long)stats.jitterMaxMicros,
+        (long long)stats.periodMicros, stats.locked ? "true" : "false", phaseError);
+}
+
+// A producer that oversleeps past the refresh counts a missed deadline, and an idle pipeline
+// arms nothing.
+static void Stalls(std::mt19937& rng, FILE* out) {
+    FakeProducer producer;
+    FramePacingConfig config;
+    config.periodMicros = 10000;
+    config.phaseMicros = 0;
+    config.leadMicros = 1000;
+    producer.frames.Configure(config);
+
+    producer.Ingest(Move(0, 100, 1, 0));
+    producer.Flush(9000 + 500);    // half a millisecond late: jitter only
+    producer.Ingest(Move(0, 12000, 1, 0));
+    producer.Flush(19000 + 4000);  // after the refresh at 20000: missed
+    const bool idle = !producer.frames.Armed();
+
+    const FramePacingStats stats = producer.frames.Stats();
+    Expect("stall.missed", stats.frames == 2 && stats.missed == 1, Format("%.0f frames, %.0f missed", (double)stats.frames, (double)stats.missed));
+    Expect("stall.jitter", stats.jitterMaxMicros == 4000 && std::fabs(stats.jitterMeanMicros - 2250) < 1e-9,
+        Format("mean %.1f us, max %.0f us", stats.jitterMeanMicros, (double)stats.jitterMaxMicros));
+    Expect("stall.idle", idle, "no deadline armed without pending motion");
+
+    producer.frames.ResetStats();
+    const FramePacingStats window = producer.frames.Stats();
+    const FramePacingStats totals = producer.frames.Totals();
+    Expect("stall.reset", window.frames == 0 && window.missed == 0 && window.jitterMaxMicros == 0 && totals.frames == 2 &&
+        totals.missed == 1 && totals.jitterMaxMicros == 4000, Format("after a reset %.0f frames, %.0f in total", (double)window.frames, (double)totals.frames));
+    InputStatsSnapshot snapshot;
+    snapshot.frames = totals;
+    const std::string text = FormatStatsText(snapshot);
+    Expect("stall.exposition", text.find("\norionix_frames_total 2\n") != std::string::npos &&
+        text.find("\norionix_frames_missed_total 1\n") != std::string::npos &&
+        text.find("\norionix_frame_jitter_micros_sum 4500\n") != std::string::npos &&
+        text.find("\norionix_frame_jitter_max_micros 4000\n") != std::string::npos, "missed deadlines and jitter in the stats text");
+    (void)rng;
+    fprintf(out, "    \"stall\": {\"frames\": %llu, \"missed\": %llu, \"jitterMeanMicros\": %.1f, \"jitterMaxMicros\": %lld}\n",
+        (unsigned long long)stats.frames, (unsigned long long)stats.missed, stats.jitterMeanMicros, (long long)stats.jitterMaxMicros);
+}
+
+int main(int argc, char** argv) {
+    double seconds = 10;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--seconds") {
+            seconds = atof(argv[i + 1]);
+        } else if (arg == "--seed") {
+            seed = (unsigned)atoi(argv[i + 1]);
+        } else {
+            fprintf(stderr, "Usage: orionix_frame_pacing_test [--seconds N] [--seed N]\n");
+            return 2;
+        }
+    }
+    if (seconds < 4) {
+        fprintf(stderr, "--seconds must be at least 4\n");
+        return 2;
+    }
+
+    std::mt19937 rng(seed);
+    printf("{\n  \"scenarios\": {\n");
+    FixedPhase(seconds, rng, stdout);
+    ConsumerLock(seconds, rng, stdout);
+    Stalls(rng, stdout);
+    printf("  },\n  \"checks\": [\n");
+    bool ok = true;
+    for (size_t i = 0; i < checks.size(); i++) {
+        ok = ok && checks[i].ok;
+        printf("    {\"name\": \"%s\", \"ok\": %s, \"detail\": \"%s\"}%s\n", checks[i].name.c_str(), checks[i].ok ? "true" : "false",
+            checks[i].detail.c_str(), i + 1 < checks.size() ? "," : "");
+    }
+    printf("  ],\n  \"ok\": %s\n}\n", ok ? "true" : "false");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,384 @@
+// Synthetic load generator for the native input pipeline. Drives IngestEvent from N simulated
+// devices on one producer thread, drains on a consumer thread the way the addon does, and prints
+// a JSON report on stdout (or --out).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+#include "../src/input_pipeline.h"
+#include "../src/latency_histogram.h"
+
+struct BenchConfig {
+    int devices = 4;
+    int rateHz = 1000;
+    double seconds = 5.0;
+    int clickEvery = 250;
+    bool saturate = false;
+    CoalesceMode coalesce = CoalesceMode::Off;
+    int64_t windowMicros = 4000;
+    OverflowPolicy overflow = OverflowPolicy::MergeMoves;
+    uint8_t subscription = kSubscribeAll;
+    std::string outPath;
+    std::string metricsPath;
+};
+
+struct SyntheticDevice {
+    uint32_t id;
+    uint32_t seed;
+    int x, y;
+};
+
+static InputPipeline pipeline;
+static std::mutex wakeMutex;
+static std::condition_variable wakeSignal;
+static bool wakeRequested = false;
+static std::atomic<bool> producerDone{false};
+
+static uint64_t generatedEvents = 0;
+static uint64_t deliveredEvents = 0;
+static LatencyHistogram latency;
+
+static int64_t ThreadCpuNanos() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (int64_t)(k.QuadPart + u.QuadPart) * 100;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static uint64_t PeakMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (uint64_t)counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+static void OnWakeup(void*) {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeRequested = true;
+    }
+    wakeSignal.notify_one();
+}
+
+// xorshift32: cheap, deterministic per-device motion.
+static int NextDelta(SyntheticDevice& device) {
+    device.seed ^= device.seed << 13;
+    device.seed ^= device.seed >> 17;
+    device.seed ^= device.seed << 5;
+    return (int)(device.seed % 17) - 8;
+}
+
+static void Ingest(const MouseEvent& event) {
+    pipeline.IngestEvent(event);
+    generatedEvents++;
+}
+
+static void EmitReport(SyntheticDevice& device, uint64_t report, int clickEvery) {
+    if (clickEvery > 0) {
+        uint64_t phase = (report + device.id) % (uint64_t)clickEvery;
+        if (phase == 0) {
+            Ingest(MakeEvent(device.id, EventType::Button, EventAction::LeftDown, device.x, device.y, 0, 0, 0x0001));
+        } else if (phase == 1) {
+            Ingest(MakeEvent(device.id, EventType::Button, EventAction::LeftUp, device.x, device.y, 0, 0, 0x0002));
+        }
+    }
+
+    int dx = NextDelta(device);
+    int dy = NextDelta(device);
+    device.x += dx;
+    device.y += dy;
+    Ingest(MakeEvent(device.id, EventType::Move, EventAction::None, device.x, device.y, dx, dy, 0));
+}
+
+static void ProducerMain(const BenchConfig& config, std::vector<SyntheticDevice>& devices, int64_t* cpuNanos) {
+    int64_t cpuBusy = 0;
+    const double period = 1000000.0 / config.rateHz;
+    const int64_t start = NowMicros();
+    const int64_t end = start + (int64_t)(config.seconds * 1000000.0);
+
+    for (SyntheticDevice& device : devices) {
+        Ingest(MakeEvent(device.id, EventType::Device, EventAction::Added, 0, 0, 0, 0, 0));
+    }
+
+    for (uint64_t report = 0;; report++) {
+        int64_t due = start + (int64_t)(report * period);
+        if (due >= end || (config.saturate && NowMicros() >= end)) {
+            break;
+        }
+
+        if (!config.saturate) {
+            for (int64_t remaining = due - NowMicros(); remaining > 0; remaining = due - NowMicros()) {
+                if (remaining > 2000) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(remaining - 1000));
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // Only the emit work is charged to the producer, not the pacing wait.
+        int64_t cpuStart = ThreadCpuNanos();
+        for (SyntheticDevice& device : devices) {
+            EmitReport(device, report, config.clickEvery);
+        }
+        pipeline.FlushProducer();
+        pipeline.WakeConsumer();
+        cpuBusy += ThreadCpuNanos() - cpuStart;
+    }
+
+    pipeline.FlushProducer();
+    pipeline.WakeConsumer();
+    *cpuNanos = cpuBusy;
+}
+
+static void ConsumerMain(int64_t* cpuNanos) {
+    const int64_t cpuStart = ThreadCpuNanos();
+    MouseEvent event;
+
+    for (;;) {
+        bool finished;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeSignal.wait_for(lock, std::chrono::milliseconds(10), []() { return wakeRequested; });
+            wakeRequested = false;
+            finished = producerDone.load();
+        }
+
+        const int64_t drainStart = NowMicros();
+        size_t drained = 0;
+        pipeline.BeginDrain();
+        while (pipeline.Queue().Pop(event)) {
+            latency.Record(NowMicros() - event.timestamp);
+            drained++;
+        }
+        deliveredEvents += drained;
+        pipeline.Stats().RecordDrain(drained, NowMicros() - drainStart);
+
+        if (finished && pipeline.Queue().Size() == 0) {
+            break;
+        }
+    }
+
+    *cpuNanos = ThreadCpuNanos() - cpuStart;
+}
+
+static bool ParseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (arg == "--saturate") {
+            config.saturate = true;
+            continue;
+        }
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--devices") {
+            config.devices = atoi(value);
+        } else if (arg == "--rate") {
+            config.rateHz = atoi(value);
+        } else if (arg == "--seconds") {
+            config.seconds = atof(value);
+        } else if (arg == "--click-every") {
+            config.clickEvery = atoi(value);
+        } else if (arg == "--window-ms") {
+            config.windowMicros = (int64_t)(atof(value) * 1000.0);
+        } else if (arg == "--out") {
+            config.outPath = value;
+        } else if (arg == "--metrics") {
+            config.metricsPath = value;
+        } else if (arg == "--coalesce") {
+            std::string mode = value;
+            if (mode == "off") config.coalesce = CoalesceMode::Off;
+            else if (mode == "window") config.coalesce = CoalesceMode::Window;
+            else if (mode == "drain") config.coalesce = CoalesceMode::UntilDrain;
+            else if (mode == "frame") config.coalesce = CoalesceMode::Frame;
+            else {
+                fprintf(stderr, "Unknown coalescing mode: %s\n", value);
+                return false;
+            }
+        } else if (arg == "--subscribe") {
+            config.subscription = 0;
+            std::string classes = value;
+            for (size_t start = 0; start <= classes.size();) {
+                size_t end = classes.find(',', start);
+                std::string name = classes.substr(start, end == std::string::npos ? std::string::npos : end - start);
+                if (name == "move") config.subscription |= kSubscribeMove;
+                else if (name == "button") config.subscription |= kSubscribeButton;
+                else if (name == "device") config.subscription |= kSubscribeDevice;
+                else if (!name.empty()) {
+                    fprintf(stderr, "Unknown event class: %s\n", name.c_str());
+                    return false;
+                }
+                start = end == std::string::npos ? classes.size() + 1 : end + 1;
+            }
+        } else if (arg == "--overflow") {
+            std::string policy = value;
+            if (policy == "drop") config.overflow = OverflowPolicy::DropMoves;
+            else if (policy == "merge") config.overflow = OverflowPolicy::MergeMoves;
+            else {
+                fprintf(stderr, "Unknown overflow policy: %s\n", value);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.devices < 1 || config.devices > (int)kMaxTrackedDevices) {
+        fprintf(stderr, "--devices must be between 1 and %d\n", (int)kMaxTrackedDevices);
+        return false;
+    }
+    if (config.rateHz < 125 || config.rateHz > 8000) {
+        fprintf(stderr, "--rate must be between 125 and 8000\n");
+        return false;
+    }
+    if (config.seconds <= 0) {
+        fprintf(stderr, "--seconds must be positive\n");
+        return false;
+    }
+    return true;
+}
+
+static const char* CoalesceModeName(CoalesceMode mode) {
+    switch (mode) {
+        case CoalesceMode::Window: return "window";
+        case CoalesceMode::UntilDrain: return "drain";
+        case CoalesceMode::Frame: return "frame";
+        default: return "off";
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr,
+            "Usage: orionix_input_bench [--devices 1-256] [--rate 125-8000] [--seconds N] [--click-every N]\n"
+            "                           [--coalesce off|window|drain|frame] [--window-ms N] [--overflow drop|merge]\n"
+            "                           [--subscribe move,button,device] [--saturate] [--out report.json]\n"
+            "                           [--metrics stats.prom]\n");
+        return 2;
+    }
+
+    pipeline.Queue().SetOverflowPolicy(config.overflow);
+    pipeline.Coalescer().Configure(config.coalesce, config.windowMicros);
+    pipeline.Subscriptions().SetDefault(config.subscription);
+    pipeline.SetConsumerWakeup(OnWakeup, nullptr);
+
+    std::vector<SyntheticDevice> devices(config.devices);
+    for (int i = 0; i < config.devices; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "Bench Mouse %d", i);
+        devices[i].id = pipeline.InternDevice(0x1000 + (uint64_t)i, name);
+        devices[i].seed = 0x9E3779B9u * (uint32_t)(i + 1);
+        devices[i].x = 0;
+        devices[i].y = 0;
+    }
+
+    int64_t producerCpu = 0, consumerCpu = 0;
+    const int64_t wallStart = NowMicros();
+
+    std::thread consumer(ConsumerMain, &consumerCpu);
+    std::thread producer(ProducerMain, std::cref(config), std::ref(devices), &producerCpu);
+    producer.join();
+    producerDone.store(true);
+    OnWakeup(nullptr);
+    consumer.join();
+
+    const double wallSeconds = (double)(NowMicros() - wallStart) / 1000000.0;
+    const double generated = (double)std::max<uint64_t>(1, generatedEvents);
+    const double delivered = (double)std::max<uint64_t>(1, deliveredEvents);
+
+    InputStatsSnapshot snapshot;
+    pipeline.CollectStats(snapshot);
+    if (!config.metricsPath.empty()) {
+        FILE* metrics = fopen(config.metricsPath.c_str(), "w");
+        if (!metrics) {
+            fprintf(stderr, "Cannot open %s\n", config.metricsPath.c_str());
+            return 1;
+        }
+        fputs(FormatStatsText(snapshot).c_str(), metrics);
+        fclose(metrics);
+    }
+
+    FILE* out = stdout;
+    if (!config.outPath.empty()) {
+        out = fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", config.outPath.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"devices\": %d, \"rateHz\": %d, \"seconds\": %.3f, \"clickEvery\": %d, \"saturate\": %s, "
+                 "\"coalesce\": \"%s\", \"windowMicros\": %lld, \"overflow\": \"%s\", \"subscription\": %d},\n",
+        config.devices, config.rateHz, config.seconds, config.clickEvery, config.saturate ? "true" : "false",
+        CoalesceModeName(config.coalesce), (long long)config.windowMicros,
+        config.overflow == OverflowPolicy::DropMoves ? "drop" : "merge", config.subscription);
+    fprintf(out, "  \"events\": {\"generated\": %llu, \"delivered\": %llu, \"droppedMoves\": %llu, \"mergedMoves\": %llu, "
+                 "\"deferredEvents\": %llu, \"coalescedMoves\": %llu, \"unsubscribed\": %llu},\n",
+        (unsigned long long)generatedEvents, (unsigned long long)deliveredEvents,
+        (unsigned long long)pipeline.Queue().DroppedMoves(), (unsigned long long)pipeline.Queue().MergedMoves(),
+        (unsigned long long)pipeline.Queue().DeferredEvents(), (unsigned long long)pipeline.Coalescer().FoldedMoves(), (unsigned long long)snapshot.unsubscribed);
+    fprintf(out, "  \"throughput\": {\"wallSeconds\": %.3f, \"generatedPerSec\": %.1f, \"deliveredPerSec\": %.1f},\n",
+        wallSeconds, generatedEvents / wallSeconds, deliveredEvents / wallSeconds);
+    fprintf(out, "  \"cpu\": {\"producerNsPerEvent\": %.1f, \"consumerNsPerEvent\": %.1f},\n",
+        producerCpu / generated, consumerCpu / delivered);
+    fprintf(out, "  \"latencyMicros\": {\"p50\": %lld, \"p99\": %lld, \"p999\": %lld, \"max\": %lld, \"mean\": %.1f},\n",
+        (long long)latency.Percentile(0.50), (long long)latency.Percentile(0.99), (long long)latency.Percentile(0.999),
+        (long long)latency.Max(), latency.Mean());
+    if (config.coalesce == CoalesceMode::Frame) {
+        const FramePacingStats pacing = pipeline.Frames().Stats();
+        fprintf(out, "  \"frames\": {\"count\": %llu, \"missed\": %llu, \"jitterMeanMicros\": %.1f, \"jitterMaxMicros\": %lld},\n",
+            (unsigned long long)pacing.frames, (unsigned long long)pacing.missed, pacing.jitterMeanMicros, (long long)pacing.jitterMaxMicros);
+    }
+    const LatencyHistogram& drainSizes = pipeline.Stats().DrainEvents();
+    fprintf(out, "  \"drains\": {\"count\": %llu, \"eventsMean\": %.1f, \"eventsMax\": %lld, \"queueHighWater\": %llu},\n",
+        (unsigned long long)drainSizes.Count(), drainSizes.Mean(), (long long)drainSizes.Max(),
+        (unsigned long long)snapshot.queueHighWater);
+    fprintf(out, "  \"peakMemoryBytes\": %llu\n", (unsigned long long)PeakMemoryBytes());
+    fprintf(out, "}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+// Fixture tests for the monitor layout index (src/monitor_layout.h): mixed DPI side by side, a
+// monitor at a negative origin, monitors separated by gaps and an overlap. Point queries are
+// checked at every edge against a plain first-match scan, and conversions and Constrain against
+// hand-computed values. Exits non-zero on any failure.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../src/monitor_layout.h"
+#include "check.h"
+
+static MonitorInfo Monitor(int64_t id, int32_t x, int32_t y, int32_t width, int32_t height, double scale, int32_t physicalX, int32_t physicalY) {
+    MonitorInfo monitor;
+    monitor.id = id;
+    monitor.x = x;
+    monitor.y = y;
+    monitor.width = width;
+    monitor.height = height;
+    monitor.scale = scale;
+    monitor.physicalX = physicalX;
+    monitor.physicalY = physicalY;
+    return monitor;
+}
+
+// Reference for Find/FindPhysical: the first listed monitor containing the point.
+static int ScanFind(const std::vector<MonitorInfo>& monitors, int32_t x, int32_t y, bool physical) {
+    for (size_t i = 0; i < monitors.size(); i++) {
+        const MonitorInfo& m = monitors[i];
+        const int32_t left = physical ? m.physicalX : m.x;
+        const int32_t top = physical ? m.physicalY : m.y;
+        const int32_t width = physical ? (int32_t)std::lround(m.width * m.scale) : m.width;
+        const int32_t height = physical ? (int32_t)std::lround(m.height * m.scale) : m.height;
+        if (x >= left && x < left + width && y >= top && y < top + height) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Compares both indexes with the scan on every edge (and one pixel either side) and on random
+// points around the desktop.
+static bool MatchesScan(const std::vector<MonitorInfo>& monitors) {
+    MonitorLayout layout;
+    layout.Build(monitors);
+    for (int space = 0; space < 2; space++) {
+        const bool physical = space == 1;
+        std::vector<int32_t> xs, ys;
+        for (const MonitorInfo& m : monitors) {
+            const int32_t left = physical ? m.physicalX : m.x;
+            const int32_t top = physical ? m.physicalY : m.y;
+            const int32_t width = physical ? (int32_t)std::lround(m.width * m.scale) : m.width;
+            const int32_t height = physical ? (int32_t)std::lround(m.height * m.scale) : m.height;
+            for (int32_t d = -1; d <= 1; d++) {
+                xs.push_back(left + d);
+                xs.push_back(left + width + d);
+                ys.push_back(top + d);
+                ys.push_back(top + height + d);
+            }
+        }
+        for (int32_t x : xs) {
+            for (int32_t y : ys) {
+                const int found = physical ? layout.FindPhysical(x, y) : layout.Find(x, y);
+                if (found != ScanFind(monitors, x, y, physical)) {
+                    return false;
+                }
+            }
+        }
+        std::mt19937 random(7);
+        std::uniform_int_distribution<int32_t> coordinate(-6000, 6000);
+        for (int i = 0; i < 100000; i++) {
+            const int32_t x = coordinate(random);
+            const int32_t y = coordinate(random);
+            const int found = physical ? layout.FindPhysical(x, y) : layout.Find(x, y);
+            if (found != ScanFind(monitors, x, y, physical)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void TestMixedDpi() {
+    // 1080p at 100%, a 1440p panel at 200% to its right and a 1080p panel at 150% below.
+    const std::vector<MonitorInfo> monitors = {
+        Monitor(1, 0, 0, 1920, 1080, 1.0, 0, 0),
+        Monitor(2, 1920, 0, 1280, 720, 2.0, 1920, 0),
+        Monitor(3, 0, 1080, 1280, 720, 1.5, 0, 1080),
+    };
+    MonitorLayout layout;
+    layout.Build(monitors);
+
+    Check(layout.Find(1919, 1079) == 0 && layout.Find(1920, 0) == 1, "logical edges split 100% and 200% monitors");
+    Check(layout.Find(3199, 719) == 1 && layout.Find(3200, 0) == -1 && layout.Find(1920, 720) == -1,
+        "the 200% monitor covers 1280x720 logical pixels");
+    Check(layout.FindPhysical(4479, 1439) == 1 && layout.FindPhysical(4480, 0) == -1, "and 2560x1440 physical pixels");
+    Check(layout.FindPhysical(1919, 2159) == 2 && layout.FindPhysical(1920, 2159) == -1,
+        "the 150% monitor covers 1920x1080 physical pixels");
+    Check(MatchesScan(monitors), "mixed DPI: Find and FindPhysical agree with a linear scan");
+
+    int32_t points[] = {2020, 50, 100, 1100, 1919, 1079};
+    layout.ToPhysical(points, 3);
+    Check(points[0] == 2120 && points[1] == 100, "logical to physical at 200%");
+    Check(points[2] == 150 && points[3] == 1110, "logical to physical at 150%");
+    Check(points[4] == 1919 && points[5] == 1079, "logical to physical at 100%");
+    layout.ToLogical(points, 3);
+    Check(points[0] == 2020 && points[1] == 50 && points[2] == 100 && points[3] == 1100 && points[4] == 1919 && points[5] == 1079,
+        "physical back to logical round-trips");
+
+    bool roundTrip = true;
+    for (int32_t y = 1080; y < 1800 && roundTrip; y += 7) {
+        for (int32_t x = 0; x < 1280 && roundTrip; x++) {
+            int32_t point[] = {x, y};
+            layout.ToPhysical(point, 1);
+            layout.ToLogical(point, 1);
+            roundTrip = point[0] == x && point[1] == y;
+        }
+    }
+    Check(roundTrip, "every logical pixel of the 150% monitor round-trips");
+}
+
+static void TestNegativeOrigin() {
+    // A 125% monitor left of and above the primary, as after dragging it in display settings.
+    const std::vector<MonitorInfo> monitors = {
+        Monitor(1, -1920, -300, 1920, 1080, 1.25, -2400, -375),
+        Monitor(2, 0, 0, 2560, 1440, 1.0, 0, 0),
+    };
+    MonitorLayout layout;
+    layout.Build(monitors);
+
+    Check(layout.Find(-1920, -300) == 0 && layout.Find(-1, 779) == 0, "negative corners belong to the left monitor");
+    Check(layout.Find(-1921, 0) == -1 && layout.Find(-1, -301) == -1 && layout.Find(-1, 780) == -1,
+        "one pixel past each negative edge is off the desktop");
+    Check(layout.Find(0, -1) == -1 && layout.Find(0, 0) == 1, "above the primary is a gap");
+    Check(layout.FindPhysical(-2400, -375) == 0 && layout.FindPhysical(-1, 974) == 0 && layout.FindPhysical(-1, 975) == -1,
+        "physical edges of the negative monitor");
+    Check(MatchesScan(monitors), "negative origin: Find and FindPhysical agree with a linear scan");
+
+    int32_t points[] = {-1920, -300, -1, 779, -961, 241};
+    layout.ToPhysical(points, 3);
+    Check(points[0] == -2400 && points[1] == -375, "negative corner to physical");
+    Check(points[2] == -1 && points[3] == 974, "bottom-right pixel to physical");
+    Check(points[4] == -1201 && points[5] == 301, "inner point to physical rounds to the nearest pixel");
+    layout.ToLogical(points, 3);
+    Check(points[0] == -1920 && points[1] == -300 && points[2] == -1 && points[3] == 779 && points[4] == -961 && points[5] == 241,
+        "negative coordinates round-trip");
+
+    int32_t x = -10, y = 900;
+    Check(layout.Constrain(-10, 700, x, y) && x == -10 && y == 779, "leaving the left monitor downwards stops at its bottom edge");
+    x = -10;
+    y = 900;
+    Check(layout.Constrain(10, 700, x, y) && x == 0 && y == 900, "the same target from the primary stops at its left edge");
+    x = -50;
+    y = 100;
+    Check(!layout.Constrain(100, 100, x, y) && x == -50 && y == 100, "crossing onto the negative monitor is allowed");
+}
+
+static void TestGaps() {
+    // Two monitors 80 pixels apart, the right one lowered by 100; a third far below, not touching.
+    const std::vector<MonitorInfo> monitors = {
+        Monitor(1, 0, 0, 1920, 1080, 1.0, 0, 0),
+        Monitor(2, 2000, 100, 1920, 1080, 1.0, 2000, 100),
+        Monitor(3, 500, 1500, 1024, 768, 1.0, 500, 1500),
+    };
+    MonitorLayout layout;
+    layout.Build(monitors);
+
+    Check(layout.Find(1919, 500) == 0 && layout.Find(1920, 500) == -1 && layout.Find(1999, 500) == -1 && layout.Find(2000, 500) == 1,
+        "the horizontal gap belongs to no monitor");
+    Check(layout.Find(2500, 99) == -1 && layout.Find(600, 1200) == -1, "the offset corner and the vertical gap are empty");
+    Check(MatchesScan(monitors), "gaps: Find and FindPhysical agree with a linear scan");
+
+    int32_t x = 1950, y = 500;
+    Check(layout.Constrain(1900, 500, x, y) && x == 1919 && y == 500, "a move into the gap stops at the right edge");
+    x = 2100;
+    y = 500;
+    Check(!layout.Constrain(1900, 500, x, y) && x == 2100, "a move that jumps the gap lands on the next monitor");
+    x = 2100;
+    y = 50;
+    Check(layout.Constrain(2100, 150, x, y) && x == 2100 && y == 100, "the lowered monitor's top edge holds");
+    x = 1960;
+    y = 500;
+    Check(layout.Constrain(1950, 500, x, y) && x == 1919 && y == 500, "a move starting in the gap uses the nearest monitor");
+
+    int32_t points[] = {1950, 500, 700, 1300};
+    layout.ToPhysical(points, 2);
+    Check(points[0] == 1950 && points[1] == 500 && points[2] == 700 && points[3] == 1300, "points in gaps convert through the nearest monitor");
+}
+
+static void TestOverlapAndEmpty() {
+    const std::vector<MonitorInfo> monitors = {
+        Monitor(1, 0, 0, 1000, 1000, 1.0, 0, 0),
+        Monitor(2, 500, 500, 1000, 1000, 2.0, 1000, 1000),
+    };
+    MonitorLayout layout;
+    layout.Build(monitors);
+    Check(layout.Find(700, 700) == 0 && layout.Find(1200, 700) == 1, "the first listed monitor wins an overlap");
+    Check(MatchesScan(monitors), "overlap: Find and FindPhysical agree with a linear scan");
+
+    MonitorLayout empty;
+    empty.Build({});
+    int32_t x = 5, y = 6;
+    int32_t points[] = {5, 6};
+    empty.ToPhysical(points, 1);
+    Check(empty.Find(0, 0) == -1 && !empty.Constrain(0, 0, x, y) && points[0] == 5 && points[1] == 6,
+        "an empty layout finds nothing and converts nothing");
+}
+
+int main() {
+    TestMixedDpi();
+    TestNegativeOrigin();
+    TestGaps();
+    TestOverlapAndEmpty();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// Unit tests for the motion engine (src/motion_engine.h): sub-pixel accumulation at fractional
+// gains, the acceleration curve and its report-rate normalisation, desktop clamping, placement
+// and the reset of a device's position when it is removed. Exits non-zero on any failure.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/input_pipeline.h"
+#include "check.h"
+
+static MouseEvent Move(uint32_t id, int dx, int dy, int64_t timestamp) {
+    MouseEvent event = MakeEvent(id, EventType::Move, EventAction::None, 0, 0, dx, dy, 0);
+    event.timestamp = timestamp;
+    return event;
+}
+
+// Applies `count` identical moves `interval` microseconds apart and returns the last event.
+static MouseEvent Drive(MotionEngine& motion, uint32_t id, int dx, int dy, int count, int64_t& clock, int64_t interval) {
+    MouseEvent event{};
+    for (int i = 0; i < count; i++) {
+        clock += interval;
+        event = Move(id, dx, dy, clock);
+        motion.Apply(event);
+    }
+    return event;
+}
+
+static MotionConfig BaseConfig() {
+    MotionConfig config;
+    config.enabled = true;
+    config.minX = 0;
+    config.minY = 0;
+    config.maxX = 3839;
+    config.maxY = 2159;
+    config.originX = 1000;
+    config.originY = 1000;
+    return config;
+}
+
+static void TestSubPixel() {
+    static InputPipeline pipeline;
+    MotionEngine& motion = pipeline.Motion();
+    MotionConfig config = BaseConfig();
+    config.gain = 0.3;
+    motion.Configure(config);
+    int64_t clock = 0;
+
+    MouseEvent event = Drive(motion, 0, 1, 0, 10, clock, 1000);
+    Check(event.x == 1003 && event.y == 1000, "ten +1 counts at gain 0.3 add up to 3 pixels");
+    Check(event.deltaX == 1, "raw deltas leave the engine untouched");
+
+    event = Drive(motion, 0, -1, 0, 10, clock, 1000);
+    Check(event.x == 1000, "negative motion accumulates symmetrically back to the start");
+
+    config.gain = 0.1;
+    motion.Configure(config);
+    for (int i = 0; i < 1000; i++) {
+        Drive(motion, 1, i % 2 == 0 ? 1 : -1, 0, 1, clock, 1000);
+    }
+    event = Drive(motion, 1, 0, 0, 1, clock, 1000);
+    Check(event.x == 1000, "alternating sub-pixel jitter does not drift");
+
+    event = Drive(motion, 2, 0, 1, 7, clock, 1000);
+    Check(event.y == 1001, "0.7 pixels round to the nearest pixel");
+}
+
+static void TestAcceleration() {
+    static InputPipeline pipeline;
+    MotionEngine& motion = pipeline.Motion();
+    MotionConfig config = BaseConfig();
+    config.acceleration = true;   // threshold 1.5 counts/ms, slope 0.25, cap 3
+    motion.Configure(config);
+    int64_t clock = 1000000;
+
+    MouseEvent event = Drive(motion, 5, 10, 0, 1, clock, 1000);
+    Check(event.x == 1010, "a device's first report is not accelerated");
+
+    // Speed is measured against the device's previous report, so each case starts with a still one.
+    Drive(motion, 0, 0, 0, 1, clock, 1000);
+    event = Drive(motion, 0, 1, 0, 10, clock, 1000);
+    Check(event.x == 1010, "below the threshold the gain stays 1");
+
+    Drive(motion, 1, 0, 0, 1, clock, 1000);
+    event = Drive(motion, 1, 4, 0, 1, clock, 1000);
+    // 4 counts/ms: 1 + (4 - 1.5) * 0.25 = 1.625
+    Check(event.x == 1000 + 7, "4 counts/ms follows the slope (6.5 px rounds to 7)");
+
+    Drive(motion, 2, 0, 0, 1, clock, 1000);
+    event = Drive(motion, 2, 100, 0, 1, clock, 1000);
+    Check(event.x == 1300, "the multiplier is capped at accelMax");
+
+    // The same speed at 8 kHz and at 125 Hz must scale the same way.
+    Drive(motion, 3, 0, 0, 1, clock, 125);
+    event = Drive(motion, 3, 1, 0, 80, clock, 125);
+    const int fast = event.x - 1000;
+    Drive(motion, 4, 0, 0, 1, clock, 10000);
+    event = Drive(motion, 4, 80, 0, 1, clock, 10000);
+    const int slow = event.x - 1000;
+    Check(fast == slow, "8 counts/ms gives the same travel at 8 kHz and 125 Hz");
+    printf("  8 counts/ms over 10 ms: %d px at 8 kHz, %d px at 125 Hz\n", fast, slow);
+}
+
+static void TestClampPlacementAndReset() {
+    static InputPipeline pipeline;
+    const uint32_t id = pipeline.InternDevice(0x42, "mouse");
+    MotionEngine& motion = pipeline.Motion();
+    MotionConfig config = BaseConfig();
+    motion.Configure(config);
+    int64_t clock = 0;
+
+    MouseEvent event = Drive(motion, id, -5000, 5000, 1, clock, 1000);
+    Check(event.x == 0 && event.y == 2159, "positions clamp to the desktop");
+
+    motion.Place(0x42, 200, 300);
+    event = Drive(motion, id, 1, 1, 1, clock, 1000);
+    Check(event.x == 201 && event.y == 301, "Place moves the device's pointer");
+
+    MouseEvent button = MakeEvent(id, EventType::Button, EventAction::LeftDown, 0, 0, 0, 0, 0);
+    motion.Apply(button);
+    Check(button.x == 201 && button.y == 301, "buttons carry the device's position");
+
+    MouseEvent removed = MakeEvent(id, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0);
+    motion.Apply(removed);
+    event = Drive(motion, id, 0, 0, 1, clock, 1000);
+    Check(event.x == 1000 && event.y == 1000, "a removed device starts again from the origin");
+
+    config.maxX = 500;
+    config.maxY = 500;
+    motion.Configure(config);
+    event = Drive(motion, id, 0, 0, 1, clock, 1000);
+    Check(event.x == 500 && event.y == 500, "a smaller desktop clamps existing positions");
+
+    config.enabled = false;
+    motion.Configure(config);
+    event = Move(id, 3, 3, clock);
+    event.x = 77;
+    event.y = 88;
+    motion.Apply(event);
+    Check(event.x == 77 && event.y == 88, "a disabled engine leaves positions alone");
+}
+
+int main() {
+    TestSubPixel();
+    TestAcceleration();
+    TestClampPlacementAndReset();
+    return failures == 0 ? 0 : 1;
+}
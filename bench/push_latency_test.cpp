@@ -0,0 +1,149 @@
+// Measures push delivery on Linux: the evdev backend's input thread ingests synthetic moves
+// (InjectMove) and wakes a consumer thread through the pipeline's wakeup hook, the way the addon
+// signals its uv_async handle. Records the time from injection to the consumer seeing the event,
+// including first moves after a long idle (the old setInterval poll slept 64 ms there), and checks
+// that an idle backend wakes nobody and burns no CPU. Runs against an empty ORIONIX_INPUT_DIR so no
+// real device interferes. Prints a JSON report and exits non-zero on any failed check.
+//
+//   orionix_push_latency_test [--samples 2000] [--limit-ms 10]
+
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/input_backend.h"
+#include "../src/input_pipeline.h"
+#include "../src/latency_histogram.h"
+#include "check.h"
+
+static std::mutex wakeMutex;
+static std::condition_variable wakeSignal;
+static bool wakeRequested = false;
+static std::atomic<uint64_t> wakeups{0};
+
+static void OnWakeup(void*) {
+    wakeups.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeRequested = true;
+    }
+    wakeSignal.notify_one();
+}
+
+static int64_t ProcessCpuMicros() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (int64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int main(int argc, char** argv) {
+    int samples = 2000;
+    double limitMs = 10.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--samples") == 0) {
+            samples = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--limit-ms") == 0) {
+            limitMs = atof(argv[i + 1]);
+        } else {
+            fprintf(stderr, "Usage: orionix_push_latency_test [--samples N] [--limit-ms N]\n");
+            return 2;
+        }
+    }
+
+    char directory[] = "/tmp/orionix-latency-XXXXXX";
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    setenv("ORIONIX_INPUT_DIR", directory, 1);
+
+    static InputPipeline pipeline;
+    pipeline.SetConsumerWakeup(OnWakeup, nullptr);
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(pipeline);
+    if (const char* error = backend->Start()) {
+        fprintf(stderr, "%s\n", error);
+        rmdir(directory);
+        return 1;
+    }
+
+    // Consumer: sleeps until woken, then drains like the addon's async callback.
+    std::atomic<bool> running{true};
+    std::atomic<int64_t> lastSeen{0};
+    std::atomic<uint64_t> seen{0};
+    std::thread consumer([&]() {
+        MouseEvent event;
+        while (running.load()) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wakeSignal.wait(lock, [] { return wakeRequested; });
+                wakeRequested = false;
+            }
+            pipeline.BeginDrain();
+            while (pipeline.Queue().Pop(event)) {
+                lastSeen.store(NowMicros());
+                seen.fetch_add(1);
+            }
+        }
+    });
+
+    auto waitFor = [&](uint64_t count) {
+        const int64_t end = NowMicros() + 1000000;
+        while (seen.load() < count && NowMicros() < end) {
+        }
+        return seen.load() >= count;
+    };
+
+    // Let start-up settle, then an idle backend must neither wake the consumer nor spin.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const uint64_t idleWakeupsBefore = wakeups.load();
+    const int64_t idleCpuBefore = ProcessCpuMicros();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const uint64_t idleWakeups = wakeups.load() - idleWakeupsBefore;
+    const int64_t idleCpuMicros = ProcessCpuMicros() - idleCpuBefore;
+
+    LatencyHistogram latency;
+    LatencyHistogram afterIdle;
+    std::mt19937 random(1);
+    uint64_t expected = seen.load();
+    bool delivered = true;
+    for (int i = 0; i < samples && delivered; i++) {
+        // Every 500th sample follows a 600 ms pause, past the old poller's idle back-off.
+        const bool idle = i % 500 == 0;
+        std::this_thread::sleep_for(std::chrono::microseconds(idle ? 600000 : random() % 2000));
+        const int64_t injected = NowMicros();
+        backend->InjectMove(1, 1, 0);
+        delivered = waitFor(++expected);
+        (idle ? afterIdle : latency).Record(lastSeen.load() - injected);
+    }
+
+    backend->Stop();
+    running.store(false);
+    OnWakeup(nullptr);
+    consumer.join();
+    rmdir(directory);
+
+    const double limitMicros = limitMs * 1000.0;
+    Check(delivered, "every injected move reached the consumer");
+    Check(idleWakeups == 0, "an idle backend never wakes the consumer");
+    Check(idleCpuMicros < 5000, "an idle backend burns no CPU");
+    Check(latency.Percentile(0.99) < limitMicros, "p99 injection-to-consumer latency is under the limit");
+    Check(afterIdle.Max() < limitMicros, "the first move after a long idle is delivered within the limit");
+
+    printf("{\"samples\": %llu, \"latencyMicros\": {\"p50\": %lld, \"p99\": %lld, \"max\": %lld}, "
+           "\"afterIdleMaxMicros\": %lld, \"idleWakeups\": %llu, \"idleCpuMicros\": %lld}\n",
+        (unsigned long long)latency.Count(), (long long)latency.Percentile(0.5), (long long)latency.Percentile(0.99),
+        (long long)latency.Max(), (long long)afterIdle.Max(), (unsigned long long)idleWakeups, (long long)idleCpuMicros);
+    return failures == 0 ? 0 : 1;
+}
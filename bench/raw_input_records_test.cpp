@@ -0,0 +1,197 @@
+// Fixture tests for the GetRawInputBuffer record walker (src/raw_input_records.h). Buffers are
+// laid out by hand the way Windows fills them: 64-bit records (x64, or a 32-bit process under
+// WOW64) and native 32-bit ones, mouse reports mixed with odd-sized HID reports so the alignment
+// padding matters, and records whose dwSize is too small or runs past the buffer. Exits non-zero
+// on any failure.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../src/raw_input_records.h"
+#include "check.h"
+
+static const uint32_t kTypeMouse = 0;
+static const uint32_t kTypeHid = 2;
+static const size_t kMouseSize = 24;
+
+// Packs records into an 8-byte aligned buffer with the padding GetRawInputBuffer leaves.
+class Buffer {
+public:
+    explicit Buffer(bool wide) : wide_(wide) {}
+
+    // dwSize defaults to header plus payload; padding follows it either way.
+    void Add(uint32_t type, uint64_t device, const std::vector<uint8_t>& payload, uint32_t size = 0) {
+        const size_t headerSize = RawInputHeaderSize(wide_);
+        const size_t start = bytes_.size();
+        bytes_.resize(start + headerSize, 0);
+        if (size == 0) {
+            size = (uint32_t)(headerSize + payload.size());
+        }
+        memcpy(&bytes_[start], &type, 4);
+        memcpy(&bytes_[start + 4], &size, 4);
+        memcpy(&bytes_[start + 8], &device, wide_ ? 8 : 4);
+        bytes_.insert(bytes_.end(), payload.begin(), payload.end());
+        const size_t align = wide_ ? 8 : 4;
+        while (bytes_.size() % align != 0) {
+            bytes_.push_back(0xCD);
+        }
+    }
+
+    void AddMouse(uint64_t device, int32_t dx, int32_t dy) {
+        std::vector<uint8_t> mouse(kMouseSize, 0);
+        memcpy(&mouse[12], &dx, 4);
+        memcpy(&mouse[16], &dy, 4);
+        Add(kTypeMouse, device, mouse);
+    }
+
+    void AddHid(uint64_t device, size_t reportBytes) {
+        std::vector<uint8_t> hid(8 + reportBytes, 0xAB);
+        uint32_t sizeHid = (uint32_t)reportBytes, count = 1;
+        memcpy(&hid[0], &sizeHid, 4);
+        memcpy(&hid[4], &count, 4);
+        Add(kTypeHid, device, hid);
+    }
+
+    // Aligned storage, as the backend's uint64_t buffer.
+    const void* Data() {
+        aligned_.assign((bytes_.size() + 7) / 8, 0);
+        memcpy(aligned_.data(), bytes_.data(), bytes_.size());
+        return aligned_.data();
+    }
+
+    size_t Size() const { return bytes_.size(); }
+    std::vector<uint8_t>& Bytes() { return bytes_; }
+
+private:
+    bool wide_;
+    std::vector<uint8_t> bytes_;
+    std::vector<uint64_t> aligned_;
+};
+
+struct Walked {
+    std::vector<RawInputRecord> records;
+    std::vector<int32_t> dx;
+};
+
+static Walked Walk(Buffer& buffer, bool wide, size_t size = 0) {
+    Walked walked;
+    RawInputRecords records(buffer.Data(), size ? size : buffer.Size(), wide);
+    RawInputRecord record;
+    while (records.Next(&record)) {
+        walked.records.push_back(record);
+        int32_t dx = 0;
+        if (record.type == kTypeMouse && record.dataSize >= kMouseSize) {
+            memcpy(&dx, record.data + 12, 4);
+        }
+        walked.dx.push_back(dx);
+    }
+    return walked;
+}
+
+static void TestMouseRun(bool wide, const char* name) {
+    printf("-- %s mouse reports\n", name);
+    Buffer buffer(wide);
+    for (int i = 0; i < 5; i++) {
+        buffer.AddMouse(0x10000 + i, i + 1, -(i + 1));
+    }
+    Walked walked = Walk(buffer, wide);
+    Check(walked.records.size() == 5, "every record found");
+    bool fields = walked.records.size() == 5;
+    for (size_t i = 0; fields && i < walked.records.size(); i++) {
+        int32_t dy;
+        memcpy(&dy, walked.records[i].data + 16, 4);
+        fields = walked.records[i].type == kTypeMouse && walked.records[i].device == 0x10000 + i &&
+                 walked.records[i].dataSize == kMouseSize && walked.dx[i] == (int32_t)i + 1 && dy == -((int32_t)i + 1);
+    }
+    Check(fields, "type, device, payload size and deltas read back");
+    Check(RawInputHeaderSize(wide) + kMouseSize == (wide ? 48u : 40u), "mouse record size");
+}
+
+// The case NEXTRAWINPUTBLOCK gets wrong in a 32-bit build under WOW64: after a 24 + 8 + 3 byte
+// record the next one starts at 40, not 36.
+static void TestOddSizes(bool wide, const char* name) {
+    printf("-- %s odd-sized HID reports\n", name);
+    Buffer buffer(wide);
+    buffer.AddMouse(1, 7, 0);
+    buffer.AddHid(2, 3);
+    buffer.AddMouse(1, 8, 0);
+    buffer.AddHid(2, 1);
+    buffer.AddHid(3, 6);
+    buffer.AddMouse(4, 9, 0);
+    Walked walked = Walk(buffer, wide);
+    Check(walked.records.size() == 6, "every record found");
+    Check(walked.records.size() == 6 && walked.dx[0] == 7 && walked.dx[2] == 8 && walked.dx[5] == 9 &&
+              walked.records[5].device == 4, "mouse reports after padded HID reports");
+    Check(walked.records.size() == 6 && walked.records[1].type == kTypeHid && walked.records[1].dataSize == 11 &&
+              walked.records[4].dataSize == 14, "HID payload sizes exclude the padding");
+
+    if (wide) {
+        // 32-bit NEXTRAWINPUTBLOCK steps from the HID record to offset 84, inside the padding.
+        const std::vector<uint8_t>& bytes = buffer.Bytes();
+        size_t offset = 0;
+        uint32_t size;
+        for (int i = 0; i < 2; i++) {
+            memcpy(&size, &bytes[offset + 4], 4);
+            offset += (size + 3) & ~3u;
+        }
+        memcpy(&size, &bytes[offset + 4], 4);
+        Check(offset == 84 && size != 48, "4-byte stepping loses the third record");
+    }
+}
+
+static void TestMalformed(bool wide, const char* name) {
+    printf("-- %s malformed records\n", name);
+    const size_t headerSize = RawInputHeaderSize(wide);
+    {
+        Buffer buffer(wide);
+        buffer.AddMouse(1, 1, 0);
+        buffer.Add(kTypeMouse, 2, std::vector<uint8_t>(kMouseSize, 0), (uint32_t)headerSize - 1);
+        buffer.AddMouse(3, 3, 0);
+        Check(Walk(buffer, wide).records.size() == 1, "stops at a dwSize shorter than the header");
+    }
+    {
+        Buffer buffer(wide);
+        buffer.AddMouse(1, 1, 0);
+        buffer.Add(kTypeMouse, 2, std::vector<uint8_t>(kMouseSize, 0), 0xFFFFFFF0u);
+        Check(Walk(buffer, wide).records.size() == 1, "stops at a dwSize past the buffer");
+    }
+    {
+        Buffer buffer(wide);
+        buffer.AddMouse(1, 1, 0);
+        buffer.AddMouse(2, 2, 0);
+        Check(Walk(buffer, wide, buffer.Size() - 1).records.size() == 1, "stops at a record cut by the buffer end");
+        Check(Walk(buffer, wide, headerSize + kMouseSize + headerSize - 1).records.size() == 1,
+              "stops at a header cut by the buffer end");
+        Check(Walk(buffer, wide, headerSize - 1).records.empty(), "buffer shorter than one header");
+    }
+    {
+        // Header-only record: a payload of zero bytes, not a mouse report.
+        Buffer buffer(wide);
+        buffer.Add(kTypeMouse, 1, std::vector<uint8_t>());
+        buffer.AddMouse(2, 5, 0);
+        Walked walked = Walk(buffer, wide);
+        Check(walked.records.size() == 2 && walked.records[0].dataSize == 0 && walked.dx[0] == 0 && walked.dx[1] == 5,
+              "header-only record is skipped over");
+    }
+    {
+        // The last record is not padded when it ends the buffer.
+        Buffer buffer(wide);
+        buffer.AddMouse(1, 1, 0);
+        buffer.AddHid(2, 1);
+        const size_t unpadded = buffer.Size() - (wide ? 7 : 3);
+        Check(Walk(buffer, wide, unpadded).records.size() == 2, "unpadded last record");
+    }
+}
+
+int main() {
+    TestMouseRun(true, "64-bit");
+    TestMouseRun(false, "32-bit");
+    TestOddSizes(true, "64-bit");
+    TestOddSizes(false, "32-bit");
+    TestMalformed(true, "64-bit");
+    TestMalformed(false, "32-bit");
+
+    printf("%s\n", failures == 0 ? "all raw input record checks passed" : "raw input record checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
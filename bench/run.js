@@ -0,0 +1,57 @@
+// Rebuilds the bench targets (bench/binding.gyp) and runs one of them with the remaining
+// arguments; <target> is a target name without its orionix_ prefix. `tests` runs every *_test
+// target this platform builds, one after the other, and exits non-zero if any of them failed.
+//
+//   node bench/run.js <target> [args...]
+//   node bench/run.js tests
+
+const { execFileSync, spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const RELEASE_DIR = path.join(__dirname, 'build', 'Release');
+const EXTENSION = process.platform === 'win32' ? '.exe' : '';
+
+function builtTargets() {
+  return fs
+    .readdirSync(RELEASE_DIR)
+    .filter((file) => file.startsWith('orionix_') && path.extname(file) === EXTENSION)
+    .map((file) => path.basename(file, EXTENSION).slice('orionix_'.length))
+    .sort();
+}
+
+function run(target, args) {
+  const result = spawnSync(path.join(RELEASE_DIR, `orionix_${target}${EXTENSION}`), args, { stdio: 'inherit' });
+  if (result.error) {
+    throw result.error;
+  }
+  return result.status === null ? 1 : result.status;
+}
+
+function main() {
+  const [target, ...args] = process.argv.slice(2);
+  if (!target) {
+    console.error('Usage: node bench/run.js <target> [args...] | tests');
+    return 2;
+  }
+
+  execFileSync('node-gyp', ['rebuild', '-C', __dirname], { stdio: 'inherit', shell: process.platform === 'win32' });
+  const targets = builtTargets();
+
+  if (target === 'tests') {
+    const failed = targets.filter((name) => name.endsWith('_test')).filter((name) => {
+      console.log(`-- ${name}`);
+      return run(name, []) !== 0;
+    });
+    console.log(failed.length === 0 ? 'all bench tests passed' : `bench tests FAILED: ${failed.join(', ')}`);
+    return failed.length === 0 ? 0 : 1;
+  }
+
+  if (!targets.includes(target)) {
+    console.error(`Unknown target "${target}"; built here: ${targets.join(', ')}`);
+    return 2;
+  }
+  return run(target, args);
+}
+
+process.exitCode = main();
@@ -0,0 +1,224 @@
+// Runs the input daemon in child processes with simulated devices and attaches two clients:
+// checks both see every device and whole records, then SIGKILLs the daemon, starts another with
+// one device fewer and checks both clients reconnect, drop the missing device and resume.
+// Exits non-zero on any failure. POSIX only.
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "../src/input_pipeline.h"
+#include "../src/input_service.h"
+#include "../src/shared_event_ring.h"
+#include "check.h"
+
+static std::atomic<bool> daemonStop{false};
+
+static void OnSignal(int) {
+    daemonStop.store(true);
+}
+
+// Sees each event as the client read it from the ring, before its own motion engine.
+struct ClientProbe {
+    std::unique_ptr<InputPipeline> pipeline;
+    std::unique_ptr<InputBackend> backend;
+    std::atomic<uint64_t> moves{0};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> added{0};
+    std::atomic<uint64_t> removed{0};
+    std::atomic<bool> draining{true};
+    std::thread consumer;
+
+    static void Tap(void* context, const MouseEvent& event) {
+        ClientProbe& self = *(ClientProbe*)context;
+        if (event.type == EventType::Move) {
+            self.moves.fetch_add(1, std::memory_order_relaxed);
+            if (event.deltaY != -event.deltaX || event.x != 500 + event.deltaX || event.y != 500 + event.deltaY) {
+                self.torn.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (event.type == EventType::Device) {
+            (event.action == EventAction::Added ? self.added : self.removed).fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::set<std::string> DeviceNames() const {
+        std::set<std::string> names;
+        for (const InputDeviceInfo& device : pipeline->Registry().Snapshot()) {
+            names.insert(device.name);
+        }
+        return names;
+    }
+};
+
+static pid_t SpawnDaemon(const char* self, const std::string& name, int devices) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::string count = std::to_string(devices);
+        execl(self, self, "--daemon", name.c_str(), count.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    return pid;
+}
+
+static bool WaitForDaemon(const std::string& name, uint64_t previousInstance) {
+    const int64_t end = NowMicros() + 3000000;
+    while (NowMicros() < end) {
+        SharedEventRing ring;
+        if (!ring.Open(name) && ring.Alive(NowMicros()) && ring.Instance() != previousInstance) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+static uint64_t CurrentInstance(const std::string& name) {
+    SharedEventRing ring;
+    return ring.Open(name) ? 0 : ring.Instance();
+}
+
+static bool StartClient(ClientProbe& client, const std::string& name) {
+    client.pipeline.reset(new InputPipeline());
+    client.pipeline->SetEventTap(ClientProbe::Tap, &client);
+    client.backend = CreateServiceBackend(*client.pipeline, name);
+    if (const char* error = client.backend->Start()) {
+        fprintf(stderr, "Client failed to start: %s\n", error);
+        return false;
+    }
+    client.consumer = std::thread([&client]() {
+        MouseEvent event;
+        while (client.draining.load()) {
+            client.pipeline->BeginDrain();
+            while (client.pipeline->Queue().Pop(event)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+    return true;
+}
+
+static void StopClient(ClientProbe& client) {
+    client.backend->Stop();
+    client.draining.store(false);
+    client.consumer.join();
+}
+
+// Waits until every client has read `count` more moves than in `since`.
+static bool WaitForMoves(ClientProbe* clients, size_t count, const uint64_t* since, uint64_t moves, int64_t timeoutMicros) {
+    const int64_t end = NowMicros() + timeoutMicros;
+    for (;;) {
+        bool all = true;
+        for (size_t i = 0; i < count; i++) {
+            all = all && clients[i].moves.load() >= since[i] + moves;
+        }
+        if (all) {
+            return true;
+        }
+        if (NowMicros() > end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+static int RunDaemon(const char* name, const char* devices) {
+    signal(SIGTERM, OnSignal);
+    InputDaemonConfig config;
+    config.name = name;
+    config.simulateHz = 2000;
+    config.simulateDevices = atoi(devices);
+    if (const char* error = RunInputDaemon(config, daemonStop)) {
+        fprintf(stderr, "Daemon: %s\n", error);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && strcmp(argv[1], "--daemon") == 0) {
+        return RunDaemon(argv[2], argv[3]);
+    }
+
+    const std::string name = "orionix-test-" + std::to_string(getpid());
+    const char* self = "/proc/self/exe";
+
+    pid_t first = SpawnDaemon(self, name, 2);
+    if (!WaitForDaemon(name, 0)) {
+        fprintf(stderr, "The first daemon never came up\n");
+        kill(first, SIGKILL);
+        return 1;
+    }
+    const uint64_t firstInstance = CurrentInstance(name);
+
+    ClientProbe clients[2];
+    for (ClientProbe& client : clients) {
+        if (!StartClient(client, name)) {
+            kill(first, SIGKILL);
+            return 1;
+        }
+    }
+
+    uint64_t since[2] = { 0, 0 };
+    Check(WaitForMoves(clients, 2, since, 2000, 2000000), "both clients read moves from the first daemon");
+    for (ClientProbe& client : clients) {
+        Check(client.DeviceNames() == std::set<std::string>{ "Simulated Mouse 1", "Simulated Mouse 2" }, "client registered both devices");
+        Check(client.added.load() == 2, "client saw exactly two arrivals");
+    }
+
+    kill(first, SIGKILL);
+    waitpid(first, nullptr, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    for (size_t i = 0; i < 2; i++) {
+        since[i] = clients[i].moves.load();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    Check(clients[0].moves.load() == since[0] && clients[1].moves.load() == since[1], "nothing arrives while no daemon runs");
+
+    // The dead daemon's segment is still named; the next one must replace it.
+    const int64_t restart = NowMicros();
+    pid_t second = SpawnDaemon(self, name, 1);
+    Check(WaitForDaemon(name, firstInstance), "a second daemon replaces the stale segment");
+    const bool resumed = WaitForMoves(clients, 2, since, 1000, 3000000);
+    const int64_t reconnectMicros = NowMicros() - restart;
+    Check(resumed, "both clients resume on the second daemon");
+    for (ClientProbe& client : clients) {
+        Check(client.DeviceNames() == std::set<std::string>{ "Simulated Mouse 1" }, "client dropped the missing device");
+        Check(client.added.load() == 2 && client.removed.load() == 1, "reconnect synthesized one removal and no duplicate arrival");
+        Check(client.torn.load() == 0, "no torn records");
+    }
+
+    for (ClientProbe& client : clients) {
+        StopClient(client);
+    }
+    kill(second, SIGTERM);
+    int status = 0;
+    waitpid(second, &status, 0);
+    Check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "the second daemon stops cleanly on SIGTERM");
+    const int fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+    Check(fd < 0, "a clean stop removes the segment");
+    if (fd >= 0) {
+        close(fd);
+        shm_unlink(("/" + name).c_str());
+    }
+
+    InputStatsSnapshot stats[2];
+    clients[0].pipeline->CollectStats(stats[0]);
+    clients[1].pipeline->CollectStats(stats[1]);
+    printf("{\"moves\": [%llu, %llu], \"serviceLost\": [%llu, %llu], \"reconnectMs\": %.1f}\n",
+        (unsigned long long)clients[0].moves.load(), (unsigned long long)clients[1].moves.load(),
+        (unsigned long long)stats[0].serviceLost, (unsigned long long)stats[1].serviceLost, reconnectMicros / 1000.0);
+    return failures == 0 ? 0 : 1;
+}
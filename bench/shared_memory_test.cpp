@@ -0,0 +1,160 @@
+// In-process test of the named shared-memory segments (src/shared_event_ring.h and
+// src/cursor_state_table.h) on whichever platform builds it: shm_open/mmap and the futex wait on
+// Linux, file mappings and the polled wait on Windows. A daemon-side ring and a client mapping
+// of the same name must agree on events, devices and instance; Wait must honour its timeout and
+// return early on a publish or a Wake; a second Create must show a new instance; the cursor table
+// must read back through a read-only mapping. Exits non-zero on any failure.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../src/cursor_state_table.h"
+#include "../src/shared_event_ring.h"
+#include "check.h"
+
+static int64_t NowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Unique per run so a crashed run or a parallel one never shares a segment.
+static std::string UniqueName(const char* prefix) {
+    std::random_device random;
+    return std::string(prefix) + std::to_string(random()) + "-" + std::to_string(NowMicros() & 0xFFFFFF);
+}
+
+static ServiceEvent MakeServiceEvent(uint64_t handle, int32_t dx) {
+    ServiceEvent event = {};
+    event.event.type = EventType::Move;
+    event.event.deltaX = dx;
+    event.event.deltaY = -dx;
+    event.handle = handle;
+    return event;
+}
+
+// Microseconds until Wait returns while `act` runs on another thread after `delayMicros`.
+template <typename Act>
+static int64_t TimedWait(SharedEventRing& client, int64_t timeoutMicros, int64_t delayMicros, Act act) {
+    std::thread actor([&]() {
+        if (delayMicros >= 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(delayMicros));
+            act();
+        }
+    });
+    const int64_t start = NowMicros();
+    client.Wait(client.Head(), timeoutMicros);
+    const int64_t elapsed = NowMicros() - start;
+    actor.join();
+    return elapsed;
+}
+
+static void TestEventRing() {
+    printf("-- event ring\n");
+    const std::string name = UniqueName("orionix-ring-test-");
+    SharedEventRing client;
+    const char* missing = client.Open(name);
+    Check(missing && strcmp(missing, "Input service not running") == 0, "open before create fails");
+
+    SharedEventRing daemon;
+    Check(daemon.Create(name) == nullptr, "create");
+    daemon.Heartbeat(NowMicros());
+    Check(client.Open(name) == nullptr, "open");
+    Check(client.Instance() != 0 && client.Instance() == daemon.Instance(), "client sees the daemon's instance");
+    Check(client.Alive(NowMicros()), "client sees the heartbeat");
+
+    for (int i = 0; i < 1000; i++) {
+        daemon.Publish(MakeServiceEvent(7 + i % 3, i));
+    }
+    daemon.Notify();
+    bool ordered = client.Head() == 1000;
+    for (uint64_t position = 0; ordered && position < 1000; position++) {
+        ServiceEvent event;
+        ordered = client.Read(position, &event) && event.event.deltaX == (int32_t)position &&
+                  event.event.deltaY == -(int32_t)position && event.handle == 7 + position % 3;
+    }
+    Check(ordered, "published events read back in order");
+
+    ServiceDevice device = {};
+    device.handle = 42;
+    device.active = 1;
+    snprintf(device.name, sizeof(device.name), "Test Mouse");
+    Check(daemon.WriteDevice(device), "write device");
+    ServiceDevice found;
+    Check(client.FindDevice(42, &found) && strcmp(found.name, "Test Mouse") == 0, "client finds the device");
+    ServiceDevice all[kServiceDeviceSlots];
+    Check(client.Devices(all, kServiceDeviceSlots) == 1, "one active device");
+
+    int64_t elapsed = TimedWait(client, 30000, -1, []() {});
+    printf("     idle wait of 30 ms took %lld us\n", (long long)elapsed);
+    Check(elapsed >= 29000 && elapsed < 250000, "idle wait lasts its timeout");
+
+    elapsed = TimedWait(client, 2000000, 20000, [&]() {
+        daemon.Publish(MakeServiceEvent(7, 1));
+        daemon.Notify();
+    });
+    Check(elapsed < 1000000, "wait returns on a publish");
+
+    elapsed = TimedWait(client, 2000000, 20000, [&]() { daemon.Wake(); });
+    Check(elapsed < 1000000, "wait returns on a wake");
+
+    // Linux replaces the segment, Windows resets it in place under the attached client; a new
+    // mapping sees the new instance either way.
+    const uint64_t first = daemon.Instance();
+    SharedEventRing restarted;
+    Check(restarted.Create(name) == nullptr, "second create with a client attached");
+    SharedEventRing reopened;
+    Check(reopened.Open(name) == nullptr && reopened.Instance() == restarted.Instance() && reopened.Instance() != first &&
+              reopened.Head() == 0, "reopening sees the new instance, empty");
+
+    client.Close();
+    reopened.Close();
+    daemon.Close();
+    restarted.Close();
+    Check(client.Open(name) != nullptr, "gone once every mapping is closed");
+}
+
+static void TestCursorTable() {
+    printf("-- cursor table\n");
+    const std::string name = UniqueName("orionix-table-test-");
+    CursorStateTable reader;
+    const char* missing = reader.Open(name);
+    Check(missing && strcmp(missing, "Cursor table not found") == 0, "open before create fails");
+
+    CursorStateTable writer;
+    Check(writer.Create(name) == nullptr, "create");
+    Check(reader.Open(name) == nullptr, "open read-only");
+
+    CursorSlotState state = {};
+    state.x = 12.5;
+    state.y = -3.25;
+    state.flags = kCursorSlotActive | kCursorSlotVisible;
+    state.color = 0x3366FF;
+    snprintf(state.id, sizeof(state.id), "mouse-1");
+    snprintf(state.type, sizeof(state.type), "pointer");
+    const uint32_t before = reader.Version();
+    Check(writer.Write(state), "write slot");
+    Check(reader.Version() != before, "version moves on a write");
+
+    CursorSlotState slots[kCursorTableSlots];
+    size_t count = reader.Snapshot(slots, kCursorTableSlots);
+    Check(count == 1 && slots[0].x == 12.5 && slots[0].y == -3.25 && slots[0].color == 0x3366FF &&
+              strcmp(slots[0].id, "mouse-1") == 0 && strcmp(slots[0].type, "pointer") == 0, "reader sees the slot");
+
+    Check(writer.Remove("mouse-1") && reader.Snapshot(slots, kCursorTableSlots) == 0, "removed slot disappears");
+
+    reader.Close();
+    writer.Close();
+    Check(reader.Open(name) != nullptr, "gone once every mapping is closed");
+}
+
+int main() {
+    TestEventRing();
+    TestCursorTable();
+
+    printf("%s\n", failures == 0 ? "all shared memory checks passed" : "shared memory checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// Loads the addon in two worker_threads at once (Linux). Each worker gets its own addon instance,
+// starts the evdev backend on an empty stand-in input directory, injects moves from its own device
+// handles and checks that it sees exactly its own events, with its own sequence numbers starting
+// at 1. Prints a JSON report and exits non-zero if either instance saw the other's input.
+//
+//   node bench/worker_instances.js [--moves N] [--devices N] [--module path/to/Orionix_raw_input.node]
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+
+const BATCH_RECORD_INT32S = 10;
+
+function runInstance({ modulePath, index, moves, devices }) {
+  const rawInput = require(modulePath);
+  const handles = Array.from({ length: devices }, (_, i) => (index + 1) * 1000 + i);
+  const report = { index, delivered: 0, foreign: 0, outOfOrder: 0, firstSeq: 0, lastSeq: 0 };
+  const slots = new Map();
+
+  rawInput.setCallbacks(
+    () => {},
+    () => {}
+  );
+  const ints = new Int32Array(
+    rawInput.enableBatchMode((count) => {
+      for (let i = 0; i < count; i++) {
+        const base = i * BATCH_RECORD_INT32S;
+        if ((ints[base + 1] & 0xff) !== 0) continue;
+
+        const deviceId = ints[base];
+        if (!slots.has(deviceId)) slots.set(deviceId, rawInput.getDeviceSlot(deviceId).handle);
+        const seq = ints[base + 7] >>> 0;
+        report.foreign += handles.includes(slots.get(deviceId)) ? 0 : 1;
+        report.outOfOrder += seq > report.lastSeq ? 0 : 1;
+        report.firstSeq = report.firstSeq || seq;
+        report.lastSeq = seq;
+        report.delivered++;
+      }
+      if (report.delivered >= moves) finish();
+    }, 256)
+  );
+
+  let finished = false;
+  function finish() {
+    if (finished) return;
+    finished = true;
+    rawInput.stopRawInput();
+    report.queue = rawInput.getQueueStats();
+    parentPort.postMessage(report);
+  }
+
+  // Injected moves travel through the backend's non-blocking command pipe; keep the backlog small.
+  let injected = 0;
+  function pump() {
+    while (injected < moves && injected - report.delivered < 512) {
+      rawInput.simulateMouseMove(1, -1, handles[injected % devices]);
+      injected++;
+    }
+    if (injected < moves && !finished) setImmediate(pump);
+  }
+
+  rawInput.startRawInput();
+  pump();
+  setTimeout(finish, 10000);
+}
+
+function parseArgs(argv) {
+  const config = {
+    moves: 20000,
+    devices: 4,
+    modulePath: path.join(__dirname, '..', 'build', 'Release', 'Orionix_raw_input.node'),
+  };
+  for (let i = 0; i < argv.length; i += 2) {
+    if (argv[i] === '--moves') config.moves = Number(argv[i + 1]);
+    else if (argv[i] === '--devices') config.devices = Number(argv[i + 1]);
+    else if (argv[i] === '--module') config.modulePath = path.resolve(argv[i + 1]);
+    else throw new Error(`Unknown option: ${argv[i]}`);
+  }
+  return config;
+}
+
+async function main() {
+  const config = parseArgs(process.argv.slice(2));
+  const inputDir = fs.mkdtempSync(path.join(os.tmpdir(), 'orionix-workers-'));
+  process.env.ORIONIX_INPUT_DIR = inputDir;
+
+  const started = Date.now();
+  const reports = await Promise.all(
+    [0, 1].map(
+      (index) =>
+        new Promise((resolve, reject) => {
+          const worker = new Worker(__filename, { workerData: { ...config, index } });
+          worker.once('message', resolve);
+          worker.once('error', reject);
+        })
+    )
+  );
+  fs.rmSync(inputDir, { recursive: true, force: true });
+
+  const ok = reports.every((r) => r.delivered === config.moves && r.foreign === 0 && r.outOfOrder === 0 && r.firstSeq === 1);
+  console.log(JSON.stringify({ config, wallMs: Date.now() - started, ok, instances: reports }, null, 2));
+  process.exit(ok ? 0 : 1);
+}
+
+if (isMainThread) {
+  main().catch((error) => {
+    console.error(error);
+    process.exit(1);
+  });
+} else {
+  runInstance(workerData);
+}
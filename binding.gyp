@@ -1,24 +1,112 @@
 {
+  "variables": {
+    "orionix_debug_log%": 0
+  },
   "targets": [
     {
       "target_name": "Orionix_raw_input",
       "sources": [
-        "src/Orionix_addon.cpp"
+        "src/orionix_addon.cpp",
+        "src/input_pipeline.cpp",
+        "src/input_stats.cpp",
+        "src/frame_scheduler.cpp",
+        "src/input_trace.cpp",
+        "src/device_registry.cpp",
+        "src/motion_engine.cpp",
+        "src/motion_filter.cpp",
+        "src/event_subscriptions.cpp",
+        "src/monitor_layout.cpp",
+        "src/cursor_lock.cpp",
+        "src/cursor_image.cpp",
+        "src/cursor_cache.cpp",
+        "src/cursor_raster.cpp",
+        "src/cursor_bitmaps.cpp",
+        "src/cursor_compositor.cpp",
+        "src/cursor_state_table.cpp",
+        "src/shared_event_ring.cpp",
+        "src/input_service.cpp"
       ],
       "include_dirs": [
         "<!(node -e \"require('nan')\")"
       ],
-      "libraries": [
-        "-luser32.lib"
+      "conditions": [
+        ["orionix_debug_log==1", {
+          "defines": [
+            "ORIONIX_DEBUG_LOG"
+          ]
+        }],
+        ["OS=='win'", {
+          "sources": [
+            "src/raw_input_backend_win.cpp",
+            "src/cursor_shape_win.cpp"
+          ],
+          "libraries": [
+            "-luser32.lib"
+          ],
+          "defines": [
+            "WIN32_LEAN_AND_MEAN",
+            "NOMINMAX"
+          ]
+        }],
+        ["OS=='linux'", {
+          "sources": [
+            "src/evdev_backend_linux.cpp",
+            "src/cursor_shape_x11.cpp"
+          ],
+          "libraries": [
+            "-lX11",
+            "-lXfixes",
+            "-lrt"
+          ]
+        }]
+      ]
+    },
+    {
+      "target_name": "orionix_input_daemon",
+      "type": "executable",
+      "sources": [
+        "src/input_daemon.cpp",
+        "src/input_service.cpp",
+        "src/shared_event_ring.cpp",
+        "src/input_pipeline.cpp",
+        "src/input_stats.cpp",
+        "src/frame_scheduler.cpp",
+        "src/input_trace.cpp",
+        "src/device_registry.cpp",
+        "src/motion_engine.cpp",
+        "src/motion_filter.cpp",
+        "src/event_subscriptions.cpp",
+        "src/monitor_layout.cpp",
+        "src/cursor_lock.cpp"
       ],
       "conditions": [
+        ["orionix_debug_log==1", {
+          "defines": [
+            "ORIONIX_DEBUG_LOG"
+          ]
+        }],
         ["OS=='win'", {
+          "sources": [
+            "src/raw_input_backend_win.cpp"
+          ],
+          "libraries": [
+            "-luser32.lib"
+          ],
           "defines": [
             "WIN32_LEAN_AND_MEAN",
             "NOMINMAX"
           ]
+        }],
+        ["OS=='linux'", {
+          "sources": [
+            "src/evdev_backend_linux.cpp"
+          ],
+          "libraries": [
+            "-lrt",
+            "-lpthread"
+          ]
         }]
       ]
     }
   ]
-}
\ No newline at end of file
+}
@@ -0,0 +1,55 @@
+#include "cursor_bitmaps.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cursor_raster.h"
+
+std::shared_ptr<const CursorBitmap> BakeCursorBitmap(const CachedCursorFrame& frame, const uint8_t* framePixels,
+                                                     int size, uint32_t rgb, uint8_t opacity) {
+    size = std::min(std::max(size, 1), kMaxCursorBitmapSize);
+    double scale = (double)size / std::max(frame.width, frame.height);
+
+    std::shared_ptr<CursorBitmap> bitmap = std::make_shared<CursorBitmap>();
+    bitmap->width = (uint16_t)std::max(1L, std::lround(frame.width * scale));
+    bitmap->height = (uint16_t)std::max(1L, std::lround(frame.height * scale));
+    bitmap->hotspotX = (uint16_t)std::min<long>(std::lround(frame.hotspotX * scale), bitmap->width - 1);
+    bitmap->hotspotY = (uint16_t)std::min<long>(std::lround(frame.hotspotY * scale), bitmap->height - 1);
+    bitmap->pixels.resize((size_t)bitmap->width * bitmap->height * 4);
+
+    ResampleRgba(framePixels, frame.width, frame.height, bitmap->pixels.data(), bitmap->width, bitmap->height);
+    TintRgba(bitmap->pixels.data(), (size_t)bitmap->width * bitmap->height, rgb, opacity);
+    return bitmap;
+}
+
+std::shared_ptr<const CursorBitmap> CursorBitmapCache::Get(const CursorBitmapKey& key, const CachedCursorFrame& frame,
+                                                           const uint8_t* framePixels, bool* cached) {
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        hits_++;
+        if (cached) *cached = true;
+        return found->second->second;
+    }
+
+    std::shared_ptr<const CursorBitmap> bitmap = BakeCursorBitmap(frame, framePixels, key.size, key.rgb, key.opacity);
+    entries_.emplace_front(key, bitmap);
+    index_[key] = entries_.begin();
+    bytes_ += bitmap->pixels.size();
+    misses_++;
+    if (cached) *cached = false;
+
+    // The newest entry always stays, even when it alone exceeds the capacity.
+    while (bytes_ > capacity_ && entries_.size() > 1) {
+        bytes_ -= entries_.back().second->pixels.size();
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    return bitmap;
+}
+
+void CursorBitmapCache::Clear() {
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
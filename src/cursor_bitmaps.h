@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cursor_cache.h"
+
+const int kMaxCursorBitmapSize = 512;
+const size_t kDefaultCursorBitmapBytes = 16 * 1024 * 1024;
+
+struct CursorBitmap {
+    uint16_t width, height;
+    uint16_t hotspotX, hotspotY;
+    std::vector<uint8_t> pixels;  // premultiplied RGBA
+};
+
+// One baked variant of a decoded cursor frame.
+struct CursorBitmapKey {
+    uint64_t source;  // content hash of the cursor file
+    uint32_t frame;
+    uint32_t rgb;     // tint, 0xFFFFFF for none
+    uint16_t size;    // the frame is scaled to fit a size x size box
+    uint8_t opacity;
+
+    bool operator==(const CursorBitmapKey& other) const {
+        return source == other.source && frame == other.frame && rgb == other.rgb && size == other.size && opacity == other.opacity;
+    }
+};
+
+// Resamples and tints one frame; the hotspot scales with it.
+std::shared_ptr<const CursorBitmap> BakeCursorBitmap(const CachedCursorFrame& frame, const uint8_t* framePixels,
+                                                     int size, uint32_t rgb, uint8_t opacity);
+
+// Baked bitmaps by (cursor, frame, size, tint, opacity), least recently used evicted first once
+// the pixel bytes exceed the capacity. Not thread-safe.
+class CursorBitmapCache {
+public:
+    explicit CursorBitmapCache(size_t capacityBytes = kDefaultCursorBitmapBytes) : capacity_(capacityBytes) {}
+
+    // `cached` reports whether the bitmap was already baked.
+    std::shared_ptr<const CursorBitmap> Get(const CursorBitmapKey& key, const CachedCursorFrame& frame, const uint8_t* framePixels,
+                                            bool* cached = nullptr);
+    void Clear();
+
+    size_t Count() const { return index_.size(); }
+    size_t Bytes() const { return bytes_; }
+    uint64_t Hits() const { return hits_; }
+    uint64_t Misses() const { return misses_; }
+
+private:
+    struct KeyHash {
+        size_t operator()(const CursorBitmapKey& key) const {
+            uint64_t h = key.source ^ ((uint64_t)key.frame << 48) ^ ((uint64_t)key.rgb << 16) ^ ((uint64_t)key.size << 40) ^ key.opacity;
+            return (size_t)(h * 0x9E3779B97F4A7C15ull >> 16);
+        }
+    };
+    typedef std::list<std::pair<CursorBitmapKey, std::shared_ptr<const CursorBitmap>>> Entries;
+
+    size_t capacity_;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    Entries entries_;  // most recently used first
+    std::unordered_map<CursorBitmapKey, Entries::iterator, KeyHash> index_;
+};
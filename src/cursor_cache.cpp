@@ -0,0 +1,238 @@
+#include "cursor_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const char kCacheMagic[6] = { 'O', 'R', 'X', 'C', 'U', 'R' };
+static const size_t kCacheHeaderSize = 16;
+
+static_assert(sizeof(CursorCacheEntry) == 24, "cache entry layout");
+static_assert(sizeof(CachedCursorFrame) == 12, "cache frame layout");
+static_assert(sizeof(CursorStep) == 8, "cache step layout");
+
+static uint32_t ReadU32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static size_t AlignBlob(size_t offset) {
+    return (offset + 7) & ~(size_t)7;
+}
+
+// Validates a blob before anything reads through the view.
+static bool ViewBlob(const uint8_t* blob, size_t size, CursorView* view) {
+    if (size < 8) {
+        return false;
+    }
+    uint32_t frameCount = ReadU32(blob);
+    uint32_t stepCount = ReadU32(blob + 4);
+    if (frameCount == 0 || frameCount > kMaxCursorFrames || stepCount > kMaxCursorSteps) {
+        return false;
+    }
+    size_t header = 8 + frameCount * sizeof(CachedCursorFrame) + stepCount * sizeof(CursorStep);
+    if (header > size) {
+        return false;
+    }
+
+    const CachedCursorFrame* frames = (const CachedCursorFrame*)(blob + 8);
+    const CursorStep* steps = (const CursorStep*)(blob + 8 + frameCount * sizeof(CachedCursorFrame));
+    size_t pixelBytes = size - header;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        const CachedCursorFrame& frame = frames[i];
+        if (frame.width == 0 || frame.width > kMaxCursorDimension || frame.height == 0 || frame.height > kMaxCursorDimension ||
+            frame.hotspotX >= frame.width || frame.hotspotY >= frame.height ||
+            frame.pixelOffset > pixelBytes || (size_t)frame.width * frame.height * 4 > pixelBytes - frame.pixelOffset) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < stepCount; i++) {
+        if (steps[i].frame >= frameCount) {
+            return false;
+        }
+    }
+
+    view->frameCount = frameCount;
+    view->stepCount = stepCount;
+    view->frames = frames;
+    view->steps = steps;
+    view->pixels = blob + header;
+    return true;
+}
+
+static std::vector<uint8_t> EncodeBlob(const CursorImage& image) {
+    uint32_t frameCount = (uint32_t)image.frames.size();
+    uint32_t stepCount = (uint32_t)image.steps.size();
+    size_t header = 8 + frameCount * sizeof(CachedCursorFrame) + stepCount * sizeof(CursorStep);
+    size_t pixelBytes = 0;
+    for (const CursorFrame& frame : image.frames) {
+        pixelBytes += frame.pixels.size();
+    }
+
+    std::vector<uint8_t> blob(header + pixelBytes);
+    memcpy(&blob[0], &frameCount, 4);
+    memcpy(&blob[4], &stepCount, 4);
+    CachedCursorFrame* frames = (CachedCursorFrame*)&blob[8];
+    uint32_t pixelOffset = 0;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        const CursorFrame& frame = image.frames[i];
+        frames[i] = { frame.width, frame.height, frame.hotspotX, frame.hotspotY, pixelOffset };
+        memcpy(&blob[header + pixelOffset], frame.pixels.data(), frame.pixels.size());
+        pixelOffset += (uint32_t)frame.pixels.size();
+    }
+    if (stepCount > 0) {
+        memcpy(&blob[8 + frameCount * sizeof(CachedCursorFrame)], image.steps.data(), stepCount * sizeof(CursorStep));
+    }
+    return blob;
+}
+
+void CursorCache::Open(const std::string& path) {
+    path_ = path;
+    mapped_.reset();
+    entries_ = nullptr;
+    entryCount_ = 0;
+    used_.clear();
+    pending_.clear();
+
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (!file->Open(path) || file->size < kCacheHeaderSize || memcmp(file->view, kCacheMagic, sizeof(kCacheMagic)) != 0) {
+        return;
+    }
+    uint16_t version = (uint16_t)(file->view[6] | (file->view[7] << 8));
+    uint32_t count = ReadU32(file->view + 8);
+    size_t tableEnd = kCacheHeaderSize + (size_t)count * sizeof(CursorCacheEntry);
+    if (version != kCursorCacheVersion || count > kMaxCursorCacheEntries || tableEnd > file->size) {
+        return;
+    }
+
+    // Entry bounds are checked here, blob contents on first lookup.
+    const CursorCacheEntry* entries = (const CursorCacheEntry*)(file->view + kCacheHeaderSize);
+    for (uint32_t i = 0; i < count; i++) {
+        const CursorCacheEntry& entry = entries[i];
+        if (entry.offset < tableEnd || entry.offset % 8 != 0 || entry.offset > file->size || entry.size > file->size - entry.offset ||
+            (i > 0 && entries[i - 1].hash >= entry.hash)) {
+            return;
+        }
+    }
+
+    mapped_ = std::move(file);
+    entries_ = entries;
+    entryCount_ = count;
+    used_.assign(count, false);
+}
+
+bool CursorCache::FindMapped(uint64_t hash, CursorView* view) {
+    const CursorCacheEntry* end = entries_ + entryCount_;
+    const CursorCacheEntry* entry = std::lower_bound(entries_, end, hash,
+        [](const CursorCacheEntry& e, uint64_t h) { return e.hash < h; });
+    if (entry == end || entry->hash != hash || !ViewBlob(mapped_->view + entry->offset, entry->size, view)) {
+        return false;
+    }
+    used_[entry - entries_] = true;
+    return true;
+}
+
+const char* CursorCache::Load(const std::string& filePath, CursorView* view, bool* cached) {
+    MappedFile file;
+    if (!file.Open(filePath)) {
+        return "Failed to read cursor file";
+    }
+    uint64_t hash = HashCursorFile(file.view, file.size);
+    view->hash = hash;
+
+    *cached = true;
+    auto pending = pending_.find(hash);
+    if (pending != pending_.end()) {
+        ViewBlob(pending->second.data(), pending->second.size(), view);
+        return nullptr;
+    }
+    if (entryCount_ > 0 && FindMapped(hash, view)) {
+        return nullptr;
+    }
+
+    CursorImage image;
+    const char* error = DecodeCursorImage(file.view, file.size, &image);
+    if (error) {
+        return error;
+    }
+    std::vector<uint8_t>& blob = pending_[hash] = EncodeBlob(image);
+    ViewBlob(blob.data(), blob.size(), view);
+    *cached = false;
+    return nullptr;
+}
+
+const char* CursorCache::Save() {
+    if (pending_.empty()) {
+        return nullptr;
+    }
+
+    struct Item {
+        uint64_t hash;
+        const uint8_t* data;
+        size_t size;
+    };
+    std::vector<Item> items;
+    for (const auto& pending : pending_) {
+        items.push_back({ pending.first, pending.second.data(), pending.second.size() });
+    }
+    // Cursors used since Open outrank the rest when the cache is full.
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < entryCount_ && items.size() < kMaxCursorCacheEntries; i++) {
+            const CursorCacheEntry& entry = entries_[i];
+            if (used_[i] == (pass == 0) && !pending_.count(entry.hash)) {
+                items.push_back({ entry.hash, mapped_->view + entry.offset, (size_t)entry.size });
+            }
+        }
+    }
+    if (items.size() > kMaxCursorCacheEntries) {
+        items.resize(kMaxCursorCacheEntries);
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.hash < b.hash; });
+
+    std::string tempPath = path_ + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return "Failed to create cursor cache file";
+    }
+
+    uint8_t header[kCacheHeaderSize] = {};
+    uint32_t count = (uint32_t)items.size();
+    memcpy(header, kCacheMagic, sizeof(kCacheMagic));
+    header[6] = (uint8_t)(kCursorCacheVersion & 0xFF);
+    header[7] = (uint8_t)(kCursorCacheVersion >> 8);
+    memcpy(header + 8, &count, 4);
+
+    std::vector<CursorCacheEntry> table(items.size());
+    size_t offset = kCacheHeaderSize + table.size() * sizeof(CursorCacheEntry);
+    for (size_t i = 0; i < items.size(); i++) {
+        table[i] = { items[i].hash, (uint64_t)offset, (uint32_t)items[i].size, 0 };
+        offset = AlignBlob(offset + items[i].size);
+    }
+
+    static const uint8_t padding[8] = {};
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+              (table.empty() || fwrite(table.data(), sizeof(CursorCacheEntry), table.size(), file) == table.size());
+    for (size_t i = 0; ok && i < items.size(); i++) {
+        size_t pad = AlignBlob(items[i].size) - items[i].size;
+        ok = fwrite(items[i].data, 1, items[i].size, file) == items[i].size && fwrite(padding, 1, pad, file) == pad;
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        remove(tempPath.c_str());
+        return "Failed to write cursor cache file";
+    }
+
+    // Windows cannot replace a mapped file.
+    mapped_.reset();
+#ifdef _WIN32
+    ok = MoveFileExA(tempPath.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = rename(tempPath.c_str(), path_.c_str()) == 0;
+#endif
+    if (!ok) {
+        remove(tempPath.c_str());
+    }
+    Open(path_);
+    return ok ? nullptr : "Failed to replace cursor cache file";
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cursor_image.h"
+#include "mapped_file.h"
+
+// Cache file: "ORXCUR" + uint16 version + uint32 entryCount + uint32 reserved, then entryCount
+// CursorCacheEntry sorted by content hash, then one 8-byte aligned blob per entry:
+//   uint32 frameCount, uint32 stepCount, CachedCursorFrame[frameCount], CursorStep[stepCount],
+//   premultiplied RGBA pixels.
+// Fields are little-endian and read in place from the mapping. Bump the version whenever the
+// layout or the decoder output changes; a file with another version is ignored and rewritten.
+const uint16_t kCursorCacheVersion = 1;
+const size_t kMaxCursorCacheEntries = 1024;
+
+struct CursorCacheEntry {
+    uint64_t hash;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+struct CachedCursorFrame {
+    uint16_t width, height;
+    uint16_t hotspotX, hotspotY;
+    uint32_t pixelOffset;  // into the blob's pixel area
+};
+
+// Points into the mapping (or a pending blob); valid until the next Open or Save.
+struct CursorView {
+    uint64_t hash = 0;  // content hash of the cursor file
+    uint32_t frameCount = 0;
+    uint32_t stepCount = 0;
+    const CachedCursorFrame* frames = nullptr;
+    const CursorStep* steps = nullptr;
+    const uint8_t* pixels = nullptr;
+};
+
+// Decoded cursors keyed by file content, so a startup or theme switch maps one file and does an
+// index lookup per cursor instead of decoding. Not thread-safe.
+class CursorCache {
+public:
+    // Maps the cache at `path`. A missing, stale or damaged file just leaves the cache empty.
+    void Open(const std::string& path);
+    const std::string& Path() const { return path_; }
+
+    // Reads and hashes the cursor file, then serves it from the cache or decodes it.
+    const char* Load(const std::string& filePath, CursorView* view, bool* cached);
+
+    // Rewrites the cache file when something was decoded since Open; a no-op otherwise.
+    const char* Save();
+
+private:
+    bool FindMapped(uint64_t hash, CursorView* view);
+
+    std::string path_;
+    std::unique_ptr<MappedFile> mapped_;
+    const CursorCacheEntry* entries_ = nullptr;
+    uint32_t entryCount_ = 0;
+    std::vector<bool> used_;
+    std::map<uint64_t, std::vector<uint8_t>> pending_;
+};
@@ -0,0 +1,179 @@
+#include "cursor_compositor.h"
+
+#include <algorithm>
+#include <cstring>
+
+static CompositorRect Intersect(const CompositorRect& a, const CompositorRect& b) {
+    int32_t left = std::max(a.x, b.x);
+    int32_t top = std::max(a.y, b.y);
+    int32_t right = std::min(a.x + a.width, b.x + b.width);
+    int32_t bottom = std::min(a.y + a.height, b.y + b.height);
+    return { left, top, right - left, bottom - top };
+}
+
+static CompositorRect Union(const CompositorRect& a, const CompositorRect& b) {
+    int32_t left = std::min(a.x, b.x);
+    int32_t top = std::min(a.y, b.y);
+    int32_t right = std::max(a.x + a.width, b.x + b.width);
+    int32_t bottom = std::max(a.y + a.height, b.y + b.height);
+    return { left, top, right - left, bottom - top };
+}
+
+static int64_t Area(const CompositorRect& rect) {
+    return (int64_t)rect.width * rect.height;
+}
+
+// Rounded v / 255 for v <= 255 * 255.
+static uint32_t Div255(uint32_t value) {
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+// Merges rects that overlap or abut (their union costs no more than drawing both), so a cursor
+// moved by a few pixels repaints one rect instead of two overlapping ones.
+static void MergeDamage(std::vector<CompositorRect>& rects) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; i++) {
+            for (size_t j = i + 1; j < rects.size(); j++) {
+                CompositorRect both = Union(rects[i], rects[j]);
+                if (!Intersect(rects[i], rects[j]).Empty() || Area(both) <= Area(rects[i]) + Area(rects[j])) {
+                    rects[i] = both;
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (rects.size() > kMaxDamageRects) {
+        CompositorRect bounds = rects[0];
+        for (const CompositorRect& rect : rects) bounds = Union(bounds, rect);
+        rects.assign(1, bounds);
+    }
+}
+
+void CursorCompositor::SetSurfaces(const std::vector<CompositorRect>& bounds) {
+    surfaces_.clear();
+    surfaces_.resize(bounds.size());
+    for (size_t i = 0; i < bounds.size(); i++) {
+        Surface& surface = surfaces_[i];
+        surface.bounds = bounds[i];
+        surface.bounds.width = std::max(0, surface.bounds.width);
+        surface.bounds.height = std::max(0, surface.bounds.height);
+        surface.pixels.assign((size_t)surface.bounds.width * surface.bounds.height * 4, 0);
+        // The first Compose hands out the whole surface so a new consumer starts in sync.
+        Invalidate(i);
+    }
+}
+
+void CursorCompositor::SetSprite(uint32_t id, std::shared_ptr<const CursorBitmap> bitmap, int32_t x, int32_t y) {
+    CompositorRect bounds = { x - bitmap->hotspotX, y - bitmap->hotspotY, bitmap->width, bitmap->height };
+    auto found = sprites_.find(id);
+    if (found != sprites_.end()) {
+        Sprite& sprite = found->second;
+        if (sprite.bitmap == bitmap && memcmp(&sprite.bounds, &bounds, sizeof(bounds)) == 0) {
+            return;
+        }
+        Damage(sprite.bounds);
+        sprite.bitmap = std::move(bitmap);
+        sprite.bounds = bounds;
+    } else {
+        sprites_[id] = { std::move(bitmap), bounds };
+    }
+    Damage(bounds);
+}
+
+void CursorCompositor::RemoveSprite(uint32_t id) {
+    auto found = sprites_.find(id);
+    if (found != sprites_.end()) {
+        Damage(found->second.bounds);
+        sprites_.erase(found);
+    }
+}
+
+void CursorCompositor::ClearSprites() {
+    for (const auto& sprite : sprites_) {
+        Damage(sprite.second.bounds);
+    }
+    sprites_.clear();
+}
+
+void CursorCompositor::Damage(const CompositorRect& bounds) {
+    for (Surface& surface : surfaces_) {
+        CompositorRect clipped = Intersect(bounds, surface.bounds);
+        if (!clipped.Empty()) {
+            surface.damage.push_back({ clipped.x - surface.bounds.x, clipped.y - surface.bounds.y, clipped.width, clipped.height });
+        }
+    }
+}
+
+void CursorCompositor::Invalidate(size_t index) {
+    Surface& surface = surfaces_[index];
+    if (!surface.bounds.Empty()) {
+        surface.damage.assign(1, { 0, 0, surface.bounds.width, surface.bounds.height });
+    }
+}
+
+const std::vector<CompositorRect>& CursorCompositor::Compose(size_t index) {
+    Surface& surface = surfaces_[index];
+    MergeDamage(surface.damage);
+    for (const CompositorRect& rect : surface.damage) {
+        Repaint(surface, rect);
+    }
+    surface.composed.swap(surface.damage);
+    surface.damage.clear();
+    return surface.composed;
+}
+
+void CursorCompositor::Repaint(Surface& surface, const CompositorRect& rect) {
+    size_t stride = (size_t)surface.bounds.width * 4;
+    uint8_t* origin = surface.pixels.data() + rect.y * stride + (size_t)rect.x * 4;
+    for (int32_t row = 0; row < rect.height; row++) {
+        memset(origin + row * stride, 0, (size_t)rect.width * 4);
+    }
+
+    for (const auto& entry : sprites_) {
+        const Sprite& sprite = entry.second;
+        CompositorRect local = { sprite.bounds.x - surface.bounds.x, sprite.bounds.y - surface.bounds.y, sprite.bounds.width, sprite.bounds.height };
+        CompositorRect clip = Intersect(local, rect);
+        if (clip.Empty()) {
+            continue;
+        }
+
+        // Premultiplied source-over.
+        const uint8_t* src = sprite.bitmap->pixels.data();
+        size_t srcStride = (size_t)sprite.bitmap->width * 4;
+        for (int32_t y = clip.y; y < clip.y + clip.height; y++) {
+            const uint8_t* s = src + (y - local.y) * srcStride + (size_t)(clip.x - local.x) * 4;
+            uint8_t* d = surface.pixels.data() + y * stride + (size_t)clip.x * 4;
+            for (int32_t x = 0; x < clip.width; x++, s += 4, d += 4) {
+                uint32_t alpha = s[3];
+                if (alpha == 255) {
+                    memcpy(d, s, 4);
+                } else if (alpha != 0) {
+                    for (int c = 0; c < 4; c++) d[c] = (uint8_t)(s[c] + Div255(d[c] * (255 - alpha)));
+                }
+            }
+        }
+    }
+}
+
+void CursorCompositor::CopyRect(size_t index, const CompositorRect& rect, uint8_t* out, bool straightAlpha) const {
+    const Surface& surface = surfaces_[index];
+    size_t stride = (size_t)surface.bounds.width * 4;
+    for (int32_t y = 0; y < rect.height; y++) {
+        const uint8_t* src = surface.pixels.data() + (rect.y + y) * stride + (size_t)rect.x * 4;
+        uint8_t* dst = out + (size_t)y * rect.width * 4;
+        if (!straightAlpha) {
+            memcpy(dst, src, (size_t)rect.width * 4);
+            continue;
+        }
+        for (int32_t x = 0; x < rect.width; x++, src += 4, dst += 4) {
+            uint32_t alpha = src[3];
+            for (int c = 0; c < 3; c++) dst[c] = alpha ? (uint8_t)std::min<uint32_t>(255, (src[c] * 255 + alpha / 2) / alpha) : 0;
+            dst[3] = (uint8_t)alpha;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "cursor_bitmaps.h"
+
+struct CompositorRect {
+    int32_t x, y, width, height;
+
+    bool Empty() const { return width <= 0 || height <= 0; }
+};
+
+// Above this many damage rects a surface repaints their bounding box instead.
+const size_t kMaxDamageRects = 16;
+
+// Draws every cursor sprite into one premultiplied RGBA surface per display, in software and
+// without a window, so it runs the same headless. Moving a sprite damages its old and new
+// bounds; Compose clears and redraws only the damaged regions of a surface, from every sprite
+// that overlaps them in id order, so the result is pixel-identical to a full redraw.
+// Not thread-safe.
+class CursorCompositor {
+public:
+    // Surface bounds in desktop coordinates. Resets the surfaces; sprites are kept and redrawn.
+    void SetSurfaces(const std::vector<CompositorRect>& bounds);
+    size_t SurfaceCount() const { return surfaces_.size(); }
+    const CompositorRect& SurfaceBounds(size_t surface) const { return surfaces_[surface].bounds; }
+    const uint8_t* SurfacePixels(size_t surface) const { return surfaces_[surface].pixels.data(); }
+
+    // Places the sprite's hotspot at (x, y); an unchanged bitmap and position damages nothing.
+    void SetSprite(uint32_t id, std::shared_ptr<const CursorBitmap> bitmap, int32_t x, int32_t y);
+    void RemoveSprite(uint32_t id);
+    void ClearSprites();
+    size_t SpriteCount() const { return sprites_.size(); }
+
+    // Damages the whole surface, e.g. when its consumer lost the previous frames.
+    void Invalidate(size_t surface);
+
+    // Repaints the surface's damage and returns the repainted rects in surface coordinates;
+    // empty when nothing changed since the last Compose of that surface.
+    const std::vector<CompositorRect>& Compose(size_t surface);
+
+    // Copies a surface-local rect out tightly packed, optionally un-premultiplied for canvas APIs.
+    void CopyRect(size_t surface, const CompositorRect& rect, uint8_t* out, bool straightAlpha) const;
+
+private:
+    struct Sprite {
+        std::shared_ptr<const CursorBitmap> bitmap;
+        CompositorRect bounds;  // desktop coordinates
+    };
+
+    struct Surface {
+        CompositorRect bounds;
+        std::vector<uint8_t> pixels;
+        std::vector<CompositorRect> damage;  // surface coordinates
+        std::vector<CompositorRect> composed;
+    };
+
+    void Damage(const CompositorRect& bounds);
+    void Repaint(Surface& surface, const CompositorRect& rect);
+
+    std::vector<Surface> surfaces_;
+    std::map<uint32_t, Sprite> sprites_;
+};
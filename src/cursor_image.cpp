@@ -0,0 +1,323 @@
+#include "cursor_image.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+static const size_t kMaxCursorPixelBytes = 16 * 1024 * 1024;
+static const uint32_t kDefaultAniJiffies = 6;
+static const uint32_t kMaxAniJiffies = 60 * 60;
+
+static uint16_t ReadU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int32_t ReadI32(const uint8_t* p) {
+    return (int32_t)ReadU32(p);
+}
+
+static uint8_t Premultiply(uint8_t channel, uint8_t alpha) {
+    return (uint8_t)((channel * alpha + 127) / 255);
+}
+
+// Icon bitmaps are a BITMAPINFOHEADER, a palette, the bottom-up colour (XOR) rows, then the
+// bottom-up 1-bpp AND mask; the header height covers both.
+static const char* DecodeBitmap(const uint8_t* dib, size_t size, CursorFrame* frame) {
+    if (size < 40) {
+        return "Truncated cursor bitmap";
+    }
+    uint32_t headerSize = ReadU32(dib);
+    int32_t width = ReadI32(dib + 4);
+    int32_t height = ReadI32(dib + 8) / 2;
+    uint16_t bits = ReadU16(dib + 14);
+    uint32_t compression = ReadU32(dib + 16);
+    uint32_t colorsUsed = ReadU32(dib + 32);
+
+    if (headerSize < 40 || headerSize > size) {
+        return "Unsupported cursor bitmap header";
+    }
+    if (width <= 0 || width > kMaxCursorDimension || height <= 0 || height > kMaxCursorDimension) {
+        return "Cursor bitmap dimensions out of range";
+    }
+    if (compression != 0) {
+        return "Compressed cursor bitmaps are not supported";
+    }
+    if (bits != 1 && bits != 4 && bits != 8 && bits != 24 && bits != 32) {
+        return "Unsupported cursor bit depth";
+    }
+
+    size_t colors = bits <= 8 ? (colorsUsed ? colorsUsed : (size_t)1 << bits) : 0;
+    if (colors > 256) {
+        return "Cursor palette too large";
+    }
+    size_t xorStride = ((size_t)width * bits + 31) / 32 * 4;
+    size_t andStride = ((size_t)width + 31) / 32 * 4;
+    size_t xorOffset = headerSize + colors * 4;
+    size_t andOffset = xorOffset + xorStride * height;
+    bool hasMask = andOffset + andStride * height <= size;
+    if (andOffset > size || (!hasMask && bits != 32)) {
+        return "Truncated cursor bitmap";
+    }
+
+    const uint8_t* palette = dib + headerSize;
+    frame->width = (uint16_t)width;
+    frame->height = (uint16_t)height;
+    frame->pixels.assign((size_t)width * height * 4, 0);
+
+    bool anyAlpha = false;
+    for (int32_t y = 0; y < height; y++) {
+        const uint8_t* row = dib + xorOffset + (size_t)(height - 1 - y) * xorStride;
+        uint8_t* out = &frame->pixels[(size_t)y * width * 4];
+        for (int32_t x = 0; x < width; x++, out += 4) {
+            const uint8_t* bgr;
+            uint8_t alpha = 255;
+            if (bits == 32) {
+                bgr = row + x * 4;
+                alpha = bgr[3];
+                anyAlpha |= alpha != 0;
+            } else if (bits == 24) {
+                bgr = row + x * 3;
+            } else {
+                size_t index;
+                if (bits == 8) {
+                    index = row[x];
+                } else if (bits == 4) {
+                    index = (row[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F;
+                } else {
+                    index = (row[x >> 3] >> (7 - (x & 7))) & 0x01;
+                }
+                if (index >= colors) {
+                    return "Cursor palette index out of range";
+                }
+                bgr = palette + index * 4;
+            }
+            out[0] = bgr[2];
+            out[1] = bgr[1];
+            out[2] = bgr[0];
+            out[3] = alpha;
+        }
+    }
+
+    // Pre-Vista 32-bpp cursors leave alpha zero and rely on the mask like the paletted ones.
+    if (bits != 32 || !anyAlpha) {
+        for (int32_t y = 0; y < height; y++) {
+            const uint8_t* mask = hasMask ? dib + andOffset + (size_t)(height - 1 - y) * andStride : nullptr;
+            uint8_t* out = &frame->pixels[(size_t)y * width * 4];
+            for (int32_t x = 0; x < width; x++, out += 4) {
+                out[3] = 255;
+                if (!mask || !((mask[x >> 3] >> (7 - (x & 7))) & 1)) {
+                    continue;
+                }
+                // Masked black is transparent; masked colour inverts the screen, which premultiplied
+                // RGBA cannot express, so it is drawn as opaque black.
+                if (out[0] | out[1] | out[2]) {
+                    out[0] = out[1] = out[2] = 0;
+                } else {
+                    out[3] = 0;
+                }
+            }
+        }
+    }
+
+    uint8_t* pixel = frame->pixels.data();
+    for (size_t i = 0; i < frame->pixels.size(); i += 4) {
+        uint8_t alpha = pixel[i + 3];
+        if (alpha != 255) {
+            pixel[i] = Premultiply(pixel[i], alpha);
+            pixel[i + 1] = Premultiply(pixel[i + 1], alpha);
+            pixel[i + 2] = Premultiply(pixel[i + 2], alpha);
+        }
+    }
+    return nullptr;
+}
+
+// Picks the largest BMP-encoded image; ties go to the deeper bit depth.
+static const char* DecodeIcon(const uint8_t* data, size_t size, CursorFrame* frame) {
+    if (size < 6) {
+        return "Truncated cursor header";
+    }
+    uint16_t type = ReadU16(data + 2);
+    size_t count = ReadU16(data + 4);
+    if (ReadU16(data) != 0 || (type != 1 && type != 2) || count == 0) {
+        return "Not a cursor or icon file";
+    }
+    if (6 + count * 16 > size) {
+        return "Truncated cursor directory";
+    }
+
+    const uint8_t* best = nullptr;
+    int64_t bestArea = 0;
+    uint16_t bestBits = 0;
+    bool sawPng = false;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* entry = data + 6 + i * 16;
+        uint32_t bytes = ReadU32(entry + 8);
+        uint32_t offset = ReadU32(entry + 12);
+        if (offset > size || bytes > size - offset || bytes < 40) {
+            continue;
+        }
+        const uint8_t* image = data + offset;
+        if (memcmp(image, kPngSignature, sizeof(kPngSignature)) == 0) {
+            sawPng = true;
+            continue;
+        }
+        int64_t area = (int64_t)ReadI32(image + 4) * (ReadI32(image + 8) / 2);
+        uint16_t bits = ReadU16(image + 14);
+        if (area > bestArea || (area == bestArea && area > 0 && bits > bestBits)) {
+            best = entry;
+            bestArea = area;
+            bestBits = bits;
+        }
+    }
+    if (!best) {
+        return sawPng ? "PNG-compressed cursor images are not supported" : "No usable image in cursor file";
+    }
+
+    uint32_t offset = ReadU32(best + 12);
+    const char* error = DecodeBitmap(data + offset, ReadU32(best + 8), frame);
+    if (error) {
+        return error;
+    }
+    // Icons have no hotspot; Windows uses their centre when they are loaded as cursors.
+    uint16_t hotspotX = type == 2 ? ReadU16(best + 4) : frame->width / 2;
+    uint16_t hotspotY = type == 2 ? ReadU16(best + 6) : frame->height / 2;
+    frame->hotspotX = std::min<uint16_t>(hotspotX, frame->width - 1);
+    frame->hotspotY = std::min<uint16_t>(hotspotY, frame->height - 1);
+    return nullptr;
+}
+
+static const char* AddAniFrame(const uint8_t* data, size_t size, CursorImage* image, size_t* pixelBytes) {
+    if (image->frames.size() >= kMaxCursorFrames) {
+        return "Too many ANI frames";
+    }
+    CursorFrame frame;
+    const char* error = DecodeIcon(data, size, &frame);
+    if (error) {
+        return error;
+    }
+    *pixelBytes += frame.pixels.size();
+    if (*pixelBytes > kMaxCursorPixelBytes) {
+        return "Animated cursor too large";
+    }
+    image->frames.push_back(std::move(frame));
+    return nullptr;
+}
+
+static const char* ReadAniTable(const uint8_t* body, uint32_t length, std::vector<uint32_t>* table) {
+    if (length / 4 > kMaxCursorSteps) {
+        return "Too many ANI steps";
+    }
+    table->clear();
+    for (uint32_t i = 0; i + 4 <= length; i += 4) {
+        table->push_back(ReadU32(body + i));
+    }
+    return nullptr;
+}
+
+// RIFF "ACON": an "anih" header, optional "rate" (jiffies per step) and "seq " (frame per step)
+// tables, and the frames as .ico/.cur images inside LIST "fram".
+static const char* DecodeAni(const uint8_t* data, size_t size, CursorImage* image) {
+    size_t riffEnd = std::min<size_t>(size, (size_t)ReadU32(data + 4) + 8);
+    bool haveHeader = false;
+    uint32_t defaultJiffies = kDefaultAniJiffies;
+    std::vector<uint32_t> rates;
+    std::vector<uint32_t> sequence;
+    size_t pixelBytes = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= riffEnd) {
+        const uint8_t* chunk = data + pos;
+        uint32_t length = ReadU32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        if (length > riffEnd - pos - 8) {
+            return "Truncated ANI chunk";
+        }
+
+        const char* error = nullptr;
+        if (memcmp(chunk, "anih", 4) == 0) {
+            if (length < 36) {
+                return "Truncated ANI header";
+            }
+            if (!(ReadU32(body + 32) & 1)) {
+                return "Raw-bitmap ANI frames are not supported";
+            }
+            uint32_t jiffies = ReadU32(body + 28);
+            defaultJiffies = jiffies ? jiffies : kDefaultAniJiffies;
+            haveHeader = true;
+        } else if (memcmp(chunk, "rate", 4) == 0) {
+            error = ReadAniTable(body, length, &rates);
+        } else if (memcmp(chunk, "seq ", 4) == 0) {
+            error = ReadAniTable(body, length, &sequence);
+        } else if (memcmp(chunk, "icon", 4) == 0) {
+            error = AddAniFrame(body, length, image, &pixelBytes);
+        } else if (memcmp(chunk, "LIST", 4) == 0 && length >= 4 && memcmp(body, "fram", 4) == 0) {
+            size_t sub = 4;
+            while (!error && sub + 8 <= length) {
+                uint32_t subLength = ReadU32(body + sub + 4);
+                if (subLength > length - sub - 8) {
+                    return "Truncated ANI frame";
+                }
+                if (memcmp(body + sub, "icon", 4) == 0) {
+                    error = AddAniFrame(body + sub + 8, subLength, image, &pixelBytes);
+                }
+                sub += 8 + (size_t)subLength + (subLength & 1);
+            }
+        }
+        if (error) {
+            return error;
+        }
+        pos += 8 + (size_t)length + (length & 1);
+    }
+
+    if (!haveHeader) {
+        return "Missing ANI header";
+    }
+    if (image->frames.empty()) {
+        return "ANI file has no frames";
+    }
+
+    size_t stepCount = sequence.empty() ? image->frames.size() : sequence.size();
+    if (!rates.empty() && rates.size() != stepCount) {
+        return "ANI rate table does not match its steps";
+    }
+    image->steps.resize(stepCount);
+    for (size_t i = 0; i < stepCount; i++) {
+        uint32_t frame = sequence.empty() ? (uint32_t)i : sequence[i];
+        if (frame >= image->frames.size()) {
+            return "ANI sequence references a missing frame";
+        }
+        uint32_t jiffies = std::min(std::max<uint32_t>(rates.empty() ? defaultJiffies : rates[i], 1), kMaxAniJiffies);
+        image->steps[i] = { frame, jiffies * 1000 / 60 };
+    }
+    return nullptr;
+}
+
+const char* DecodeCursorImage(const uint8_t* data, size_t size, CursorImage* image) {
+    image->frames.clear();
+    image->steps.clear();
+
+    const char* error;
+    if (size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "ACON", 4) == 0) {
+        error = DecodeAni(data, size, image);
+    } else {
+        image->frames.resize(1);
+        error = DecodeIcon(data, size, &image->frames[0]);
+    }
+    if (error) {
+        image->frames.clear();
+        image->steps.clear();
+    }
+    return error;
+}
+
+uint64_t HashCursorFile(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int kMaxCursorDimension = 256;
+const size_t kMaxCursorFrames = 256;
+const size_t kMaxCursorSteps = 1024;
+
+struct CursorFrame {
+    uint16_t width, height;
+    uint16_t hotspotX, hotspotY;
+    std::vector<uint8_t> pixels;  // premultiplied RGBA, top row first
+};
+
+struct CursorStep {
+    uint32_t frame;
+    uint32_t durationMs;
+};
+
+// A static cursor has one frame and no steps; an animated one plays its steps in order and loops.
+struct CursorImage {
+    std::vector<CursorFrame> frames;
+    std::vector<CursorStep> steps;
+};
+
+// Decodes a .cur/.ico (largest BMP-encoded image) or a RIFF .ani. Returns nullptr on success or
+// an error message; never reads outside [data, data + size).
+const char* DecodeCursorImage(const uint8_t* data, size_t size, CursorImage* image);
+
+// FNV-1a over the file bytes; keys the decoded-cursor cache.
+uint64_t HashCursorFile(const uint8_t* data, size_t size);
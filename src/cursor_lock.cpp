@@ -0,0 +1,122 @@
+#include "cursor_lock.h"
+
+#include "input_pipeline.h"
+
+void CursorLock::SetSink(std::unique_ptr<CursorSink> sink) {
+    sink_ = std::move(sink);
+    known_ = false;
+}
+
+void CursorLock::Lock(uint64_t ownerHandle, int32_t x, int32_t y) {
+    commands_.TryPush({ CommandKind::Lock, true, ownerHandle, x, y });
+}
+
+void CursorLock::Unlock() {
+    commands_.TryPush({ CommandKind::Unlock, false, 0, 0, 0 });
+}
+
+void CursorLock::SetRouting(bool enabled) {
+    commands_.TryPush({ CommandKind::Routing, enabled, 0, 0, 0 });
+}
+
+void CursorLock::ApplyCommands() {
+    Command command;
+    while (commands_.TryPop(command)) {
+        switch (command.kind) {
+        case CommandKind::Lock:
+            locked_ = true;
+            ownerHandle_ = command.handle;
+            ownerResolved_ = false;
+            targetX_ = command.x;
+            targetY_ = command.y;
+            // Lock takes the device's logical position, like the engine's own events.
+            if (pipeline_.Motion().Enabled()) {
+                pipeline_.Motion().ToPhysical(targetX_, targetY_);
+            }
+            pending_ = true;
+            break;
+        case CommandKind::Unlock:
+            locked_ = false;
+            pending_ = false;
+            break;
+        case CommandKind::Routing:
+            routing_ = command.enabled;
+            break;
+        }
+    }
+}
+
+bool CursorLock::IsOwner(uint32_t deviceId) {
+    if (!ownerResolved_) {
+        ownerResolved_ = pipeline_.LookupDevice(ownerHandle_, &ownerId_);
+    }
+    return ownerResolved_ && deviceId == ownerId_;
+}
+
+void CursorLock::Observe(const MouseEvent& event) {
+    if (commands_.Size() > 0) {
+        ApplyCommands();
+    }
+    if (!locked_ && !routing_) {
+        return;
+    }
+
+    if (event.type == EventType::Device) {
+        if (event.action == EventAction::Removed && locked_ && IsOwner(event.deviceId)) {
+            locked_ = false;
+            pending_ = false;
+        }
+        return;
+    }
+    if (event.type != EventType::Move) {
+        return;
+    }
+
+    const MotionEngine& motion = pipeline_.Motion();
+    const bool engine = motion.Enabled();
+    int32_t x = event.x;
+    int32_t y = event.y;
+    if (engine) {
+        // The OS applied the raw delta to its cursor; only the engine knows where the device is.
+        known_ = false;
+        motion.ToPhysical(x, y);
+    } else {
+        // Without the engine, backends report the OS cursor position itself.
+        known_ = true;
+        knownX_ = x;
+        knownY_ = y;
+    }
+
+    if (locked_) {
+        if (IsOwner(event.deviceId)) {
+            targetX_ = x;
+            targetY_ = y;
+        }
+        pending_ = true;
+    } else if (engine) {
+        targetX_ = x;
+        targetY_ = y;
+        pending_ = true;
+    }
+}
+
+void CursorLock::Flush() {
+    if (commands_.Size() > 0) {
+        ApplyCommands();
+    }
+    if (!pending_ || !sink_) {
+        return;
+    }
+    pending_ = false;
+
+    if (known_ && knownX_ == targetX_ && knownY_ == targetY_) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    sink_->MoveTo(targetX_, targetY_);
+    known_ = true;
+    knownX_ = targetX_;
+    knownY_ = targetY_;
+    repositions_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "event_ring.h"
+
+class InputPipeline;
+
+// Moves the OS cursor, in physical desktop pixels. Swappable so arbitration can run without a desktop.
+class CursorSink {
+public:
+    virtual ~CursorSink() {}
+    virtual void MoveTo(int32_t x, int32_t y) = 0;
+};
+
+// nullptr where the platform cursor cannot be driven.
+std::unique_ptr<CursorSink> CreateSystemCursorSink();
+
+// Arbitrates the OS cursor on the producer thread. While a device owns it, the cursor follows that
+// device and is re-pinned after other mice nudge it; with routing on, it follows whichever device
+// moved last. At most one MoveTo per FlushProducer, and none when the cursor is already on target.
+class CursorLock {
+public:
+    explicit CursorLock(InputPipeline& pipeline) : pipeline_(pipeline) {}
+
+    // Before the producer starts.
+    void SetSink(std::unique_ptr<CursorSink> sink);
+
+    // Any single thread (the JS thread); picked up by the producer before its next event or flush.
+    void Lock(uint64_t ownerHandle, int32_t x, int32_t y);
+    void Unlock();
+    void SetRouting(bool enabled);
+
+    // Producer thread: Observe sees every event after the motion engine, Flush ends the batch.
+    void Observe(const MouseEvent& event);
+    void Flush();
+
+    uint64_t Repositions() const { return repositions_.load(std::memory_order_relaxed); }
+    uint64_t SkippedRepositions() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    enum class CommandKind : uint8_t { Lock, Unlock, Routing };
+
+    struct Command {
+        CommandKind kind;
+        bool enabled;
+        uint64_t handle;
+        int32_t x, y;
+    };
+
+    void ApplyCommands();
+    bool IsOwner(uint32_t deviceId);
+
+    InputPipeline& pipeline_;
+    SpscRing<Command, 64> commands_;
+    std::unique_ptr<CursorSink> sink_;
+
+    bool locked_ = false;
+    bool routing_ = false;
+    uint64_t ownerHandle_ = 0;
+    bool ownerResolved_ = false;
+    uint32_t ownerId_ = 0;
+
+    bool pending_ = false;
+    int32_t targetX_ = 0, targetY_ = 0;
+    // Last OS cursor position we know for certain; unknown after a move we did not observe directly.
+    bool known_ = false;
+    int32_t knownX_ = 0, knownY_ = 0;
+
+    std::atomic<uint64_t> repositions_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
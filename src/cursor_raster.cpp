@@ -0,0 +1,422 @@
+#include "cursor_raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define ORIONIX_X64 1
+#include <immintrin.h>
+// Helpers shared with the AVX2 paths are forced inline so they are VEX-encoded there; an
+// out-of-line legacy SSE call with dirty upper halves stalls on the AVX/SSE transition.
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ORIONIX_AVX2
+#define ORIONIX_SHARED __forceinline
+#else
+#define ORIONIX_AVX2 __attribute__((target("avx2")))
+#define ORIONIX_SHARED inline __attribute__((always_inline))
+#endif
+#endif
+
+// Filter weights are 2.14 fixed point and sum to exactly 1 << kWeightBits.
+static const int kWeightBits = 14;
+static const int32_t kWeightRound = 1 << (kWeightBits - 1);
+
+struct FilterTaps {
+    int maxTaps = 0;
+    std::vector<int> start;
+    std::vector<int> count;
+    std::vector<int16_t> weights;  // maxTaps per output pixel
+};
+
+static double Bicubic(double x) {
+    const double a = -0.5;
+    x = std::fabs(x);
+    if (x < 1.0) return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    if (x < 2.0) return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+    return 0.0;
+}
+
+static void BuildTaps(int srcSize, int dstSize, FilterTaps& taps) {
+    double scale = (double)srcSize / dstSize;
+    double filterScale = std::max(scale, 1.0);
+    double support = 2.0 * filterScale;
+    taps.maxTaps = (int)std::ceil(support) * 2 + 1;
+    taps.start.resize(dstSize);
+    taps.count.resize(dstSize);
+    taps.weights.assign((size_t)dstSize * taps.maxTaps, 0);
+
+    std::vector<double> raw(taps.maxTaps);
+    for (int i = 0; i < dstSize; i++) {
+        double center = (i + 0.5) * scale;
+        int first = std::max(0, (int)(center - support + 0.5));
+        int last = std::min(srcSize, (int)(center + support + 0.5));
+        int count = std::max(1, last - first);
+
+        double total = 0.0;
+        for (int k = 0; k < count; k++) {
+            raw[k] = Bicubic((first + k - center + 0.5) / filterScale);
+            total += raw[k];
+        }
+
+        int16_t* weights = &taps.weights[(size_t)i * taps.maxTaps];
+        int sum = 0, peak = 0;
+        for (int k = 0; k < count; k++) {
+            weights[k] = (int16_t)std::lround(total != 0.0 ? raw[k] / total * (1 << kWeightBits) : 0.0);
+            sum += weights[k];
+            if (weights[k] > weights[peak]) peak = k;
+        }
+        weights[peak] = (int16_t)(weights[peak] + (1 << kWeightBits) - sum);
+        taps.start[i] = first;
+        taps.count[i] = count;
+    }
+}
+
+static int32_t Clamp255(int32_t value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static void StorePixel(uint8_t* out, const int32_t acc[4]) {
+    int32_t alpha = Clamp255((acc[3] + kWeightRound) >> kWeightBits);
+    for (int c = 0; c < 3; c++) {
+        out[c] = (uint8_t)std::min(Clamp255((acc[c] + kWeightRound) >> kWeightBits), alpha);
+    }
+    out[3] = (uint8_t)alpha;
+}
+
+// Rounded v / 255 for v <= 255 * 255.
+static uint32_t Div255(uint32_t value) {
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+static void HorizontalScalar(const uint8_t* src, int srcWidth, int rows, uint8_t* dst, int dstWidth, const FilterTaps& taps) {
+    for (int y = 0; y < rows; y++) {
+        const uint8_t* srcRow = src + (size_t)y * srcWidth * 4;
+        uint8_t* dstRow = dst + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; x++) {
+            const int16_t* weights = &taps.weights[(size_t)x * taps.maxTaps];
+            const uint8_t* p = srcRow + taps.start[x] * 4;
+            int32_t acc[4] = { 0, 0, 0, 0 };
+            for (int k = 0; k < taps.count[x]; k++) {
+                for (int c = 0; c < 4; c++) acc[c] += weights[k] * p[k * 4 + c];
+            }
+            StorePixel(dstRow + x * 4, acc);
+        }
+    }
+}
+
+static void VerticalPixelScalar(const uint8_t* rows, size_t stride, const int16_t* weights, int count, uint8_t* out) {
+    int32_t acc[4] = { 0, 0, 0, 0 };
+    for (int k = 0; k < count; k++) {
+        const uint8_t* p = rows + k * stride;
+        for (int c = 0; c < 4; c++) acc[c] += weights[k] * p[c];
+    }
+    StorePixel(out, acc);
+}
+
+static void VerticalScalar(const uint8_t* src, int width, uint8_t* dst, int dstHeight, const FilterTaps& taps) {
+    size_t stride = (size_t)width * 4;
+    for (int y = 0; y < dstHeight; y++) {
+        const int16_t* weights = &taps.weights[(size_t)y * taps.maxTaps];
+        const uint8_t* rows = src + taps.start[y] * stride;
+        for (int x = 0; x < width; x++) {
+            VerticalPixelScalar(rows + x * 4, stride, weights, taps.count[y], dst + y * stride + x * 4);
+        }
+    }
+}
+
+static void TintScalar(uint8_t* pixels, size_t pixelCount, const uint8_t multiplier[4]) {
+    for (size_t i = 0; i < pixelCount * 4; i++) {
+        pixels[i] = (uint8_t)Div255(pixels[i] * multiplier[i & 3]);
+    }
+}
+
+#ifdef ORIONIX_X64
+ORIONIX_SHARED static uint32_t LoadPixel(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+ORIONIX_SHARED static int32_t WeightPair(int16_t first, int16_t second) {
+    return (int32_t)((uint32_t)(uint16_t)first | ((uint32_t)(uint16_t)second << 16));
+}
+
+// int16 lanes of whole pixels: clamp to [0, 255], then colour to alpha.
+ORIONIX_SHARED static __m128i ClampPremultiplied(__m128i x) {
+    x = _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(255));
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xFF), 0xFF);
+    return _mm_min_epi16(x, alpha);
+}
+
+ORIONIX_SHARED static __m128i Descale(__m128i acc) {
+    return _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(kWeightRound)), kWeightBits);
+}
+
+// Accumulates taps [k, count) of one output pixel two at a time: madd pairs the same channel of
+// neighbouring source pixels with their two weights.
+ORIONIX_SHARED static __m128i HorizontalTailSse2(const uint8_t* p, const int16_t* weights, int k, int count, __m128i acc) {
+    const __m128i zero = _mm_setzero_si128();
+    for (; k + 2 <= count; k += 2) {
+        __m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + k * 4)), zero);
+        px = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(WeightPair(weights[k], weights[k + 1]))));
+    }
+    if (k < count) {
+        __m128i px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)LoadPixel(p + k * 4)), zero), zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(WeightPair(weights[k], 0))));
+    }
+    return acc;
+}
+
+ORIONIX_SHARED static void StorePixelSse2(uint8_t* out, __m128i acc) {
+    __m128i x = ClampPremultiplied(_mm_packs_epi32(Descale(acc), _mm_setzero_si128()));
+    uint32_t value = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(x, x));
+    memcpy(out, &value, 4);
+}
+
+static void HorizontalSse2(const uint8_t* src, int srcWidth, int rows, uint8_t* dst, int dstWidth, const FilterTaps& taps) {
+    for (int y = 0; y < rows; y++) {
+        const uint8_t* srcRow = src + (size_t)y * srcWidth * 4;
+        uint8_t* dstRow = dst + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; x++) {
+            const int16_t* weights = &taps.weights[(size_t)x * taps.maxTaps];
+            __m128i acc = HorizontalTailSse2(srcRow + taps.start[x] * 4, weights, 0, taps.count[x], _mm_setzero_si128());
+            StorePixelSse2(dstRow + x * 4, acc);
+        }
+    }
+}
+
+// Four output pixels per step; unpacking two source rows byte-wise pairs each channel with the
+// same channel one row down, ready for madd against the two row weights.
+static void VerticalSse2(const uint8_t* src, int width, uint8_t* dst, int dstHeight, const FilterTaps& taps) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t stride = (size_t)width * 4;
+    for (int y = 0; y < dstHeight; y++) {
+        const int16_t* weights = &taps.weights[(size_t)y * taps.maxTaps];
+        const uint8_t* rows = src + taps.start[y] * stride;
+        int count = taps.count[y];
+        uint8_t* out = dst + y * stride;
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+            for (int k = 0; k < count; k += 2) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(rows + k * stride + x * 4));
+                __m128i b = k + 1 < count ? _mm_loadu_si128((const __m128i*)(rows + (k + 1) * stride + x * 4)) : zero;
+                __m128i w = _mm_set1_epi32(WeightPair(weights[k], k + 1 < count ? weights[k + 1] : 0));
+                __m128i lo = _mm_unpacklo_epi8(a, b);
+                __m128i hi = _mm_unpackhi_epi8(a, b);
+                acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+                acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+                acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+                acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+            }
+            __m128i p01 = ClampPremultiplied(_mm_packs_epi32(Descale(acc0), Descale(acc1)));
+            __m128i p23 = ClampPremultiplied(_mm_packs_epi32(Descale(acc2), Descale(acc3)));
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(p01, p23));
+        }
+        for (; x < width; x++) {
+            VerticalPixelScalar(rows + x * 4, stride, weights, count, out + x * 4);
+        }
+    }
+}
+
+static __m128i TintLanes(__m128i x, __m128i multiplier) {
+    __m128i v = _mm_add_epi16(_mm_mullo_epi16(x, multiplier), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+static void TintSse2(uint8_t* pixels, size_t pixelCount, const uint8_t multiplier[4]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m = _mm_setr_epi16(multiplier[0], multiplier[1], multiplier[2], multiplier[3],
+                                     multiplier[0], multiplier[1], multiplier[2], multiplier[3]);
+    size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+        __m128i lo = TintLanes(_mm_unpacklo_epi8(x, zero), m);
+        __m128i hi = TintLanes(_mm_unpackhi_epi8(x, zero), m);
+        _mm_storeu_si128((__m128i*)(pixels + i * 4), _mm_packus_epi16(lo, hi));
+    }
+    TintScalar(pixels + i * 4, pixelCount - i, multiplier);
+}
+
+ORIONIX_AVX2 static __m256i ClampPremultipliedAvx2(__m256i x) {
+    x = _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0xFF), 0xFF);
+    return _mm256_min_epi16(x, alpha);
+}
+
+ORIONIX_AVX2 static __m256i DescaleAvx2(__m256i acc) {
+    return _mm256_srai_epi32(_mm256_add_epi32(acc, _mm256_set1_epi32(kWeightRound)), kWeightBits);
+}
+
+// Four taps per step: each 128-bit lane handles two of them after a per-lane channel shuffle.
+ORIONIX_AVX2 static void HorizontalAvx2(const uint8_t* src, int srcWidth, int rows, uint8_t* dst, int dstWidth, const FilterTaps& taps) {
+    const __m256i pairChannels = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+                                                  0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+    for (int y = 0; y < rows; y++) {
+        const uint8_t* srcRow = src + (size_t)y * srcWidth * 4;
+        uint8_t* dstRow = dst + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; x++) {
+            const int16_t* weights = &taps.weights[(size_t)x * taps.maxTaps];
+            const uint8_t* p = srcRow + taps.start[x] * 4;
+            int count = taps.count[x];
+
+            __m256i wide = _mm256_setzero_si256();
+            int k = 0;
+            for (; k + 4 <= count; k += 4) {
+                __m256i px = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(p + k * 4)));
+                px = _mm256_shuffle_epi8(px, pairChannels);
+                int32_t w01 = WeightPair(weights[k], weights[k + 1]);
+                int32_t w23 = WeightPair(weights[k + 2], weights[k + 3]);
+                __m256i w = _mm256_setr_epi32(w01, w01, w01, w01, w23, w23, w23, w23);
+                wide = _mm256_add_epi32(wide, _mm256_madd_epi16(px, w));
+            }
+            __m128i acc = _mm_add_epi32(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+            StorePixelSse2(dstRow + x * 4, HorizontalTailSse2(p, weights, k, count, acc));
+        }
+    }
+}
+
+ORIONIX_AVX2 static void VerticalAvx2(const uint8_t* src, int width, uint8_t* dst, int dstHeight, const FilterTaps& taps) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t stride = (size_t)width * 4;
+    for (int y = 0; y < dstHeight; y++) {
+        const int16_t* weights = &taps.weights[(size_t)y * taps.maxTaps];
+        const uint8_t* rows = src + taps.start[y] * stride;
+        int count = taps.count[y];
+        uint8_t* out = dst + y * stride;
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m256i acc01 = _mm256_setzero_si256(), acc23 = _mm256_setzero_si256();
+            for (int k = 0; k < count; k += 2) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(rows + k * stride + x * 4));
+                __m128i b = k + 1 < count ? _mm_loadu_si128((const __m128i*)(rows + (k + 1) * stride + x * 4)) : zero;
+                __m256i w = _mm256_set1_epi32(WeightPair(weights[k], k + 1 < count ? weights[k + 1] : 0));
+                acc01 = _mm256_add_epi32(acc01, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(a, b)), w));
+                acc23 = _mm256_add_epi32(acc23, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_unpackhi_epi8(a, b)), w));
+            }
+            // packs works per lane, leaving pixels in 0, 2, 1, 3 order.
+            __m256i pixels = _mm256_permute4x64_epi64(_mm256_packs_epi32(DescaleAvx2(acc01), DescaleAvx2(acc23)), 0xD8);
+            pixels = ClampPremultipliedAvx2(pixels);
+            __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(pixels, pixels), 0x08);
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm256_castsi256_si128(bytes));
+        }
+        for (; x < width; x++) {
+            VerticalPixelScalar(rows + x * 4, stride, weights, count, out + x * 4);
+        }
+    }
+}
+
+ORIONIX_AVX2 static __m256i TintLanesAvx2(__m256i x, __m256i multiplier) {
+    __m256i v = _mm256_add_epi16(_mm256_mullo_epi16(x, multiplier), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+}
+
+ORIONIX_AVX2 static void TintAvx2(uint8_t* pixels, size_t pixelCount, const uint8_t multiplier[4]) {
+    const __m256i m = _mm256_setr_epi16(multiplier[0], multiplier[1], multiplier[2], multiplier[3],
+                                        multiplier[0], multiplier[1], multiplier[2], multiplier[3],
+                                        multiplier[0], multiplier[1], multiplier[2], multiplier[3],
+                                        multiplier[0], multiplier[1], multiplier[2], multiplier[3]);
+    size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(pixels + i * 4 + 16));
+        __m256i a = TintLanesAvx2(_mm256_cvtepu8_epi16(lo), m);
+        __m256i b = TintLanesAvx2(_mm256_cvtepu8_epi16(hi), m);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(pixels + i * 4), packed);
+    }
+    TintSse2(pixels + i * 4, pixelCount - i, multiplier);
+}
+#endif
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+SimdLevel DetectSimdLevel() {
+#ifdef ORIONIX_X64
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesAvx && (info[1] & (1 << 5)) ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#endif
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+static const SimdLevel detectedLevel = DetectSimdLevel();
+static SimdLevel activeLevel = detectedLevel;
+
+SimdLevel ActiveSimdLevel() {
+    return activeLevel;
+}
+
+void SetSimdLevel(SimdLevel level) {
+    activeLevel = std::min(level, detectedLevel);
+}
+
+void ResampleRgba(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst, int dstWidth, int dstHeight) {
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        memcpy(dst, src, (size_t)srcWidth * srcHeight * 4);
+        return;
+    }
+
+    FilterTaps horizontal, vertical;
+    BuildTaps(srcWidth, dstWidth, horizontal);
+    BuildTaps(srcHeight, dstHeight, vertical);
+    std::vector<uint8_t> columns((size_t)dstWidth * srcHeight * 4);
+
+    switch (activeLevel) {
+#ifdef ORIONIX_X64
+        case SimdLevel::Avx2:
+            HorizontalAvx2(src, srcWidth, srcHeight, columns.data(), dstWidth, horizontal);
+            VerticalAvx2(columns.data(), dstWidth, dst, dstHeight, vertical);
+            break;
+        case SimdLevel::Sse2:
+            HorizontalSse2(src, srcWidth, srcHeight, columns.data(), dstWidth, horizontal);
+            VerticalSse2(columns.data(), dstWidth, dst, dstHeight, vertical);
+            break;
+#endif
+        default:
+            HorizontalScalar(src, srcWidth, srcHeight, columns.data(), dstWidth, horizontal);
+            VerticalScalar(columns.data(), dstWidth, dst, dstHeight, vertical);
+            break;
+    }
+}
+
+void TintRgba(uint8_t* pixels, size_t pixelCount, uint32_t rgb, uint8_t opacity) {
+    uint8_t multiplier[4] = {
+        (uint8_t)Div255(((rgb >> 16) & 0xFF) * opacity),
+        (uint8_t)Div255(((rgb >> 8) & 0xFF) * opacity),
+        (uint8_t)Div255((rgb & 0xFF) * opacity),
+        opacity,
+    };
+    if ((multiplier[0] & multiplier[1] & multiplier[2] & multiplier[3]) == 255) {
+        return;
+    }
+
+    switch (activeLevel) {
+#ifdef ORIONIX_X64
+        case SimdLevel::Avx2: TintAvx2(pixels, pixelCount, multiplier); break;
+        case SimdLevel::Sse2: TintSse2(pixels, pixelCount, multiplier); break;
+#endif
+        default: TintScalar(pixels, pixelCount, multiplier); break;
+    }
+}
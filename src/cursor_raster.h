@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Image kernels for premultiplied RGBA cursor bitmaps. Every path computes the same integers, so
+// the SIMD output is bit-identical to the scalar fallback.
+enum class SimdLevel : uint8_t { Scalar, Sse2, Avx2 };
+
+const char* SimdLevelName(SimdLevel level);
+
+// Best level the CPU and OS support; the active level starts there.
+SimdLevel DetectSimdLevel();
+SimdLevel ActiveSimdLevel();
+// Clamped to the detected level; lower levels are for benchmarks and comparisons.
+void SetSimdLevel(SimdLevel level);
+
+// Separable bicubic resample (the support widens with the reduction, so downscales filter instead
+// of skipping pixels). Colour channels are clamped to alpha to keep the premultiplied invariant.
+void ResampleRgba(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst, int dstWidth, int dstHeight);
+
+// Multiplies colour by `rgb` (0xRRGGBB; white leaves it unchanged) and everything by opacity.
+void TintRgba(uint8_t* pixels, size_t pixelCount, uint32_t rgb, uint8_t opacity);
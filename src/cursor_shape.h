@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// Names match the cursor types the overlay already maps to .cur files and CSS.
+enum class CursorType : uint8_t {
+    Arrow, IBeam, Wait, AppStarting, Cross, UpArrow, Hand, Help, No,
+    SizeNS, SizeWE, SizeNWSE, SizeNESW, SizeAll, Hidden, Custom, Count
+};
+
+inline const char* CursorTypeName(CursorType shape) {
+    static const char* const names[] = {
+        "Arrow", "IBeam", "Wait", "AppStarting", "Cross", "UpArrow", "Hand", "Help", "No",
+        "SizeNS", "SizeWE", "SizeNWSE", "SizeNESW", "SizeAll", "Hidden", "Custom"
+    };
+    return shape < CursorType::Count ? names[(int)shape] : "Custom";
+}
+
+// Watches the OS cursor on its own thread and reports shape changes, never repeats.
+class CursorShapeSource {
+public:
+    typedef void (*ChangeCallback)(CursorType shape, void* context);
+
+    virtual ~CursorShapeSource() {}
+
+    // Returns nullptr once watching, or an error message. The current shape is reported first.
+    virtual const char* Start(ChangeCallback onChange, void* context) = 0;
+    virtual void Stop() = 0;
+};
+
+// Platform source: WinEvent hooks on Windows, XFixes cursor notifications on X11.
+std::unique_ptr<CursorShapeSource> CreateCursorShapeSource();
+
+#ifdef _WIN32
+// Shape of a cursor handle via the cached system-cursor table; Custom when not a system cursor.
+CursorType ClassifyCursorHandle(void* cursor);
+#else
+// Shape of an X cursor name (cursor font or freedesktop/CSS alias); Custom for any other name.
+CursorType ClassifyCursorName(const char* name);
+#endif
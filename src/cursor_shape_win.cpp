@@ -0,0 +1,187 @@
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "cursor_shape.h"
+
+struct CursorEntry {
+    HCURSOR handle;
+    CursorType shape;
+};
+
+static const struct {
+    LPCTSTR id;
+    CursorType shape;
+} kSystemCursors[] = {
+    { IDC_ARROW, CursorType::Arrow },
+    { IDC_IBEAM, CursorType::IBeam },
+    { IDC_WAIT, CursorType::Wait },
+    { IDC_APPSTARTING, CursorType::AppStarting },
+    { IDC_CROSS, CursorType::Cross },
+    { IDC_UPARROW, CursorType::UpArrow },
+    { IDC_HAND, CursorType::Hand },
+    { IDC_HELP, CursorType::Help },
+    { IDC_NO, CursorType::No },
+    { IDC_SIZENS, CursorType::SizeNS },
+    { IDC_SIZEWE, CursorType::SizeWE },
+    { IDC_SIZENWSE, CursorType::SizeNWSE },
+    { IDC_SIZENESW, CursorType::SizeNESW },
+    { IDC_SIZEALL, CursorType::SizeAll },
+};
+static const size_t kSystemCursorCount = sizeof(kSystemCursors) / sizeof(kSystemCursors[0]);
+
+// Sorted by handle; rebuilt when the cursor scheme changes.
+static CursorEntry cursorTable[kSystemCursorCount];
+static std::mutex cursorTableMutex;
+static std::once_flag cursorTableOnce;
+
+static bool HandleLess(const CursorEntry& a, const CursorEntry& b) {
+    return (uintptr_t)a.handle < (uintptr_t)b.handle;
+}
+
+static void BuildCursorTable() {
+    CursorEntry table[kSystemCursorCount];
+    for (size_t i = 0; i < kSystemCursorCount; i++) {
+        table[i] = { LoadCursor(nullptr, kSystemCursors[i].id), kSystemCursors[i].shape };
+    }
+    std::sort(table, table + kSystemCursorCount, HandleLess);
+
+    std::lock_guard<std::mutex> lock(cursorTableMutex);
+    std::copy(table, table + kSystemCursorCount, cursorTable);
+}
+
+CursorType ClassifyCursorHandle(void* cursor) {
+    std::call_once(cursorTableOnce, BuildCursorTable);
+
+    std::lock_guard<std::mutex> lock(cursorTableMutex);
+    const CursorEntry key = { (HCURSOR)cursor, CursorType::Custom };
+    const CursorEntry* entry = std::lower_bound(cursorTable, cursorTable + kSystemCursorCount, key, HandleLess);
+    return entry != cursorTable + kSystemCursorCount && entry->handle == key.handle ? entry->shape : CursorType::Custom;
+}
+
+// WinEvent hooks fire on the hooking thread's message loop whenever the cursor changes name
+// (its shape) or is shown or hidden; a hidden top-level window catches cursor scheme changes.
+class WinEventCursorSource : public CursorShapeSource {
+public:
+    ~WinEventCursorSource() override {
+        Stop();
+    }
+
+    const char* Start(ChangeCallback onChange, void* context) override {
+        if (watchThread.joinable()) {
+            return nullptr;
+        }
+        if (claimed.exchange(true)) {
+            return "The cursor shape is already watched in another context";
+        }
+
+        callback = onChange;
+        callbackContext = context;
+        last = CursorType::Count;
+        std::promise<const char*> started;
+        std::future<const char*> result = started.get_future();
+        watchThread = std::thread([this, &started]() { Run(started); });
+
+        const char* error = result.get();
+        if (error) {
+            watchThread.join();
+            claimed.store(false);
+        }
+        return error;
+    }
+
+    void Stop() override {
+        if (!watchThread.joinable()) {
+            return;
+        }
+        PostThreadMessage(watchThreadId, WM_QUIT, 0, 0);
+        watchThread.join();
+        claimed.store(false);
+    }
+
+private:
+    static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        if (msg == WM_SETTINGCHANGE && wParam == SPI_SETCURSORS && active) {
+            BuildCursorTable();
+            active->Report();
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
+    static void CALLBACK OnWinEvent(HWINEVENTHOOK, DWORD, HWND hwnd, LONG idObject, LONG, DWORD, DWORD) {
+        if (hwnd == nullptr && idObject == OBJID_CURSOR && active) {
+            active->Report();
+        }
+    }
+
+    void Report() {
+        CURSORINFO cursorInfo;
+        cursorInfo.cbSize = sizeof(CURSORINFO);
+        CursorType shape = CursorType::Custom;
+        if (GetCursorInfo(&cursorInfo)) {
+            shape = (cursorInfo.flags & CURSOR_SHOWING) ? ClassifyCursorHandle(cursorInfo.hCursor) : CursorType::Hidden;
+        }
+        if (shape != last) {
+            last = shape;
+            callback(shape, callbackContext);
+        }
+    }
+
+    void Run(std::promise<const char*>& started) {
+        watchThreadId = GetCurrentThreadId();
+        std::call_once(cursorTableOnce, BuildCursorTable);
+
+        WNDCLASSA windowClass = {};
+        windowClass.lpfnWndProc = WndProc;
+        windowClass.hInstance = GetModuleHandle(nullptr);
+        windowClass.lpszClassName = "OrionixCursorShapeWatcher";
+        RegisterClassA(&windowClass);
+
+        // Not message-only: those never receive broadcast WM_SETTINGCHANGE.
+        HWND window = CreateWindowExA(0, windowClass.lpszClassName, "", 0, 0, 0, 0, 0, nullptr, nullptr, windowClass.hInstance, nullptr);
+        HWINEVENTHOOK nameHook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr, OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT);
+        HWINEVENTHOOK showHook = SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_HIDE, nullptr, OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT);
+        if (!window || !nameHook || !showHook) {
+            if (nameHook) UnhookWinEvent(nameHook);
+            if (showHook) UnhookWinEvent(showHook);
+            if (window) DestroyWindow(window);
+            started.set_value("Failed to install the cursor WinEvent hooks");
+            return;
+        }
+
+        active = this;
+        Report();
+        started.set_value(nullptr);
+
+        MSG msg;
+        while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+
+        active = nullptr;
+        UnhookWinEvent(showHook);
+        UnhookWinEvent(nameHook);
+        DestroyWindow(window);
+    }
+
+    // Hook procedures carry no user data; one source watches at a time, process-wide.
+    static WinEventCursorSource* active;
+    static std::atomic<bool> claimed;
+
+    std::thread watchThread;
+    DWORD watchThreadId = 0;
+    ChangeCallback callback = nullptr;
+    void* callbackContext = nullptr;
+    CursorType last = CursorType::Count;
+};
+
+WinEventCursorSource* WinEventCursorSource::active = nullptr;
+std::atomic<bool> WinEventCursorSource::claimed{false};
+
+std::unique_ptr<CursorShapeSource> CreateCursorShapeSource() {
+    return std::unique_ptr<CursorShapeSource>(new WinEventCursorSource());
+}
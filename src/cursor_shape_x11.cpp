@@ -0,0 +1,167 @@
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cursor_shape.h"
+
+// Core X cursor-font names and their freedesktop/CSS aliases.
+static const struct {
+    const char* name;
+    CursorType shape;
+} kCursorNames[] = {
+    { "left_ptr", CursorType::Arrow }, { "default", CursorType::Arrow }, { "arrow", CursorType::Arrow },
+    { "xterm", CursorType::IBeam }, { "text", CursorType::IBeam },
+    { "watch", CursorType::Wait }, { "wait", CursorType::Wait },
+    { "left_ptr_watch", CursorType::AppStarting }, { "progress", CursorType::AppStarting },
+    { "crosshair", CursorType::Cross }, { "cross", CursorType::Cross }, { "tcross", CursorType::Cross },
+    { "sb_up_arrow", CursorType::UpArrow }, { "up-arrow", CursorType::UpArrow },
+    { "hand1", CursorType::Hand }, { "hand2", CursorType::Hand }, { "pointer", CursorType::Hand },
+    { "question_arrow", CursorType::Help }, { "help", CursorType::Help },
+    { "crossed_circle", CursorType::No }, { "not-allowed", CursorType::No }, { "no-drop", CursorType::No },
+    { "sb_v_double_arrow", CursorType::SizeNS }, { "ns-resize", CursorType::SizeNS }, { "row-resize", CursorType::SizeNS },
+    { "sb_h_double_arrow", CursorType::SizeWE }, { "ew-resize", CursorType::SizeWE }, { "col-resize", CursorType::SizeWE },
+    { "bd_double_arrow", CursorType::SizeNWSE }, { "nwse-resize", CursorType::SizeNWSE }, { "size_fdiag", CursorType::SizeNWSE },
+    { "fd_double_arrow", CursorType::SizeNESW }, { "nesw-resize", CursorType::SizeNESW }, { "size_bdiag", CursorType::SizeNESW },
+    { "fleur", CursorType::SizeAll }, { "move", CursorType::SizeAll }, { "all-scroll", CursorType::SizeAll },
+};
+static const size_t kCursorNameCount = sizeof(kCursorNames) / sizeof(kCursorNames[0]);
+
+CursorType ClassifyCursorName(const char* name) {
+    for (size_t i = 0; name && i < kCursorNameCount; i++) {
+        if (strcmp(kCursorNames[i].name, name) == 0) {
+            return kCursorNames[i].shape;
+        }
+    }
+    return CursorType::Custom;
+}
+
+// XFixes reports every cursor change on the root window with the cursor's name atom, so the
+// shape is a lookup in an atom table interned once per connection.
+class XFixesCursorSource : public CursorShapeSource {
+public:
+    ~XFixesCursorSource() override {
+        Stop();
+    }
+
+    const char* Start(ChangeCallback onChange, void* context) override {
+        if (watchThread.joinable()) {
+            return nullptr;
+        }
+
+        display = XOpenDisplay(nullptr);
+        if (!display) {
+            return "Cannot open the X display";
+        }
+        int errorBase;
+        if (!XFixesQueryExtension(display, &eventBase, &errorBase)) {
+            XCloseDisplay(display);
+            display = nullptr;
+            return "The XFixes extension is not available";
+        }
+        if (pipe(stopPipe) != 0) {
+            XCloseDisplay(display);
+            display = nullptr;
+            return "Failed to create the cursor watcher stop pipe";
+        }
+
+        BuildAtomTable();
+        XFixesSelectCursorInput(display, DefaultRootWindow(display), XFixesDisplayCursorNotifyMask);
+
+        callback = onChange;
+        callbackContext = context;
+        last = CursorType::Count;
+        XFixesCursorImage* image = XFixesGetCursorImage(display);
+        if (image) {
+            Report(image->atom);
+            XFree(image);
+        }
+
+        watchThread = std::thread(&XFixesCursorSource::Run, this);
+        return nullptr;
+    }
+
+    void Stop() override {
+        if (!watchThread.joinable()) {
+            return;
+        }
+        char stop = 0;
+        (void)!write(stopPipe[1], &stop, 1);
+        watchThread.join();
+
+        close(stopPipe[0]);
+        close(stopPipe[1]);
+        XCloseDisplay(display);
+        display = nullptr;
+    }
+
+private:
+    void BuildAtomTable() {
+        char* names[kCursorNameCount];
+        Atom atoms[kCursorNameCount];
+        for (size_t i = 0; i < kCursorNameCount; i++) {
+            names[i] = const_cast<char*>(kCursorNames[i].name);
+        }
+        XInternAtoms(display, names, (int)kCursorNameCount, False, atoms);
+
+        atomTable.clear();
+        for (size_t i = 0; i < kCursorNameCount; i++) {
+            atomTable.push_back({ atoms[i], kCursorNames[i].shape });
+        }
+        std::sort(atomTable.begin(), atomTable.end());
+    }
+
+    void Report(Atom name) {
+        CursorType shape = CursorType::Custom;
+        auto entry = std::lower_bound(atomTable.begin(), atomTable.end(), std::make_pair(name, (CursorType)0));
+        if (name != None && entry != atomTable.end() && entry->first == name) {
+            shape = entry->second;
+        }
+        if (shape != last) {
+            last = shape;
+            callback(shape, callbackContext);
+        }
+    }
+
+    void Run() {
+        pollfd fds[2] = {
+            { ConnectionNumber(display), POLLIN, 0 },
+            { stopPipe[0], POLLIN, 0 },
+        };
+
+        for (;;) {
+            while (XPending(display) > 0) {
+                XEvent event;
+                XNextEvent(display, &event);
+                if (event.type == eventBase + XFixesCursorNotify) {
+                    Report(((XFixesCursorNotifyEvent*)&event)->cursor_name);
+                }
+            }
+            if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+                break;
+            }
+            if (fds[1].revents & POLLIN) {
+                break;
+            }
+        }
+    }
+
+    Display* display = nullptr;
+    int eventBase = 0;
+    int stopPipe[2] = { -1, -1 };
+    std::vector<std::pair<Atom, CursorType>> atomTable;
+    std::thread watchThread;
+    ChangeCallback callback = nullptr;
+    void* callbackContext = nullptr;
+    CursorType last = CursorType::Count;
+};
+
+std::unique_ptr<CursorShapeSource> CreateCursorShapeSource() {
+    return std::unique_ptr<CursorShapeSource>(new XFixesCursorSource());
+}
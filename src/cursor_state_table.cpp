@@ -0,0 +1,203 @@
+#include "cursor_state_table.h"
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kTableMagic[8] = { 'O', 'R', 'X', 'C', 'T', 'A', 'B', 0 };
+// A reader gives up on a slot after this many torn or in-progress reads and skips it for the
+// current snapshot; the writer holds a slot odd for a few stores only, unless it was preempted.
+static const int kMaxReadAttempts = 64;
+
+static_assert(sizeof(CursorSlotState) % 8 == 0, "slot payload is copied as 64-bit words");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+const char* CursorStateTable::Create(const std::string& name) {
+    Close();
+#ifdef _WIN32
+    std::string fullName = "Local\\" + name;
+    mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)sizeof(Layout), fullName.c_str());
+    if (!mapping_) {
+        return "Failed to create cursor table";
+    }
+    layout_ = (Layout*)MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Layout));
+#else
+    std::string fullName = "/" + name;
+    shm_unlink(fullName.c_str());
+    int fd = shm_open(fullName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return "Failed to create cursor table";
+    }
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, sizeof(Layout)) == 0) {
+        mapped = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(fullName.c_str());
+        return "Failed to map cursor table";
+    }
+    layout_ = (Layout*)mapped;
+#endif
+    if (!layout_) {
+        Close();
+        return "Failed to map cursor table";
+    }
+
+    name_ = name;
+    owner_ = true;
+    memset((void*)layout_, 0, sizeof(Layout));
+    layout_->header.version = kCursorTableVersion;
+    layout_->header.slotCount = (uint32_t)kCursorTableSlots;
+    layout_->header.slotSize = (uint32_t)sizeof(Slot);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(layout_->header.magic, kTableMagic, sizeof(kTableMagic));
+    return nullptr;
+}
+
+const char* CursorStateTable::Open(const std::string& name) {
+    Close();
+#ifdef _WIN32
+    std::string fullName = "Local\\" + name;
+    mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, fullName.c_str());
+    if (!mapping_) {
+        return "Cursor table not found";
+    }
+    layout_ = (Layout*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, sizeof(Layout));
+#else
+    std::string fullName = "/" + name;
+    int fd = shm_open(fullName.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return "Cursor table not found";
+    }
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Layout)) {
+        mapped = mmap(nullptr, sizeof(Layout), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    layout_ = mapped == MAP_FAILED ? nullptr : (Layout*)mapped;
+#endif
+    if (!layout_) {
+        Close();
+        return "Failed to map cursor table";
+    }
+
+    const Header& header = layout_->header;
+    if (memcmp(header.magic, kTableMagic, sizeof(kTableMagic)) != 0 || header.version != kCursorTableVersion ||
+        header.slotCount != kCursorTableSlots || header.slotSize != sizeof(Slot)) {
+        Close();
+        return "Incompatible cursor table";
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    name_ = name;
+    return nullptr;
+}
+
+void CursorStateTable::Close() {
+#ifdef _WIN32
+    if (layout_) UnmapViewOfFile(layout_);
+    if (mapping_) CloseHandle(mapping_);
+    mapping_ = nullptr;
+#else
+    if (layout_) munmap((void*)layout_, sizeof(Layout));
+    if (owner_) shm_unlink(("/" + name_).c_str());
+#endif
+    layout_ = nullptr;
+    owner_ = false;
+    name_.clear();
+    for (std::string& owner : owners_) owner.clear();
+}
+
+void CursorStateTable::StoreSlot(Slot& slot, const CursorSlotState& state) {
+    uint64_t words[kSlotWords];
+    memcpy(words, &state, sizeof(words));
+
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kSlotWords; i++) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(seq + 2, std::memory_order_release);
+    layout_->header.writes.fetch_add(1, std::memory_order_release);
+}
+
+bool CursorStateTable::Write(const CursorSlotState& state) {
+    if (!owner_ || !state.id[0]) {
+        return false;
+    }
+    std::string id(state.id, strnlen(state.id, sizeof(state.id)));
+    size_t index = kCursorTableSlots;
+    for (size_t i = 0; i < kCursorTableSlots; i++) {
+        if (owners_[i] == id) {
+            index = i;
+            break;
+        }
+        if (index == kCursorTableSlots && owners_[i].empty()) {
+            index = i;
+        }
+    }
+    if (index == kCursorTableSlots) {
+        return false;
+    }
+
+    owners_[index] = id;
+    StoreSlot(layout_->slots[index], state);
+    return true;
+}
+
+bool CursorStateTable::Remove(const char* id) {
+    if (!owner_) {
+        return false;
+    }
+    for (size_t i = 0; i < kCursorTableSlots; i++) {
+        if (!owners_[i].empty() && owners_[i] == id) {
+            owners_[i].clear();
+            StoreSlot(layout_->slots[i], CursorSlotState());
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t CursorStateTable::Version() const {
+    return layout_ ? layout_->header.writes.load(std::memory_order_acquire) : 0;
+}
+
+bool CursorStateTable::ReadSlot(const Slot& slot, CursorSlotState* state) {
+    uint64_t words[kSlotWords];
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            for (size_t i = 0; i < kSlotWords; i++) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                memcpy(state, words, sizeof(words));
+                state->id[sizeof(state->id) - 1] = 0;
+                state->type[sizeof(state->type) - 1] = 0;
+                return true;
+            }
+        }
+        retries_++;
+    }
+    return false;
+}
+
+size_t CursorStateTable::Snapshot(CursorSlotState* out, size_t capacity) {
+    size_t count = 0;
+    for (size_t i = 0; layout_ && i < kCursorTableSlots && count < capacity; i++) {
+        if (ReadSlot(layout_->slots[i], &out[count]) && (out[count].flags & kCursorSlotActive)) {
+            count++;
+        }
+    }
+    return count;
+}
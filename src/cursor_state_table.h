@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+const uint32_t kCursorTableVersion = 1;
+const size_t kCursorTableSlots = 32;
+
+const uint32_t kCursorSlotActive = 1 << 0;
+const uint32_t kCursorSlotVisible = 1 << 1;
+const uint32_t kCursorSlotFocused = 1 << 2;  // the device that last moved
+
+// One cursor as the overlays draw it. Copied in and out of the table as whole 64-bit words.
+struct CursorSlotState {
+    double x, y;           // desktop coordinates (DIP)
+    uint32_t flags;        // kCursorSlot*
+    uint32_t color;        // 0xRRGGBB
+    uint32_t inputSeq;     // latency-tracking sequence of the move that produced this state
+    uint32_t reserved;
+    char id[32];           // NUL-terminated device id
+    char type[24];         // NUL-terminated cursor type
+};
+
+// Fixed-layout cursor table in named shared memory, written by the main process and read by
+// the overlay renderers without IPC. Each slot is a seqlock: the writer makes the sequence odd,
+// stores the payload, then makes it even again; a reader keeps a copy only when it saw the same
+// even sequence before and after, so it never returns a half-written state. One writer process;
+// any number of readers. The writer side is not thread-safe.
+class CursorStateTable {
+public:
+    CursorStateTable() {}
+    CursorStateTable(const CursorStateTable&) = delete;
+    CursorStateTable& operator=(const CursorStateTable&) = delete;
+    ~CursorStateTable() { Close(); }
+
+    // Writer: creates the named segment, replacing a stale one, and removes it on Close.
+    const char* Create(const std::string& name);
+    // Reader: maps an existing segment read-only.
+    const char* Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return layout_ != nullptr; }
+    const std::string& Name() const { return name_; }
+
+    // Writer: the slot is claimed by id on first write; false when every slot is taken.
+    bool Write(const CursorSlotState& state);
+    bool Remove(const char* id);
+
+    // Bumped after every write; an unchanged version means the last snapshot is still current.
+    uint32_t Version() const;
+    // Copies every active slot, each one consistent. A slot whose writer stalls mid-write (or
+    // died) is left out of this snapshot rather than waited on.
+    size_t Snapshot(CursorSlotState* out, size_t capacity);
+    uint64_t Retries() const { return retries_; }
+
+private:
+    static const size_t kSlotWords = sizeof(CursorSlotState) / 8;
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq;
+        uint32_t reserved;
+        std::atomic<uint64_t> words[kSlotWords];
+    };
+
+    struct alignas(64) Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t slotCount;
+        uint32_t slotSize;
+        std::atomic<uint32_t> writes;
+    };
+
+    struct Layout {
+        Header header;
+        Slot slots[kCursorTableSlots];
+    };
+
+    bool ReadSlot(const Slot& slot, CursorSlotState* state);
+    void StoreSlot(Slot& slot, const CursorSlotState& state);
+
+    std::string name_;
+    bool owner_ = false;
+    Layout* layout_ = nullptr;
+    std::string owners_[kCursorTableSlots];  // writer only
+    uint64_t retries_ = 0;
+#ifdef _WIN32
+    HANDLE mapping_ = nullptr;
+#endif
+};
@@ -1,5 +1,6 @@
 import { ChildProcess, spawn } from 'child_process';
 import * as path from 'path';
+import { RawInputModuleInterface } from './types';
 
 export class CursorTypeDetector {
   private currentCursorType: string = 'Arrow';
@@ -7,6 +8,7 @@ export class CursorTypeDetector {
   private detectionInterval: NodeJS.Timeout | null = null;
   private callbacks: Set<(newType: string) => void> = new Set();
   private powershellProcess?: ChildProcess;
+  private nativeModule: RawInputModuleInterface | null = null;
   private powershellScript: string;
 
   private readonly cursorFileMap: Record<string, string> = {
@@ -147,11 +149,21 @@ while ($true) {
 `;
   }
 
-  public start(): void {
+  public start(nativeModule?: RawInputModuleInterface | null): void {
     if (this.isDetecting) {
       return;
     }
 
+    // The addon reports shape changes from OS notifications; PowerShell polling is the fallback.
+    if (nativeModule?.watchCursorShape) {
+      try {
+        nativeModule.watchCursorShape((newType: string) => this.updateCursorType(newType));
+        this.nativeModule = nativeModule;
+        this.isDetecting = true;
+        return;
+      } catch (error) {}
+    }
+
     try {
       this.isDetecting = true;
 
@@ -166,14 +178,7 @@ while ($true) {
         buffer = lines.pop() || '';
 
         for (const line of lines) {
-          const output = line.trim();
-          if (output && output !== this.currentCursorType && output !== '') {
-            this.currentCursorType = output;
-
-            for (const callback of this.callbacks) {
-              callback(output);
-            }
-          }
+          this.updateCursorType(line.trim());
         }
       });
 
@@ -193,6 +198,17 @@ while ($true) {
     }
   }
 
+  private updateCursorType(newType: string): void {
+    if (!newType || newType === this.currentCursorType) {
+      return;
+    }
+
+    this.currentCursorType = newType;
+    for (const callback of this.callbacks) {
+      callback(newType);
+    }
+  }
+
   public stop(): void {
     if (!this.isDetecting) {
       return;
@@ -200,6 +216,11 @@ while ($true) {
 
     this.isDetecting = false;
 
+    if (this.nativeModule) {
+      this.nativeModule.unwatchCursorShape?.();
+      this.nativeModule = null;
+    }
+
     if (this.powershellProcess) {
       this.powershellProcess.kill();
       this.powershellProcess = undefined;
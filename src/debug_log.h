@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+
+// Input-path debug logging. Compiled out unless ORIONIX_DEBUG_LOG is defined
+// (node-gyp rebuild --orionix_debug_log=1), and even then silent until setDebugLogging(true), so
+// release builds pay nothing and debug builds only pay a relaxed load per call site.
+#ifdef ORIONIX_DEBUG_LOG
+#include <cstdarg>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+inline std::atomic<bool>& DebugLogFlag() {
+    static std::atomic<bool> enabled{false};
+    return enabled;
+}
+
+inline void DebugLogWrite(const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+#ifdef _WIN32
+    OutputDebugStringA(line);
+#else
+    fputs(line, stderr);
+#endif
+}
+
+#define DEBUG_LOG(...)                                                    \
+    do {                                                                  \
+        if (DebugLogFlag().load(std::memory_order_relaxed)) {            \
+            DebugLogWrite(__VA_ARGS__);                                   \
+        }                                                                 \
+    } while (0)
+
+inline bool EnableDebugLog(bool enabled) {
+    DebugLogFlag().store(enabled, std::memory_order_relaxed);
+    return true;
+}
+#else
+#define DEBUG_LOG(...) \
+    do {               \
+    } while (0)
+
+// False: this build has no debug logging to turn on.
+inline bool EnableDebugLog(bool) { return false; }
+#endif
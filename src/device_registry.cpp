@@ -0,0 +1,141 @@
+#include "device_registry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "device_vendors.h"
+
+const char* DeviceBusName(DeviceBus bus) {
+    switch (bus) {
+        case DeviceBus::Usb: return "usb";
+        case DeviceBus::Bluetooth: return "bluetooth";
+        case DeviceBus::Ps2: return "ps2";
+        case DeviceBus::Virtual: return "virtual";
+        default: return "unknown";
+    }
+}
+
+const char* DeviceKindName(DeviceKind kind) {
+    return kind == DeviceKind::Touchpad ? "touchpad" : "mouse";
+}
+
+static bool Contains(const std::string& haystack, const char* needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+// Reads up to `digits` hex digits following `tag`, or returns -1.
+static int ReadHexField(const std::string& path, const char* tag, int digits) {
+    size_t pos = path.find(tag);
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    pos += strlen(tag);
+
+    int value = 0;
+    int read = 0;
+    for (; read < digits && pos + read < path.size(); read++) {
+        char c = path[pos + read];
+        if (!isxdigit((unsigned char)c)) {
+            break;
+        }
+        value = value * 16 + (isdigit((unsigned char)c) ? c - '0' : (toupper((unsigned char)c) - 'A' + 10));
+    }
+    return read > 0 ? value : -1;
+}
+
+DeviceIdentity ParseDevicePath(const std::string& path) {
+    std::string upper(path);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return (char)toupper(c); });
+
+    DeviceIdentity identity;
+    int vendorId = ReadHexField(upper, "VID_", 4);
+    int productId = ReadHexField(upper, "PID_", 4);
+    int interfaceNumber = ReadHexField(upper, "MI_", 2);
+    if (vendorId < 0) {
+        // Bluetooth HID paths use _VID&ssssvvvv_PID&pppp, where ssss is the vendor id source.
+        vendorId = ReadHexField(upper, "_VID&", 8);
+        vendorId = vendorId < 0 ? -1 : vendorId & 0xFFFF;
+        productId = ReadHexField(upper, "_PID&", 4);
+    }
+    identity.vendorId = vendorId < 0 ? 0 : (uint16_t)vendorId;
+    identity.productId = productId < 0 ? 0 : (uint16_t)productId;
+    identity.interfaceNumber = (int16_t)interfaceNumber;
+
+    if (Contains(upper, "{00001124-") || Contains(upper, "{00001812-") || Contains(upper, "_VID&")) {
+        identity.bus = DeviceBus::Bluetooth;
+    } else if (Contains(upper, "RDP_MOU") || Contains(upper, "TERMINPUT") || Contains(upper, "VMBUS")) {
+        identity.bus = DeviceBus::Virtual;
+    } else if (Contains(upper, "PS2") || Contains(upper, "ACPI#") || Contains(upper, "PNP0F")) {
+        identity.bus = DeviceBus::Ps2;
+    } else if (Contains(upper, "HID")) {
+        identity.bus = DeviceBus::Usb;
+    }
+
+    const ProductEntry* product = FindProduct(identity.vendorId, identity.productId);
+    if ((product && product->touchpad) || identity.vendorId == 0x06CB ||
+        Contains(upper, "TOUCHPAD") || Contains(upper, "TRACKPAD") || Contains(upper, "SYNAPTICS")) {
+        identity.kind = DeviceKind::Touchpad;
+    }
+    return identity;
+}
+
+std::string DescribeDevice(const DeviceIdentity& identity) {
+    if (const ProductEntry* product = FindProduct(identity.vendorId, identity.productId)) {
+        return product->name;
+    }
+    if (identity.kind == DeviceKind::Touchpad) {
+        return "Trackpad";
+    }
+    switch (identity.bus) {
+        case DeviceBus::Ps2: return "PS/2 Mouse";
+        case DeviceBus::Virtual: return "Virtual Mouse";
+        default: break;
+    }
+    if (const VendorEntry* vendor = FindVendor(identity.vendorId)) {
+        return std::string(vendor->name) + " Mouse";
+    }
+    switch (identity.bus) {
+        case DeviceBus::Usb: return "USB Mouse";
+        case DeviceBus::Bluetooth: return "Bluetooth Mouse";
+        default: return "Generic Mouse";
+    }
+}
+
+void DeviceRegistry::Add(const InputDeviceInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(devices_.begin(), devices_.end(), [&](const InputDeviceInfo& d) { return d.id == info.id; });
+    if (it != devices_.end()) {
+        *it = info;
+    } else {
+        devices_.push_back(info);
+    }
+}
+
+void DeviceRegistry::Remove(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(devices_.begin(), devices_.end(), [&](const InputDeviceInfo& d) { return d.id == id; });
+    if (it != devices_.end()) {
+        devices_.erase(it);
+    }
+}
+
+void DeviceRegistry::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_.clear();
+}
+
+std::vector<InputDeviceInfo> DeviceRegistry::Snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return devices_;
+}
+
+bool DeviceRegistry::Find(uint32_t id, InputDeviceInfo* info) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(devices_.begin(), devices_.end(), [&](const InputDeviceInfo& d) { return d.id == id; });
+    if (it == devices_.end()) {
+        return false;
+    }
+    *info = *it;
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class DeviceBus : uint8_t {
+    Unknown,
+    Usb,
+    Bluetooth,
+    Ps2,
+    Virtual
+};
+
+enum class DeviceKind : uint8_t {
+    Mouse,
+    Touchpad
+};
+
+struct DeviceIdentity {
+    uint16_t vendorId = 0;
+    uint16_t productId = 0;
+    int16_t interfaceNumber = -1;
+    DeviceBus bus = DeviceBus::Unknown;
+    DeviceKind kind = DeviceKind::Mouse;
+};
+
+struct InputDeviceInfo {
+    uint32_t id;
+    uint64_t handle;
+    std::string name;
+    std::string path;
+    DeviceIdentity identity;
+};
+
+const char* DeviceBusName(DeviceBus bus);
+const char* DeviceKindName(DeviceKind kind);
+
+// Parses a Windows device interface path such as \\?\HID#VID_046D&PID_C52B&MI_01&Col01#...
+DeviceIdentity ParseDevicePath(const std::string& path);
+// Display name from the vendor/product tables, e.g. "Logitech Mouse" or "Trackpad".
+std::string DescribeDevice(const DeviceIdentity& identity);
+
+// Connected devices of one pipeline (see InputPipeline::RegisterDevice).
+class DeviceRegistry {
+public:
+    // Input thread.
+    void Add(const InputDeviceInfo& info);
+    void Remove(uint32_t id);
+    // Called when a backend stops; ids stay reserved for their handles.
+    void Clear();
+
+    // Any thread: connected devices as of the last arrival/removal.
+    std::vector<InputDeviceInfo> Snapshot() const;
+    bool Find(uint32_t id, InputDeviceInfo* info) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<InputDeviceInfo> devices_;
+};
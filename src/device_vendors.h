@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct VendorEntry {
+    uint16_t vendorId;
+    const char* name;
+};
+
+struct ProductEntry {
+    uint32_t key;  // vendorId << 16 | productId
+    const char* name;
+    bool touchpad;
+};
+
+// Sorted by vendorId; checked at compile time below.
+constexpr VendorEntry kVendors[] = {
+    { 0x03F0, "HP" },
+    { 0x0458, "Genius" },
+    { 0x045E, "Microsoft" },
+    { 0x0461, "Primax" },
+    { 0x046D, "Logitech" },
+    { 0x047D, "Kensington" },
+    { 0x0483, "STMicroelectronics" },
+    { 0x04B4, "Cypress" },
+    { 0x04CA, "Lite-On" },
+    { 0x04D9, "Holtek" },
+    { 0x04E8, "Samsung" },
+    { 0x04F2, "Chicony" },
+    { 0x04F3, "Elan" },
+    { 0x054C, "Sony" },
+    { 0x056A, "Wacom" },
+    { 0x05AC, "Apple" },
+    { 0x05FE, "Chic Technology" },
+    { 0x0627, "QEMU" },
+    { 0x062A, "MosArt" },
+    { 0x06CB, "Synaptics" },
+    { 0x0738, "Mad Catz" },
+    { 0x093A, "Pixart" },
+    { 0x0951, "HyperX" },
+    { 0x09DA, "A4Tech" },
+    { 0x0A5C, "Broadcom" },
+    { 0x0A81, "Chesen" },
+    { 0x0B05, "ASUS" },
+    { 0x0C45, "Microdia" },
+    { 0x0D62, "Darfon" },
+    { 0x0E0F, "VMware" },
+    { 0x1038, "SteelSeries" },
+    { 0x10C4, "Silicon Labs" },
+    { 0x12D1, "Huawei" },
+    { 0x1462, "MSI" },
+    { 0x1532, "Razer" },
+    { 0x17EF, "Lenovo" },
+    { 0x1915, "Nordic Semiconductor" },
+    { 0x1A2C, "China Resource Semico" },
+    { 0x1A81, "Holtek" },
+    { 0x1B1C, "Corsair" },
+    { 0x1BCF, "Sunplus" },
+    { 0x1C4F, "SiGma Micro" },
+    { 0x1D57, "Xenta" },
+    { 0x1E7D, "ROCCAT" },
+    { 0x24AE, "Rapoo" },
+    { 0x2516, "Cooler Master" },
+    { 0x258A, "SINO WEALTH" },
+    { 0x25A7, "Areson" },
+    { 0x2717, "Xiaomi" },
+    { 0x2DC8, "8BitDo" },
+    { 0x3434, "Keychron" },
+    { 0x413C, "Dell" },
+    { 0x80EE, "VirtualBox" },
+};
+
+// Sorted by key; only products whose name says more than "<Vendor> Mouse".
+constexpr ProductEntry kProducts[] = {
+    { 0x046DC52B, "Logitech Wireless Mouse", false },  // Unifying receiver
+    { 0x046DC534, "Logitech Wireless Mouse", false },  // Nano receiver
+    { 0x046DC548, "Logitech Wireless Mouse", false },  // Bolt receiver
+    { 0x05AC0265, "Apple Magic Trackpad", true },
+};
+
+template <typename T, size_t N, typename Key>
+constexpr bool IsSortedBy(const T (&table)[N], Key key) {
+    for (size_t i = 1; i < N; i++) {
+        if (!(key(table[i - 1]) < key(table[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(IsSortedBy(kVendors, [](const VendorEntry& e) { return e.vendorId; }), "kVendors must be sorted");
+static_assert(IsSortedBy(kProducts, [](const ProductEntry& e) { return e.key; }), "kProducts must be sorted");
+
+constexpr const VendorEntry* FindVendor(uint16_t vendorId) {
+    size_t low = 0, high = sizeof(kVendors) / sizeof(kVendors[0]);
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (kVendors[mid].vendorId == vendorId) return &kVendors[mid];
+        if (kVendors[mid].vendorId < vendorId) low = mid + 1;
+        else high = mid;
+    }
+    return nullptr;
+}
+
+constexpr const ProductEntry* FindProduct(uint16_t vendorId, uint16_t productId) {
+    const uint32_t key = (uint32_t)vendorId << 16 | productId;
+    size_t low = 0, high = sizeof(kProducts) / sizeof(kProducts[0]);
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (kProducts[mid].key == key) return &kProducts[mid];
+        if (kProducts[mid].key < key) low = mid + 1;
+        else high = mid;
+    }
+    return nullptr;
+}
+
+static_assert(FindVendor(0x046D)->vendorId == 0x046D && !FindVendor(0x0001), "vendor lookup");
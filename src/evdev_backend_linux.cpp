@@ -0,0 +1,524 @@
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cursor_lock.h"
+#include "hotplug_debouncer.h"
+#include "input_backend.h"
+#include "input_pipeline.h"
+
+// Same bit values as the Win32 RI_MOUSE_* button flags so JS sees identical flags on both backends.
+static const uint16_t kLeftDown = 0x0001;
+static const uint16_t kLeftUp = 0x0002;
+static const uint16_t kRightDown = 0x0004;
+static const uint16_t kRightUp = 0x0008;
+static const uint16_t kMiddleDown = 0x0010;
+static const uint16_t kMiddleUp = 0x0020;
+
+static const char* kInputDirectory = "/dev/input";
+static const size_t kMaxFrameButtons = 8;
+// Records taken per read(); a mouse at 8 kHz queues a few frames of three records between wakeups.
+static const size_t kReadRecords = 64;
+
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define NBITS(x) ((((x) - 1) / BITS_PER_LONG) + 1)
+
+static bool TestBit(const unsigned long* bits, int bit) {
+    return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1;
+}
+
+static bool IsRelativePointer(int fd) {
+    unsigned long evBits[NBITS(EV_MAX)] = {};
+    unsigned long relBits[NBITS(REL_MAX)] = {};
+
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(evBits)), evBits) < 0 ||
+        ioctl(fd, EVIOCGBIT(EV_REL, sizeof(relBits)), relBits) < 0) {
+        return false;
+    }
+    return TestBit(evBits, EV_REL) && TestBit(relBits, REL_X) && TestBit(relBits, REL_Y);
+}
+
+// Empty when the kernel has no name; callers fall back to DescribeDevice.
+static std::string ReadDeviceName(int fd) {
+    char name[128] = {};
+    if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) <= 0) {
+        return std::string();
+    }
+    return name;
+}
+
+static DeviceIdentity ReadDeviceIdentity(int fd, const std::string& name) {
+    DeviceIdentity identity;
+    input_id id = {};
+    if (ioctl(fd, EVIOCGID, &id) == 0) {
+        identity.vendorId = id.vendor;
+        identity.productId = id.product;
+        switch (id.bustype) {
+            case BUS_USB: identity.bus = DeviceBus::Usb; break;
+            case BUS_BLUETOOTH: identity.bus = DeviceBus::Bluetooth; break;
+            case BUS_I8042: identity.bus = DeviceBus::Ps2; break;
+            case BUS_VIRTUAL: identity.bus = DeviceBus::Virtual; break;
+            default: break;
+        }
+    }
+    if (strcasestr(name.c_str(), "touchpad") || strcasestr(name.c_str(), "trackpad")) {
+        identity.kind = DeviceKind::Touchpad;
+    }
+    return identity;
+}
+
+// Opens path when it is a relative pointer device; handle is the node's device number.
+static int OpenPointerDevice(const std::string& path, uint64_t* handle) {
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !IsRelativePointer(fd)) {
+        close(fd);
+        return -1;
+    }
+
+    *handle = (uint64_t)st.st_rdev;
+    return fd;
+}
+
+// ORIONIX_INPUT_DIR points the backend at a stand-in directory, e.g. to exercise hot-plug in a temp dir.
+static std::string InputDirectory() {
+    const char* override = getenv("ORIONIX_INPUT_DIR");
+    return override && *override ? override : kInputDirectory;
+}
+
+// ORIONIX_EVDEV_READ_RECORDS=1 restores one read() per record, for comparison benchmarks.
+static size_t ReadRecords() {
+    const char* override = getenv("ORIONIX_EVDEV_READ_RECORDS");
+    long records = override ? atol(override) : 0;
+    return records >= 1 && records <= (long)kReadRecords ? (size_t)records : kReadRecords;
+}
+
+template <typename Fn>
+static void ForEachEventNode(const std::string& directory, Fn fn) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "event", 5) == 0) {
+            fn(directory + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+struct EvdevDevice {
+    int fd;
+    uint32_t id;
+    uint64_t handle;
+    // Closed and announced; erased once the current epoll batch is done.
+    bool removed;
+    int x, y;
+    int frameDx, frameDy;
+    EventAction frameButtons[kMaxFrameButtons];
+    uint16_t frameFlags[kMaxFrameButtons];
+    size_t frameButtonCount;
+    bool dropping;
+};
+
+class EvdevBackend : public InputBackend {
+public:
+    explicit EvdevBackend(InputPipeline& pipeline)
+        : pipeline(pipeline), inputDirectory(InputDirectory()), readRecords(ReadRecords()) {}
+
+    ~EvdevBackend() override {
+        CloseFds();
+    }
+
+    const char* Start() override {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) {
+            return "Failed to create wakeup eventfd";
+        }
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            CloseFds();
+            return "Failed to create epoll instance";
+        }
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+        // Hot-plug is best effort: without the watch, devices present at start still work.
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0 && inotify_add_watch(inotifyFd, inputDirectory.c_str(),
+                IN_CREATE | IN_ATTRIB | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM) >= 0) {
+            ev.data.ptr = &inotifyFd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, inotifyFd, &ev);
+        }
+
+        stopRequested = false;
+        inputThread = std::thread([this]() { Run(); });
+        return nullptr;
+    }
+
+    // The flag cannot be lost the way a command in a full pipe could; the eventfd write only
+    // fails when the counter is already non-zero, i.e. a wakeup is pending anyway.
+    void Stop() override {
+        stopRequested = true;
+        WakeInputThread();
+        inputThread.join();
+        CloseFds();
+    }
+
+    // Every wakeup ends in FlushProducer.
+    void RequestFlush() override {
+        WakeInputThread();
+    }
+
+    void InjectMove(uint64_t handle, int dx, int dy) override {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            injected.push_back({ handle, dx, dy });
+        }
+        WakeInputThread();
+    }
+
+private:
+    struct Injection {
+        uint64_t handle;
+        int dx, dy;
+    };
+
+    void WakeInputThread() {
+        const uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+
+    void CloseFds() {
+        if (epollFd >= 0) {
+            close(epollFd);
+            epollFd = -1;
+        }
+        if (inotifyFd >= 0) {
+            close(inotifyFd);
+            inotifyFd = -1;
+        }
+        if (wakeFd >= 0) {
+            close(wakeFd);
+            wakeFd = -1;
+        }
+    }
+
+    // Input thread from here on.
+    void Run() {
+        ForEachEventNode(inputDirectory, [this](const std::string& path) { AddDevice(path); });
+        pipeline.FlushProducer();
+        pipeline.WakeConsumer();
+
+        epoll_event events[16];
+        while (!stopRequested) {
+            int64_t wait = pipeline.ProducerWaitMicros();
+            int64_t settle = hotplug.WaitMicros(NowMicros());
+            if (settle >= 0) {
+                wait = wait < 0 ? settle : std::min(wait, settle);
+            }
+            int timeout = wait < 0 ? -1 : (int)((wait + 999) / 1000);
+
+            int count = epoll_wait(epollFd, events, 16, timeout);
+            if (count < 0 && errno != EINTR) {
+                break;
+            }
+
+            for (int i = 0; i < count; i++) {
+                if (events[i].data.ptr == nullptr) {
+                    RunCommands();
+                } else if (events[i].data.ptr == &inotifyFd) {
+                    HandleNodeChanges();
+                } else {
+                    EvdevDevice& device = *(EvdevDevice*)events[i].data.ptr;
+                    if (!device.removed) {
+                        ReadDevice(device);
+                    }
+                }
+            }
+            ReapRemovedDevices();
+
+            hotplug.TakeSettled(NowMicros(), [this](uint64_t key) {
+                auto it = pendingNodes.find(key);
+                if (it != pendingNodes.end()) {
+                    AddDevice(it->second);
+                    pendingNodes.erase(it);
+                }
+            });
+            pipeline.FlushProducer();
+            pipeline.WakeConsumer();
+        }
+
+        for (auto& entry : devices) {
+            if (!entry.second.removed) {
+                close(entry.second.fd);
+            }
+        }
+        devices.clear();
+        nodeHandles.clear();
+        pendingNodes.clear();
+        pipeline.Registry().Clear();
+    }
+
+    // Node creation and its permission fix-up by udev arrive separately; both restart the settle
+    // window, and the node is only opened once it has been quiet.
+    void HandleNodeChanges() {
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t size = read(inotifyFd, buffer, sizeof(buffer));
+            if (size <= 0) {
+                return;
+            }
+            for (char* p = buffer; p < buffer + size;) {
+                const inotify_event* event = (const inotify_event*)p;
+                p += sizeof(inotify_event) + event->len;
+                if (event->len == 0 || strncmp(event->name, "event", 5) != 0) {
+                    continue;
+                }
+
+                std::string path = inputDirectory + "/" + event->name;
+                uint64_t key = std::hash<std::string>()(path);
+                if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    hotplug.Removed(key);
+                    pendingNodes.erase(key);
+                    auto node = nodeHandles.find(path);
+                    if (node != nodeHandles.end() && devices.count(node->second)) {
+                        RemoveDevice(devices[node->second]);
+                    }
+                } else {
+                    pendingNodes[key] = path;
+                    hotplug.Arrived(key, NowMicros());
+                }
+            }
+        }
+    }
+
+    void AddDevice(const std::string& path) {
+        uint64_t handle;
+        int fd = OpenPointerDevice(path, &handle);
+        if (fd < 0) {
+            return;
+        }
+        if (devices.count(handle)) {
+            close(fd);
+            return;
+        }
+
+        nodeHandles[path] = handle;
+        EvdevDevice& device = devices[handle];
+        memset(&device, 0, sizeof(device));
+        device.fd = fd;
+        device.handle = handle;
+        std::string name = ReadDeviceName(fd);
+        device.id = pipeline.RegisterDevice(handle, name, path, ReadDeviceIdentity(fd, name));
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = &device;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+
+        pipeline.IngestEvent(MakeEvent(device.id, EventType::Device, EventAction::Added, device.x, device.y, 0, 0, 0));
+    }
+
+    // Later events of the current epoll batch may still carry the device's address, so the entry
+    // itself is only erased by ReapRemovedDevices once the batch is done.
+    void RemoveDevice(EvdevDevice& device) {
+        if (device.removed) {
+            return;
+        }
+        device.removed = true;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, device.fd, nullptr);
+        close(device.fd);
+        pipeline.Registry().Remove(device.id);
+        pipeline.IngestEvent(MakeEvent(device.id, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0));
+        pipeline.ReleaseDevice(device.id);
+
+        for (auto node = nodeHandles.begin(); node != nodeHandles.end(); ++node) {
+            if (node->second == device.handle) {
+                nodeHandles.erase(node);
+                break;
+            }
+        }
+        removedHandles.push_back(device.handle);
+    }
+
+    void ReapRemovedDevices() {
+        for (uint64_t handle : removedHandles) {
+            devices.erase(handle);
+        }
+        removedHandles.clear();
+    }
+
+    void RunCommands() {
+        uint64_t count;
+        ssize_t size = read(wakeFd, &count, sizeof(count));
+        (void)size;
+
+        std::vector<Injection> pending;
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            pending.swap(injected);
+        }
+        for (const Injection& injection : pending) {
+            uint32_t deviceId = pipeline.InternDevice(injection.handle, "Simulated Mouse");
+            pipeline.IngestEvent(MakeEvent(deviceId, EventType::Move, EventAction::None,
+                500 + injection.dx, 500 + injection.dy, injection.dx, injection.dy, 0));
+        }
+    }
+
+    // evdev only hands out whole records, so a read that comes back short has drained the device
+    // and the next records will raise EPOLLIN again; no trailing EAGAIN read is needed.
+    void ReadDevice(EvdevDevice& device) {
+        for (;;) {
+            ssize_t size = read(device.fd, readBuffer, readRecords * sizeof(input_event));
+            pipeline.CountRead();
+            if (size >= (ssize_t)sizeof(input_event)) {
+                size_t count = (size_t)size / sizeof(input_event);
+                pipeline.CountMessages(count);
+                for (size_t i = 0; i < count; i++) {
+                    HandleInputEvent(device, readBuffer[i]);
+                }
+                if (count < readRecords) {
+                    return;
+                }
+                continue;
+            }
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            if (size < 0 && errno == EAGAIN) {
+                return;
+            }
+            RemoveDevice(device);
+            return;
+        }
+    }
+
+    void PushFrameButton(EvdevDevice& device, EventAction action, uint16_t flag) {
+        if (device.frameButtonCount < kMaxFrameButtons) {
+            device.frameButtons[device.frameButtonCount] = action;
+            device.frameFlags[device.frameButtonCount] = flag;
+            device.frameButtonCount++;
+        }
+    }
+
+    void HandleInputEvent(EvdevDevice& device, const input_event& event) {
+        switch (event.type) {
+            case EV_REL:
+                if (event.code == REL_X) device.frameDx += event.value;
+                if (event.code == REL_Y) device.frameDy += event.value;
+                break;
+            case EV_KEY: {
+                if (event.value == 2) {
+                    break;
+                }
+                bool down = event.value == 1;
+                if (event.code == BTN_LEFT)   PushFrameButton(device, down ? EventAction::LeftDown : EventAction::LeftUp, down ? kLeftDown : kLeftUp);
+                if (event.code == BTN_RIGHT)  PushFrameButton(device, down ? EventAction::RightDown : EventAction::RightUp, down ? kRightDown : kRightUp);
+                if (event.code == BTN_MIDDLE) PushFrameButton(device, down ? EventAction::MiddleDown : EventAction::MiddleUp, down ? kMiddleDown : kMiddleUp);
+                break;
+            }
+            case EV_SYN:
+                if (event.code == SYN_DROPPED) {
+                    device.dropping = true;
+                } else if (event.code == SYN_REPORT) {
+                    if (!device.dropping) {
+                        EmitFrame(device);
+                    }
+                    device.dropping = false;
+                    device.frameDx = 0;
+                    device.frameDy = 0;
+                    device.frameButtonCount = 0;
+                }
+                break;
+        }
+    }
+
+    // The frame's motion goes first so its buttons carry the position they happened at.
+    void EmitFrame(EvdevDevice& device) {
+        if (device.frameDx != 0 || device.frameDy != 0) {
+            device.x += device.frameDx;
+            device.y += device.frameDy;
+            pipeline.IngestEvent(MakeEvent(device.id, EventType::Move, EventAction::None, device.x, device.y, device.frameDx, device.frameDy, 0));
+        }
+
+        for (size_t i = 0; i < device.frameButtonCount; i++) {
+            pipeline.IngestEvent(MakeEvent(device.id, EventType::Button, device.frameButtons[i], device.x, device.y, 0, 0, device.frameFlags[i]));
+        }
+    }
+
+    InputPipeline& pipeline;
+    std::string inputDirectory;
+    size_t readRecords;
+    input_event readBuffer[kReadRecords];
+    std::thread inputThread;
+    int epollFd = -1;
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> stopRequested{false};
+    std::mutex commandMutex;
+    std::vector<Injection> injected;
+    std::map<uint64_t, EvdevDevice> devices;
+    std::map<std::string, uint64_t> nodeHandles;
+    std::map<uint64_t, std::string> pendingNodes;
+    std::vector<uint64_t> removedHandles;
+    HotplugDebouncer hotplug;
+};
+
+std::unique_ptr<InputBackend> CreateInputBackend(InputPipeline& pipeline) {
+    return std::unique_ptr<InputBackend>(new EvdevBackend(pipeline));
+}
+
+// evdev sits below the display server; warping its cursor would need an X11 or compositor client.
+std::unique_ptr<CursorSink> CreateSystemCursorSink() {
+    return nullptr;
+}
+
+std::vector<InputDeviceInfo> EnumerateInputDevices() {
+    std::vector<InputDeviceInfo> result;
+
+    ForEachEventNode(InputDirectory(), [&result](const std::string& path) {
+        uint64_t handle;
+        int fd = OpenPointerDevice(path, &handle);
+        if (fd < 0) {
+            return;
+        }
+        InputDeviceInfo device;
+        device.id = (uint32_t)result.size();
+        device.handle = handle;
+        device.name = ReadDeviceName(fd);
+        device.path = path;
+        device.identity = ReadDeviceIdentity(fd, device.name);
+        if (device.name.empty()) {
+            device.name = DescribeDevice(device.identity);
+        }
+        result.push_back(device);
+        close(fd);
+    });
+
+    return result;
+}
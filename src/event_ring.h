@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+enum class EventType : uint8_t {
+    Move,
+    Button,
+    Device
+};
+
+enum class EventAction : uint8_t {
+    None,
+    LeftDown,
+    LeftUp,
+    RightDown,
+    RightUp,
+    MiddleDown,
+    MiddleUp,
+    Added,
+    Removed
+};
+
+inline const char* EventTypeName(EventType type) {
+    switch (type) {
+        case EventType::Move: return "move";
+        case EventType::Button: return "button";
+        case EventType::Device: return "device";
+    }
+    return "";
+}
+
+inline const char* EventActionName(EventAction action) {
+    switch (action) {
+        case EventAction::None: return "";
+        case EventAction::LeftDown: return "left-down";
+        case EventAction::LeftUp: return "left-up";
+        case EventAction::RightDown: return "right-down";
+        case EventAction::RightUp: return "right-up";
+        case EventAction::MiddleDown: return "middle-down";
+        case EventAction::MiddleUp: return "middle-up";
+        case EventAction::Added: return "added";
+        case EventAction::Removed: return "removed";
+    }
+    return "";
+}
+
+// Plain old data so the ring never allocates; names are resolved from deviceId on the consumer side.
+struct MouseEvent {
+    uint32_t deviceId;
+    EventType type;
+    EventAction action;
+    uint16_t flags;
+    uint32_t seq;
+    int32_t x, y;
+    int32_t deltaX, deltaY;
+    int64_t timestamp;
+};
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool TryPush(const T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cachedTail_ >= Capacity) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head - cachedTail_ >= Capacity) {
+                return false;
+            }
+        }
+        slots_[head & (Capacity - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) {
+                return false;
+            }
+        }
+        out = slots_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t head = head_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+    alignas(64) T slots_[Capacity];
+};
+
+enum class OverflowPolicy : uint8_t {
+    DropMoves,
+    MergeMoves
+};
+
+// Moves may only fill the ring up to Capacity - Capacity / 8; the remaining slots are
+// reserved so button and device events still fit when the consumer falls behind.
+// Moves that do not fit are dropped or folded into a per-device pending move that is
+// published (in order) before the next event of that device or once space frees up.
+// Button and device events, and folded moves, are never lost: once even the reserve is full
+// they wait in a producer-side backlog that Flush publishes first, and while the backlog is
+// non-empty new moves are folded (or dropped) instead of overtaking it. The backlog only grows
+// while the consumer is stalled, at the rate of clicks and hot-plugs.
+template <size_t Capacity, size_t MaxDevices>
+class MouseEventQueue {
+public:
+    static constexpr size_t kMoveLimit = Capacity - Capacity / 8;
+
+    void SetOverflowPolicy(OverflowPolicy policy) {
+        policy_.store(policy, std::memory_order_relaxed);
+    }
+
+    OverflowPolicy GetOverflowPolicy() const {
+        return policy_.load(std::memory_order_relaxed);
+    }
+
+    // Producer side.
+    bool Push(const MouseEvent& event) {
+        if (!backlog_.empty() || (pendingCount_ > 0 && ring_.Size() < kMoveLimit)) {
+            Flush();
+        }
+
+        const bool tracked = event.deviceId < MaxDevices;
+
+        if (event.type == EventType::Move) {
+            if (tracked && pending_[event.deviceId].active) {
+                Merge(pending_[event.deviceId].event, event);
+                merged_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (backlog_.empty() && ring_.Size() < kMoveLimit && ring_.TryPush(event)) {
+                return true;
+            }
+            if (tracked && GetOverflowPolicy() == OverflowPolicy::MergeMoves) {
+                pending_[event.deviceId].event = event;
+                pending_[event.deviceId].active = true;
+                pendingCount_++;
+                return true;
+            }
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (tracked && pending_[event.deviceId].active) {
+            PublishPending(event.deviceId);
+        }
+        Publish(event);
+        return true;
+    }
+
+    // Producer side: publishes the backlog, then folded moves, once the consumer has made room.
+    void Flush() {
+        while (!backlog_.empty()) {
+            if (!ring_.TryPush(backlog_.front())) {
+                return;
+            }
+            backlog_.pop_front();
+            backlogSize_.store(backlog_.size(), std::memory_order_relaxed);
+        }
+        if (pendingCount_ == 0) {
+            return;
+        }
+        for (size_t id = 0; id < MaxDevices && pendingCount_ > 0; id++) {
+            if (ring_.Size() >= kMoveLimit) {
+                return;
+            }
+            if (pending_[id].active) {
+                PublishPending(id);
+            }
+        }
+    }
+
+    // Consumer side.
+    bool Pop(MouseEvent& out) {
+        return ring_.TryPop(out);
+    }
+
+    // Producer side: true while the backlog or folded moves are still waiting for room in the ring.
+    bool HasPending() const { return pendingCount_ > 0 || !backlog_.empty(); }
+
+    size_t Size() const { return ring_.Size(); }
+    uint64_t DroppedMoves() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t MergedMoves() const { return merged_.load(std::memory_order_relaxed); }
+    // Events that had to wait in the backlog, and how many wait right now.
+    uint64_t DeferredEvents() const { return deferred_.load(std::memory_order_relaxed); }
+    size_t Backlog() const { return backlogSize_.load(std::memory_order_relaxed); }
+
+private:
+    struct PendingMove {
+        bool active = false;
+        MouseEvent event{};
+    };
+
+    static void Merge(MouseEvent& into, const MouseEvent& from) {
+        into.x = from.x;
+        into.y = from.y;
+        into.deltaX += from.deltaX;
+        into.deltaY += from.deltaY;
+        into.flags = from.flags;
+        into.seq = from.seq;
+        into.timestamp = from.timestamp;
+    }
+
+    void Publish(const MouseEvent& event) {
+        if (backlog_.empty() && ring_.TryPush(event)) {
+            return;
+        }
+        backlog_.push_back(event);
+        backlogSize_.store(backlog_.size(), std::memory_order_relaxed);
+        deferred_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PublishPending(size_t id) {
+        Publish(pending_[id].event);
+        pending_[id].active = false;
+        pendingCount_--;
+    }
+
+    SpscRing<MouseEvent, Capacity> ring_;
+    PendingMove pending_[MaxDevices];
+    size_t pendingCount_ = 0;
+    std::atomic<OverflowPolicy> policy_{OverflowPolicy::MergeMoves};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> merged_{0};
+    std::atomic<uint64_t> deferred_{0};
+    std::deque<MouseEvent> backlog_;
+    std::atomic<size_t> backlogSize_{0};
+};
@@ -0,0 +1,64 @@
+#include "event_subscriptions.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "input_pipeline.h"
+
+void EventSubscriptions::SetDefault(uint8_t mask) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    pendingDefault_ = mask & kSubscribeAll;
+    dirty_.store(true, std::memory_order_release);
+}
+
+void EventSubscriptions::SetDevice(uint64_t handle, uint8_t mask) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    auto it = std::find_if(pendingDevices_.begin(), pendingDevices_.end(), [handle](const auto& device) { return device.first == handle; });
+    if (it != pendingDevices_.end()) {
+        it->second = mask & kSubscribeAll;
+    } else {
+        pendingDevices_.emplace_back(handle, mask & kSubscribeAll);
+    }
+    dirty_.store(true, std::memory_order_release);
+}
+
+void EventSubscriptions::ClearDevice(uint64_t handle) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    pendingDevices_.erase(std::remove_if(pendingDevices_.begin(), pendingDevices_.end(), [handle](const auto& device) { return device.first == handle; }),
+                          pendingDevices_.end());
+    dirty_.store(true, std::memory_order_release);
+}
+
+// Like MotionFilter::SyncConfig, the producer keeps the old masks while the JS thread holds the lock.
+void EventSubscriptions::Sync() {
+    std::unique_lock<std::mutex> lock(configMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    default_ = pendingDefault_;
+    devices_ = pendingDevices_;
+    dirty_.store(false, std::memory_order_relaxed);
+
+    filtering_ = default_ != kSubscribeAll;
+    for (const auto& device : devices_) {
+        filtering_ = filtering_ || device.second != kSubscribeAll;
+    }
+    memset(resolved_, 0, sizeof(resolved_));
+}
+
+uint8_t EventSubscriptions::MaskFor(uint32_t deviceId) {
+    if (deviceId >= kMaxDevices) {
+        return default_;
+    }
+    if (!resolved_[deviceId]) {
+        const uint64_t handle = pipeline_.GetDeviceSlot(deviceId).handle;
+        masks_[deviceId] = default_;
+        for (const auto& device : devices_) {
+            if (device.first == handle) {
+                masks_[deviceId] = device.second;
+            }
+        }
+        resolved_[deviceId] = true;
+    }
+    return masks_[deviceId];
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "event_ring.h"
+
+class InputPipeline;
+
+// Event classes for setSubscription().
+const uint8_t kSubscribeMove = 0x01;
+const uint8_t kSubscribeButton = 0x02;
+const uint8_t kSubscribeDevice = 0x04;
+const uint8_t kSubscribeAll = kSubscribeMove | kSubscribeButton | kSubscribeDevice;
+
+// Which event classes reach the queue, by default and per device. The producer drops the rest
+// after the motion engine, cursor lock and filters have seen them, so positions stay true while
+// nobody listens, but nothing is coalesced, queued or turned into a JS object.
+class EventSubscriptions {
+public:
+    static const size_t kMaxDevices = 256;
+
+    explicit EventSubscriptions(const InputPipeline& pipeline) : pipeline_(pipeline) {}
+
+    // Any thread. The producer switches to the new masks as a whole before its next event.
+    void SetDefault(uint8_t mask);
+    void SetDevice(uint64_t handle, uint8_t mask);
+    void ClearDevice(uint64_t handle);
+
+    // Producer thread.
+    // Drops the cached mask of a released id; the next device to take it resolves its own.
+    void ForgetDevice(uint32_t deviceId) {
+        if (deviceId < kMaxDevices) {
+            resolved_[deviceId] = false;
+        }
+    }
+    bool Wants(const MouseEvent& event) {
+        if (dirty_.load(std::memory_order_acquire)) {
+            Sync();
+        }
+        if (!filtering_) {
+            return true;
+        }
+        return (MaskFor(event.deviceId) & ClassOf(event.type)) != 0;
+    }
+
+private:
+    static uint8_t ClassOf(EventType type) {
+        return type == EventType::Move ? kSubscribeMove : type == EventType::Button ? kSubscribeButton : kSubscribeDevice;
+    }
+
+    void Sync();
+    uint8_t MaskFor(uint32_t deviceId);
+
+    const InputPipeline& pipeline_;
+    std::atomic<bool> dirty_{false};
+    std::mutex configMutex_;
+    uint8_t pendingDefault_ = kSubscribeAll;
+    std::vector<std::pair<uint64_t, uint8_t>> pendingDevices_;
+
+    // Producer copies; masks_ caches each device's resolved mask until the next Sync.
+    bool filtering_ = false;
+    uint8_t default_ = kSubscribeAll;
+    std::vector<std::pair<uint64_t, uint8_t>> devices_;
+    uint8_t masks_[kMaxDevices] = {};
+    bool resolved_[kMaxDevices] = {};
+};
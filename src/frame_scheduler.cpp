@@ -0,0 +1,121 @@
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Loop gains: each consumer frame moves the phase by a tenth of its error and the period by
+// 0.2% of the error per elapsed frame. A 59.94 Hz display configured as 60 Hz is learned to within
+// a couple of microseconds in a few seconds, despite ~250 us of noise on each report.
+static const double kPhaseGain = 0.1;
+static const double kPeriodGain = 0.002;
+// The estimated period stays within this fraction of the configured one.
+static const double kPeriodRange = 0.25;
+
+void FrameScheduler::Configure(const FramePacingConfig& config) {
+    const int64_t period = std::max<int64_t>(config.periodMicros, 1000);
+    nominalPeriod_.store(period, std::memory_order_relaxed);
+    period_.store(period, std::memory_order_relaxed);
+    anchor_.store(config.phaseMicros >= 0 ? config.phaseMicros : 0, std::memory_order_relaxed);
+    lead_.store(std::min(std::max<int64_t>(config.leadMicros, 0), period - 1), std::memory_order_relaxed);
+    following_.store(config.phaseMicros < 0, std::memory_order_relaxed);
+    locked_.store(config.phaseMicros >= 0, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+void FrameScheduler::ObserveFrame(int64_t now) {
+    const uint32_t generation = generation_.load(std::memory_order_acquire);
+    if (!following_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const double nominal = (double)nominalPeriod_.load(std::memory_order_relaxed);
+    if (generation != observedGeneration_ || badFrames_ >= kRelockFrames) {
+        // A lost lock keeps its period estimate; a new config starts from the configured one.
+        if (generation != observedGeneration_) {
+            periodEstimate_ = nominal;
+        }
+        observedGeneration_ = generation;
+        anchorEstimate_ = (double)now;
+        goodFrames_ = 0;
+        badFrames_ = 0;
+        locked_.store(false, std::memory_order_relaxed);
+        anchor_.store(now, std::memory_order_relaxed);
+        return;
+    }
+
+    // Several overlays report the same frame; only the first report of a frame counts.
+    const double elapsed = (double)now - anchorEstimate_;
+    const int64_t frames = (int64_t)std::llround(elapsed / periodEstimate_);
+    if (frames <= 0) {
+        return;
+    }
+    const double error = elapsed - frames * periodEstimate_;
+    if (std::fabs(error) > periodEstimate_ / 4) {
+        // A stalled consumer says nothing about the refresh; keep the schedule.
+        goodFrames_ = 0;
+        badFrames_++;
+        locked_.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    badFrames_ = 0;
+    anchorEstimate_ += frames * periodEstimate_ + kPhaseGain * error;
+    periodEstimate_ += kPeriodGain * error / (double)frames;
+    periodEstimate_ = std::min(std::max(periodEstimate_, nominal * (1 - kPeriodRange)), nominal * (1 + kPeriodRange));
+    goodFrames_ = std::fabs(error) < periodEstimate_ / 16 ? goodFrames_ + 1 : 0;
+
+    period_.store((int64_t)std::llround(periodEstimate_), std::memory_order_relaxed);
+    anchor_.store((int64_t)std::llround(anchorEstimate_), std::memory_order_relaxed);
+    locked_.store(goodFrames_ >= kLockFrames, std::memory_order_relaxed);
+}
+
+void FrameScheduler::Arm(int64_t now) {
+    const int64_t period = period_.load(std::memory_order_relaxed);
+    const int64_t anchor = anchor_.load(std::memory_order_relaxed);
+    const int64_t lead = lead_.load(std::memory_order_relaxed);
+    // First refresh whose deadline is not already behind us, and not the refresh delivered last
+    // even if the phase estimate moved since.
+    const int64_t offset = std::max(now, delivered_ + period / 2) + lead - anchor;
+    int64_t frames = offset / period;
+    if (frames * period < offset) {
+        frames++;
+    }
+    deadline_ = anchor + frames * period - lead;
+}
+
+void FrameScheduler::Delivered(int64_t now) {
+    const int64_t late = std::max<int64_t>(0, now - deadline_);
+    const bool missed = late > lead_.load(std::memory_order_relaxed);
+    Record(window_, late, missed);
+    Record(total_, late, missed);
+    delivered_ = deadline_;
+    deadline_ = kNoDeadline;
+}
+
+void FrameScheduler::Record(Counters& counters, int64_t late, bool missed) {
+    counters.frames.fetch_add(1, std::memory_order_relaxed);
+    if (missed) {
+        counters.missed.fetch_add(1, std::memory_order_relaxed);
+    }
+    counters.jitterSum.fetch_add((uint64_t)late, std::memory_order_relaxed);
+    if (late > counters.jitterMax.load(std::memory_order_relaxed)) {
+        counters.jitterMax.store(late, std::memory_order_relaxed);
+    }
+}
+
+FramePacingStats FrameScheduler::Read(const Counters& counters) const {
+    FramePacingStats stats;
+    stats.frames = counters.frames.load(std::memory_order_relaxed);
+    stats.missed = counters.missed.load(std::memory_order_relaxed);
+    stats.jitterMeanMicros = stats.frames ? (double)counters.jitterSum.load(std::memory_order_relaxed) / (double)stats.frames : 0.0;
+    stats.jitterMaxMicros = counters.jitterMax.load(std::memory_order_relaxed);
+    stats.periodMicros = period_.load(std::memory_order_relaxed);
+    stats.locked = locked_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FrameScheduler::ResetStats() {
+    window_.frames.store(0, std::memory_order_relaxed);
+    window_.missed.store(0, std::memory_order_relaxed);
+    window_.jitterSum.store(0, std::memory_order_relaxed);
+    window_.jitterMax.store(0, std::memory_order_relaxed);
+}
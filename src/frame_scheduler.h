@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+struct FramePacingConfig {
+    int64_t periodMicros = 16667;
+    // NowMicros() time of any one refresh (a vsync timestamp). Negative: no vsync source, the
+    // schedule locks onto the frames the consumer reports instead.
+    int64_t phaseMicros = -1;
+    // Moves are delivered this long before each expected refresh.
+    int64_t leadMicros = 2000;
+};
+
+struct FramePacingStats {
+    uint64_t frames;
+    uint64_t missed;          // delivered after the refresh they were meant for
+    double jitterMeanMicros;  // delivery time - deadline
+    int64_t jitterMaxMicros;
+    int64_t periodMicros;     // current estimate
+    bool locked;
+};
+
+// Deadlines for the Frame coalescing mode: one delivery per refresh, leadMicros before it. The
+// producer arms a deadline when motion becomes pending and delivers every pending move once it
+// passes, so an idle pipeline never wakes per frame. Time is passed in, never read, so the
+// schedule runs the same against a fake clock.
+class FrameScheduler {
+public:
+    static const int64_t kNoDeadline = INT64_MAX;
+
+    // Any thread. Resets the lock onto consumer frames.
+    void Configure(const FramePacingConfig& config);
+
+    // Consumer thread: a frame the consumer presented at `now`. Ignored with a fixed phase.
+    void ObserveFrame(int64_t now);
+
+    // Producer thread.
+    bool Armed() const { return deadline_ != kNoDeadline; }
+    // Sets the deadline to the first one at or after `now`, at most one per refresh.
+    void Arm(int64_t now);
+    int64_t Deadline() const { return deadline_; }
+    bool Due(int64_t now) const { return now >= deadline_; }
+    // Records how late the delivery was and disarms.
+    void Delivered(int64_t now);
+    void Cancel() { deadline_ = kNoDeadline; }
+
+    // Any thread. Stats() covers the deliveries since the last ResetStats, Totals() all of them.
+    FramePacingStats Stats() const { return Read(window_); }
+    FramePacingStats Totals() const { return Read(total_); }
+    void ResetStats();
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> missed{0};
+        std::atomic<uint64_t> jitterSum{0};
+        std::atomic<int64_t> jitterMax{0};
+    };
+
+    static void Record(Counters& counters, int64_t late, bool missed);
+    FramePacingStats Read(const Counters& counters) const;
+
+    // Consecutive on-time consumer frames before the schedule counts as locked.
+    static const int kLockFrames = 8;
+    // Consecutive off-schedule frames before the estimator starts over from the latest one.
+    static const int kRelockFrames = 16;
+
+    // Published by Configure/ObserveFrame, read by the producer in Arm.
+    std::atomic<int64_t> nominalPeriod_{16667};
+    std::atomic<int64_t> period_{16667};
+    std::atomic<int64_t> anchor_{0};   // time of one expected refresh
+    std::atomic<int64_t> lead_{2000};
+    std::atomic<bool> following_{true};
+    std::atomic<bool> locked_{false};
+    std::atomic<uint32_t> generation_{0};
+
+    // Consumer-side estimator; starts over whenever generation_ moves.
+    uint32_t observedGeneration_ = UINT32_MAX;
+    double periodEstimate_ = 16667;
+    double anchorEstimate_ = 0;
+    int goodFrames_ = 0;
+    int badFrames_ = 0;
+
+    int64_t deadline_ = kNoDeadline;
+    int64_t delivered_ = INT64_MIN / 2;   // deadline of the last delivery
+
+    Counters window_;
+    Counters total_;
+};
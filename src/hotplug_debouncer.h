@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Long enough for a composite device to finish enumerating and for udev to fix node permissions.
+const int64_t kHotplugSettleMicros = 150000;
+
+// Input thread only. OS arrival notifications come in bursts (one per HID collection, a create
+// then an attribute change per device node), so an arrival is reported once its key has been
+// quiet for the settle window. A removal inside the window cancels the arrival outright.
+class HotplugDebouncer {
+public:
+    explicit HotplugDebouncer(int64_t settleMicros = kHotplugSettleMicros) : settleMicros_(settleMicros) {}
+
+    void Arrived(uint64_t key, int64_t now) {
+        for (auto& entry : pending_) {
+            if (entry.first == key) {
+                entry.second = now + settleMicros_;
+                return;
+            }
+        }
+        pending_.push_back({ key, now + settleMicros_ });
+    }
+
+    // False when the arrival was still settling: the device was never reported, so neither is its removal.
+    bool Removed(uint64_t key) {
+        for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+            if (it->first == key) {
+                pending_.erase(it);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Calls fn(key) for every arrival that has settled, in notification order.
+    template <typename Fn>
+    void TakeSettled(int64_t now, Fn fn) {
+        size_t kept = 0;
+        for (size_t i = 0; i < pending_.size(); i++) {
+            if (pending_[i].second <= now) {
+                fn(pending_[i].first);
+            } else {
+                pending_[kept++] = pending_[i];
+            }
+        }
+        pending_.resize(kept);
+    }
+
+    // Microseconds until the next arrival settles, or -1 when none is pending.
+    int64_t WaitMicros(int64_t now) const {
+        int64_t wait = -1;
+        for (const auto& entry : pending_) {
+            int64_t remaining = std::max<int64_t>(0, entry.second - now);
+            wait = wait < 0 ? remaining : std::min(wait, remaining);
+        }
+        return wait;
+    }
+
+private:
+    int64_t settleMicros_;
+    std::vector<std::pair<uint64_t, int64_t>> pending_;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "device_registry.h"
+
+class InputPipeline;
+
+// Owns device I/O on a dedicated input thread and feeds one pipeline (input_pipeline.h).
+class InputBackend {
+public:
+    virtual ~InputBackend() {}
+
+    // Returns nullptr once the input thread is running, or an error message.
+    virtual const char* Start() = 0;
+    virtual void Stop() = 0;
+
+    // Asks the input thread to run FlushProducer, e.g. after a drain left folded moves behind.
+    virtual void RequestFlush() = 0;
+    virtual void InjectMove(uint64_t handle, int dx, int dy) = 0;
+};
+
+std::unique_ptr<InputBackend> CreateInputBackend(InputPipeline& pipeline);
+std::vector<InputDeviceInfo> EnumerateInputDevices();
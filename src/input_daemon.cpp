@@ -0,0 +1,70 @@
+// orionix_input_daemon: runs the input backend outside Electron and publishes its events for any
+// number of clients (connectInputService in the addon). Stops on Ctrl+C or SIGTERM.
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "input_service.h"
+
+static std::atomic<bool> stopRequested{false};
+
+static void OnSignal(int) {
+    stopRequested.store(true);
+}
+
+static bool ParseArgs(int argc, char** argv, InputDaemonConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--name") {
+            config.name = value;
+        } else if (arg == "--simulate") {
+            config.simulateHz = atoi(value);
+        } else if (arg == "--devices") {
+            config.simulateDevices = atoi(value);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (config.name.empty() || config.name.find_first_of("/\\") != std::string::npos) {
+        fprintf(stderr, "--name must be non-empty and contain no slashes\n");
+        return false;
+    }
+    if (config.simulateHz < 0 || config.simulateHz > 10000) {
+        fprintf(stderr, "--simulate must be between 0 and 10000\n");
+        return false;
+    }
+    if (config.simulateDevices < 0 || config.simulateDevices > 16) {
+        fprintf(stderr, "--devices must be between 0 and 16\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    InputDaemonConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        fprintf(stderr, "Usage: orionix_input_daemon [--name orionix-input] [--simulate Hz] [--devices N]\n");
+        return 2;
+    }
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    if (const char* error = RunInputDaemon(config, stopRequested)) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    return 0;
+}
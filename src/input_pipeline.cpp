@@ -0,0 +1,316 @@
+#include "input_pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+int64_t CounterToMicros(int64_t counter) {
+    static LARGE_INTEGER frequency = []() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return f;
+    }();
+    return (counter / frequency.QuadPart) * 1000000 + (counter % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+}
+#endif
+
+int64_t NowMicros() {
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return CounterToMicros(counter.QuadPart);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+MouseEvent MakeEvent(uint32_t deviceId, EventType type, EventAction action, int x, int y, int deltaX, int deltaY, int flags) {
+    MouseEvent event;
+    event.deviceId = deviceId;
+    event.type = type;
+    event.action = action;
+    event.flags = (uint16_t)flags;
+    event.seq = 0;
+    event.x = x;
+    event.y = y;
+    event.deltaX = deltaX;
+    event.deltaY = deltaY;
+    event.timestamp = NowMicros();
+    return event;
+}
+
+InputPipeline::InputPipeline() : motion_(*this), filter_(*this), subscriptions_(*this), cursorLock_(*this), trace_(*this) {}
+
+static size_t HandleBucket(uint64_t handle, size_t buckets) {
+    handle ^= handle >> 33;
+    handle *= 0xFF51AFD7ED558CCDull;
+    handle ^= handle >> 33;
+    return (size_t)handle & (buckets - 1);
+}
+
+bool InputPipeline::LookupDevice(uint64_t handle, uint32_t* id) const {
+    for (size_t bucket = HandleBucket(handle, kHandleBuckets); handleBuckets_[bucket] != 0; bucket = (bucket + 1) & (kHandleBuckets - 1)) {
+        const uint32_t entry = handleBuckets_[bucket];
+        if (entry != kTombstone && deviceSlots_[entry - 1].handle == handle) {
+            *id = entry - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t InputPipeline::InternDevice(uint64_t handle, const char* name) {
+    size_t bucket = HandleBucket(handle, kHandleBuckets);
+    size_t tombstone = kHandleBuckets;
+    for (; handleBuckets_[bucket] != 0; bucket = (bucket + 1) & (kHandleBuckets - 1)) {
+        const uint32_t entry = handleBuckets_[bucket];
+        if (entry == kTombstone) {
+            if (tombstone == kHandleBuckets) {
+                tombstone = bucket;
+            }
+        } else if (deviceSlots_[entry - 1].handle == handle) {
+            return entry - 1;
+        }
+    }
+
+    ReclaimDevices();
+    uint32_t id;
+    if (freeCount_ > 0) {
+        id = freeIds_[--freeCount_];
+        stats_.ForgetDevice(id);
+    } else if (deviceSlotCount_ < kMaxDeviceSlots) {
+        id = (uint32_t)deviceSlotCount_++;
+    } else {
+        stats_.CountRejectedDevice();
+        return kInvalidDeviceId;
+    }
+    if (tombstone != kHandleBuckets) {
+        bucket = tombstone;
+        tombstones_--;
+    }
+    DeviceSlot& slot = deviceSlots_[id];
+    slot.handle = handle;
+    strncpy(slot.name, name, sizeof(slot.name) - 1);
+    slot.name[sizeof(slot.name) - 1] = '\0';
+    handleBuckets_[bucket] = id + 1;
+    return id;
+}
+
+void InputPipeline::ReleaseDevice(uint32_t id) {
+    if (id >= deviceSlotCount_) {
+        return;
+    }
+    for (size_t bucket = HandleBucket(deviceSlots_[id].handle, kHandleBuckets); handleBuckets_[bucket] != 0; bucket = (bucket + 1) & (kHandleBuckets - 1)) {
+        if (handleBuckets_[bucket] != id + 1) {
+            continue;
+        }
+        handleBuckets_[bucket] = kTombstone;
+        tombstones_++;
+        coalescer_.ForgetDevice(id, queue_);
+        subscriptions_.ForgetDevice(id);
+        retiredIds_[retiredCount_++] = id;
+        if (tombstones_ > kHandleBuckets / 4) {
+            RebuildHandleIndex();
+        }
+        return;
+    }
+}
+
+// An empty queue means the consumer has taken every event of the sealed ids; a drain begun
+// after that means it has also finished reading their slots.
+void InputPipeline::ReclaimDevices() {
+    if (retiredCount_ == 0) {
+        return;
+    }
+    const uint64_t drains = drains_.load(std::memory_order_acquire);
+    if (sealedCount_ > 0 && drains != sealedDrain_) {
+        for (size_t i = 0; i < sealedCount_; i++) {
+            freeIds_[freeCount_++] = retiredIds_[i];
+        }
+        retiredCount_ -= sealedCount_;
+        memmove(retiredIds_, retiredIds_ + sealedCount_, retiredCount_ * sizeof(retiredIds_[0]));
+        sealedCount_ = 0;
+    }
+    if (sealedCount_ == 0 && retiredCount_ > 0 && queue_.Size() == 0 && !queue_.HasPending()) {
+        sealedCount_ = retiredCount_;
+        sealedDrain_ = drains;
+    }
+}
+
+void InputPipeline::RebuildHandleIndex() {
+    uint32_t live[kMaxDeviceSlots];
+    size_t count = 0;
+    for (uint32_t entry : handleBuckets_) {
+        if (entry != 0 && entry != kTombstone) {
+            live[count++] = entry;
+        }
+    }
+    memset(handleBuckets_, 0, sizeof(handleBuckets_));
+    tombstones_ = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t bucket = HandleBucket(deviceSlots_[live[i] - 1].handle, kHandleBuckets);
+        while (handleBuckets_[bucket] != 0) {
+            bucket = (bucket + 1) & (kHandleBuckets - 1);
+        }
+        handleBuckets_[bucket] = live[i];
+    }
+}
+
+uint32_t InputPipeline::RegisterDevice(uint64_t handle, const std::string& name, const std::string& path, const DeviceIdentity& identity) {
+    InputDeviceInfo info;
+    info.handle = handle;
+    info.name = name.empty() ? DescribeDevice(identity) : name;
+    info.path = path;
+    info.identity = identity;
+    info.id = InternDevice(handle, info.name.c_str());
+    if (info.id != kInvalidDeviceId) {
+        registry_.Add(info);
+    }
+    return info.id;
+}
+
+uint32_t InputPipeline::NextSeq() {
+    if (++ingestSeq_ == 0) {
+        ingestSeq_ = 1;
+    }
+    return ingestSeq_;
+}
+
+void InputPipeline::IngestEvent(const MouseEvent& event) {
+    if (event.deviceId >= kMaxDeviceSlots) {
+        stats_.CountRejectedEvent();
+        return;
+    }
+    MouseEvent stamped = event;
+    stamped.seq = NextSeq();
+
+    if (trace_.IsActive()) {
+        trace_.Record(stamped);
+    }
+    if (eventTap_) {
+        eventTap_(tapContext_, stamped);
+    }
+    motion_.Apply(stamped);
+    cursorLock_.Observe(stamped);
+    if (filter_.Enabled()) {
+        filter_.Apply(stamped);
+    }
+    stats_.CountEvent(stamped);
+    if (!subscriptions_.Wants(stamped)) {
+        stats_.CountUnsubscribed();
+        return;
+    }
+    coalescer_.Push(stamped, stamped.timestamp, queue_);
+    ArmFrame(stamped.timestamp);
+}
+
+// The frame deadline only runs while motion waits for it, so an idle producer stays asleep.
+void InputPipeline::ArmFrame(int64_t now) {
+    if (!frames_.Armed() && coalescer_.HasPending() && coalescer_.Mode() == CoalesceMode::Frame) {
+        frames_.Arm(now);
+    }
+}
+
+void InputPipeline::FlushProducer() {
+    const int64_t now = NowMicros();
+    MouseEvent settle;
+    while (filter_.TakeSettle(now, settle)) {
+        settle.seq = NextSeq();
+        stats_.CountSettle();
+        if (!subscriptions_.Wants(settle)) {
+            stats_.CountUnsubscribed();
+            continue;
+        }
+        coalescer_.Push(settle, now, queue_);
+    }
+    if (coalescer_.Mode() == CoalesceMode::Frame) {
+        ArmFrame(now);
+        if (frames_.Armed() && frames_.Due(now)) {
+            // A click may have published the frame's motion already.
+            if (coalescer_.HasPending()) {
+                frames_.Delivered(now);
+                coalescer_.FlushAll(queue_);
+            } else {
+                frames_.Cancel();
+            }
+        }
+    } else {
+        frames_.Cancel();
+        coalescer_.Flush(now, queue_);
+    }
+    queue_.Flush();
+    cursorLock_.Flush();
+    ReclaimDevices();
+}
+
+int64_t InputPipeline::ProducerWaitMicros() {
+    int64_t wait = queue_.HasPending() ? 1000 : -1;
+    int64_t deadline = coalescer_.NextDeadline();
+    if (deadline != coalescer_.kNoDeadline) {
+        int64_t remaining = std::max<int64_t>(0, deadline - NowMicros());
+        wait = wait < 0 ? remaining : std::min(wait, remaining);
+    }
+    if (frames_.Armed()) {
+        int64_t remaining = std::max<int64_t>(0, frames_.Deadline() - NowMicros());
+        wait = wait < 0 ? remaining : std::min(wait, remaining);
+    }
+    int64_t settle = filter_.NextDeadline();
+    if (settle != filter_.kNoDeadline) {
+        int64_t remaining = std::max<int64_t>(0, settle - NowMicros());
+        wait = wait < 0 ? remaining : std::min(wait, remaining);
+    }
+    return wait;
+}
+
+void InputPipeline::WakeConsumer() {
+    const size_t depth = queue_.Size();
+    stats_.ObserveQueueDepth(depth);
+    if (consumerWakeup_ && depth > 0 && !wakePending_.exchange(true)) {
+        consumerWakeup_(wakeupContext_);
+    }
+}
+
+void InputPipeline::SetConsumerWakeup(void (*wakeup)(void*), void* context) {
+    consumerWakeup_ = wakeup;
+    wakeupContext_ = context;
+}
+
+void InputPipeline::SetEventTap(void (*tap)(void*, const MouseEvent&), void* context) {
+    eventTap_ = tap;
+    tapContext_ = context;
+}
+
+void InputPipeline::BeginDrain() {
+    wakePending_.store(false);
+    drains_.fetch_add(1, std::memory_order_release);
+    coalescer_.OnDrain();
+}
+
+const DeviceSlot& InputPipeline::GetDeviceSlot(uint32_t id) const {
+    return deviceSlots_[std::min<size_t>(id, kMaxDeviceSlots - 1)];
+}
+
+void InputPipeline::CollectStats(InputStatsSnapshot& snapshot) const {
+    stats_.Snapshot(snapshot);
+    snapshot.coalescedMoves = coalescer_.FoldedMoves();
+    snapshot.emittedMoves = coalescer_.EmittedMoves();
+    snapshot.droppedMoves = queue_.DroppedMoves();
+    snapshot.mergedMoves = queue_.MergedMoves();
+    snapshot.deferredEvents = queue_.DeferredEvents();
+    snapshot.queueBacklog = queue_.Backlog();
+    snapshot.queuePending = queue_.Size();
+    snapshot.frames = frames_.Totals();
+    for (DeviceStats& device : snapshot.devices) {
+        const DeviceSlot& slot = GetDeviceSlot(device.id);
+        device.handle = slot.handle;
+        device.name = slot.name;
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "cursor_lock.h"
+#include "device_registry.h"
+#include "event_ring.h"
+#include "event_subscriptions.h"
+#include "frame_scheduler.h"
+#include "input_stats.h"
+#include "input_trace.h"
+#include "motion_coalescer.h"
+#include "motion_engine.h"
+#include "motion_filter.h"
+
+// Written by the input thread before the first event referencing the slot is queued, and again
+// only when a released id goes to a new device, after the consumer drained the old one's events.
+struct DeviceSlot {
+    uint64_t handle;
+    char name[128];
+};
+
+const size_t kEventQueueCapacity = 8192;
+const size_t kMaxTrackedDevices = 256;
+const size_t kMaxDeviceSlots = 1024;
+// InternDevice's answer once every slot is taken; IngestEvent drops events that carry it.
+const uint32_t kInvalidDeviceId = UINT32_MAX;
+
+typedef MouseEventQueue<kEventQueueCapacity, kMaxTrackedDevices> EventQueue;
+
+int64_t NowMicros();
+#ifdef _WIN32
+// QueryPerformanceCounter ticks (NowMicros' clock) to microseconds.
+int64_t CounterToMicros(int64_t counter);
+#endif
+MouseEvent MakeEvent(uint32_t deviceId, EventType type, EventAction action, int x, int y, int deltaX, int deltaY, int flags);
+
+// Everything between a backend's input thread and the JS consumer that drains it: device ids,
+// motion engine, cursor arbitration, motion filters, event subscriptions, coalescing and frame
+// pacing, the event queue, stats and trace recording. One per addon instance, so independent
+// instances (e.g. one per worker thread) never share events.
+class InputPipeline {
+public:
+    InputPipeline();
+    InputPipeline(const InputPipeline&) = delete;
+    InputPipeline& operator=(const InputPipeline&) = delete;
+
+    EventQueue& Queue() { return queue_; }
+    MotionCoalescer<kMaxTrackedDevices>& Coalescer() { return coalescer_; }
+    FrameScheduler& Frames() { return frames_; }
+    MotionEngine& Motion() { return motion_; }
+    const MotionEngine& Motion() const { return motion_; }
+    MotionFilter& Filter() { return filter_; }
+    EventSubscriptions& Subscriptions() { return subscriptions_; }
+    CursorLock& Cursor() { return cursorLock_; }
+    TraceRecorder& Trace() { return trace_; }
+    DeviceRegistry& Registry() { return registry_; }
+    InputStats& Stats() { return stats_; }
+
+    // Producer side (the backend's input thread, or the JS thread while no backend runs).
+    // Dense, stable id for a device handle; O(1) via an open-addressed index. Released ids are
+    // handed out again before new ones. kInvalidDeviceId once kMaxDeviceSlots handles hold an id,
+    // so a new device never aliases another's id.
+    uint32_t InternDevice(uint64_t handle, const char* name);
+    bool LookupDevice(uint64_t handle, uint32_t* id) const;
+    // Frees a removed device's id, once its Removed event is ingested, so replugs keep ids dense
+    // and under the coalescer's and queue's 256. The id is only reused after the consumer began a
+    // drain past that event, so GetDeviceSlot still names the old device for what is queued.
+    void ReleaseDevice(uint32_t id);
+    // Records a device once on arrival and returns its dense id, or kInvalidDeviceId without
+    // registering it. An empty name falls back to DescribeDevice.
+    uint32_t RegisterDevice(uint64_t handle, const std::string& name, const std::string& path, const DeviceIdentity& identity);
+    // Stamps the next sequence id (never 0) and hands the event to the coalescer and queue.
+    void IngestEvent(const MouseEvent& event);
+    // Also emits the motion filter's settle moves that are due and, in Frame mode, the frame's moves.
+    void FlushProducer();
+    // Microseconds until FlushProducer must run again, or -1 when the producer may block indefinitely.
+    int64_t ProducerWaitMicros();
+    void WakeConsumer();
+    void CountMessages(uint64_t count) { stats_.CountMessages(count); }
+    // Sees every event as the backend produced it, before the motion engine; set before the
+    // backend starts. The input daemon publishes through it (input_service.h).
+    void SetEventTap(void (*tap)(void*, const MouseEvent&), void* context);
+    void CountRead() { stats_.CountRead(); }
+
+    // Consumer side.
+    void SetConsumerWakeup(void (*wakeup)(void*), void* context);
+    void BeginDrain();
+    const DeviceSlot& GetDeviceSlot(uint32_t id) const;
+    uint64_t MessageCount() const { return stats_.Messages(); }
+    // Counters plus the queue and coalescer figures, with device handles and names filled in.
+    void CollectStats(InputStatsSnapshot& snapshot) const;
+
+private:
+    uint32_t NextSeq();
+    void ArmFrame(int64_t now);
+    void ReclaimDevices();
+    void RebuildHandleIndex();
+
+    // Open-addressed handle -> id + 1 index; twice kMaxDeviceSlots so probes stay short. A
+    // released handle leaves a tombstone so later probes walk past it; the index is rebuilt once
+    // they fill a quarter of it.
+    static const size_t kHandleBuckets = kMaxDeviceSlots * 2;
+    static const uint32_t kTombstone = UINT32_MAX;
+
+    EventQueue queue_;
+    MotionCoalescer<kMaxTrackedDevices> coalescer_;
+    FrameScheduler frames_;
+    MotionEngine motion_;
+    MotionFilter filter_;
+    EventSubscriptions subscriptions_;
+    CursorLock cursorLock_;
+    TraceRecorder trace_;
+    DeviceRegistry registry_;
+
+    DeviceSlot deviceSlots_[kMaxDeviceSlots] = {};
+    size_t deviceSlotCount_ = 0;
+    uint32_t handleBuckets_[kHandleBuckets] = {};
+    size_t tombstones_ = 0;
+    // Released ids wait in retiredIds_ until the queue was seen empty (the first sealedCount_
+    // of them, at drain sealedDrain_) and a later drain began; then they join freeIds_.
+    uint32_t retiredIds_[kMaxDeviceSlots] = {};
+    size_t retiredCount_ = 0;
+    size_t sealedCount_ = 0;
+    uint64_t sealedDrain_ = 0;
+    uint32_t freeIds_[kMaxDeviceSlots] = {};
+    size_t freeCount_ = 0;
+    std::atomic<uint64_t> drains_{0};
+    uint32_t ingestSeq_ = 0;
+    InputStats stats_;
+    std::atomic<bool> wakePending_{false};
+    void (*consumerWakeup_)(void*) = nullptr;
+    void* wakeupContext_ = nullptr;
+    void (*eventTap_)(void*, const MouseEvent&) = nullptr;
+    void* tapContext_ = nullptr;
+};
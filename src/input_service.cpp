@@ -0,0 +1,406 @@
+#include "input_service.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "debug_log.h"
+#include "input_pipeline.h"
+#include "shared_event_ring.h"
+
+static const int64_t kHeartbeatMicros = 100000;
+static const int64_t kClientWaitMicros = 100000;
+static const int64_t kReconnectMicros = 250000;
+
+static void CopyString(char* out, size_t size, const std::string& value) {
+    strncpy(out, value.c_str(), size - 1);
+    out[size - 1] = '\0';
+}
+
+static ServiceDevice MakeServiceDevice(const InputDeviceInfo& info, bool active) {
+    ServiceDevice device = {};
+    device.handle = info.handle;
+    device.vendorId = info.identity.vendorId;
+    device.productId = info.identity.productId;
+    device.interfaceNumber = info.identity.interfaceNumber;
+    device.bus = (uint8_t)info.identity.bus;
+    device.kind = (uint8_t)info.identity.kind;
+    device.active = active ? 1 : 0;
+    CopyString(device.name, sizeof(device.name), info.name);
+    CopyString(device.path, sizeof(device.path), info.path);
+    return device;
+}
+
+// The daemon's pipeline tap, on the backend's input thread: the ring's only writer once the
+// backend runs.
+struct DaemonPublisher {
+    InputPipeline* pipeline;
+    SharedEventRing ring;
+    std::unordered_map<uint64_t, ServiceDevice> devices;
+
+    void Describe(const ServiceDevice& device) {
+        devices[device.handle] = device;
+        if (!ring.WriteDevice(device)) {
+            DEBUG_LOG("[service] device table full, %llu not announced\n", (unsigned long long)device.handle);
+        }
+    }
+
+    static void Tap(void* context, const MouseEvent& event) {
+        DaemonPublisher& self = *(DaemonPublisher*)context;
+        const uint64_t handle = self.pipeline->GetDeviceSlot(event.deviceId).handle;
+
+        if (event.type == EventType::Device && event.action == EventAction::Added) {
+            InputDeviceInfo info;
+            if (self.pipeline->Registry().Find(event.deviceId, &info)) {
+                self.Describe(MakeServiceDevice(info, true));
+            }
+        } else if (event.type == EventType::Device && event.action == EventAction::Removed) {
+            auto it = self.devices.find(handle);
+            if (it != self.devices.end()) {
+                ServiceDevice device = it->second;
+                device.active = 0;
+                self.Describe(device);
+            }
+        } else if (!self.devices.count(handle)) {
+            // Injected devices never arrive; an inactive entry still gives clients their name.
+            InputDeviceInfo info;
+            info.handle = handle;
+            info.name = self.pipeline->GetDeviceSlot(event.deviceId).name;
+            self.Describe(MakeServiceDevice(info, false));
+        }
+
+        ServiceEvent published;
+        published.event = event;
+        published.handle = handle;
+        self.ring.Publish(published);
+        self.ring.Notify();
+    }
+};
+
+const char* RunInputDaemon(const InputDaemonConfig& config, const std::atomic<bool>& stop) {
+    // A daemon that just crashed still looks alive until its last heartbeat ages out, so only one
+    // that keeps beating counts as running.
+    {
+        SharedEventRing existing;
+        if (!existing.Open(config.name)) {
+            const int64_t beat = existing.LastHeartbeat();
+            while (existing.Alive(NowMicros()) && !stop.load()) {
+                if (existing.LastHeartbeat() != beat) {
+                    return "Input service is already running";
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+    }
+
+    std::unique_ptr<DaemonPublisher> publisher(new DaemonPublisher());
+    if (const char* error = publisher->ring.Create(config.name)) {
+        return error;
+    }
+    publisher->ring.Heartbeat(NowMicros());
+
+    // Simulated devices are announced before the backend runs, while this thread is still the
+    // ring's only writer.
+    std::vector<uint64_t> simulated;
+    for (int i = 0; i < config.simulateDevices; i++) {
+        InputDeviceInfo info;
+        info.handle = kSimulatedHandleBase + (uint64_t)i + 1;
+        info.name = "Simulated Mouse " + std::to_string(i + 1);
+        info.identity.bus = DeviceBus::Virtual;
+        publisher->Describe(MakeServiceDevice(info, true));
+
+        ServiceEvent added = {};
+        added.event = MakeEvent(0, EventType::Device, EventAction::Added, 0, 0, 0, 0, 0);
+        added.handle = info.handle;
+        publisher->ring.Publish(added);
+        simulated.push_back(info.handle);
+    }
+    publisher->ring.Notify();
+
+    // Nothing drains this pipeline: the tap publishes, and an empty mask keeps the queue empty.
+    std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+    publisher->pipeline = pipeline.get();
+    pipeline->Subscriptions().SetDefault(0);
+    pipeline->SetEventTap(DaemonPublisher::Tap, publisher.get());
+
+    std::unique_ptr<InputBackend> backend = CreateInputBackend(*pipeline);
+    if (const char* error = backend->Start()) {
+        return error;
+    }
+
+    const int64_t period = config.simulateHz > 0 ? std::max<int64_t>(1, 1000000 / config.simulateHz) : kHeartbeatMicros;
+    int64_t nextBeat = NowMicros();
+    uint64_t tick = 0;
+    while (!stop.load()) {
+        const int64_t now = NowMicros();
+        if (now >= nextBeat) {
+            publisher->ring.Heartbeat(now);
+            nextBeat = now + kHeartbeatMicros;
+        }
+        if (config.simulateHz > 0) {
+            // dy == -dx, so a client can check every record it reads arrived whole.
+            const int dx = (int)(tick % 7) + 1;
+            for (uint64_t handle : simulated) {
+                backend->InjectMove(handle, dx, -dx);
+            }
+            tick++;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min(period, kHeartbeatMicros)));
+    }
+
+    backend->Stop();
+    publisher->ring.Close();
+    return nullptr;
+}
+
+class ServiceBackend : public InputBackend {
+public:
+    ServiceBackend(InputPipeline& pipeline, const std::string& name) : pipeline(pipeline), name(name) {}
+
+    const char* Start() override {
+        ring.reset(new SharedEventRing());
+        if (const char* error = ring->Open(name)) {
+            return error;
+        }
+        if (!ring->Alive(NowMicros())) {
+            ring->Close();
+            return "Input service not running";
+        }
+        stopRequested = false;
+        instance = ring->Instance();
+        position = ring->Head();
+        SyncDevices();
+        inputThread = std::thread([this]() { Run(); });
+        return nullptr;
+    }
+
+    void Stop() override {
+        stopRequested = true;
+        WakeInputThread();
+        inputThread.join();
+        ring.reset();
+    }
+
+    void RequestFlush() override {
+        WakeInputThread();
+    }
+
+    void InjectMove(uint64_t handle, int dx, int dy) override {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            injected.push_back({ handle, dx, dy });
+        }
+        WakeInputThread();
+    }
+
+private:
+    struct Injection {
+        uint64_t handle;
+        int dx, dy;
+    };
+
+    // The wake word is shared by every client of the ring, so this also wakes the others once;
+    // they find nothing new and wait again.
+    void WakeInputThread() {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (ring) {
+            ring->Wake();
+        }
+    }
+
+    // Input thread from here on.
+    void Run() {
+        int64_t lastCheck = NowMicros();
+        while (!stopRequested) {
+            RunCommands();
+
+            int64_t wait = pipeline.ProducerWaitMicros();
+            wait = wait < 0 ? kClientWaitMicros : std::min(wait, kClientWaitMicros);
+            const uint64_t head = ring->Head();
+            if (head <= position) {
+                ring->Wait(head, wait);
+            }
+            ReadEvents();
+
+            const int64_t now = NowMicros();
+            if (now - lastCheck >= kReconnectMicros) {
+                lastCheck = now;
+                if (!ring->Alive(now) || ring->Instance() != instance) {
+                    Reconnect(now);
+                }
+            }
+            pipeline.FlushProducer();
+            pipeline.WakeConsumer();
+        }
+        pipeline.Registry().Clear();
+        active.clear();
+    }
+
+    void RunCommands() {
+        std::vector<Injection> pending;
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            pending.swap(injected);
+        }
+        for (const Injection& injection : pending) {
+            uint32_t deviceId = pipeline.InternDevice(injection.handle, "Simulated Mouse");
+            pipeline.IngestEvent(MakeEvent(deviceId, EventType::Move, EventAction::None,
+                500 + injection.dx, 500 + injection.dy, injection.dx, injection.dy, 0));
+        }
+    }
+
+    void ReadEvents() {
+        const uint64_t head = ring->Head();
+        // Behind this client's position only when the segment was reset under it; Reconnect
+        // picks up the new instance.
+        if (head <= position) {
+            return;
+        }
+        pipeline.CountRead();
+
+        uint64_t lost = 0;
+        if (head - position > kEventRingCapacity) {
+            lost = head - position - kEventRingCapacity;
+            position = head - kEventRingCapacity;
+        }
+        uint64_t read = 0;
+        ServiceEvent published;
+        for (; position < head; position++) {
+            // The daemon may lap the oldest records while this copies them.
+            if (!ring->Read(position, &published)) {
+                lost++;
+                continue;
+            }
+            Deliver(published);
+            read++;
+        }
+        pipeline.CountMessages(read);
+        if (lost > 0) {
+            pipeline.Stats().CountServiceLost(lost);
+            DEBUG_LOG("[service] lost %llu events\n", (unsigned long long)lost);
+            // A lost arrival or removal would leave the registry wrong until the next one.
+            SyncDevices();
+        }
+    }
+
+    void Deliver(const ServiceEvent& published) {
+        MouseEvent event = published.event;
+        const uint64_t handle = published.handle;
+
+        if (event.type == EventType::Device) {
+            // SyncDevices may have applied the change already.
+            if (event.action == EventAction::Added) {
+                if (active.count(handle)) {
+                    return;
+                }
+                ServiceDevice device;
+                if (!ring->FindDevice(handle, &device)) {
+                    return;
+                }
+                event.deviceId = Register(device);
+            } else {
+                auto it = active.find(handle);
+                if (it == active.end()) {
+                    return;
+                }
+                event.deviceId = it->second;
+                pipeline.Registry().Remove(it->second);
+                active.erase(it);
+            }
+            pipeline.IngestEvent(event);
+            if (event.action == EventAction::Removed) {
+                pipeline.ReleaseDevice(event.deviceId);
+            }
+            return;
+        }
+
+        uint32_t deviceId;
+        if (!pipeline.LookupDevice(handle, &deviceId)) {
+            ServiceDevice device;
+            deviceId = pipeline.InternDevice(handle, ring->FindDevice(handle, &device) ? device.name : "Service Device");
+        }
+        event.deviceId = deviceId;
+        pipeline.IngestEvent(event);
+    }
+
+    uint32_t Register(const ServiceDevice& device) {
+        DeviceIdentity identity;
+        identity.vendorId = device.vendorId;
+        identity.productId = device.productId;
+        identity.interfaceNumber = device.interfaceNumber;
+        identity.bus = (DeviceBus)device.bus;
+        identity.kind = (DeviceKind)device.kind;
+        uint32_t id = pipeline.RegisterDevice(device.handle, device.name, device.path, identity);
+        active[device.handle] = id;
+        return id;
+    }
+
+    // Brings the registry in line with the daemon's table, with the arrivals and removals a local
+    // backend would have produced.
+    void SyncDevices() {
+        ServiceDevice devices[kServiceDeviceSlots];
+        const size_t count = ring->Devices(devices, kServiceDeviceSlots);
+
+        std::unordered_set<uint64_t> present;
+        for (size_t i = 0; i < count; i++) {
+            present.insert(devices[i].handle);
+        }
+        for (auto it = active.begin(); it != active.end();) {
+            if (present.count(it->first)) {
+                ++it;
+                continue;
+            }
+            pipeline.Registry().Remove(it->second);
+            pipeline.IngestEvent(MakeEvent(it->second, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0));
+            pipeline.ReleaseDevice(it->second);
+            it = active.erase(it);
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (!active.count(devices[i].handle)) {
+                uint32_t id = Register(devices[i]);
+                pipeline.IngestEvent(MakeEvent(id, EventType::Device, EventAction::Added, 0, 0, 0, 0, 0));
+            }
+        }
+    }
+
+    // Keeps the old mapping until a live daemon with a new instance has replaced it, so a daemon
+    // that is merely slow to beat is never dropped.
+    void Reconnect(int64_t now) {
+        std::unique_ptr<SharedEventRing> next(new SharedEventRing());
+        if (next->Open(name) || !next->Alive(now) || next->Instance() == instance) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(ringMutex);
+            ring.swap(next);
+        }
+        // Head first: an arrival published after it is read again, and Deliver skips it.
+        instance = ring->Instance();
+        position = ring->Head();
+        SyncDevices();
+        DEBUG_LOG("[service] reconnected to %s\n", name.c_str());
+    }
+
+    InputPipeline& pipeline;
+    std::string name;
+    std::unique_ptr<SharedEventRing> ring;
+    std::mutex ringMutex;
+    std::thread inputThread;
+    std::atomic<bool> stopRequested{false};
+
+    std::mutex commandMutex;
+    std::vector<Injection> injected;
+
+    uint64_t instance = 0;
+    uint64_t position = 0;
+    std::unordered_map<uint64_t, uint32_t> active;   // announced handle -> pipeline id
+};
+
+std::unique_ptr<InputBackend> CreateServiceBackend(InputPipeline& pipeline, const std::string& name) {
+    return std::unique_ptr<InputBackend>(new ServiceBackend(pipeline, name));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "input_backend.h"
+
+class InputPipeline;
+
+const char* const kDefaultServiceName = "orionix-input";
+
+struct InputDaemonConfig {
+    std::string name = kDefaultServiceName;
+    int simulateHz = 0;         // > 0: each simulated device moves this often
+    int simulateDevices = 0;    // announced like real devices, handles kSimulatedHandleBase + index
+};
+
+const uint64_t kSimulatedHandleBase = 0x53494d0000000000ull;
+
+// Runs the platform backend in this process and publishes its events and devices through a
+// SharedEventRing (shared_event_ring.h) until `stop` is set. Events go out as the backend
+// produced them, before any motion engine, filter or subscription, so every client applies its own.
+// Returns nullptr after a clean stop, or an error message.
+const char* RunInputDaemon(const InputDaemonConfig& config, const std::atomic<bool>& stop);
+
+// Client of a running daemon: reads the ring on its own input thread and ingests what it finds,
+// so the rest of the pipeline cannot tell it from a local backend. Survives daemon restarts by
+// reopening the ring and diffing the device table. Timestamps stay comparable because NowMicros'
+// clock is system-wide on both platforms.
+std::unique_ptr<InputBackend> CreateServiceBackend(InputPipeline& pipeline, const std::string& name);
@@ -0,0 +1,126 @@
+#include "input_stats.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+void InputStats::Snapshot(InputStatsSnapshot& snapshot) const {
+    snapshot.messages = messages_.Load();
+    snapshot.reads = reads_.Load();
+    snapshot.moves = moves_.Load();
+    snapshot.buttons = buttons_.Load();
+    snapshot.deviceEvents = deviceEvents_.Load();
+    snapshot.settleMoves = settleMoves_.Load();
+    snapshot.unsubscribed = unsubscribed_.Load();
+    snapshot.serviceLost = serviceLost_.Load();
+    snapshot.rejectedDevices = rejectedDevices_.Load();
+    snapshot.rejectedEvents = rejectedEvents_.Load();
+    snapshot.queueHighWater = queueHighWater_.Load();
+    snapshot.drainEvents = drainEvents_;
+    snapshot.drainMicros = drainMicros_;
+    snapshot.devices.clear();
+    for (uint32_t id = 0; id < kMaxDevices; id++) {
+        const uint64_t moves = devices_[id].moves.Load();
+        const uint64_t buttons = devices_[id].buttons.Load();
+        if (moves || buttons) {
+            snapshot.devices.push_back({ id, 0, std::string(), moves, buttons });
+        }
+    }
+}
+
+static void Append(std::string& out, const char* format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    out += line;
+}
+
+static std::string EscapeLabel(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+static void AppendCounter(std::string& out, const char* name, const char* help, uint64_t value) {
+    Append(out, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name, (unsigned long long)value);
+}
+
+static void AppendSummary(std::string& out, const char* name, const char* help, const LatencyHistogram& histogram) {
+    Append(out, "# HELP %s %s\n# TYPE %s summary\n", name, help, name);
+    const double quantiles[] = { 0.5, 0.9, 0.99 };
+    for (double quantile : quantiles) {
+        Append(out, "%s{quantile=\"%g\"} %lld\n", name, quantile, (long long)histogram.Percentile(quantile));
+    }
+    Append(out, "%s_sum %.0f\n%s_count %llu\n", name, histogram.Mean() * (double)histogram.Count(), name,
+        (unsigned long long)histogram.Count());
+}
+
+std::string FormatStatsText(const InputStatsSnapshot& snapshot) {
+    std::string out;
+    AppendCounter(out, "orionix_input_messages_total", "OS input records read by the backend.", snapshot.messages);
+    AppendCounter(out, "orionix_input_reads_total", "Backend calls that fetched input records.", snapshot.reads);
+
+    Append(out, "# HELP orionix_input_events_total Events ingested by the pipeline, by type.\n"
+                "# TYPE orionix_input_events_total counter\n");
+    Append(out, "orionix_input_events_total{type=\"move\"} %llu\n", (unsigned long long)snapshot.moves);
+    Append(out, "orionix_input_events_total{type=\"button\"} %llu\n", (unsigned long long)snapshot.buttons);
+    Append(out, "orionix_input_events_total{type=\"device\"} %llu\n", (unsigned long long)snapshot.deviceEvents);
+    Append(out, "orionix_input_events_total{type=\"settle\"} %llu\n", (unsigned long long)snapshot.settleMoves);
+
+    Append(out, "# HELP orionix_device_events_total Events ingested per device.\n# TYPE orionix_device_events_total counter\n");
+    for (const DeviceStats& device : snapshot.devices) {
+        const std::string name = EscapeLabel(device.name);
+        Append(out, "orionix_device_events_total{device=\"%u\",handle=\"%llu\",name=\"%s\",type=\"move\"} %llu\n", device.id,
+            (unsigned long long)device.handle, name.c_str(), (unsigned long long)device.moves);
+        Append(out, "orionix_device_events_total{device=\"%u\",handle=\"%llu\",name=\"%s\",type=\"button\"} %llu\n", device.id,
+            (unsigned long long)device.handle, name.c_str(), (unsigned long long)device.buttons);
+    }
+
+    AppendCounter(out, "orionix_unsubscribed_events_total", "Events dropped because nobody subscribed to them.", snapshot.unsubscribed);
+    AppendCounter(out, "orionix_service_lost_events_total", "Events the input service overwrote before this client read them.", snapshot.serviceLost);
+    AppendCounter(out, "orionix_rejected_devices_total", "Devices refused because every device id was taken.", snapshot.rejectedDevices);
+    AppendCounter(out, "orionix_rejected_events_total", "Events dropped because their device was refused an id.", snapshot.rejectedEvents);
+    AppendCounter(out, "orionix_coalesced_moves_total", "Moves folded into a pending move.", snapshot.coalescedMoves);
+    AppendCounter(out, "orionix_emitted_moves_total", "Moves published to the event queue.", snapshot.emittedMoves);
+    AppendCounter(out, "orionix_queue_dropped_moves_total", "Moves dropped on a full queue.", snapshot.droppedMoves);
+    AppendCounter(out, "orionix_queue_merged_moves_total", "Moves merged on a full queue.", snapshot.mergedMoves);
+    AppendCounter(out, "orionix_queue_deferred_events_total", "Non-move events held back on a full queue until it had room.", snapshot.deferredEvents);
+
+    Append(out, "# HELP orionix_queue_pending Events waiting in the queue.\n# TYPE orionix_queue_pending gauge\norionix_queue_pending %llu\n",
+        (unsigned long long)snapshot.queuePending);
+    Append(out, "# HELP orionix_queue_high_water Deepest the queue has been after a producer batch.\n"
+                "# TYPE orionix_queue_high_water gauge\norionix_queue_high_water %llu\n",
+        (unsigned long long)snapshot.queueHighWater);
+    Append(out, "# HELP orionix_queue_backlog Events held back on the producer side of a full queue.\n"
+                "# TYPE orionix_queue_backlog gauge\norionix_queue_backlog %llu\n",
+        (unsigned long long)snapshot.queueBacklog);
+
+    AppendCounter(out, "orionix_frames_total", "Frame-paced deliveries.", snapshot.frames.frames);
+    AppendCounter(out, "orionix_frames_missed_total", "Frame-paced deliveries after the refresh they were meant for.", snapshot.frames.missed);
+    Append(out, "# HELP orionix_frame_jitter_micros Delivery time minus deadline of frame-paced deliveries.\n"
+                "# TYPE orionix_frame_jitter_micros summary\norionix_frame_jitter_micros_sum %.0f\norionix_frame_jitter_micros_count %llu\n",
+        snapshot.frames.jitterMeanMicros * (double)snapshot.frames.frames, (unsigned long long)snapshot.frames.frames);
+    Append(out, "# HELP orionix_frame_jitter_max_micros Largest delay of a frame-paced delivery past its deadline.\n"
+                "# TYPE orionix_frame_jitter_max_micros gauge\norionix_frame_jitter_max_micros %lld\n",
+        (long long)snapshot.frames.jitterMaxMicros);
+    Append(out, "# HELP orionix_frame_period_micros Current refresh period estimate.\n"
+                "# TYPE orionix_frame_period_micros gauge\norionix_frame_period_micros %lld\n",
+        (long long)snapshot.frames.periodMicros);
+    Append(out, "# HELP orionix_frame_locked Whether the schedule is locked onto the display refresh.\n"
+                "# TYPE orionix_frame_locked gauge\norionix_frame_locked %d\n",
+        snapshot.frames.locked ? 1 : 0);
+
+    AppendSummary(out, "orionix_drain_events", "Events delivered per consumer drain.", snapshot.drainEvents);
+    AppendSummary(out, "orionix_drain_micros", "Time spent in one consumer drain, JS callbacks included.", snapshot.drainMicros);
+    return out;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "event_ring.h"
+#include "frame_scheduler.h"
+#include "latency_histogram.h"
+
+// Written by one thread only, so an increment is a relaxed load and store instead of a locked
+// read-modify-write; readers on other threads see a recent value.
+class RelaxedCounter {
+public:
+    void Add(uint64_t amount = 1) { value_.store(value_.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+    void Max(uint64_t value) {
+        if (value > value_.load(std::memory_order_relaxed)) {
+            value_.store(value, std::memory_order_relaxed);
+        }
+    }
+    uint64_t Load() const { return value_.load(std::memory_order_relaxed); }
+    void Reset() { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+struct DeviceStats {
+    uint32_t id;
+    uint64_t handle;
+    std::string name;
+    uint64_t moves;
+    uint64_t buttons;
+};
+
+struct InputStatsSnapshot {
+    uint64_t messages = 0;     // OS input records read by the backend
+    uint64_t reads = 0;        // backend calls that fetched them
+    uint64_t moves = 0;
+    uint64_t buttons = 0;
+    uint64_t deviceEvents = 0;
+    uint64_t settleMoves = 0;
+    uint64_t unsubscribed = 0;   // dropped by the subscription masks
+    uint64_t serviceLost = 0;    // overwritten in the input service's ring before this client read them
+    uint64_t rejectedDevices = 0;   // devices refused once every id was taken
+    uint64_t rejectedEvents = 0;    // events from those devices, dropped
+    uint64_t coalescedMoves = 0;
+    uint64_t emittedMoves = 0;
+    uint64_t droppedMoves = 0;
+    uint64_t mergedMoves = 0;
+    uint64_t deferredEvents = 0;   // button/device events that waited in the queue backlog
+    uint64_t queueBacklog = 0;
+    uint64_t queuePending = 0;
+    uint64_t queueHighWater = 0;
+    FramePacingStats frames = {};   // Frame coalescing mode, every delivery since the pipeline was created
+    LatencyHistogram drainEvents;
+    LatencyHistogram drainMicros;
+    std::vector<DeviceStats> devices;   // devices that produced at least one event
+};
+
+// Hot-path counters of one InputPipeline. Event counters belong to the producer thread, drain
+// figures to the consumer thread; any thread may take a snapshot of the former.
+class InputStats {
+public:
+    static const size_t kMaxDevices = 256;
+
+    // Producer thread.
+    void CountMessages(uint64_t count) { messages_.Add(count); }
+    void CountRead() { reads_.Add(); }
+    void CountEvent(const MouseEvent& event) {
+        if (event.type == EventType::Move) {
+            moves_.Add();
+        } else if (event.type == EventType::Button) {
+            buttons_.Add();
+        } else {
+            deviceEvents_.Add();
+        }
+        if (event.deviceId < kMaxDevices && event.type != EventType::Device) {
+            PerDevice& device = devices_[event.deviceId];
+            (event.type == EventType::Move ? device.moves : device.buttons).Add();
+        }
+    }
+    void CountSettle() { settleMoves_.Add(); }
+    void CountUnsubscribed() { unsubscribed_.Add(); }
+    void CountServiceLost(uint64_t count) { serviceLost_.Add(count); }
+    void CountRejectedDevice() { rejectedDevices_.Add(); }
+    void CountRejectedEvent() { rejectedEvents_.Add(); }
+    void ObserveQueueDepth(size_t depth) { queueHighWater_.Max(depth); }
+    // A released id's counts leave with its device instead of passing to the next one.
+    void ForgetDevice(uint32_t deviceId) {
+        if (deviceId < kMaxDevices) {
+            devices_[deviceId].moves.Reset();
+            devices_[deviceId].buttons.Reset();
+        }
+    }
+
+    // Consumer thread.
+    void RecordDrain(size_t events, int64_t micros) {
+        if (events > 0) {
+            drainEvents_.Record((int64_t)events);
+            drainMicros_.Record(micros);
+        }
+    }
+    const LatencyHistogram& DrainEvents() const { return drainEvents_; }
+    const LatencyHistogram& DrainMicros() const { return drainMicros_; }
+
+    uint64_t Messages() const { return messages_.Load(); }
+
+    // Fills the counters this class owns; queue and coalescer figures come from InputPipeline.
+    void Snapshot(InputStatsSnapshot& snapshot) const;
+
+private:
+    struct PerDevice {
+        RelaxedCounter moves;
+        RelaxedCounter buttons;
+    };
+
+    RelaxedCounter messages_;
+    RelaxedCounter reads_;
+    RelaxedCounter moves_;
+    RelaxedCounter buttons_;
+    RelaxedCounter deviceEvents_;
+    RelaxedCounter settleMoves_;
+    RelaxedCounter unsubscribed_;
+    RelaxedCounter serviceLost_;
+    RelaxedCounter rejectedDevices_;
+    RelaxedCounter rejectedEvents_;
+    RelaxedCounter queueHighWater_;
+    PerDevice devices_[kMaxDevices];
+
+    LatencyHistogram drainEvents_;
+    LatencyHistogram drainMicros_;
+};
+
+// Prometheus text exposition of a snapshot, one sample per line.
+std::string FormatStatsText(const InputStatsSnapshot& snapshot);
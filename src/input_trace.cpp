@@ -0,0 +1,358 @@
+#include "input_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "input_pipeline.h"
+#include "mapped_file.h"
+
+static const char kTraceMagic[6] = { 'O', 'R', 'X', 'T', 'R', 'C' };
+static const size_t kTraceFlushBytes = 64 * 1024;
+
+static void PutVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+static void PutZigzag(std::string& out, int64_t value) {
+    PutVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static bool GetVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool GetZigzag(const uint8_t*& cursor, const uint8_t* end, int64_t& value) {
+    uint64_t raw;
+    if (!GetVarint(cursor, end, raw)) {
+        return false;
+    }
+    value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    return true;
+}
+
+TraceRecorder::~TraceRecorder() {
+    Stop();
+}
+
+bool TraceRecorder::Start(const std::string& path) {
+    if (IsActive()) {
+        return false;
+    }
+
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+
+    MouseEvent stale;
+    while (ring_.TryPop(stale)) {
+    }
+
+    buffer_.assign(kTraceMagic, sizeof(kTraceMagic));
+    buffer_.push_back((char)(kTraceVersion & 0xFF));
+    buffer_.push_back((char)(kTraceVersion >> 8));
+
+    lastTimestamp_ = 0;
+    lastX_.reset(new int32_t[kMaxDeviceSlots]());
+    lastY_.reset(new int32_t[kMaxDeviceSlots]());
+    described_.reset(new bool[kMaxDeviceSlots]());
+    written_.store(0);
+    dropped_.store(0);
+    stopRequested_.store(false);
+
+    writer_ = std::thread([this]() { WriterMain(); });
+    active_.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceRecorder::Stop() {
+    if (!IsActive()) {
+        return;
+    }
+    active_.store(false, std::memory_order_release);
+    stopRequested_.store(true);
+    writer_.join();
+    fclose(file_);
+    file_ = nullptr;
+}
+
+void TraceRecorder::WriterMain() {
+    MouseEvent event;
+    for (;;) {
+        bool idle = true;
+        while (ring_.TryPop(event)) {
+            Encode(event);
+            idle = false;
+            if (buffer_.size() >= kTraceFlushBytes) {
+                fwrite(buffer_.data(), 1, buffer_.size(), file_);
+                buffer_.clear();
+            }
+        }
+
+        if (idle) {
+            if (!buffer_.empty()) {
+                fwrite(buffer_.data(), 1, buffer_.size(), file_);
+                buffer_.clear();
+                fflush(file_);
+            }
+            if (stopRequested_.load()) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+void TraceRecorder::Encode(const MouseEvent& event) {
+    const uint32_t id = event.deviceId < kMaxDeviceSlots ? event.deviceId : (uint32_t)(kMaxDeviceSlots - 1);
+
+    if (!described_[id]) {
+        const DeviceSlot& slot = pipeline_.GetDeviceSlot(id);
+        const size_t nameLength = strlen(slot.name);
+        buffer_.push_back((char)kTraceDeviceInfo);
+        PutVarint(buffer_, 0);
+        PutVarint(buffer_, id);
+        PutVarint(buffer_, slot.handle);
+        PutVarint(buffer_, nameLength);
+        buffer_.append(slot.name, nameLength);
+        described_[id] = true;
+    }
+
+    const int64_t dt = lastTimestamp_ == 0 ? 0 : std::max<int64_t>(0, event.timestamp - lastTimestamp_);
+    lastTimestamp_ = event.timestamp;
+
+    switch (event.type) {
+        case EventType::Move:
+            buffer_.push_back((char)kTraceMove);
+            PutVarint(buffer_, dt);
+            PutVarint(buffer_, id);
+            PutZigzag(buffer_, event.deltaX);
+            PutZigzag(buffer_, event.deltaY);
+            PutZigzag(buffer_, (int64_t)event.x - lastX_[id]);
+            PutZigzag(buffer_, (int64_t)event.y - lastY_[id]);
+            PutVarint(buffer_, event.flags);
+            break;
+        case EventType::Button:
+            buffer_.push_back((char)kTraceButton);
+            PutVarint(buffer_, dt);
+            PutVarint(buffer_, id);
+            buffer_.push_back((char)event.action);
+            PutVarint(buffer_, event.flags);
+            break;
+        case EventType::Device:
+            buffer_.push_back((char)(event.action == EventAction::Added ? kTraceDeviceAdded : kTraceDeviceRemoved));
+            PutVarint(buffer_, dt);
+            PutVarint(buffer_, id);
+            if (event.action == EventAction::Added) {
+                PutZigzag(buffer_, event.x);
+                PutZigzag(buffer_, event.y);
+            }
+            break;
+    }
+
+    lastX_[id] = event.x;
+    lastY_[id] = event.y;
+    // A released id may come back as another device, which is described anew.
+    if (event.type == EventType::Device && event.action == EventAction::Removed) {
+        described_[id] = false;
+    }
+    written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+class ReplayBackend : public InputBackend {
+public:
+    ReplayBackend(InputPipeline& pipeline, const std::string& path, bool realtime) : pipeline(pipeline), path(path), realtime(realtime) {}
+
+    const char* Start() override {
+        if (!trace.Open(path)) {
+            return "Failed to map trace file";
+        }
+        if (trace.size < sizeof(kTraceMagic) + 2 || memcmp(trace.view, kTraceMagic, sizeof(kTraceMagic)) != 0) {
+            return "Not an Orionix trace file";
+        }
+        uint16_t version = (uint16_t)(trace.view[6] | (trace.view[7] << 8));
+        if (version != kTraceVersion) {
+            return "Unsupported trace version";
+        }
+
+        replayThread = std::thread([this]() { Run(); });
+        return nullptr;
+    }
+
+    void Stop() override {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex);
+            stopRequested = true;
+        }
+        stopSignal.notify_all();
+        replayThread.join();
+    }
+
+    void RequestFlush() override {}
+    void InjectMove(uint64_t, int, int) override {}
+
+private:
+    // Sleeps until the given time while keeping the producer flushed; false once stopped.
+    bool WaitUntil(int64_t due) {
+        for (;;) {
+            int64_t now = NowMicros();
+            if (now >= due) {
+                return !stopRequested;
+            }
+            int64_t wait = pipeline.ProducerWaitMicros();
+            int64_t sleep = wait < 0 ? due - now : std::min(wait, due - now);
+            std::unique_lock<std::mutex> lock(stopMutex);
+            if (stopSignal.wait_for(lock, std::chrono::microseconds(sleep), [this]() { return stopRequested.load(); })) {
+                return false;
+            }
+            lock.unlock();
+            pipeline.FlushProducer();
+            pipeline.WakeConsumer();
+        }
+    }
+
+    void Run() {
+        std::vector<uint32_t> idMap(kMaxDeviceSlots, UINT32_MAX);
+        std::vector<int32_t> lastX(kMaxDeviceSlots, 0), lastY(kMaxDeviceSlots, 0);
+
+        const uint8_t* cursor = trace.view + sizeof(kTraceMagic) + 2;
+        const uint8_t* end = trace.view + trace.size;
+        const int64_t start = NowMicros();
+        int64_t traceTime = 0;
+        size_t sinceFlush = 0;
+
+        while (cursor < end && !stopRequested) {
+            uint8_t tag = *cursor++;
+            uint64_t dt, id;
+            if (!GetVarint(cursor, end, dt) || !GetVarint(cursor, end, id) || id >= kMaxDeviceSlots) {
+                break;
+            }
+            traceTime += (int64_t)dt;
+
+            if (tag == kTraceDeviceInfo) {
+                uint64_t handle, nameLength;
+                if (!GetVarint(cursor, end, handle) || !GetVarint(cursor, end, nameLength) || nameLength > (uint64_t)(end - cursor)) {
+                    break;
+                }
+                std::string name((const char*)cursor, (size_t)nameLength);
+                cursor += nameLength;
+                idMap[id] = pipeline.InternDevice(handle, name.c_str());
+                continue;
+            }
+
+            if (idMap[id] == UINT32_MAX) {
+                idMap[id] = pipeline.InternDevice(id, "Replayed Device");
+            }
+
+            MouseEvent event = {};
+            event.deviceId = idMap[id];
+            event.timestamp = start + traceTime;
+
+            bool valid = true;
+            switch (tag) {
+                case kTraceMove: {
+                    int64_t dx, dy, x, y;
+                    uint64_t flags = 0;
+                    valid = GetZigzag(cursor, end, dx) && GetZigzag(cursor, end, dy) &&
+                            GetZigzag(cursor, end, x) && GetZigzag(cursor, end, y) && GetVarint(cursor, end, flags);
+                    event.type = EventType::Move;
+                    event.action = EventAction::None;
+                    event.deltaX = (int32_t)dx;
+                    event.deltaY = (int32_t)dy;
+                    event.x = lastX[id] + (int32_t)x;
+                    event.y = lastY[id] + (int32_t)y;
+                    event.flags = (uint16_t)flags;
+                    break;
+                }
+                case kTraceButton: {
+                    uint64_t flags = 0;
+                    valid = cursor < end;
+                    if (valid) {
+                        event.action = (EventAction)*cursor++;
+                        valid = GetVarint(cursor, end, flags);
+                    }
+                    event.type = EventType::Button;
+                    event.x = lastX[id];
+                    event.y = lastY[id];
+                    event.flags = (uint16_t)flags;
+                    break;
+                }
+                case kTraceDeviceAdded: {
+                    int64_t x, y;
+                    valid = GetZigzag(cursor, end, x) && GetZigzag(cursor, end, y);
+                    event.type = EventType::Device;
+                    event.action = EventAction::Added;
+                    event.x = (int32_t)x;
+                    event.y = (int32_t)y;
+                    break;
+                }
+                case kTraceDeviceRemoved:
+                    event.type = EventType::Device;
+                    event.action = EventAction::Removed;
+                    break;
+                default:
+                    valid = false;
+            }
+            if (!valid) {
+                break;
+            }
+
+            lastX[id] = event.x;
+            lastY[id] = event.y;
+
+            if (realtime) {
+                if (!WaitUntil(event.timestamp)) {
+                    return;
+                }
+            } else {
+                while (pipeline.Queue().Size() > kEventQueueCapacity / 2 && !stopRequested) {
+                    pipeline.FlushProducer();
+                    pipeline.WakeConsumer();
+                    std::this_thread::yield();
+                }
+            }
+
+            pipeline.IngestEvent(event);
+            if (realtime || ++sinceFlush == 64) {
+                pipeline.FlushProducer();
+                pipeline.WakeConsumer();
+                sinceFlush = 0;
+            }
+        }
+
+        pipeline.FlushProducer();
+        pipeline.WakeConsumer();
+
+        while (WaitUntil(NowMicros() + 1000000)) {
+        }
+    }
+
+    InputPipeline& pipeline;
+    std::string path;
+    bool realtime;
+    MappedFile trace;
+    std::thread replayThread;
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    std::atomic<bool> stopRequested{false};
+};
+
+std::unique_ptr<InputBackend> CreateReplayBackend(InputPipeline& pipeline, const std::string& path, bool realtime) {
+    return std::unique_ptr<InputBackend>(new ReplayBackend(pipeline, path, realtime));
+}
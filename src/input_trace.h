@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "event_ring.h"
+#include "input_backend.h"
+
+class InputPipeline;
+
+// Trace file: "ORXTRC" + uint16 version, then records of
+//   uint8 tag, varint dtMicros, varint deviceId, payload
+// Move:    zigzag dx, dy, x - prevX, y - prevY, varint flags
+// Button:  uint8 action, varint flags
+// Added:   zigzag x, y
+// Removed: (none)
+// Info:    varint handle, varint nameLength, name bytes (written before a device's first record)
+enum TraceTag : uint8_t {
+    kTraceMove = 1,
+    kTraceButton = 2,
+    kTraceDeviceAdded = 3,
+    kTraceDeviceRemoved = 4,
+    kTraceDeviceInfo = 5
+};
+
+const uint16_t kTraceVersion = 1;
+
+// Producer pushes into a private ring; a writer thread encodes and appends to the file,
+// so recording never blocks the input thread (records are counted as dropped instead).
+class TraceRecorder {
+public:
+    explicit TraceRecorder(const InputPipeline& pipeline) : pipeline_(pipeline) {}
+    ~TraceRecorder();
+
+    bool Start(const std::string& path);
+    void Stop();
+    bool IsActive() const { return active_.load(std::memory_order_acquire); }
+
+    // Producer side.
+    void Record(const MouseEvent& event) {
+        if (!ring_.TryPush(event)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t RecordsWritten() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t RecordsDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void WriterMain();
+    void Encode(const MouseEvent& event);
+
+    const InputPipeline& pipeline_;
+    SpscRing<MouseEvent, 16384> ring_;
+    std::atomic<bool> active_{false};
+    std::atomic<bool> stopRequested_{false};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread writer_;
+    FILE* file_ = nullptr;
+    std::string buffer_;
+    int64_t lastTimestamp_ = 0;
+    std::unique_ptr<int32_t[]> lastX_;
+    std::unique_ptr<int32_t[]> lastY_;
+    std::unique_ptr<bool[]> described_;
+};
+
+// Memory-maps a trace and feeds it through the pipeline on its own thread, either paced by the
+// recorded timestamps or as fast as the event queue drains.
+std::unique_ptr<InputBackend> CreateReplayBackend(InputPipeline& pipeline, const std::string& path, bool realtime);
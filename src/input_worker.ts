@@ -0,0 +1,71 @@
+import { parentPort, workerData } from 'worker_threads';
+import { startInputEngine } from './raw_input_detector';
+import { InputWorkerMessage, InputWorkerRequest, RawInputModuleInterface } from './types';
+
+const BATCH_RECORD_INT32S = 10;
+const BATCH_RECORD_BYTES = BATCH_RECORD_INT32S * 4;
+const EVENT_TYPE_DEVICE = 2;
+
+// Runs the native input engine off the main thread. Requiring the addon here creates an instance
+// of its own, whose backend wakes this worker's loop; each batch is copied out of the shared batch
+// buffer and transferred to the main thread, so the main thread never drains the native queue.
+const port = parentPort!;
+const rawInput = require(workerData.modulePath) as RawInputModuleInterface;
+const knownSlots = new Set<number>();
+
+function post(message: InputWorkerMessage, transfer?: ArrayBuffer[]): void {
+  port.postMessage(message, transfer);
+}
+
+function onBatch(count: number): void {
+  const ints = new Int32Array(buffer, 0, count * BATCH_RECORD_INT32S);
+  const slots: [number, number, string][] = [];
+  let deviceChanged = false;
+
+  for (let i = 0; i < count; i++) {
+    const base = i * BATCH_RECORD_INT32S;
+    const deviceId = ints[base];
+    if (!knownSlots.has(deviceId)) {
+      knownSlots.add(deviceId);
+      const slot = rawInput.getDeviceSlot?.(deviceId);
+      if (slot) slots.push([deviceId, slot.handle, slot.name]);
+    }
+    deviceChanged = deviceChanged || (ints[base + 1] & 0xff) === EVENT_TYPE_DEVICE;
+  }
+
+  const records = buffer.slice(0, count * BATCH_RECORD_BYTES);
+  const devices = deviceChanged ? rawInput.getDevices() : undefined;
+  post({ type: 'batch', count, records, slots, devices }, [records]);
+}
+
+rawInput.setCallbacks(
+  () => {},
+  () => {}
+);
+const buffer = rawInput.enableBatchMode!(onBatch, workerData.batchRecords);
+
+port.on('message', (request: InputWorkerRequest) => {
+  if (request.type === 'stop') {
+    rawInput.stopRawInput();
+    rawInput.disableBatchMode?.();
+    port.close();
+    return;
+  }
+
+  try {
+    const value = (rawInput as any)[request.method]?.(...request.args);
+    if (request.id !== undefined) post({ type: 'result', id: request.id, value });
+  } catch (error) {
+    if (request.id !== undefined) post({ type: 'result', id: request.id, error: String(error) });
+  }
+});
+
+try {
+  if (startInputEngine(rawInput, !!workerData.service)) {
+    post({ type: 'started' });
+  } else {
+    post({ type: 'error', message: 'Input failed to start' });
+  }
+} catch (error) {
+  post({ type: 'error', message: String(error) });
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Log-linear histogram of non-negative microsecond values: 64 linear sub-buckets per power of two,
+// so any recorded value is reported within ~1.6% of its true magnitude. Single writer.
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 6;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kMagnitudes = 40;
+    static const int kBucketCount = kSubBuckets * (kMagnitudes + 1);
+
+    LatencyHistogram() { Reset(); }
+
+    void Reset() {
+        memset(counts_, 0, sizeof(counts_));
+        count_ = 0;
+        sum_ = 0;
+        max_ = 0;
+    }
+
+    void Record(int64_t value) {
+        if (value < 0) value = 0;
+        counts_[BucketOf((uint64_t)value)]++;
+        count_++;
+        sum_ += (uint64_t)value;
+        max_ = std::max(max_, value);
+    }
+
+    void Merge(const LatencyHistogram& other) {
+        for (int i = 0; i < kBucketCount; i++) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t Count() const { return count_; }
+    int64_t Max() const { return max_; }
+    double Mean() const { return count_ ? (double)sum_ / (double)count_ : 0.0; }
+
+    // Upper bound of the bucket holding the given quantile (0..1), capped at the observed max.
+    int64_t Percentile(double quantile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(quantile * (double)count_ + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, count_));
+
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; i++) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(BucketUpperBound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static int BucketOf(uint64_t value) {
+        if (value < (uint64_t)kSubBuckets) {
+            return (int)value;
+        }
+        int shift = 63 - CountLeadingZeros(value) - kSubBucketBits;
+        if (shift >= kMagnitudes) {
+            return kBucketCount - 1;
+        }
+        int sub = (int)(value >> shift) - kSubBuckets;
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    static int64_t BucketUpperBound(int bucket) {
+        int magnitude = bucket / kSubBuckets;
+        int sub = bucket % kSubBuckets;
+        if (magnitude == 0) {
+            return sub;
+        }
+        return ((int64_t)(kSubBuckets + sub + 1) << (magnitude - 1)) - 1;
+    }
+
+    static int CountLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - (int)index;
+#elif defined(_MSC_VER)
+        // No 64-bit scan on 32-bit x86.
+        unsigned long index;
+        if (_BitScanReverse(&index, (unsigned long)(value >> 32))) {
+            return 31 - (int)index;
+        }
+        _BitScanReverse(&index, (unsigned long)value);
+        return 63 - (int)index;
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+    uint64_t counts_[kBucketCount];
+    uint64_t count_;
+    uint64_t sum_;
+    int64_t max_;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "latency_histogram.h"
+
+enum class LatencyStage : uint8_t {
+    Queue,     // ingest -> popped by the addon
+    Dispatch,  // ingest -> main-process handler
+    Send,      // ingest -> overlay IPC sent
+    Paint,     // ingest -> renderer report received back in main (includes the return hop)
+    Count
+};
+
+inline const char* LatencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::Queue: return "queue";
+        case LatencyStage::Dispatch: return "dispatch";
+        case LatencyStage::Send: return "send";
+        case LatencyStage::Paint: return "paint";
+        default: return "";
+    }
+}
+
+// Consumer-thread only. Remembers the ingest time of recently delivered sequence ids so later
+// stages, reported by seq from JS, can be measured against the same monotonic clock.
+class LatencyTracker {
+public:
+    static const size_t kRecentEvents = 4096;
+
+    void OnDelivered(uint32_t seq, int64_t ingestMicros, int64_t now) {
+        Recent& slot = recent_[seq & (kRecentEvents - 1)];
+        slot.seq = seq;
+        slot.ingest = ingestMicros;
+        histograms_[(size_t)LatencyStage::Queue].Record(now - ingestMicros);
+    }
+
+    // False when seq is unknown or has aged out of the recent window.
+    bool Report(LatencyStage stage, uint32_t seq, int64_t now) {
+        const Recent& slot = recent_[seq & (kRecentEvents - 1)];
+        if (slot.seq != seq || slot.ingest == 0) {
+            return false;
+        }
+        histograms_[(size_t)stage].Record(now - slot.ingest);
+        return true;
+    }
+
+    const LatencyHistogram& Histogram(LatencyStage stage) const {
+        return histograms_[(size_t)stage];
+    }
+
+    void Reset() {
+        for (LatencyHistogram& histogram : histograms_) {
+            histogram.Reset();
+        }
+    }
+
+private:
+    struct Recent {
+        uint32_t seq = 0;
+        int64_t ingest = 0;
+    };
+
+    Recent recent_[kRecentEvents];
+    LatencyHistogram histograms_[(size_t)LatencyStage::Count];
+};
@@ -25,6 +25,12 @@ const DEFAULT_CONFIG: AppConfig = {
   cursorSpeed: 1.0,
   acceleration: true,
   overlayDebug: false,
+  nativeCompositor: false,
+  inputWorker: false,
+  inputService: false,
+  motionSmoothing: false,
+  motionPrediction: false,
+  framePacing: false,
 };
 
 interface CursorState {
@@ -41,6 +47,7 @@ interface CursorState {
   cursorFile: string;
   hasMovedOnce: boolean;
   totalMovement: number;
+  seq?: number;
 }
 
 class OrionixAppElectron {
@@ -55,6 +62,8 @@ class OrionixAppElectron {
   private displays: Display[] = [];
   private displayBounds: Map<number, { x: number; y: number; width: number; height: number }> = new Map();
   private cachedTotalBounds: { minX: number; maxX: number; minY: number; maxY: number } | null = null;
+  private nativeMotion: boolean = false;
+  private motionRequest: number = 0;
 
   private screenWidth: number = 800;
   private screenHeight: number = 600;
@@ -105,6 +114,18 @@ class OrionixAppElectron {
   private devicePresent: Set<number> = new Set();
   private lockTeleportInterval: NodeJS.Timeout | null = null;
   private lockedPosition: { x: number; y: number } | null = null;
+  private nativeCursorLock: boolean = false;
+  // Bumped per lock and release, so a late lockCursor answer for an earlier lock is ignored.
+  private cursorLockRequest: number = 0;
+  private cursorHotspots: Record<string, { hotspotX: number; hotspotY: number; width: number; height: number }> = {};
+  private cursorThemePaths: Record<string, string> = {};
+  private compositorActive: boolean = false;
+  private compositorCursorSize: number = 32;
+  private compositorIds: Map<string, number> = new Map();
+  private nextCompositorId: number = 1;
+  private composePending: boolean = false;
+  private cursorTableName: string | null = null;
+  private tableReaders: Set<number> = new Set();
 
   constructor() {
     this.configPath = path.join(__dirname, '..', 'config.json');
@@ -280,6 +301,7 @@ class OrionixAppElectron {
 
     this.fileWatcher.on('change', (filePath: string) => {
       if (filePath.endsWith('cursorsToUse.json')) {
+        this.loadCursorTheme();
         this.sendToAllOverlays('cursors-config-changed', {});
 
         this.cursors.forEach((cursor, deviceId) => {
@@ -319,20 +341,43 @@ class OrionixAppElectron {
       const pos = this.lastHtmlPosByDevice.get(dev) ?? this.getFallbackSystemPos();
       this.lockedPosition = { x: pos.x, y: pos.y };
 
+      // The interval loop holds the cursor until the engine confirms it pins it on the input thread.
       if (this.mouseDetector.rawInputModule?.setSystemCursorPos) {
         this.mouseDetector.rawInputModule.setSystemCursorPos(this.lockedPosition.x, this.lockedPosition.y);
       }
-
       this.startLockTeleportLoop();
+
+      if (this.mouseDetector.rawInputModule?.lockCursor) {
+        const request = ++this.cursorLockRequest;
+        this.mouseDetector
+          .callEngine<boolean>('lockCursor', dev, pos.x, pos.y)
+          .catch(() => false)
+          .then((locked) => {
+            if (locked && request === this.cursorLockRequest) {
+              this.nativeCursorLock = true;
+              this.stopLockTeleportLoop();
+            }
+          });
+      }
     }
 
     if (this.ownerHandle === dev && set.size === 0) {
-      this.ownerHandle = null;
-      this.lockedPosition = null;
-      this.stopLockTeleportLoop();
+      this.releaseCursorLock();
     }
   }
 
+  private releaseCursorLock(): void {
+    // Also undoes a lock the engine has not confirmed yet; the unlock reaches it after the lock.
+    if (this.ownerHandle !== null || this.nativeCursorLock) {
+      this.mouseDetector.rawInputModule?.unlockCursor?.();
+    }
+    this.cursorLockRequest++;
+    this.ownerHandle = null;
+    this.lockedPosition = null;
+    this.stopLockTeleportLoop();
+    this.nativeCursorLock = false;
+  }
+
   private startLockTeleportLoop(): void {
     if (this.lockTeleportInterval) {
       return;
@@ -369,13 +414,12 @@ class OrionixAppElectron {
     if (!pos) return;
 
     if (this.ownerHandle) {
-      if (dev === this.ownerHandle) {
+      if (dev === this.ownerHandle && !this.nativeCursorLock) {
         if (this.lockedPosition && this.mouseDetector.rawInputModule?.setSystemCursorPos) {
           this.mouseDetector.rawInputModule.setSystemCursorPos(this.lockedPosition.x, this.lockedPosition.y);
         }
-      } else {
       }
-    } else {
+    } else if (!this.nativeMotion || !this.mouseDetector.rawInputModule?.setCursorRouting) {
       if (this.mouseDetector.rawInputModule?.setSystemCursorPos) {
         this.mouseDetector.rawInputModule.setSystemCursorPos(pos.x, pos.y);
       }
@@ -387,8 +431,7 @@ class OrionixAppElectron {
     this.pressedButtonsByDevice.delete(dev);
     this.lastHtmlPosByDevice.delete(dev);
     if (this.ownerHandle === dev) {
-      this.ownerHandle = null;
-      this.lockedPosition = null;
+      this.releaseCursorLock();
     }
   }
 
@@ -616,15 +659,20 @@ class OrionixAppElectron {
 
   private startMouseInput(): void {
     try {
-      const success = this.mouseDetector.start();
+      const success = this.mouseDetector.start({ worker: !!this.config.inputWorker, service: !!this.config.inputService });
 
       if (success) {
         this.centerSystemCursor();
+        this.syncMotionEngine();
+        this.syncMonitorLayout();
+        this.loadCursorTheme();
+        this.syncCompositor();
+        this.createCursorTable();
       }
     } catch (error) {}
 
     try {
-      this.cursorTypeDetector.start();
+      this.cursorTypeDetector.start(this.mouseDetector.rawInputModule);
     } catch (error) {}
   }
 
@@ -723,12 +771,7 @@ class OrionixAppElectron {
       }
     }
 
-    if (this.lockTeleportInterval) {
-      clearInterval(this.lockTeleportInterval);
-      this.lockTeleportInterval = null;
-    }
-    this.ownerHandle = null;
-    this.lockedPosition = null;
+    this.releaseCursorLock();
 
     this.settingsWindow = new BrowserWindow({
       width: 1200,
@@ -749,6 +792,7 @@ class OrionixAppElectron {
       icon: path.join(__dirname, '..', 'assets', 'icon.ico'),
       title: 'Orionix - Paramètres',
     });
+    this.syncSubscriptions();
 
     this.settingsWindow.loadFile(path.join(__dirname, '..', 'settingsInterface', 'settings.html'));
 
@@ -770,6 +814,7 @@ class OrionixAppElectron {
 
     this.settingsWindow.on('closed', () => {
       this.settingsWindow = null;
+      this.syncSubscriptions();
 
       this.restartApplication();
     });
@@ -827,8 +872,12 @@ class OrionixAppElectron {
   }
 
   private setupSettingsIPC(): void {
-    ipcMain.on('cursor:htmlPos', (event, data: { deviceHandle: number; x: number; y: number }) => {
+    ipcMain.on('cursor:htmlPos', (event, data: { deviceHandle: number; x: number; y: number; seq?: number }) => {
       this.lastHtmlPosByDevice.set(data.deviceHandle, { x: data.x, y: data.y });
+      this.reportLatency('paint', data.seq);
+      if (this.config.framePacing) {
+        this.mouseDetector.rawInputModule?.reportFrame?.();
+      }
     });
 
     ipcMain.on('settings-changed', (event, newSettings) => {
@@ -954,6 +1003,8 @@ class OrionixAppElectron {
       this.config.acceleration = newSettings.acceleration;
     }
 
+    this.syncMotionEngine();
+    this.cursors.forEach((cursor) => this.updateCompositorCursor(cursor));
     this.saveConfig();
   }
 
@@ -979,6 +1030,8 @@ class OrionixAppElectron {
       return;
     }
 
+    this.reportLatency('dispatch', mouseData.seq);
+
     const cursorId = mouseData.deviceId;
     const deviceName = mouseData.deviceName || 'Device Inconnu';
     const isRawInput = mouseData.isRawInput || false;
@@ -986,7 +1039,7 @@ class OrionixAppElectron {
     const dx = mouseData.dx || 0;
     const dy = mouseData.dy || 0;
 
-    if (dx === 0 && dy === 0) {
+    if (dx === 0 && dy === 0 && !mouseData.settled) {
       return;
     }
 
@@ -1013,16 +1066,24 @@ class OrionixAppElectron {
       this.manageSystemCursorVisibility();
     }
 
-    const scaledDx = dx / this.displayScaleFactor;
-    const scaledDy = dy / this.displayScaleFactor;
+    let newX: number;
+    let newY: number;
+    if (this.nativeMotion && isRawInput) {
+      newX = mouseData.x;
+      newY = mouseData.y;
+    } else {
+      const scaledDx = dx / this.displayScaleFactor;
+      const scaledDy = dy / this.displayScaleFactor;
 
-    let newX = cursor.x + scaledDx * this.config.sensitivity;
-    let newY = cursor.y + scaledDy * this.config.sensitivity;
+      newX = cursor.x + scaledDx * this.config.sensitivity;
+      newY = cursor.y + scaledDy * this.config.sensitivity;
+    }
 
     const beforeClampX = newX;
     const beforeClampY = newY;
 
-    const clamped = this.applySmartBounds(newX, newY, cursor.x, cursor.y);
+    // The native engine already kept the pointer on a monitor using the addon's layout index.
+    const clamped = this.nativeMotion && isRawInput ? { x: newX, y: newY } : this.applySmartBounds(newX, newY, cursor.x, cursor.y);
     newX = clamped.x;
     newY = clamped.y;
 
@@ -1036,6 +1097,7 @@ class OrionixAppElectron {
     cursor.x = newX;
     cursor.y = newY;
     cursor.lastUpdate = performance.now();
+    cursor.seq = mouseData.seq;
 
     if (this.ownerHandle !== null && typeof deviceHandle === 'number' && deviceHandle === this.ownerHandle) {
       const physicalX = Math.round(newX * this.displayScaleFactor);
@@ -1076,8 +1138,12 @@ class OrionixAppElectron {
   }
 
   sendInstantCursorUpdate(cursor: CursorState): void {
-    if (cursor.hasMovedOnce) {
-      this.sendToAllOverlays('cursor-position-update', {
+    if (cursor.hasMovedOnce && this.compositorActive) {
+      this.updateCompositorCursor(cursor);
+      this.reportLatency('send', cursor.seq);
+    } else if (cursor.hasMovedOnce) {
+      this.writeCursorTable(cursor);
+      this.sendToIpcOverlays('cursor-position-update', {
         deviceId: cursor.id,
         x: cursor.x,
         y: cursor.y,
@@ -1086,7 +1152,15 @@ class OrionixAppElectron {
         cursorFile: cursor.cursorFile,
         isActive: cursor.id === this.lastActiveDevice,
         isVisible: true,
+        seq: cursor.seq,
       });
+      this.reportLatency('send', cursor.seq);
+    }
+  }
+
+  private reportLatency(stage: 'dispatch' | 'send' | 'paint', seq?: number): void {
+    if (seq && this.mouseDetector.rawInputModule?.reportLatency) {
+      this.mouseDetector.rawInputModule.reportLatency(stage, seq);
     }
   }
 
@@ -1108,6 +1182,17 @@ class OrionixAppElectron {
       this.cursors.delete(deviceId);
       this.manageSystemCursorVisibility();
 
+      if (this.cursorTableName) {
+        this.mouseDetector.rawInputModule?.removeCursorState?.(deviceId);
+      }
+
+      const compositorId = this.compositorIds.get(deviceId);
+      if (compositorId !== undefined) {
+        this.compositorIds.delete(deviceId);
+        this.mouseDetector.rawInputModule?.removeCompositorCursor?.(compositorId);
+        this.scheduleCompose();
+      }
+
       this.sendToAllOverlays('cursor-removed', deviceId);
 
       if (this.lastActiveDevice === deviceId) {
@@ -1147,8 +1232,46 @@ class OrionixAppElectron {
     });
   }
 
+  // Overlays reading the shared cursor table pick positions up on their own frame; the rest
+  // still get them over IPC.
+  private sendToIpcOverlays(channel: string, data: any): void {
+    this.overlayWindows.forEach((window) => {
+      if (window && !window.isDestroyed() && !this.tableReaders.has(window.webContents.id)) {
+        window.webContents.send(channel, data);
+      }
+    });
+  }
+
+  private createCursorTable(): void {
+    try {
+      this.cursorTableName = this.mouseDetector.rawInputModule?.createCursorTable?.() ?? null;
+    } catch (error) {
+      this.cursorTableName = null;
+    }
+    this.tableReaders.clear();
+    if (this.cursorTableName) {
+      this.sendToAllOverlays('cursor-table', { name: this.cursorTableName, modulePath: this.mouseDetector.modulePath });
+    }
+  }
+
+  private writeCursorTable(cursor: CursorState): void {
+    if (!this.cursorTableName || this.tableReaders.size === 0) return;
+    try {
+      this.mouseDetector.rawInputModule?.writeCursorState?.(cursor.id, {
+        x: cursor.x,
+        y: cursor.y,
+        type: cursor.cursorType || 'default',
+        color: cursor.color,
+        visible: true,
+        focused: cursor.id === this.lastActiveDevice,
+        seq: cursor.seq,
+      });
+    } catch (error) {}
+  }
+
   private createOverlayWindows(): void {
     this.closeAllOverlays();
+    this.tableReaders.clear();
 
     this.displays = screen.getAllDisplays();
     this.displayBounds.clear();
@@ -1157,6 +1280,9 @@ class OrionixAppElectron {
     this.analyzeDisplayConfiguration();
 
     const totalBounds = this.calculateTotalScreenBounds();
+    this.syncMotionEngine();
+    this.syncMonitorLayout();
+    this.syncCompositor();
     console.log(`🎯 Bounds totaux calculés:`, {
       minX: totalBounds.minX,
       minY: totalBounds.minY,
@@ -1413,6 +1539,7 @@ class OrionixAppElectron {
           cursorFile: cursor.cursorFile,
           timestamp: performance.now(),
           isActive: cursor.id === this.lastActiveDevice,
+          seq: cursor.seq,
         });
       }
     }
@@ -1444,6 +1571,14 @@ class OrionixAppElectron {
       return this.config;
     });
 
+    ipcMain.handle('get-latency-stats', (_event, reset?: boolean) => {
+      return this.mouseDetector.callEngine('getLatencyStats', reset).catch(() => null);
+    });
+
+    ipcMain.handle('get-input-stats', (_event, format?: 'text') => {
+      return this.mouseDetector.callEngine('getStats', format).catch(() => null);
+    });
+
     ipcMain.handle('get-device-count', () => {
       return this.mouseDetector.getDeviceCount();
     });
@@ -1452,8 +1587,25 @@ class OrionixAppElectron {
       this.handleMouseMove(mouseData);
     });
 
-    ipcMain.on('renderer-ready', () => {
+    ipcMain.on('renderer-ready', (event) => {
       this.sendExistingCursorsToRenderer();
+      event.reply('cursor-hotspots', this.cursorHotspots);
+      this.tableReaders.delete(event.sender.id);
+      if (this.cursorTableName) {
+        event.reply('cursor-table', { name: this.cursorTableName, modulePath: this.mouseDetector.modulePath });
+      }
+      this.overlayWindows.forEach((window, displayId) => {
+        if (window.webContents === event.sender) {
+          this.composeDisplays(true, displayId);
+        }
+      });
+    });
+
+    ipcMain.on('cursor-table-ready', (event) => {
+      this.tableReaders.add(event.sender.id);
+      this.cursors.forEach((cursor) => {
+        if (cursor.hasMovedOnce) this.writeCursorTable(cursor);
+      });
     });
 
     ipcMain.handle('increase-sensitivity', () => {
@@ -1539,14 +1691,228 @@ class OrionixAppElectron {
   }
 
   private sendConfigUpdate(): void {
+    this.syncMotionEngine();
     this.sendToAllOverlays('config-updated', this.config);
   }
 
+  private syncMotionEngine(): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    if (!rawInputModule?.configureMotion) {
+      this.nativeMotion = false;
+      return;
+    }
+
+    // The JS motion path and its clamp stay in use until the engine confirms it took over.
+    const bounds = this.calculateTotalScreenBounds();
+    const request = ++this.motionRequest;
+    this.mouseDetector
+      .callEngine<boolean>('configureMotion', {
+        enabled: true,
+        gain: this.config.sensitivity / this.displayScaleFactor,
+        acceleration: this.config.acceleration,
+        bounds: { x: bounds.minX, y: bounds.minY, width: bounds.maxX - bounds.minX, height: bounds.maxY - bounds.minY },
+        origin: { x: this.centerX, y: this.centerY },
+      })
+      .catch(() => false)
+      .then((enabled) => {
+        if (request !== this.motionRequest || this.mouseDetector.rawInputModule !== rawInputModule) {
+          return;
+        }
+        this.nativeMotion = enabled;
+        rawInputModule.setCursorRouting?.(enabled);
+        // Filters only change the positions the native engine hands back, so they need it on.
+        rawInputModule.configureMotionFilter?.({
+          smoothing: enabled && !!this.config.motionSmoothing,
+          prediction: enabled && !!this.config.motionPrediction,
+          refreshHz: screen.getPrimaryDisplay().displayFrequency || 60,
+        });
+      });
+    this.syncFramePacing();
+    this.syncStatsDump();
+    this.syncSubscriptions();
+  }
+
+  // Moves and buttons are ignored while the settings window is open, so the native side drops
+  // them instead of queueing them for nothing; device changes still come through.
+  private syncSubscriptions(): void {
+    const settingsOpen = !!this.settingsWindow && !this.settingsWindow.isDestroyed();
+    this.mouseDetector.rawInputModule?.setSubscription?.(settingsOpen ? ['device'] : ['move', 'button', 'device']);
+  }
+
+  private syncStatsDump(): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    if (!rawInputModule?.setStatsDump) {
+      return;
+    }
+
+    if (this.config.statsDumpPath) {
+      const dumpPath = path.resolve(app.getPath('userData'), this.config.statsDumpPath);
+      rawInputModule.setStatsDump(dumpPath, this.config.statsDumpIntervalMs ?? 5000);
+    } else {
+      rawInputModule.setStatsDump(null);
+    }
+  }
+
+  // One coalesced move per device per refresh, delivered just before it; the overlays' paint
+  // reports (reportFrame) give the phase where the platform has no vsync source.
+  private syncFramePacing(): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    if (!rawInputModule?.setCoalescing) {
+      return;
+    }
+
+    if (this.config.framePacing && rawInputModule.configureFramePacing) {
+      rawInputModule.configureFramePacing({ refreshHz: screen.getPrimaryDisplay().displayFrequency || 60 });
+      rawInputModule.setCoalescing('frame');
+    } else {
+      rawInputModule.setCoalescing('off');
+    }
+  }
+
+  private syncMonitorLayout(): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    if (!rawInputModule?.setMonitorLayout) {
+      return;
+    }
+
+    rawInputModule.setMonitorLayout(
+      this.displays.map((display) => {
+        const physical = process.platform === 'win32' ? screen.dipToScreenPoint({ x: display.bounds.x, y: display.bounds.y }) : undefined;
+        return {
+          id: display.id,
+          x: display.bounds.x,
+          y: display.bounds.y,
+          width: display.bounds.width,
+          height: display.bounds.height,
+          scaleFactor: display.scaleFactor,
+          physicalX: physical?.x,
+          physicalY: physical?.y,
+        };
+      })
+    );
+  }
+
+  // Decodes the theme's cursor files natively (served from the cache after the first run) so the
+  // overlays can place each cursor by its real hotspot.
+  private loadCursorTheme(): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    if (!rawInputModule?.loadCursors) {
+      return;
+    }
+
+    try {
+      const appRoot = app.isPackaged ? path.join(process.resourcesPath, 'app.asar.unpacked') : path.join(__dirname, '..');
+      const mapping: Record<string, string> = JSON.parse(fs.readFileSync(path.join(appRoot, 'cursorsToUse.json'), 'utf8').replace(/^\uFEFF/, ''));
+      const keys = Object.keys(mapping).filter((key) => /\.(cur|ani|ico)$/i.test(mapping[key]));
+      const result = rawInputModule.loadCursors(
+        keys.map((key) => path.resolve(appRoot, mapping[key])),
+        path.join(app.getPath('userData'), 'cursor-cache.bin')
+      );
+
+      this.cursorHotspots = {};
+      this.cursorThemePaths = {};
+      result.cursors.forEach((cursor, i) => {
+        this.cursorThemePaths[keys[i].toLowerCase()] = cursor.path;
+        const frame = cursor.frames?.[0];
+        if (frame) {
+          this.cursorHotspots[keys[i].toLowerCase()] = { hotspotX: frame.hotspotX, hotspotY: frame.hotspotY, width: frame.width, height: frame.height };
+        }
+      });
+      this.sendToAllOverlays('cursor-hotspots', this.cursorHotspots);
+      this.cursors.forEach((cursor) => this.updateCompositorCursor(cursor));
+    } catch (error) {}
+  }
+
+  // With nativeCompositor, the addon draws every cursor into one surface per display and the
+  // overlays only paint the rects that changed, instead of moving one DOM element per cursor.
+  private syncCompositor(): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    this.compositorActive = !!this.config.nativeCompositor && !!rawInputModule?.configureCompositor;
+    if (!this.compositorActive) {
+      return;
+    }
+
+    rawInputModule!.configureCompositor!(
+      this.displays.map((display) => ({
+        x: display.bounds.x,
+        y: display.bounds.y,
+        width: display.bounds.width,
+        height: display.bounds.height,
+      }))
+    );
+    this.getSystemCursorSize().then((size) => {
+      this.compositorCursorSize = size;
+      this.cursors.forEach((cursor) => this.updateCompositorCursor(cursor));
+      this.scheduleCompose();
+    });
+  }
+
+  private updateCompositorCursor(cursor: CursorState): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    const cursorPath = this.cursorThemePaths[cursor.cursorType.toLowerCase()] || this.cursorThemePaths.arrow;
+    if (!this.compositorActive || !cursor.hasMovedOnce || !cursorPath || !rawInputModule?.setCompositorCursor) {
+      return;
+    }
+
+    let id = this.compositorIds.get(cursor.id);
+    if (id === undefined) {
+      id = this.nextCompositorId++;
+      this.compositorIds.set(cursor.id, id);
+    }
+    try {
+      rawInputModule.setCompositorCursor(
+        id,
+        cursorPath,
+        {
+          size: this.compositorCursorSize,
+          color: this.config.colorIdentification ? cursor.color : '#FFFFFF',
+          opacity: this.config.cursorOpacity,
+        },
+        cursor.x,
+        cursor.y
+      );
+    } catch (error) {
+      return;
+    }
+    this.scheduleCompose();
+  }
+
+  // Moves from one event-loop turn are composed together.
+  private scheduleCompose(): void {
+    if (this.composePending) {
+      return;
+    }
+    this.composePending = true;
+    setImmediate(() => {
+      this.composePending = false;
+      this.composeDisplays(false);
+    });
+  }
+
+  private composeDisplays(full: boolean, displayId?: number): void {
+    const rawInputModule = this.mouseDetector.rawInputModule;
+    if (!this.compositorActive || !rawInputModule?.composeSurface) {
+      return;
+    }
+
+    this.displays.forEach((display, index) => {
+      if (displayId !== undefined && display.id !== displayId) {
+        return;
+      }
+      const rects = rawInputModule.composeSurface!(index, full);
+      const window = this.overlayWindows.get(display.id);
+      if (rects.length > 0 && window && !window.isDestroyed()) {
+        window.webContents.send('compositor-frame', rects);
+      }
+    });
+  }
+
   private resetConfig(): { success: boolean; message: string } {
     try {
       this.config = { ...DEFAULT_CONFIG };
 
       this.saveConfig();
+      this.syncMotionEngine();
 
       this.sendToAllOverlays('config-updated', this.config);
 
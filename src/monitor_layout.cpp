@@ -0,0 +1,138 @@
+#include "monitor_layout.h"
+
+#include <algorithm>
+#include <cmath>
+
+static void PhysicalRect(const MonitorInfo& monitor, int32_t& x, int32_t& y, int32_t& width, int32_t& height) {
+    x = monitor.physicalX;
+    y = monitor.physicalY;
+    width = (int32_t)std::lround(monitor.width * monitor.scale);
+    height = (int32_t)std::lround(monitor.height * monitor.scale);
+}
+
+static void Rect(const MonitorInfo& monitor, bool physical, int32_t& x, int32_t& y, int32_t& width, int32_t& height) {
+    if (physical) {
+        PhysicalRect(monitor, x, y, width, height);
+    } else {
+        x = monitor.x;
+        y = monitor.y;
+        width = monitor.width;
+        height = monitor.height;
+    }
+}
+
+void MonitorLayout::Grid::Build(const std::vector<MonitorInfo>& monitors, bool physical) {
+    xEdges.clear();
+    yEdges.clear();
+    for (const MonitorInfo& monitor : monitors) {
+        int32_t x, y, width, height;
+        Rect(monitor, physical, x, y, width, height);
+        xEdges.push_back(x);
+        xEdges.push_back(x + width);
+        yEdges.push_back(y);
+        yEdges.push_back(y + height);
+    }
+    std::sort(xEdges.begin(), xEdges.end());
+    xEdges.erase(std::unique(xEdges.begin(), xEdges.end()), xEdges.end());
+    std::sort(yEdges.begin(), yEdges.end());
+    yEdges.erase(std::unique(yEdges.begin(), yEdges.end()), yEdges.end());
+
+    const size_t columns = xEdges.empty() ? 0 : xEdges.size() - 1;
+    const size_t rows = yEdges.empty() ? 0 : yEdges.size() - 1;
+    cells.assign(columns * rows, -1);
+
+    // Earlier monitors win overlapping cells, matching a first-match scan over the list.
+    for (size_t i = 0; i < monitors.size(); i++) {
+        int32_t x, y, width, height;
+        Rect(monitors[i], physical, x, y, width, height);
+        size_t c0 = std::lower_bound(xEdges.begin(), xEdges.end(), x) - xEdges.begin();
+        size_t c1 = std::lower_bound(xEdges.begin(), xEdges.end(), x + width) - xEdges.begin();
+        size_t r0 = std::lower_bound(yEdges.begin(), yEdges.end(), y) - yEdges.begin();
+        size_t r1 = std::lower_bound(yEdges.begin(), yEdges.end(), y + height) - yEdges.begin();
+        for (size_t r = r0; r < r1; r++) {
+            for (size_t c = c0; c < c1; c++) {
+                if (cells[r * columns + c] < 0) {
+                    cells[r * columns + c] = (int16_t)i;
+                }
+            }
+        }
+    }
+}
+
+int MonitorLayout::Grid::Find(int32_t x, int32_t y) const {
+    if (cells.empty() || x < xEdges.front() || x >= xEdges.back() || y < yEdges.front() || y >= yEdges.back()) {
+        return -1;
+    }
+    size_t column = std::upper_bound(xEdges.begin(), xEdges.end(), x) - xEdges.begin() - 1;
+    size_t row = std::upper_bound(yEdges.begin(), yEdges.end(), y) - yEdges.begin() - 1;
+    return cells[row * (xEdges.size() - 1) + column];
+}
+
+void MonitorLayout::Build(const std::vector<MonitorInfo>& monitors) {
+    monitors_ = monitors;
+    if (monitors_.size() > 32767) {
+        monitors_.resize(32767);
+    }
+    logical_.Build(monitors_, false);
+    physical_.Build(monitors_, true);
+}
+
+int MonitorLayout::Nearest(int32_t x, int32_t y, bool physical) const {
+    int best = -1;
+    int64_t bestDistance = INT64_MAX;
+    for (size_t i = 0; i < monitors_.size(); i++) {
+        int32_t mx, my, width, height;
+        Rect(monitors_[i], physical, mx, my, width, height);
+        int64_t dx = x < mx ? mx - x : (x >= mx + width ? x - (mx + width - 1) : 0);
+        int64_t dy = y < my ? my - y : (y >= my + height ? y - (my + height - 1) : 0);
+        int64_t distance = dx * dx + dy * dy;
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+bool MonitorLayout::Constrain(int32_t fromX, int32_t fromY, int32_t& x, int32_t& y) const {
+    if (monitors_.empty() || Find(x, y) >= 0) {
+        return false;
+    }
+
+    int from = Find(fromX, fromY);
+    if (from < 0) {
+        from = Nearest(fromX, fromY, false);
+    }
+    const MonitorInfo& monitor = monitors_[from];
+    x = std::max(monitor.x, std::min(x, monitor.x + monitor.width - 1));
+    y = std::max(monitor.y, std::min(y, monitor.y + monitor.height - 1));
+    return true;
+}
+
+void MonitorLayout::ToLogical(int32_t* points, size_t count) const {
+    if (monitors_.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int32_t& x = points[i * 2];
+        int32_t& y = points[i * 2 + 1];
+        int index = FindPhysical(x, y);
+        const MonitorInfo& monitor = monitors_[index >= 0 ? index : Nearest(x, y, true)];
+        x = monitor.x + (int32_t)std::lround((x - monitor.physicalX) / monitor.scale);
+        y = monitor.y + (int32_t)std::lround((y - monitor.physicalY) / monitor.scale);
+    }
+}
+
+void MonitorLayout::ToPhysical(int32_t* points, size_t count) const {
+    if (monitors_.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int32_t& x = points[i * 2];
+        int32_t& y = points[i * 2 + 1];
+        int index = Find(x, y);
+        const MonitorInfo& monitor = monitors_[index >= 0 ? index : Nearest(x, y, false)];
+        x = monitor.physicalX + (int32_t)std::lround((x - monitor.x) * monitor.scale);
+        y = monitor.physicalY + (int32_t)std::lround((y - monitor.y) * monitor.scale);
+    }
+}
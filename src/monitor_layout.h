@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct MonitorInfo {
+    int64_t id;
+    int32_t x, y, width, height;   // logical (DIP) desktop coordinates
+    double scale;                  // physical pixels per logical pixel
+    int32_t physicalX, physicalY;  // top-left corner in physical desktop coordinates
+};
+
+// Immutable once built; rebuild on display change. Point queries bisect the sorted monitor edges
+// and read the covering monitor from a precomputed cell table, in logical or physical space.
+class MonitorLayout {
+public:
+    void Build(const std::vector<MonitorInfo>& monitors);
+
+    bool Empty() const { return monitors_.empty(); }
+    size_t Count() const { return monitors_.size(); }
+    const MonitorInfo& Monitor(int index) const { return monitors_[index]; }
+
+    // Index of the monitor containing the logical point, or -1 in a gap / off the desktop.
+    int Find(int32_t x, int32_t y) const { return logical_.Find(x, y); }
+    int FindPhysical(int32_t x, int32_t y) const { return physical_.Find(x, y); }
+
+    // A move may only land on a monitor; a target in a gap or off the desktop slides along the
+    // edges of the monitor the move started from. Returns true when the target was changed.
+    bool Constrain(int32_t fromX, int32_t fromY, int32_t& x, int32_t& y) const;
+
+    // In-place conversion of interleaved x, y pairs; points outside every monitor use the nearest one.
+    void ToLogical(int32_t* points, size_t count) const;
+    void ToPhysical(int32_t* points, size_t count) const;
+
+private:
+    struct Grid {
+        std::vector<int32_t> xEdges;
+        std::vector<int32_t> yEdges;
+        std::vector<int16_t> cells;
+
+        void Build(const std::vector<MonitorInfo>& monitors, bool physical);
+        int Find(int32_t x, int32_t y) const;
+    };
+
+    int Nearest(int32_t x, int32_t y, bool physical) const;
+
+    std::vector<MonitorInfo> monitors_;
+    Grid logical_;
+    Grid physical_;
+};
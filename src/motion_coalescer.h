@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "event_ring.h"
+
+enum class CoalesceMode : uint8_t {
+    Off,
+    Window,
+    UntilDrain,
+    Frame
+};
+
+// Sits between the input handler and the event queue (producer thread only, except where noted).
+// A device publishes at most one move per window (Window), per consumer drain (UntilDrain) or
+// per display frame (Frame, flushed by the pipeline's FrameScheduler); moves arriving in between
+// are folded into a pending move with summed deltas and the latest position. Any non-move event
+// of a device publishes its pending move first, so a click is always preceded by the motion that
+// led to it.
+template <size_t MaxDevices>
+class MotionCoalescer {
+public:
+    static constexpr int64_t kNoDeadline = INT64_MAX;
+
+    // Any thread.
+    void Configure(CoalesceMode mode, int64_t windowMicros) {
+        windowMicros_.store(windowMicros, std::memory_order_relaxed);
+        mode_.store(mode, std::memory_order_release);
+    }
+
+    CoalesceMode Mode() const { return mode_.load(std::memory_order_acquire); }
+    int64_t WindowMicros() const { return windowMicros_.load(std::memory_order_relaxed); }
+
+    // Consumer thread: marks the start of a drain.
+    void OnDrain() { drainEpoch_.fetch_add(1, std::memory_order_release); }
+
+    // Any thread: lets the consumer ask the producer for a flush after draining.
+    bool HasPending() const { return hasPending_.load(std::memory_order_acquire); }
+
+    uint64_t FoldedMoves() const { return folded_.load(std::memory_order_relaxed); }
+    uint64_t EmittedMoves() const { return emitted_.load(std::memory_order_relaxed); }
+
+    template <typename Sink>
+    void Push(const MouseEvent& event, int64_t now, Sink& sink) {
+        const CoalesceMode mode = Mode();
+        if (mode == CoalesceMode::Off || event.deviceId >= MaxDevices) {
+            if (pendingCount_ > 0) {
+                FlushAll(sink);
+            }
+            if (event.type == EventType::Move) {
+                emitted_.fetch_add(1, std::memory_order_relaxed);
+            }
+            sink.Push(event);
+            return;
+        }
+
+        DeviceState& state = devices_[event.deviceId];
+
+        if (event.type != EventType::Move) {
+            if (state.pending) {
+                Emit(state, now, sink);
+            }
+            sink.Push(event);
+            return;
+        }
+
+        if (state.pending) {
+            state.event.x = event.x;
+            state.event.y = event.y;
+            state.event.deltaX += event.deltaX;
+            state.event.deltaY += event.deltaY;
+            state.event.flags = event.flags;
+            state.event.seq = event.seq;
+            state.event.timestamp = event.timestamp;
+            folded_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            state.event = event;
+            state.pending = true;
+            pendingCount_++;
+            hasPending_.store(true, std::memory_order_release);
+        }
+
+        if (IsDue(state, mode, now)) {
+            Emit(state, now, sink);
+        }
+    }
+
+    // Publishes every pending move whose window expired or whose drain has happened.
+    template <typename Sink>
+    void Flush(int64_t now, Sink& sink) {
+        if (pendingCount_ == 0) {
+            return;
+        }
+        const CoalesceMode mode = Mode();
+        if (mode == CoalesceMode::Off) {
+            FlushAll(sink);
+            return;
+        }
+        for (size_t id = 0; id < MaxDevices && pendingCount_ > 0; id++) {
+            DeviceState& state = devices_[id];
+            if (state.pending && IsDue(state, mode, now)) {
+                Emit(state, now, sink);
+            }
+        }
+    }
+
+    template <typename Sink>
+    void FlushAll(Sink& sink) {
+        for (size_t id = 0; id < MaxDevices && pendingCount_ > 0; id++) {
+            if (devices_[id].pending) {
+                Emit(devices_[id], devices_[id].event.timestamp, sink);
+            }
+        }
+    }
+
+    // Publishes a released id's pending move and clears its window, so the next device to take
+    // the id starts fresh.
+    template <typename Sink>
+    void ForgetDevice(uint32_t deviceId, Sink& sink) {
+        if (deviceId >= MaxDevices) {
+            return;
+        }
+        DeviceState& state = devices_[deviceId];
+        if (state.pending) {
+            Emit(state, state.event.timestamp, sink);
+        }
+        state = DeviceState();
+    }
+
+    // Earliest time a pending move becomes due in Window mode.
+    int64_t NextDeadline() const {
+        if (pendingCount_ == 0 || Mode() != CoalesceMode::Window) {
+            return kNoDeadline;
+        }
+        const int64_t window = WindowMicros();
+        int64_t deadline = kNoDeadline;
+        for (size_t id = 0; id < MaxDevices; id++) {
+            if (devices_[id].pending && devices_[id].lastEmit + window < deadline) {
+                deadline = devices_[id].lastEmit + window;
+            }
+        }
+        return deadline;
+    }
+
+private:
+    struct DeviceState {
+        bool pending = false;
+        MouseEvent event{};
+        int64_t lastEmit = INT64_MIN / 2;
+        uint64_t emitEpoch = UINT64_MAX;
+    };
+
+    bool IsDue(const DeviceState& state, CoalesceMode mode, int64_t now) const {
+        if (mode == CoalesceMode::Window) {
+            return now - state.lastEmit >= WindowMicros();
+        }
+        if (mode == CoalesceMode::Frame) {
+            return false;
+        }
+        return state.emitEpoch != drainEpoch_.load(std::memory_order_acquire);
+    }
+
+    template <typename Sink>
+    void Emit(DeviceState& state, int64_t now, Sink& sink) {
+        sink.Push(state.event);
+        emitted_.fetch_add(1, std::memory_order_relaxed);
+        state.pending = false;
+        state.lastEmit = now;
+        state.emitEpoch = drainEpoch_.load(std::memory_order_acquire);
+        if (--pendingCount_ == 0) {
+            hasPending_.store(false, std::memory_order_release);
+        }
+    }
+
+    DeviceState devices_[MaxDevices];
+    size_t pendingCount_ = 0;
+    std::atomic<CoalesceMode> mode_{CoalesceMode::Off};
+    std::atomic<int64_t> windowMicros_{0};
+    std::atomic<uint64_t> drainEpoch_{0};
+    std::atomic<bool> hasPending_{false};
+    std::atomic<uint64_t> folded_{0};
+    std::atomic<uint64_t> emitted_{0};
+};
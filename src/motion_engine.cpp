@@ -0,0 +1,153 @@
+#include "motion_engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "input_pipeline.h"
+
+static const int kFixedShift = 16;
+static const double kFixedOne = (double)(1 << kFixedShift);
+
+void MotionEngine::Configure(const MotionConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        pending_ = config;
+    }
+    dirty_.store(true, std::memory_order_release);
+    enabled_.store(config.enabled, std::memory_order_release);
+}
+
+void MotionEngine::SetLayout(const MonitorLayout& layout) {
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        pendingLayout_ = layout;
+    }
+    dirty_.store(true, std::memory_order_release);
+}
+
+void MotionEngine::Place(uint64_t handle, int32_t x, int32_t y) {
+    placements_.TryPush({ handle, x, y });
+}
+
+void MotionEngine::SyncConfig() {
+    std::unique_lock<std::mutex> lock(configMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    config_ = pending_;
+    layout_ = pendingLayout_;
+    dirty_.store(false, std::memory_order_relaxed);
+
+    for (DeviceState& state : devices_) {
+        if (state.placed) {
+            Clamp(state);
+        }
+    }
+}
+
+void MotionEngine::ApplyPlacements() {
+    Placement placement;
+    while (placements_.TryPop(placement)) {
+        uint32_t id;
+        if (pipeline_.LookupDevice(placement.handle, &id) && id < kMaxDevices) {
+            DeviceState& state = devices_[id];
+            state.placed = true;
+            state.x = (int64_t)placement.x << kFixedShift;
+            state.y = (int64_t)placement.y << kFixedShift;
+            Clamp(state);
+        }
+    }
+}
+
+void MotionEngine::Clamp(DeviceState& state) const {
+    state.x = std::max((int64_t)config_.minX << kFixedShift, std::min(state.x, (int64_t)config_.maxX << kFixedShift));
+    state.y = std::max((int64_t)config_.minY << kFixedShift, std::min(state.y, (int64_t)config_.maxY << kFixedShift));
+}
+
+void MotionEngine::ToPhysical(int32_t& x, int32_t& y) const {
+    int32_t point[2] = { x, y };
+    layout_.ToPhysical(point, 1);
+    x = point[0];
+    y = point[1];
+}
+
+static int32_t ToPixel(int64_t fixed) {
+    return (int32_t)((fixed + ((int64_t)1 << (kFixedShift - 1))) >> kFixedShift);
+}
+
+// Keeps the pointer out of the gaps between monitors; the sub-pixel remainder is dropped only on
+// the axis that hit an edge.
+void MotionEngine::ConstrainToLayout(DeviceState& state, int64_t fromX, int64_t fromY) const {
+    if (layout_.Empty()) {
+        return;
+    }
+    int32_t x = ToPixel(state.x);
+    int32_t y = ToPixel(state.y);
+    const int32_t targetX = x;
+    const int32_t targetY = y;
+    if (layout_.Constrain(ToPixel(fromX), ToPixel(fromY), x, y)) {
+        if (x != targetX) {
+            state.x = (int64_t)x << kFixedShift;
+        }
+        if (y != targetY) {
+            state.y = (int64_t)y << kFixedShift;
+        }
+    }
+}
+
+// Speed in counts per millisecond, normalised by the report interval so 125 Hz and 8 kHz mice
+// follow the same curve.
+double MotionEngine::AccelerationFactor(const DeviceState& state, const MouseEvent& event) const {
+    const int64_t interval = std::max<int64_t>(125, std::min<int64_t>(event.timestamp - state.lastTimestamp, 20000));
+    const double speed = std::sqrt((double)event.deltaX * event.deltaX + (double)event.deltaY * event.deltaY) * 1000.0 / (double)interval;
+    const double factor = 1.0 + (speed - config_.accelThreshold) * config_.accelSlope;
+    return std::max(1.0, std::min(factor, config_.accelMax));
+}
+
+void MotionEngine::Apply(MouseEvent& event) {
+    if (dirty_.load(std::memory_order_acquire)) {
+        SyncConfig();
+    }
+    if (placements_.Size() > 0) {
+        ApplyPlacements();
+    }
+    if (!config_.enabled || event.deviceId >= kMaxDevices) {
+        return;
+    }
+
+    DeviceState& state = devices_[event.deviceId];
+
+    if (event.type == EventType::Device) {
+        if (event.action == EventAction::Removed) {
+            state.placed = false;
+        }
+        return;
+    }
+
+    if (!state.placed) {
+        state.placed = true;
+        state.x = (int64_t)config_.originX << kFixedShift;
+        state.y = (int64_t)config_.originY << kFixedShift;
+        // No previous report: the first one is measured like the first after a long pause.
+        state.lastTimestamp = 0;
+        Clamp(state);
+    }
+
+    if (event.type == EventType::Move) {
+        const int64_t fromX = state.x;
+        const int64_t fromY = state.y;
+        double gain = config_.gain;
+        if (config_.acceleration) {
+            gain *= AccelerationFactor(state, event);
+        }
+        state.x += (int64_t)std::llround(event.deltaX * gain * kFixedOne);
+        state.y += (int64_t)std::llround(event.deltaY * gain * kFixedOne);
+        state.lastTimestamp = event.timestamp;
+        Clamp(state);
+        ConstrainToLayout(state, fromX, fromY);
+    }
+
+    // Round to the nearest pixel so positive and negative motion truncate symmetrically.
+    event.x = ToPixel(state.x);
+    event.y = ToPixel(state.y);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "event_ring.h"
+#include "monitor_layout.h"
+
+class InputPipeline;
+
+struct MotionConfig {
+    bool enabled = false;
+    double gain = 1.0;             // output pixels per raw count
+    bool acceleration = false;
+    double accelThreshold = 1.5;   // counts per millisecond before the curve starts
+    double accelSlope = 0.25;      // extra gain per count/ms above the threshold
+    double accelMax = 3.0;         // cap on the acceleration multiplier
+    int32_t minX = 0, minY = 0;    // virtual desktop, inclusive
+    int32_t maxX = 1919, maxY = 1079;
+    int32_t originX = 960, originY = 540;
+};
+
+// Gives every device its own pointer position (producer thread). Positions are 48.16 fixed point,
+// so sub-pixel motion is carried between reports instead of being truncated away; moves and
+// buttons leave with x/y set to the device's pixel position, raw deltas untouched.
+class MotionEngine {
+public:
+    static const size_t kMaxDevices = 256;
+
+    explicit MotionEngine(const InputPipeline& pipeline) : pipeline_(pipeline) {}
+
+    // Any thread; picked up by the producer before its next event.
+    void Configure(const MotionConfig& config);
+    void SetLayout(const MonitorLayout& layout);
+    bool Enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    // JS thread only: moves a device's pointer, e.g. after the app clamped it to a monitor edge.
+    void Place(uint64_t handle, int32_t x, int32_t y);
+
+    // Producer thread.
+    void Apply(MouseEvent& event);
+    // Logical engine position to physical desktop pixels, per the current monitor layout.
+    void ToPhysical(int32_t& x, int32_t& y) const;
+
+private:
+    struct DeviceState {
+        bool placed = false;
+        int64_t x = 0;
+        int64_t y = 0;
+        int64_t lastTimestamp = 0;
+    };
+
+    struct Placement {
+        uint64_t handle;
+        int32_t x, y;
+    };
+
+    void SyncConfig();
+    void ApplyPlacements();
+    void Clamp(DeviceState& state) const;
+    void ConstrainToLayout(DeviceState& state, int64_t fromX, int64_t fromY) const;
+    double AccelerationFactor(const DeviceState& state, const MouseEvent& event) const;
+
+    const InputPipeline& pipeline_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> dirty_{false};
+    std::mutex configMutex_;
+    MotionConfig pending_;
+    MotionConfig config_;
+    MonitorLayout pendingLayout_;
+    MonitorLayout layout_;
+    SpscRing<Placement, 64> placements_;
+    DeviceState devices_[kMaxDevices];
+};
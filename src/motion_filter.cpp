@@ -0,0 +1,221 @@
+#include "motion_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "input_pipeline.h"
+
+static const double kPi = 3.14159265358979323846;
+// A device silent for longer than this starts over from its next report instead of blending
+// the new motion with a stale velocity.
+static const int64_t kResetGapMicros = 100000;
+static const int64_t kMinSettleMicros = 2000;
+// Initial velocity variance, (px/s)^2: the first reports decide the speed.
+static const double kInitialVelocityVariance = 4e6;
+
+void MotionFilter::ConfigureDefault(const MotionFilterConfig& config) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    pendingDefault_ = config;
+    bool enabled = config.Active();
+    for (const auto& device : pendingDevices_) {
+        enabled = enabled || device.second.Active();
+    }
+    dirty_.store(true, std::memory_order_release);
+    enabled_.store(enabled, std::memory_order_release);
+}
+
+void MotionFilter::ConfigureDevice(uint64_t handle, const MotionFilterConfig& config) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    auto it = std::find_if(pendingDevices_.begin(), pendingDevices_.end(), [handle](const auto& device) { return device.first == handle; });
+    if (it != pendingDevices_.end()) {
+        it->second = config;
+    } else {
+        pendingDevices_.emplace_back(handle, config);
+    }
+    dirty_.store(true, std::memory_order_release);
+    enabled_.store(true, std::memory_order_release);
+}
+
+void MotionFilter::ClearDevice(uint64_t handle) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    pendingDevices_.erase(std::remove_if(pendingDevices_.begin(), pendingDevices_.end(), [handle](const auto& device) { return device.first == handle; }),
+                          pendingDevices_.end());
+    dirty_.store(true, std::memory_order_release);
+}
+
+// The producer keeps filtering with the old configs if the JS thread holds the lock right now.
+void MotionFilter::SyncConfig() {
+    std::unique_lock<std::mutex> lock(configMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    default_ = pendingDefault_;
+    devices_ = pendingDevices_;
+    dirty_.store(false, std::memory_order_relaxed);
+    for (DeviceState& state : states_) {
+        state.configured = false;
+    }
+}
+
+const MotionFilterConfig& MotionFilter::ConfigFor(uint32_t deviceId) const {
+    const uint64_t handle = pipeline_.GetDeviceSlot(deviceId).handle;
+    for (const auto& device : devices_) {
+        if (device.first == handle) {
+            return device.second;
+        }
+    }
+    return default_;
+}
+
+void MotionFilter::Reset(DeviceState& state, int32_t x, int32_t y) const {
+    auto resetAxis = [&state](Axis& axis, double value) {
+        axis.smoothed = value;
+        axis.speed = 0;
+        axis.position = value;
+        axis.velocity = 0;
+        axis.p00 = state.config.measurementNoise;
+        axis.p01 = 0;
+        axis.p11 = kInitialVelocityVariance;
+    };
+    state.tracking = true;
+    resetAxis(state.x, x);
+    resetAxis(state.y, y);
+}
+
+static double SmoothingFactor(double cutoff, double dt) {
+    const double tau = 1.0 / (2 * kPi * cutoff);
+    return 1.0 / (1.0 + tau / dt);
+}
+
+double MotionFilter::Smooth(Axis& axis, double value, double dt, const MotionFilterConfig& config) const {
+    const double speed = (value - axis.smoothed) / dt;
+    axis.speed += SmoothingFactor(config.derivativeCutoff, dt) * (speed - axis.speed);
+    const double cutoff = config.minCutoff + config.beta * std::fabs(axis.speed);
+    axis.smoothed += SmoothingFactor(cutoff, dt) * (value - axis.smoothed);
+    return axis.smoothed;
+}
+
+// One predict/update step of a [position, velocity] Kalman filter, then extrapolation by the lead.
+double MotionFilter::Predict(Axis& axis, double value, double dt, const MotionFilterConfig& config) const {
+    const double q = config.processNoise;
+    axis.position += axis.velocity * dt;
+    axis.p00 += dt * (2 * axis.p01 + dt * axis.p11) + q * dt * dt * dt / 3;
+    axis.p01 += dt * axis.p11 + q * dt * dt / 2;
+    axis.p11 += q * dt;
+
+    const double innovation = value - axis.position;
+    const double s = axis.p00 + config.measurementNoise;
+    const double k0 = axis.p00 / s;
+    const double k1 = axis.p01 / s;
+    axis.position += k0 * innovation;
+    axis.velocity += k1 * innovation;
+    axis.p11 -= k1 * axis.p01;
+    axis.p00 -= k0 * axis.p00;
+    axis.p01 -= k0 * axis.p01;
+
+    return axis.position + axis.velocity * (config.leadMicros * 1e-6);
+}
+
+void MotionFilter::Apply(MouseEvent& event) {
+    if (dirty_.load(std::memory_order_acquire)) {
+        SyncConfig();
+    }
+    if (event.deviceId >= kMaxDevices) {
+        return;
+    }
+
+    deviceCount_ = std::max(deviceCount_, event.deviceId + 1);
+    DeviceState& state = states_[event.deviceId];
+    if (event.type == EventType::Device) {
+        if (event.action == EventAction::Removed) {
+            state.tracking = false;
+            state.configured = false;
+            if (!state.settled) {
+                state.settled = true;
+                unsettled_--;
+            }
+        }
+        return;
+    }
+    if (event.type != EventType::Move) {
+        return;
+    }
+
+    if (!state.configured) {
+        state.config = ConfigFor(event.deviceId);
+        state.configured = true;
+        state.tracking = false;
+    }
+    const MotionFilterConfig& config = state.config;
+    if (!config.Active()) {
+        return;
+    }
+
+    const int64_t elapsed = event.timestamp - state.lastTimestamp;
+    state.rawX = event.x;
+    state.rawY = event.y;
+    if (!state.tracking || elapsed > kResetGapMicros) {
+        Reset(state, event.x, event.y);
+    } else {
+        state.interval += (std::max<int64_t>(elapsed, 125) - state.interval) / 8;
+        // Reports sharing a timestamp still count as motion; a zero dt would stall the filters.
+        const double dt = std::max<int64_t>(elapsed, 50) * 1e-6;
+        double x = event.x;
+        double y = event.y;
+        if (config.smoothing) {
+            x = Smooth(state.x, x, dt, config);
+            y = Smooth(state.y, y, dt, config);
+        }
+        if (config.prediction) {
+            x = Predict(state.x, x, dt, config);
+            y = Predict(state.y, y, dt, config);
+        }
+        event.x = (int32_t)std::lround(x);
+        event.y = (int32_t)std::lround(y);
+    }
+    state.lastTimestamp = event.timestamp;
+
+    const bool settled = event.x == state.rawX && event.y == state.rawY;
+    if (settled != state.settled) {
+        state.settled = settled;
+        unsettled_ += settled ? -1 : 1;
+    }
+}
+
+static int64_t SettleTime(int64_t lastTimestamp, int64_t interval) {
+    return lastTimestamp + std::max(kMinSettleMicros, 2 * interval);
+}
+
+int64_t MotionFilter::NextDeadline() const {
+    if (unsettled_ == 0) {
+        return kNoDeadline;
+    }
+    int64_t deadline = kNoDeadline;
+    for (uint32_t id = 0; id < deviceCount_; id++) {
+        const DeviceState& state = states_[id];
+        if (!state.settled) {
+            deadline = std::min(deadline, SettleTime(state.lastTimestamp, state.interval));
+        }
+    }
+    return deadline;
+}
+
+bool MotionFilter::TakeSettle(int64_t now, MouseEvent& event) {
+    if (unsettled_ == 0) {
+        return false;
+    }
+    for (uint32_t id = 0; id < deviceCount_; id++) {
+        DeviceState& state = states_[id];
+        if (state.settled || SettleTime(state.lastTimestamp, state.interval) > now) {
+            continue;
+        }
+        state.settled = true;
+        unsettled_--;
+        // The hand stopped: keep filtering from rest at the true position.
+        Reset(state, state.rawX, state.rawY);
+        event = MakeEvent(id, EventType::Move, EventAction::None, state.rawX, state.rawY, 0, 0, kMoveFlagSettle);
+        event.timestamp = now;
+        return true;
+    }
+    return false;
+}
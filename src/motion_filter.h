@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "event_ring.h"
+
+class InputPipeline;
+
+// Set on the move MotionFilter emits once a device goes quiet, which carries no motion and puts
+// the cursor back on its true position.
+const uint16_t kMoveFlagSettle = 0x8000;
+
+struct MotionFilterConfig {
+    // One-Euro filter (Casiez et al.): a low-pass whose cutoff rises with speed, so a still hand
+    // loses its jitter while fast motion keeps little lag.
+    bool smoothing = false;
+    double minCutoff = 1.0;          // Hz at rest; lower removes more jitter
+    double beta = 0.02;              // cutoff increase per px/s; higher lags less when fast
+    double derivativeCutoff = 1.0;   // Hz, for the speed that drives the cutoff
+    // Constant-velocity Kalman filter; the cursor is drawn where it is expected to be leadMicros
+    // after the report, e.g. one display refresh later.
+    bool prediction = false;
+    int64_t leadMicros = 16667;
+    double processNoise = 4e7;       // px^2/s^3, white-acceleration density
+    double measurementNoise = 2.0;   // px^2 per report
+
+    bool Active() const { return smoothing || prediction; }
+};
+
+// Per-device smoothing and prediction of the delivered position (producer thread). It runs after
+// the motion engine and cursor lock and rewrites only the x/y handed to JS; the engine position,
+// the OS cursor and button coordinates keep the true position.
+class MotionFilter {
+public:
+    static const size_t kMaxDevices = 256;
+
+    explicit MotionFilter(const InputPipeline& pipeline) : pipeline_(pipeline) {}
+
+    // Any thread; picked up by the producer before its next event. The default covers every
+    // device without a config of its own.
+    void ConfigureDefault(const MotionFilterConfig& config);
+    void ConfigureDevice(uint64_t handle, const MotionFilterConfig& config);
+    void ClearDevice(uint64_t handle);
+    bool Enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    // Producer thread.
+    void Apply(MouseEvent& event);
+    // Earliest time a settle move is due, or kNoDeadline.
+    int64_t NextDeadline() const;
+    // Takes one settle move due by `now`: a device whose drawn position is off its true position
+    // and that has not reported for two of its report intervals.
+    bool TakeSettle(int64_t now, MouseEvent& event);
+
+    static const int64_t kNoDeadline = INT64_MAX;
+
+private:
+    struct Axis {
+        // One-Euro state.
+        double smoothed = 0;
+        double speed = 0;
+        // Kalman state: position, velocity and their covariance.
+        double position = 0;
+        double velocity = 0;
+        double p00 = 0, p01 = 0, p11 = 0;
+    };
+
+    struct DeviceState {
+        bool configured = false;
+        bool tracking = false;
+        bool settled = true;
+        MotionFilterConfig config;
+        int64_t lastTimestamp = 0;
+        int64_t interval = 8000;     // smoothed report interval
+        int32_t rawX = 0, rawY = 0;
+        Axis x, y;
+    };
+
+    void SyncConfig();
+    const MotionFilterConfig& ConfigFor(uint32_t deviceId) const;
+    void Reset(DeviceState& state, int32_t x, int32_t y) const;
+    double Smooth(Axis& axis, double value, double dt, const MotionFilterConfig& config) const;
+    double Predict(Axis& axis, double value, double dt, const MotionFilterConfig& config) const;
+
+    const InputPipeline& pipeline_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> dirty_{false};
+    std::mutex configMutex_;
+    MotionFilterConfig pendingDefault_;
+    std::vector<std::pair<uint64_t, MotionFilterConfig>> pendingDevices_;
+    MotionFilterConfig default_;
+    std::vector<std::pair<uint64_t, MotionFilterConfig>> devices_;
+    DeviceState states_[kMaxDevices];
+    uint32_t unsettled_ = 0;
+    uint32_t deviceCount_ = 0;   // states_ past this have never seen an event
+};
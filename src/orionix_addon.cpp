@@ -1,40 +1,98 @@
 #include <nan.h>
+#ifdef _WIN32
 #include <windows.h>
 #include <ShellScalingApi.h>
-#include <map>
+#include <dwmapi.h>
+#else
+#include <unistd.h>
+#endif
 #include <vector>
 #include <string>
+#include <cstring>
 #include <algorithm>
-#include <queue>
-#include <mutex>
-
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "cursor_bitmaps.h"
+#include "cursor_cache.h"
+#include "cursor_compositor.h"
+#include "cursor_lock.h"
+#include "cursor_raster.h"
+#include "cursor_shape.h"
+#include "cursor_state_table.h"
+#include "debug_log.h"
+#include "input_backend.h"
+#include "input_pipeline.h"
+#include "input_service.h"
+#include "input_stats.h"
+#include "input_trace.h"
+#include "latency_tracker.h"
+#include "monitor_layout.h"
+#include "motion_engine.h"
+#include "motion_filter.h"
+
+#ifdef _WIN32
 #pragma comment(lib, "Shcore.lib")
+#pragma comment(lib, "Dwmapi.lib")
+#endif
 
 using namespace Nan;
 
-struct MouseEvent {
-    HANDLE hDevice;
-    std::string deviceName;
-    int x, y;
-    int deltaX, deltaY;
-    int flags;
-    std::string type;
-    std::string action;
+// Batch records: int32 deviceId, typeCode (type | action << 8), x, y, dx, dy, flags, seq,
+// then a float64 timestamp in microseconds. 40 bytes keeps the float64 8-byte aligned.
+static const size_t kBatchRecordInt32s = 10;
+static const size_t kBatchRecordBytes = kBatchRecordInt32s * sizeof(int32_t);
+static const size_t kDefaultBatchRecords = 1024;
+
+// Everything one loaded copy of the addon owns. Node creates one per context that requires it
+// (the main thread and each worker_thread), so instances never share events, devices or callbacks.
+// Every method reaches its instance through the function data set up in Init.
+struct AddonInstance {
+    InputPipeline pipeline;
+
+    Nan::Persistent<v8::Function> moveCallback;
+    Nan::Persistent<v8::Function> deviceCallback;
+
+    std::unique_ptr<InputBackend> inputBackend;
+    bool inputRunning = false;
+    // Heap-allocated so they can outlive the instance until libuv's close callback.
+    uv_async_t* eventsAsync = nullptr;
+    Nan::AsyncResource* deliveryResource = nullptr;
+
+    Nan::Persistent<v8::Function> batchCallback;
+    Nan::Persistent<v8::ArrayBuffer> batchBuffer;
+    std::shared_ptr<v8::BackingStore> batchStore;
+    size_t batchCapacity = 0;
+
+    LatencyTracker latencyTracker;
+    // JS-thread copy for queries; the motion engine gets its own on the producer thread.
+    MonitorLayout monitorLayout;
+
+    std::unique_ptr<CursorShapeSource> cursorShapeSource;
+    Nan::Persistent<v8::Function> cursorShapeCallback;
+    uv_async_t* cursorShapeAsync = nullptr;
+    std::atomic<uint8_t> latestCursorType{(uint8_t)CursorType::Arrow};
+    CursorType deliveredCursorType = CursorType::Count;
+
+    CursorCache cursorCache;
+    CursorBitmapCache cursorBitmaps;
+    CursorCompositor compositor;
+
+    CursorStateTable cursorTableWriter;
+    CursorStateTable cursorTableReader;
+
+    uv_timer_t* statsTimer = nullptr;
+    std::string statsPath;
 };
 
-struct MouseDevice {
-    HANDLE hDevice;
-    std::string name;
-    int x, y;
-};
+static AddonInstance& Instance(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    return *static_cast<AddonInstance*>(info.Data().As<v8::External>()->Value());
+}
 
-static std::map<HANDLE, MouseDevice> devices;
-static HWND hiddenWindow = nullptr;
-static Nan::Persistent<v8::Function> moveCallback;
-static Nan::Persistent<v8::Function> deviceCallback;
-static std::queue<MouseEvent> eventQueue;
-static std::mutex eventMutex;
-static int messageCount = 0;
+#ifdef _WIN32
 static HCURSOR originalCursor = nullptr;
 static HCURSOR transparentCursor = nullptr;
 static bool cursorHidden = false;
@@ -87,46 +145,6 @@ BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType) {
     return FALSE;
 }
 
-std::string GetDeviceName(HANDLE hDevice) {
-    UINT nameSize;
-    GetRawInputDeviceInfo(hDevice, RIDI_DEVICENAME, nullptr, &nameSize);
-
-    if (nameSize > 0) {
-        std::vector<WCHAR> name(nameSize);
-        if (GetRawInputDeviceInfo(hDevice, RIDI_DEVICENAME, &name[0], &nameSize) > 0) {
-            std::wstring devicePath(&name[0]);
-
-            std::string cleanPath;
-            for (wchar_t wc : devicePath) {
-                if (wc >= 32 && wc <= 126) {
-                    cleanPath += (char)wc;
-                }
-            }
-
-            if (cleanPath.find("HID") != std::string::npos) {
-                if (cleanPath.find("VID_046D") != std::string::npos) {
-                    return "Logitech Mouse";
-                } else if (cleanPath.find("VID_1532") != std::string::npos) {
-                    return "Razer Mouse";
-                } else if (cleanPath.find("VID_045E") != std::string::npos) {
-                    return "Microsoft Mouse";
-                } else if (cleanPath.find("TouchPad") != std::string::npos || cleanPath.find("trackpad") != std::string::npos) {
-                    return "Trackpad";
-                } else {
-                    return "USB Mouse";
-                }
-            } else if (cleanPath.find("PS2") != std::string::npos) {
-                return "PS/2 Mouse";
-            } else if (cleanPath.find("Synaptics") != std::string::npos || cleanPath.find("TouchPad") != std::string::npos) {
-                return "Trackpad";
-            } else {
-                return "Generic Mouse";
-            }
-        }
-    }
-    return "Unknown Device";
-}
-
 HCURSOR CreateTransparentCursor() {
 
     const int width = 1;
@@ -146,144 +164,10 @@ HCURSOR CreateTransparentCursor() {
     );
 }
 
-LRESULT CALLBACK RawInputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-    switch (msg) {
-        case WM_INPUT: {
-            messageCount++;
-
-            UINT dwSize;
-            GetRawInputData((HRAWINPUT)lParam, RID_INPUT, nullptr, &dwSize, sizeof(RAWINPUTHEADER));
-
-            std::vector<BYTE> buffer(dwSize);
-            if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &buffer[0], &dwSize, sizeof(RAWINPUTHEADER)) == dwSize) {
-                RAWINPUT* raw = (RAWINPUT*)&buffer[0];
-
-                if (raw->header.dwType == RIM_TYPEMOUSE) {
-                    HANDLE hDevice = raw->header.hDevice;
-
-                    if (devices.find(hDevice) == devices.end()) {
-                        MouseDevice device;
-                        device.hDevice = hDevice;
-                        device.name = GetDeviceName(hDevice);
-                        device.x = GetSystemMetrics(SM_CXSCREEN) / 2;
-                        device.y = GetSystemMetrics(SM_CYSCREEN) / 2;
-                        devices[hDevice] = device;
-
-                        MouseEvent event;
-                        event.hDevice = hDevice;
-                        event.deviceName = device.name;
-                        event.x = device.x;
-                        event.y = device.y;
-                        event.deltaX = 0;
-                        event.deltaY = 0;
-                        event.flags = 0;
-                        event.type = "device";
-                        event.action = "added";
-
-                        std::lock_guard<std::mutex> lock(eventMutex);
-                        eventQueue.push(event);
-                    }
-
-                    auto& device = devices[hDevice];
-
-                    USHORT buttonFlags = raw->data.mouse.usButtonFlags;
-
-                    if (buttonFlags != 0) {
-                        char debugMsg[256];
-                        sprintf_s(debugMsg, "[C++] ButtonFlags = 0x%04X, Device = %p\n", buttonFlags, hDevice);
-                        OutputDebugStringA(debugMsg);
-                    }
-
-                    auto pushButton = [&](const char* action) {
-                        MouseEvent event;
-                        event.hDevice = hDevice;
-                        event.deviceName = device.name;
-                        event.x = device.x;
-                        event.y = device.y;
-                        event.deltaX = 0;
-                        event.deltaY = 0;
-                        event.flags = buttonFlags;
-                        event.type = "button";
-                        event.action = action;
-
-                        std::lock_guard<std::mutex> lock(eventMutex);
-                        eventQueue.push(event);
-                    };
-
-                    if (buttonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)   pushButton("left-down");
-                    if (buttonFlags & RI_MOUSE_LEFT_BUTTON_UP)     pushButton("left-up");
-                    if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)  pushButton("right-down");
-                    if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_UP)    pushButton("right-up");
-                    if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN) pushButton("middle-down");
-                    if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)   pushButton("middle-up");
-
-                    if (buttonFlags != 0) {
-                        OutputDebugStringA("[C++] Button flags detected!\n");
-                    }
-
-                    if (raw->data.mouse.lLastX != 0 || raw->data.mouse.lLastY != 0) {
-                        POINT cursorPos;
-                        if (GetCursorPos(&cursorPos)) {
-                            device.x = cursorPos.x;
-                            device.y = cursorPos.y;
-                        } else {
-                            device.x += raw->data.mouse.lLastX;
-                            device.y += raw->data.mouse.lLastY;
-
-                            device.x = std::max(0, std::min(device.x, GetSystemMetrics(SM_CXSCREEN) - 1));
-                            device.y = std::max(0, std::min(device.y, (GetSystemMetrics(SM_CYSCREEN) - 1)));
-                        }
-
-                        MouseEvent event;
-                        event.hDevice = hDevice;
-                        event.deviceName = device.name;
-                        event.x = device.x;
-                        event.y = device.y;
-                        event.deltaX = raw->data.mouse.lLastX;
-                        event.deltaY = raw->data.mouse.lLastY;
-                        event.flags = raw->data.mouse.usFlags;
-                        event.type = "move";
-                        event.action = "";
-
-                        std::lock_guard<std::mutex> lock(eventMutex);
-                        eventQueue.push(event);
-                    }
-                }
-            }
-            break;
-        }
-        case WM_INPUT_DEVICE_CHANGE: {
-            HANDLE hDevice = (HANDLE)lParam;
-            if (wParam == GIDC_REMOVAL) {
-
-                std::string deviceName = "Unknown";
-                auto it = devices.find(hDevice);
-                if (it != devices.end()) {
-                    deviceName = it->second.name;
-                    devices.erase(it);
-                }
-
-                MouseEvent event;
-                event.hDevice = hDevice;
-                event.deviceName = deviceName;
-                event.x = 0;
-                event.y = 0;
-                event.deltaX = 0;
-                event.deltaY = 0;
-                event.flags = 0;
-                event.type = "device";
-                event.action = "removed";
-
-                std::lock_guard<std::mutex> lock(eventMutex);
-                eventQueue.push(event);
-            }
-            break;
-        }
-    }
-    return DefWindowProc(hwnd, msg, wParam, lParam);
-}
+#endif
 
 NAN_METHOD(SetCallbacks) {
+    AddonInstance& addon = Instance(info);
     if (info.Length() < 2) {
         Nan::ThrowTypeError("Expected 2 arguments: (mouseMoveCallback, deviceChangeCallback)");
         return;
@@ -294,88 +178,291 @@ NAN_METHOD(SetCallbacks) {
         return;
     }
 
-    moveCallback.Reset(v8::Local<v8::Function>::Cast(info[0]));
-    deviceCallback.Reset(v8::Local<v8::Function>::Cast(info[1]));
+    addon.moveCallback.Reset(v8::Local<v8::Function>::Cast(info[0]));
+    addon.deviceCallback.Reset(v8::Local<v8::Function>::Cast(info[1]));
 }
 
-NAN_METHOD(StartRawInput) {
+void CallJs(AddonInstance& addon, v8::Local<v8::Function> callback, v8::Local<v8::Value> arg) {
+    v8::Local<v8::Value> argv[] = { arg };
+    if (addon.deliveryResource) {
+        addon.deliveryResource->runInAsyncScope(Nan::GetCurrentContext()->Global(), callback, 1, argv);
+    } else {
+        Nan::Call(callback, Nan::GetCurrentContext()->Global(), 1, argv);
+    }
+}
 
-    WNDCLASSA wc = {};
-    wc.lpfnWndProc = RawInputWndProc;
-    wc.hInstance = GetModuleHandle(nullptr);
-    wc.lpszClassName = "OrionixRawInput";
+int DrainMessages(AddonInstance& addon);
 
-    if (!RegisterClassA(&wc)) {
-        DWORD error = GetLastError();
-        if (error != ERROR_CLASS_ALREADY_EXISTS) {
+int DrainBatch(AddonInstance& addon) {
+    int total = 0;
+    size_t filled = 0;
+    std::shared_ptr<v8::BackingStore> store = addon.batchStore;
+    const size_t capacity = addon.batchCapacity;
+    uint8_t* data = (uint8_t*)store->Data();
+    MouseEvent event;
 
-            Nan::ThrowError("Failed to register window class");
-            return;
-        } else {
+    auto flush = [&]() {
+        Nan::HandleScope scope;
+        CallJs(addon, New(addon.batchCallback), Nan::New<v8::Number>((double)filled));
+        filled = 0;
+    };
+
+    while (addon.pipeline.Queue().Pop(event)) {
+        addon.latencyTracker.OnDelivered(event.seq, event.timestamp, NowMicros());
+
+        int32_t* record = (int32_t*)(data + filled * kBatchRecordBytes);
+        record[0] = (int32_t)event.deviceId;
+        record[1] = (int32_t)event.type | ((int32_t)event.action << 8);
+        record[2] = event.x;
+        record[3] = event.y;
+        record[4] = event.deltaX;
+        record[5] = event.deltaY;
+        record[6] = event.flags;
+        record[7] = (int32_t)event.seq;
+        double timestamp = (double)event.timestamp;
+        memcpy(record + 8, &timestamp, sizeof(timestamp));
+
+        total++;
+        if (++filled == capacity) {
+            flush();
+            if (addon.batchStore != store) {
+                return total + DrainMessages(addon);
+            }
+        }
+    }
+
+    if (filled > 0) {
+        flush();
+    }
+    return total;
+}
 
+static void SetDeviceMetadata(v8::Local<v8::Object> deviceObj, const InputDeviceInfo& device) {
+    Nan::Set(deviceObj, Nan::New("path").ToLocalChecked(), Nan::New(device.path.c_str()).ToLocalChecked());
+    Nan::Set(deviceObj, Nan::New("vendorId").ToLocalChecked(), Nan::New<v8::Number>(device.identity.vendorId));
+    Nan::Set(deviceObj, Nan::New("productId").ToLocalChecked(), Nan::New<v8::Number>(device.identity.productId));
+    Nan::Set(deviceObj, Nan::New("interface").ToLocalChecked(), Nan::New<v8::Number>(device.identity.interfaceNumber));
+    Nan::Set(deviceObj, Nan::New("bus").ToLocalChecked(), Nan::New(DeviceBusName(device.identity.bus)).ToLocalChecked());
+    Nan::Set(deviceObj, Nan::New("kind").ToLocalChecked(), Nan::New(DeviceKindName(device.identity.kind)).ToLocalChecked());
+}
+
+int DrainEvents(AddonInstance& addon) {
+    const int64_t start = NowMicros();
+    addon.pipeline.BeginDrain();
+    int count = DrainMessages(addon);
+    addon.pipeline.Stats().RecordDrain((size_t)count, NowMicros() - start);
+    if (addon.inputRunning && addon.pipeline.Coalescer().HasPending()) {
+        addon.inputBackend->RequestFlush();
+    }
+    return count;
+}
+
+int DrainMessages(AddonInstance& addon) {
+    if (!addon.batchCallback.IsEmpty()) {
+        return DrainBatch(addon);
+    }
+
+    int count = 0;
+    MouseEvent event;
+    while (addon.pipeline.Queue().Pop(event)) {
+        Nan::HandleScope scope;
+        addon.latencyTracker.OnDelivered(event.seq, event.timestamp, NowMicros());
+
+        const DeviceSlot& slot = addon.pipeline.GetDeviceSlot(event.deviceId);
+        const char* type = EventTypeName(event.type);
+        const char* action = EventActionName(event.action);
+
+        if ((event.type == EventType::Move || event.type == EventType::Button) && !addon.moveCallback.IsEmpty()) {
+            v8::Local<v8::Object> eventObj = New<v8::Object>();
+
+            Nan::Set(eventObj, Nan::New("type").ToLocalChecked(), Nan::New(type).ToLocalChecked());
+            Nan::Set(eventObj, Nan::New("deviceHandle").ToLocalChecked(), Nan::New<v8::Number>((double)slot.handle));
+            Nan::Set(eventObj, Nan::New("deviceName").ToLocalChecked(), Nan::New(slot.name).ToLocalChecked());
+            Nan::Set(eventObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(event.x));
+            Nan::Set(eventObj, Nan::New("y").ToLocalChecked(), Nan::New<v8::Number>(event.y));
+            Nan::Set(eventObj, Nan::New("dx").ToLocalChecked(), Nan::New<v8::Number>(event.deltaX));
+            Nan::Set(eventObj, Nan::New("dy").ToLocalChecked(), Nan::New<v8::Number>(event.deltaY));
+            Nan::Set(eventObj, Nan::New("flags").ToLocalChecked(), Nan::New<v8::Number>(event.flags));
+            Nan::Set(eventObj, Nan::New("action").ToLocalChecked(), Nan::New(action).ToLocalChecked());
+            Nan::Set(eventObj, Nan::New("seq").ToLocalChecked(), Nan::New<v8::Number>((double)event.seq));
+
+            CallJs(addon, New(addon.moveCallback), eventObj);
+
+        } else if (event.type == EventType::Device && !addon.deviceCallback.IsEmpty()) {
+            v8::Local<v8::Object> deviceObj = New<v8::Object>();
+
+            Nan::Set(deviceObj, Nan::New("action").ToLocalChecked(), Nan::New(action).ToLocalChecked());
+            Nan::Set(deviceObj, Nan::New("handle").ToLocalChecked(), Nan::New<v8::Number>((double)slot.handle));
+            Nan::Set(deviceObj, Nan::New("name").ToLocalChecked(), Nan::New(slot.name).ToLocalChecked());
+            Nan::Set(deviceObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(event.x));
+            Nan::Set(deviceObj, Nan::New("y").ToLocalChecked(), Nan::New<v8::Number>(event.y));
+
+            InputDeviceInfo device;
+            if (event.action == EventAction::Added && addon.pipeline.Registry().Find(event.deviceId, &device)) {
+                SetDeviceMetadata(deviceObj, device);
+            }
+
+            CallJs(addon, New(addon.deviceCallback), deviceObj);
         }
+
+        count++;
     }
+    return count;
+}
 
-    hiddenWindow = CreateWindowExA(
-        0,
-        "OrionixRawInput",
-        "Hidden",
-        WS_POPUP,
-        -32000, -32000, 1, 1,
-        nullptr,
-        nullptr,
-        GetModuleHandle(nullptr),
-        nullptr
-    );
+void OnEventsPending(uv_async_t* handle) {
+    Nan::HandleScope scope;
+    DrainEvents(*(AddonInstance*)handle->data);
+}
+
+// Input thread; each instance wakes only its own loop.
+void SignalEventsPending(void* context) {
+    uv_async_send(((AddonInstance*)context)->eventsAsync);
+}
+
+static uv_async_t* CreateAsync(AddonInstance& addon, uv_async_cb callback) {
+    uv_async_t* handle = new uv_async_t;
+    uv_async_init(Nan::GetCurrentEventLoop(), handle, callback);
+    handle->data = &addon;
+    uv_unref((uv_handle_t*)handle);
+    return handle;
+}
+
+// Starts delivery from the given backend; returns an error message on failure.
+static const char* StartBackend(AddonInstance& addon, std::unique_ptr<InputBackend> backend) {
+    if (!addon.eventsAsync) {
+        addon.eventsAsync = CreateAsync(addon, OnEventsPending);
+    }
+    uv_ref((uv_handle_t*)addon.eventsAsync);
+    addon.deliveryResource = new Nan::AsyncResource("OrionixRawInput");
+    addon.pipeline.SetConsumerWakeup(SignalEventsPending, &addon);
+    addon.pipeline.Cursor().SetSink(CreateSystemCursorSink());
+
+    addon.inputBackend = std::move(backend);
+    const char* error = addon.inputBackend->Start();
+    if (error) {
+        addon.inputBackend.reset();
+        uv_unref((uv_handle_t*)addon.eventsAsync);
+        delete addon.deliveryResource;
+        addon.deliveryResource = nullptr;
+        return error;
+    }
 
-    if (!hiddenWindow) {
-        DWORD error = GetLastError();
+    addon.inputRunning = true;
+    return nullptr;
+}
 
-        Nan::ThrowError("Failed to create hidden window");
+NAN_METHOD(StartRawInput) {
+    AddonInstance& addon = Instance(info);
+    if (addon.inputRunning) {
+        info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
         return;
-    } else {
+    }
 
+    const char* error = StartBackend(addon, CreateInputBackend(addon.pipeline));
+    if (error) {
+        Nan::ThrowError(error);
+        return;
     }
 
-    RAWINPUTDEVICE rid[1];
-    rid[0].usUsagePage = 0x01;
-    rid[0].usUsage = 0x02;
-    rid[0].dwFlags = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY;
-    rid[0].hwndTarget = hiddenWindow;
+#ifdef _WIN32
+    if (!SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE)) {
+
+    }
+#endif
 
-    if (!RegisterRawInputDevices(rid, 1, sizeof(rid[0]))) {
-        DWORD error = GetLastError();
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
+}
 
-        Nan::ThrowError("Failed to register raw input devices");
+NAN_METHOD(StartReplay) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected arguments: (tracePath, realtime?)");
         return;
-    } else {
+    }
+    if (addon.inputRunning) {
+        Nan::ThrowError("Input is already running; call stopRawInput first");
+        return;
+    }
+
+    Nan::Utf8String path(info[0]);
+    bool realtime = info.Length() < 2 || !info[1]->IsBoolean() || Nan::To<bool>(info[1]).FromJust();
 
+    const char* error = StartBackend(addon, CreateReplayBackend(addon.pipeline, *path, realtime));
+    if (error) {
+        Nan::ThrowError(error);
+        return;
     }
 
-    if (!SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE)) {
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
+}
+
+// connectInputService(name?): takes events from a running orionix_input_daemon instead of the
+// devices; stopRawInput disconnects.
+NAN_METHOD(ConnectInputService) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() > 0 && !info[0]->IsString() && !info[0]->IsUndefined()) {
+        Nan::ThrowTypeError("Expected arguments: (name?)");
+        return;
+    }
+    if (addon.inputRunning) {
+        Nan::ThrowError("Input is already running; call stopRawInput first");
+        return;
+    }
 
+    std::string name = info.Length() > 0 && info[0]->IsString() ? *Nan::Utf8String(info[0]) : kDefaultServiceName;
+    const char* error = StartBackend(addon, CreateServiceBackend(addon.pipeline, name));
+    if (error) {
+        Nan::ThrowError(error);
+        return;
     }
 
     info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
 }
 
-NAN_METHOD(StopRawInput) {
-    if (hiddenWindow) {
-        DestroyWindow(hiddenWindow);
-        hiddenWindow = nullptr;
+NAN_METHOD(StartTraceRecording) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected 1 argument: (tracePath)");
+        return;
     }
 
-    RAWINPUTDEVICE rid[1];
-    rid[0].usUsagePage = 0x01;
-    rid[0].usUsage = 0x02;
-    rid[0].dwFlags = RIDEV_REMOVE;
-    rid[0].hwndTarget = nullptr;
+    Nan::Utf8String path(info[0]);
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(addon.pipeline.Trace().Start(*path)));
+}
+
+NAN_METHOD(StopTraceRecording) {
+    AddonInstance& addon = Instance(info);
+    addon.pipeline.Trace().Stop();
+
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    Nan::Set(result, Nan::New("records").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Trace().RecordsWritten()));
+    Nan::Set(result, Nan::New("dropped").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Trace().RecordsDropped()));
+    info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(StopRawInput) {
+    AddonInstance& addon = Instance(info);
+    if (addon.inputRunning) {
+        addon.inputBackend->Stop();
+        addon.inputBackend.reset();
+        addon.inputRunning = false;
+        // An owner held across a restart would pin the cursor before JS re-declares it.
+        addon.pipeline.Cursor().Unlock();
+
+        uv_unref((uv_handle_t*)addon.eventsAsync);
+
+        Nan::HandleScope scope;
+        DrainEvents(addon);
 
-    RegisterRawInputDevices(rid, 1, sizeof(rid[0]));
+        delete addon.deliveryResource;
+        addon.deliveryResource = nullptr;
+    }
 
     info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
 }
 
+#ifdef _WIN32
 NAN_METHOD(SetSystemCursorPos) {
     if (info.Length() < 2) {
         Nan::ThrowTypeError("Expected 2 arguments: (x, y)");
@@ -412,11 +499,160 @@ NAN_METHOD(GetSystemCursorPos) {
     }
 }
 
+#endif
+
 NAN_METHOD(GetMessageCount) {
-    info.GetReturnValue().Set(Nan::New<v8::Number>(messageCount));
+    AddonInstance& addon = Instance(info);
+    info.GetReturnValue().Set(Nan::New<v8::Number>((double)addon.pipeline.MessageCount()));
+}
+
+static v8::Local<v8::Object> HistogramObject(const LatencyHistogram& histogram) {
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    Nan::Set(result, Nan::New("count").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Count()));
+    Nan::Set(result, Nan::New("mean").ToLocalChecked(), Nan::New<v8::Number>(histogram.Mean()));
+    Nan::Set(result, Nan::New("p50").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Percentile(0.50)));
+    Nan::Set(result, Nan::New("p99").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Percentile(0.99)));
+    Nan::Set(result, Nan::New("max").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Max()));
+    return result;
+}
+
+static v8::Local<v8::Object> FramePacingObject(const FramePacingStats& pacing) {
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    Nan::Set(result, Nan::New("count").ToLocalChecked(), Nan::New<v8::Number>((double)pacing.frames));
+    Nan::Set(result, Nan::New("missed").ToLocalChecked(), Nan::New<v8::Number>((double)pacing.missed));
+    Nan::Set(result, Nan::New("jitterMean").ToLocalChecked(), Nan::New<v8::Number>(pacing.jitterMeanMicros));
+    Nan::Set(result, Nan::New("jitterMax").ToLocalChecked(), Nan::New<v8::Number>((double)pacing.jitterMaxMicros));
+    Nan::Set(result, Nan::New("period").ToLocalChecked(), Nan::New<v8::Number>((double)pacing.periodMicros));
+    Nan::Set(result, Nan::New("locked").ToLocalChecked(), Nan::New<v8::Boolean>(pacing.locked));
+    return result;
+}
+
+// getStats(): one snapshot of the pipeline's counters; format 'text' gives the exposition format.
+NAN_METHOD(GetStats) {
+    AddonInstance& addon = Instance(info);
+    InputStatsSnapshot snapshot;
+    addon.pipeline.CollectStats(snapshot);
+
+    if (info.Length() > 0 && info[0]->IsString() && strcmp(*Nan::Utf8String(info[0]), "text") == 0) {
+        info.GetReturnValue().Set(Nan::New(FormatStatsText(snapshot)).ToLocalChecked());
+        return;
+    }
+
+    v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+    Nan::Set(stats, Nan::New("messages").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.messages));
+    Nan::Set(stats, Nan::New("reads").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.reads));
+    Nan::Set(stats, Nan::New("serviceLost").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.serviceLost));
+    Nan::Set(stats, Nan::New("rejectedDevices").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.rejectedDevices));
+    Nan::Set(stats, Nan::New("rejectedEvents").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.rejectedEvents));
+
+    v8::Local<v8::Object> events = Nan::New<v8::Object>();
+    Nan::Set(events, Nan::New("move").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.moves));
+    Nan::Set(events, Nan::New("button").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.buttons));
+    Nan::Set(events, Nan::New("device").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.deviceEvents));
+    Nan::Set(events, Nan::New("settle").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.settleMoves));
+    Nan::Set(events, Nan::New("unsubscribed").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.unsubscribed));
+    Nan::Set(stats, Nan::New("events").ToLocalChecked(), events);
+
+    v8::Local<v8::Object> queue = Nan::New<v8::Object>();
+    Nan::Set(queue, Nan::New("pending").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.queuePending));
+    Nan::Set(queue, Nan::New("highWater").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.queueHighWater));
+    Nan::Set(queue, Nan::New("coalescedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.coalescedMoves));
+    Nan::Set(queue, Nan::New("emittedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.emittedMoves));
+    Nan::Set(queue, Nan::New("droppedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.droppedMoves));
+    Nan::Set(queue, Nan::New("mergedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.mergedMoves));
+    Nan::Set(queue, Nan::New("deferredEvents").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.deferredEvents));
+    Nan::Set(queue, Nan::New("backlog").ToLocalChecked(), Nan::New<v8::Number>((double)snapshot.queueBacklog));
+    Nan::Set(stats, Nan::New("queue").ToLocalChecked(), queue);
+
+    v8::Local<v8::Object> drains = Nan::New<v8::Object>();
+    Nan::Set(drains, Nan::New("events").ToLocalChecked(), HistogramObject(snapshot.drainEvents));
+    Nan::Set(drains, Nan::New("micros").ToLocalChecked(), HistogramObject(snapshot.drainMicros));
+    Nan::Set(stats, Nan::New("drains").ToLocalChecked(), drains);
+    Nan::Set(stats, Nan::New("frames").ToLocalChecked(), FramePacingObject(snapshot.frames));
+
+    v8::Local<v8::Array> devices = Nan::New<v8::Array>((int)snapshot.devices.size());
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        const DeviceStats& device = snapshot.devices[i];
+        v8::Local<v8::Object> deviceObj = Nan::New<v8::Object>();
+        Nan::Set(deviceObj, Nan::New("id").ToLocalChecked(), Nan::New<v8::Number>(device.id));
+        Nan::Set(deviceObj, Nan::New("handle").ToLocalChecked(), Nan::New<v8::Number>((double)device.handle));
+        Nan::Set(deviceObj, Nan::New("name").ToLocalChecked(), Nan::New(device.name).ToLocalChecked());
+        Nan::Set(deviceObj, Nan::New("moves").ToLocalChecked(), Nan::New<v8::Number>((double)device.moves));
+        Nan::Set(deviceObj, Nan::New("buttons").ToLocalChecked(), Nan::New<v8::Number>((double)device.buttons));
+        Nan::Set(devices, (uint32_t)i, deviceObj);
+    }
+    Nan::Set(stats, Nan::New("devices").ToLocalChecked(), devices);
+
+    info.GetReturnValue().Set(stats);
+}
+
+// Written to a temporary file first so a scraper never reads half a dump.
+static void WriteStatsDump(uv_timer_t* timer) {
+    AddonInstance& addon = *(AddonInstance*)timer->data;
+    InputStatsSnapshot snapshot;
+    addon.pipeline.CollectStats(snapshot);
+    const std::string text = FormatStatsText(snapshot);
+
+    const std::string temporary = addon.statsPath + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    const bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (fclose(file) != 0 || !written) {
+        remove(temporary.c_str());
+        return;
+    }
+#ifdef _WIN32
+    MoveFileExA(temporary.c_str(), addon.statsPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    rename(temporary.c_str(), addon.statsPath.c_str());
+#endif
+}
+
+// setStatsDump(path, intervalMs = 5000) rewrites `path` with getStats('text') periodically;
+// setStatsDump(null) stops. The timer never keeps the process alive.
+NAN_METHOD(SetStatsDump) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !(info[0]->IsString() || info[0]->IsNull())) {
+        Nan::ThrowTypeError("Expected arguments: (path | null, intervalMs?)");
+        return;
+    }
+
+    if (addon.statsTimer) {
+        uv_timer_stop(addon.statsTimer);
+    }
+    if (info[0]->IsNull()) {
+        return;
+    }
+
+    double intervalMs = info.Length() > 1 && info[1]->IsNumber() ? Nan::To<double>(info[1]).FromJust() : 5000;
+    if (!(intervalMs >= 100)) {
+        Nan::ThrowRangeError("intervalMs must be at least 100");
+        return;
+    }
+
+    addon.statsPath = *Nan::Utf8String(info[0]);
+    if (!addon.statsTimer) {
+        addon.statsTimer = new uv_timer_t;
+        uv_timer_init(Nan::GetCurrentEventLoop(), addon.statsTimer);
+        addon.statsTimer->data = &addon;
+        uv_unref((uv_handle_t*)addon.statsTimer);
+    }
+    uv_timer_start(addon.statsTimer, WriteStatsDump, (uint64_t)intervalMs, (uint64_t)intervalMs);
+}
+
+// setDebugLogging(enabled): false when this build was compiled without ORIONIX_DEBUG_LOG.
+NAN_METHOD(SetDebugLogging) {
+    if (info.Length() < 1 || !info[0]->IsBoolean()) {
+        Nan::ThrowTypeError("Expected 1 argument: (enabled)");
+        return;
+    }
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(EnableDebugLog(Nan::To<bool>(info[0]).FromJust())));
 }
 
 NAN_METHOD(SimulateMouseMove) {
+    AddonInstance& addon = Instance(info);
     if (info.Length() < 3) {
         Nan::ThrowTypeError("Expected 3 arguments: (dx, dy, deviceHandle)");
         return;
@@ -424,119 +660,958 @@ NAN_METHOD(SimulateMouseMove) {
 
     int dx = Nan::To<int32_t>(info[0]).FromJust();
     int dy = Nan::To<int32_t>(info[1]).FromJust();
-    HANDLE hDevice = (HANDLE)(uintptr_t)Nan::To<uint32_t>(info[2]).FromJust();
+    uint64_t handle = Nan::To<uint32_t>(info[2]).FromJust();
 
-    MouseEvent event;
-    event.hDevice = hDevice;
-    event.deviceName = "Simulated Mouse";
-    event.x = 500 + dx;
-    event.y = 500 + dy;
-    event.deltaX = dx;
-    event.deltaY = dy;
-    event.flags = 0;
-    event.type = "move";
-    event.action = "";
-
-    std::lock_guard<std::mutex> lock(eventMutex);
-    eventQueue.push(event);
+    if (addon.inputRunning) {
+        addon.inputBackend->InjectMove(handle, dx, dy);
+    } else {
+        uint32_t deviceId = addon.pipeline.InternDevice(handle, "Simulated Mouse");
+        addon.pipeline.IngestEvent(MakeEvent(deviceId, EventType::Move, EventAction::None, 500 + dx, 500 + dy, dx, dy, 0));
+    }
 
     info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
 }
 
-NAN_METHOD(GetDevices) {
-    UINT numDevices;
-    if (GetRawInputDeviceList(nullptr, &numDevices, sizeof(RAWINPUTDEVICELIST)) != 0) {
-        Nan::ThrowError("Failed to get device count");
+NAN_METHOD(SetOverflowPolicy) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected 1 argument: (policy: 'drop' | 'merge')");
         return;
     }
 
-    std::vector<RAWINPUTDEVICELIST> deviceList(numDevices);
-    if (GetRawInputDeviceList(&deviceList[0], &numDevices, sizeof(RAWINPUTDEVICELIST)) == (UINT)-1) {
-        Nan::ThrowError("Failed to get device list");
+    Nan::Utf8String policy(info[0]);
+    if (strcmp(*policy, "drop") == 0) {
+        addon.pipeline.Queue().SetOverflowPolicy(OverflowPolicy::DropMoves);
+    } else if (strcmp(*policy, "merge") == 0) {
+        addon.pipeline.Queue().SetOverflowPolicy(OverflowPolicy::MergeMoves);
+    } else {
+        Nan::ThrowRangeError("Unknown overflow policy, expected 'drop' or 'merge'");
         return;
     }
 
-    v8::Local<v8::Array> result = New<v8::Array>();
-    int mouseIndex = 0;
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
+}
 
-    for (UINT i = 0; i < numDevices; i++) {
-        if (deviceList[i].dwType == RIM_TYPEMOUSE) {
-            v8::Local<v8::Object> deviceObj = New<v8::Object>();
-            std::string deviceName = GetDeviceName(deviceList[i].hDevice);
+NAN_METHOD(SetCoalescing) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected arguments: (mode: 'off' | 'window' | 'drain' | 'frame', windowMs?)");
+        return;
+    }
+
+    Nan::Utf8String mode(info[0]);
+    double windowMs = info.Length() > 1 && info[1]->IsNumber() ? Nan::To<double>(info[1]).FromJust() : 0;
+    int64_t windowMicros = (int64_t)(std::max(0.0, windowMs) * 1000);
+
+    if (strcmp(*mode, "off") == 0) {
+        addon.pipeline.Coalescer().Configure(CoalesceMode::Off, 0);
+    } else if (strcmp(*mode, "window") == 0) {
+        addon.pipeline.Coalescer().Configure(CoalesceMode::Window, windowMicros);
+    } else if (strcmp(*mode, "drain") == 0) {
+        addon.pipeline.Coalescer().Configure(CoalesceMode::UntilDrain, 0);
+    } else if (strcmp(*mode, "frame") == 0) {
+        addon.pipeline.Coalescer().Configure(CoalesceMode::Frame, 0);
+    } else {
+        Nan::ThrowRangeError("Unknown coalescing mode, expected 'off', 'window', 'drain' or 'frame'");
+        return;
+    }
+
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
+}
+
+static double GetNumberOption(v8::Local<v8::Object> options, const char* key, double fallback) {
+    v8::Local<v8::Value> value = Nan::Get(options, Nan::New(key).ToLocalChecked()).ToLocalChecked();
+    return value->IsNumber() ? Nan::To<double>(value).FromJust() : fallback;
+}
+
+static v8::Local<v8::Object> GetObjectOption(v8::Local<v8::Object> options, const char* key) {
+    v8::Local<v8::Value> value = Nan::Get(options, Nan::New(key).ToLocalChecked()).ToLocalChecked();
+    return value->IsObject() ? Nan::To<v8::Object>(value).ToLocalChecked() : Nan::New<v8::Object>();
+}
+
+NAN_METHOD(ConfigureMotion) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsObject()) {
+        Nan::ThrowTypeError("Expected 1 argument: ({ enabled, gain, acceleration, bounds, origin })");
+        return;
+    }
+
+    v8::Local<v8::Object> options = Nan::To<v8::Object>(info[0]).ToLocalChecked();
+    MotionConfig config;
+    config.enabled = Nan::To<bool>(Nan::Get(options, Nan::New("enabled").ToLocalChecked()).ToLocalChecked()).FromJust();
+    config.gain = GetNumberOption(options, "gain", config.gain);
+    config.acceleration = Nan::To<bool>(Nan::Get(options, Nan::New("acceleration").ToLocalChecked()).ToLocalChecked()).FromJust();
+    config.accelThreshold = GetNumberOption(options, "accelThreshold", config.accelThreshold);
+    config.accelSlope = GetNumberOption(options, "accelSlope", config.accelSlope);
+    config.accelMax = GetNumberOption(options, "accelMax", config.accelMax);
+
+    v8::Local<v8::Object> bounds = GetObjectOption(options, "bounds");
+    config.minX = (int32_t)GetNumberOption(bounds, "x", config.minX);
+    config.minY = (int32_t)GetNumberOption(bounds, "y", config.minY);
+    config.maxX = config.minX + std::max(0, (int32_t)GetNumberOption(bounds, "width", config.maxX - config.minX + 1) - 1);
+    config.maxY = config.minY + std::max(0, (int32_t)GetNumberOption(bounds, "height", config.maxY - config.minY + 1) - 1);
+
+    v8::Local<v8::Object> origin = GetObjectOption(options, "origin");
+    config.originX = (int32_t)GetNumberOption(origin, "x", (config.minX + config.maxX) / 2);
+    config.originY = (int32_t)GetNumberOption(origin, "y", (config.minY + config.maxY) / 2);
+
+    addon.pipeline.Motion().Configure(config);
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(config.enabled));
+}
+
+// configureMotionFilter(options, deviceHandle?): without a handle, the default for every device
+// that has no filter of its own. { smoothing, minCutoff, beta, derivativeCutoff, prediction,
+// refreshHz, predictMs, processNoise, measurementNoise }; the lead defaults to one refresh.
+NAN_METHOD(ConfigureMotionFilter) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsObject()) {
+        Nan::ThrowTypeError("Expected arguments: ({ smoothing, prediction, ... }, deviceHandle?)");
+        return;
+    }
+
+    v8::Local<v8::Object> options = Nan::To<v8::Object>(info[0]).ToLocalChecked();
+    MotionFilterConfig config;
+    config.smoothing = Nan::To<bool>(Nan::Get(options, Nan::New("smoothing").ToLocalChecked()).ToLocalChecked()).FromJust();
+    config.minCutoff = GetNumberOption(options, "minCutoff", config.minCutoff);
+    config.beta = GetNumberOption(options, "beta", config.beta);
+    config.derivativeCutoff = GetNumberOption(options, "derivativeCutoff", config.derivativeCutoff);
+    config.prediction = Nan::To<bool>(Nan::Get(options, Nan::New("prediction").ToLocalChecked()).ToLocalChecked()).FromJust();
+    config.processNoise = GetNumberOption(options, "processNoise", config.processNoise);
+    config.measurementNoise = GetNumberOption(options, "measurementNoise", config.measurementNoise);
+    double refreshHz = GetNumberOption(options, "refreshHz", 60);
+    double predictMs = GetNumberOption(options, "predictMs", refreshHz > 0 ? 1000.0 / refreshHz : 0);
+    config.leadMicros = (int64_t)(std::min(std::max(predictMs, 0.0), 100.0) * 1000);
+    if (!(config.minCutoff > 0 && config.derivativeCutoff > 0 && config.beta >= 0 &&
+          config.processNoise > 0 && config.measurementNoise > 0)) {
+        Nan::ThrowRangeError("Cutoffs and noise terms must be positive, beta non-negative");
+        return;
+    }
+
+    if (info.Length() > 1 && info[1]->IsNumber()) {
+        addon.pipeline.Filter().ConfigureDevice((uint64_t)Nan::To<double>(info[1]).FromJust(), config);
+    } else {
+        addon.pipeline.Filter().ConfigureDefault(config);
+    }
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(config.Active()));
+}
+
+// clearMotionFilter(deviceHandle): the device goes back to the default filter.
+NAN_METHOD(ClearMotionFilter) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 1 argument: (deviceHandle)");
+        return;
+    }
+
+    addon.pipeline.Filter().ClearDevice((uint64_t)Nan::To<double>(info[0]).FromJust());
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+}
+
+// setSubscription(classes, deviceHandle?): only the listed event classes ('move', 'button',
+// 'device') reach JS, for one device or, without a handle, every device without its own mask.
+// The rest is dropped natively before it is queued.
+NAN_METHOD(SetSubscription) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsArray()) {
+        Nan::ThrowTypeError("Expected arguments: (classes, deviceHandle?)");
+        return;
+    }
+
+    v8::Local<v8::Array> classes = info[0].As<v8::Array>();
+    uint8_t mask = 0;
+    for (uint32_t i = 0; i < classes->Length(); i++) {
+        std::string name = *Nan::Utf8String(Nan::Get(classes, i).ToLocalChecked());
+        if (name == "move") {
+            mask |= kSubscribeMove;
+        } else if (name == "button") {
+            mask |= kSubscribeButton;
+        } else if (name == "device") {
+            mask |= kSubscribeDevice;
+        } else {
+            Nan::ThrowRangeError("Event classes must be 'move', 'button' or 'device'");
+            return;
+        }
+    }
+
+    if (info.Length() > 1 && info[1]->IsNumber()) {
+        addon.pipeline.Subscriptions().SetDevice((uint64_t)Nan::To<double>(info[1]).FromJust(), mask);
+    } else {
+        addon.pipeline.Subscriptions().SetDefault(mask);
+    }
+    info.GetReturnValue().Set(Nan::New<v8::Number>(mask));
+}
+
+// clearSubscription(deviceHandle): the device goes back to the default subscription.
+NAN_METHOD(ClearSubscription) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 1 argument: (deviceHandle)");
+        return;
+    }
+
+    addon.pipeline.Subscriptions().ClearDevice((uint64_t)Nan::To<double>(info[0]).FromJust());
+}
+
+// configureFramePacing({ refreshHz, phaseMs?, leadMs? }) for the 'frame' coalescing mode. phaseMs
+// is any vsync time on the addon's monotonic clock. Without it, Windows takes period and phase
+// from the compositor (DWM); elsewhere the schedule follows reportFrame().
+NAN_METHOD(ConfigureFramePacing) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsObject()) {
+        Nan::ThrowTypeError("Expected arguments: ({ refreshHz, phaseMs?, leadMs? })");
+        return;
+    }
+
+    v8::Local<v8::Object> options = Nan::To<v8::Object>(info[0]).ToLocalChecked();
+    double refreshHz = GetNumberOption(options, "refreshHz", 60);
+    double phaseMs = GetNumberOption(options, "phaseMs", -1);
+    double leadMs = GetNumberOption(options, "leadMs", 2);
+    if (!(refreshHz >= 1 && refreshHz <= 1000) || !(leadMs >= 0)) {
+        Nan::ThrowRangeError("refreshHz must be within 1..1000 and leadMs non-negative");
+        return;
+    }
+
+    FramePacingConfig config;
+    config.periodMicros = (int64_t)std::llround(1e6 / refreshHz);
+    config.phaseMicros = phaseMs >= 0 ? (int64_t)std::llround(phaseMs * 1000) : -1;
+    config.leadMicros = (int64_t)std::llround(leadMs * 1000);
+#ifdef _WIN32
+    DWM_TIMING_INFO timing = {};
+    timing.cbSize = sizeof(timing);
+    if (config.phaseMicros < 0 && SUCCEEDED(DwmGetCompositionTimingInfo(nullptr, &timing)) && timing.qpcRefreshPeriod > 0) {
+        config.periodMicros = CounterToMicros((int64_t)timing.qpcRefreshPeriod);
+        config.phaseMicros = CounterToMicros((int64_t)timing.qpcVBlank);
+    }
+#endif
+    addon.pipeline.Frames().Configure(config);
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+}
+
+// A frame the consumer presented just now; the frame schedule locks onto these.
+NAN_METHOD(ReportFrame) {
+    AddonInstance& addon = Instance(info);
+    addon.pipeline.Frames().ObserveFrame(NowMicros());
+}
+
+NAN_METHOD(SetDevicePosition) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 3 || !info[0]->IsNumber() || !info[1]->IsNumber() || !info[2]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 3 arguments: (deviceHandle, x, y)");
+        return;
+    }
+
+    uint64_t handle = (uint64_t)Nan::To<double>(info[0]).FromJust();
+    addon.pipeline.Motion().Place(handle, (int32_t)Nan::To<double>(info[1]).FromJust(), (int32_t)Nan::To<double>(info[2]).FromJust());
+}
 
-            Nan::Set(deviceObj, Nan::New("id").ToLocalChecked(), Nan::New<v8::Number>(mouseIndex));
-            Nan::Set(deviceObj, Nan::New("name").ToLocalChecked(), Nan::New(deviceName.c_str()).ToLocalChecked());
-            Nan::Set(deviceObj, Nan::New("handle").ToLocalChecked(), Nan::New<v8::Number>((double)(uintptr_t)deviceList[i].hDevice));
-            Nan::Set(deviceObj, Nan::New("type").ToLocalChecked(), Nan::New("mouse").ToLocalChecked());
-            Nan::Set(deviceObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(0));
+NAN_METHOD(SetMonitorLayout) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsArray()) {
+        Nan::ThrowTypeError("Expected 1 argument: ([{ id, x, y, width, height, scaleFactor, physicalX, physicalY }])");
+        return;
+    }
 
-            Nan::Set(result, mouseIndex, deviceObj);
-            mouseIndex++;
+    v8::Local<v8::Array> displays = v8::Local<v8::Array>::Cast(info[0]);
+    std::vector<MonitorInfo> monitors;
+    monitors.reserve(displays->Length());
+    for (uint32_t i = 0; i < displays->Length(); i++) {
+        v8::Local<v8::Value> value = Nan::Get(displays, i).ToLocalChecked();
+        if (!value->IsObject()) {
+            continue;
+        }
+        v8::Local<v8::Object> display = Nan::To<v8::Object>(value).ToLocalChecked();
+        MonitorInfo monitor;
+        monitor.id = (int64_t)GetNumberOption(display, "id", i);
+        monitor.x = (int32_t)GetNumberOption(display, "x", 0);
+        monitor.y = (int32_t)GetNumberOption(display, "y", 0);
+        monitor.width = (int32_t)GetNumberOption(display, "width", 0);
+        monitor.height = (int32_t)GetNumberOption(display, "height", 0);
+        monitor.scale = GetNumberOption(display, "scaleFactor", 1.0);
+        if (monitor.width <= 0 || monitor.height <= 0 || !(monitor.scale > 0)) {
+            continue;
         }
+        monitor.physicalX = (int32_t)GetNumberOption(display, "physicalX", monitor.x * monitor.scale);
+        monitor.physicalY = (int32_t)GetNumberOption(display, "physicalY", monitor.y * monitor.scale);
+        monitors.push_back(monitor);
+    }
+
+    addon.monitorLayout.Build(monitors);
+    addon.pipeline.Motion().SetLayout(addon.monitorLayout);
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Number>((double)addon.monitorLayout.Count()));
+}
+
+NAN_METHOD(FindMonitor) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 2 || !info[0]->IsNumber() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 2 arguments: (x, y)");
+        return;
+    }
+
+    int index = addon.monitorLayout.Find((int32_t)Nan::To<double>(info[0]).FromJust(), (int32_t)Nan::To<double>(info[1]).FromJust());
+    if (index < 0) {
+        info.GetReturnValue().SetNull();
+        return;
+    }
+    info.GetReturnValue().Set(Nan::New<v8::Number>((double)addon.monitorLayout.Monitor(index).id));
+}
+
+// Converts interleaved x, y pairs in place, so a whole batch crosses the boundary once.
+NAN_METHOD(TransformPoints) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 2 || !info[0]->IsInt32Array() || !info[1]->IsString()) {
+        Nan::ThrowTypeError("Expected 2 arguments: (Int32Array points, 'toPhysical' | 'toLogical')");
+        return;
+    }
+
+    Nan::Utf8String direction(info[1]);
+    const bool toPhysical = strcmp(*direction, "toPhysical") == 0;
+    if (!toPhysical && strcmp(*direction, "toLogical") != 0) {
+        Nan::ThrowRangeError("Unknown direction, expected 'toPhysical' or 'toLogical'");
+        return;
     }
 
+    Nan::TypedArrayContents<int32_t> points(info[0]);
+    const size_t count = points.length() / 2;
+    if (toPhysical) {
+        addon.monitorLayout.ToPhysical(*points, count);
+    } else {
+        addon.monitorLayout.ToLogical(*points, count);
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Number>((double)count));
+}
+
+NAN_METHOD(LockCursor) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 3 || !info[0]->IsNumber() || !info[1]->IsNumber() || !info[2]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 3 arguments: (ownerHandle, x, y)");
+        return;
+    }
+
+    uint64_t handle = (uint64_t)Nan::To<double>(info[0]).FromJust();
+    addon.pipeline.Cursor().Lock(handle, (int32_t)Nan::To<double>(info[1]).FromJust(), (int32_t)Nan::To<double>(info[2]).FromJust());
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(addon.inputRunning));
+}
+
+NAN_METHOD(UnlockCursor) {
+    AddonInstance& addon = Instance(info);
+    addon.pipeline.Cursor().Unlock();
+    if (addon.inputRunning) {
+        addon.inputBackend->RequestFlush();
+    }
+}
+
+NAN_METHOD(SetCursorRouting) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsBoolean()) {
+        Nan::ThrowTypeError("Expected 1 argument: (enabled)");
+        return;
+    }
+
+    addon.pipeline.Cursor().SetRouting(Nan::To<bool>(info[0]).FromJust());
+}
+
+// Watcher thread; the JS callback only runs for a type it has not seen last.
+static void OnCursorTypeChanged(CursorType type, void* context) {
+    AddonInstance& addon = *(AddonInstance*)context;
+    addon.latestCursorType.store((uint8_t)type, std::memory_order_release);
+    uv_async_send(addon.cursorShapeAsync);
+}
+
+static void OnCursorTypePending(uv_async_t* handle) {
+    Nan::HandleScope scope;
+    AddonInstance& addon = *(AddonInstance*)handle->data;
+    CursorType type = (CursorType)addon.latestCursorType.load(std::memory_order_acquire);
+    if (type == addon.deliveredCursorType || addon.cursorShapeCallback.IsEmpty()) {
+        return;
+    }
+    addon.deliveredCursorType = type;
+    CallJs(addon, New(addon.cursorShapeCallback), Nan::New(CursorTypeName(type)).ToLocalChecked());
+}
+
+NAN_METHOD(WatchCursorShape) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsFunction()) {
+        Nan::ThrowTypeError("Expected 1 argument: (onCursorTypeChange)");
+        return;
+    }
+
+    addon.cursorShapeCallback.Reset(v8::Local<v8::Function>::Cast(info[0]));
+    if (addon.cursorShapeSource) {
+        info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
+        return;
+    }
+
+    if (!addon.cursorShapeAsync) {
+        addon.cursorShapeAsync = CreateAsync(addon, OnCursorTypePending);
+    }
+    uv_ref((uv_handle_t*)addon.cursorShapeAsync);
+    addon.deliveredCursorType = CursorType::Count;
+
+    addon.cursorShapeSource = CreateCursorShapeSource();
+    const char* error = addon.cursorShapeSource->Start(OnCursorTypeChanged, &addon);
+    if (error) {
+        addon.cursorShapeSource.reset();
+        addon.cursorShapeCallback.Reset();
+        uv_unref((uv_handle_t*)addon.cursorShapeAsync);
+        Nan::ThrowError(error);
+        return;
+    }
+
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(true));
+}
+
+NAN_METHOD(UnwatchCursorShape) {
+    AddonInstance& addon = Instance(info);
+    if (addon.cursorShapeSource) {
+        addon.cursorShapeSource->Stop();
+        addon.cursorShapeSource.reset();
+        uv_unref((uv_handle_t*)addon.cursorShapeAsync);
+    }
+    addon.cursorShapeCallback.Reset();
+}
+
+NAN_METHOD(GetCursorType) {
+    AddonInstance& addon = Instance(info);
+    if (!addon.cursorShapeSource) {
+        info.GetReturnValue().SetNull();
+        return;
+    }
+    CursorType type = (CursorType)addon.latestCursorType.load(std::memory_order_acquire);
+    info.GetReturnValue().Set(Nan::New(CursorTypeName(type)).ToLocalChecked());
+}
+
+// Decoded frames for each cursor file; contents decoded by an earlier call or run come straight
+// from the cache file at cachePath. Pixels are premultiplied RGBA.
+NAN_METHOD(LoadCursors) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 2 || !info[0]->IsArray() || !info[1]->IsString()) {
+        Nan::ThrowTypeError("Expected 2 arguments: (paths, cachePath)");
+        return;
+    }
+
+    std::string cachePath = *Nan::Utf8String(info[1]);
+    if (cachePath != addon.cursorCache.Path()) {
+        addon.cursorCache.Open(cachePath);
+    }
+
+    v8::Local<v8::Array> paths = v8::Local<v8::Array>::Cast(info[0]);
+    v8::Local<v8::Array> cursors = New<v8::Array>();
+    uint32_t hits = 0, decoded = 0;
+    for (uint32_t i = 0; i < paths->Length(); i++) {
+        Nan::Utf8String path(Nan::Get(paths, i).ToLocalChecked());
+        v8::Local<v8::Object> cursorObj = New<v8::Object>();
+        Nan::Set(cursorObj, Nan::New("path").ToLocalChecked(), Nan::New(*path).ToLocalChecked());
+
+        CursorView view;
+        bool cached = false;
+        const char* error = addon.cursorCache.Load(*path, &view, &cached);
+        if (error) {
+            Nan::Set(cursorObj, Nan::New("error").ToLocalChecked(), Nan::New(error).ToLocalChecked());
+            Nan::Set(cursors, i, cursorObj);
+            continue;
+        }
+        if (cached) {
+            hits++;
+        } else {
+            decoded++;
+        }
+
+        v8::Local<v8::Array> frames = New<v8::Array>(view.frameCount);
+        for (uint32_t f = 0; f < view.frameCount; f++) {
+            const CachedCursorFrame& frame = view.frames[f];
+            v8::Local<v8::Object> frameObj = New<v8::Object>();
+            Nan::Set(frameObj, Nan::New("width").ToLocalChecked(), Nan::New<v8::Number>(frame.width));
+            Nan::Set(frameObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>(frame.height));
+            Nan::Set(frameObj, Nan::New("hotspotX").ToLocalChecked(), Nan::New<v8::Number>(frame.hotspotX));
+            Nan::Set(frameObj, Nan::New("hotspotY").ToLocalChecked(), Nan::New<v8::Number>(frame.hotspotY));
+            Nan::Set(frameObj, Nan::New("pixels").ToLocalChecked(),
+                Nan::CopyBuffer((const char*)view.pixels + frame.pixelOffset, (uint32_t)frame.width * frame.height * 4).ToLocalChecked());
+            Nan::Set(frames, f, frameObj);
+        }
+
+        v8::Local<v8::Array> steps = New<v8::Array>(view.stepCount);
+        for (uint32_t s = 0; s < view.stepCount; s++) {
+            v8::Local<v8::Object> stepObj = New<v8::Object>();
+            Nan::Set(stepObj, Nan::New("frame").ToLocalChecked(), Nan::New<v8::Number>(view.steps[s].frame));
+            Nan::Set(stepObj, Nan::New("durationMs").ToLocalChecked(), Nan::New<v8::Number>(view.steps[s].durationMs));
+            Nan::Set(steps, s, stepObj);
+        }
+
+        Nan::Set(cursorObj, Nan::New("cached").ToLocalChecked(), Nan::New<v8::Boolean>(cached));
+        Nan::Set(cursorObj, Nan::New("frames").ToLocalChecked(), frames);
+        Nan::Set(cursorObj, Nan::New("steps").ToLocalChecked(), steps);
+        Nan::Set(cursors, i, cursorObj);
+    }
+
+    v8::Local<v8::Object> result = New<v8::Object>();
+    Nan::Set(result, Nan::New("cursors").ToLocalChecked(), cursors);
+    Nan::Set(result, Nan::New("cacheHits").ToLocalChecked(), Nan::New<v8::Number>(hits));
+    Nan::Set(result, Nan::New("decoded").ToLocalChecked(), Nan::New<v8::Number>(decoded));
+    if (const char* error = addon.cursorCache.Save()) {
+        Nan::Set(result, Nan::New("cacheError").ToLocalChecked(), Nan::New(error).ToLocalChecked());
+    }
     info.GetReturnValue().Set(result);
 }
 
-NAN_METHOD(ProcessMessages) {
-    MSG msg;
-    int count = 0;
+// Reads an optional '#RRGGBB' `color` option; throws and returns false when it is malformed.
+static bool GetColorOption(v8::Local<v8::Object> options, uint32_t* rgb) {
+    v8::Local<v8::Value> color = Nan::Get(options, Nan::New("color").ToLocalChecked()).ToLocalChecked();
+    if (!color->IsString()) {
+        return true;
+    }
+    Nan::Utf8String text(color);
+    if (text.length() != 7 || **text != '#' || strspn(*text + 1, "0123456789abcdefABCDEF") != 6) {
+        Nan::ThrowTypeError("Expected color as '#RRGGBB'");
+        return false;
+    }
+    *rgb = (uint32_t)strtoul(*text + 1, nullptr, 16);
+    return true;
+}
 
-    while (count < 10 && PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
-        count++;
+// Bakes (or finds in the LRU) the bitmap for info[pathArg] with the { size, color: '#RRGGBB',
+// opacity: 0..1, frame } options at info[pathArg + 1]. Throws and returns false on bad arguments.
+static bool GetCursorBitmap(const Nan::FunctionCallbackInfo<v8::Value>& info, int pathArg,
+                            std::shared_ptr<const CursorBitmap>* bitmap, bool* cached) {
+    AddonInstance& addon = Instance(info);
+    v8::Local<v8::Object> options = info.Length() > pathArg + 1 && info[pathArg + 1]->IsObject()
+        ? Nan::To<v8::Object>(info[pathArg + 1]).ToLocalChecked() : Nan::New<v8::Object>();
+    double size = GetNumberOption(options, "size", 32);
+    double opacity = std::min(std::max(GetNumberOption(options, "opacity", 1.0), 0.0), 1.0);
+    double frameIndex = GetNumberOption(options, "frame", 0);
+    uint32_t rgb = 0xFFFFFF;
+    if (!GetColorOption(options, &rgb)) {
+        return false;
+    }
+    if (!(size >= 1 && size <= kMaxCursorBitmapSize)) {
+        Nan::ThrowRangeError("Expected size between 1 and 512");
+        return false;
     }
 
-    std::queue<MouseEvent> localQueue;
-    {
-        std::lock_guard<std::mutex> lock(eventMutex);
-        localQueue.swap(eventQueue);
+    CursorView view;
+    if (const char* error = addon.cursorCache.Load(*Nan::Utf8String(info[pathArg]), &view, cached)) {
+        Nan::ThrowError(error);
+        return false;
+    }
+    if (!(frameIndex >= 0 && frameIndex < view.frameCount)) {
+        Nan::ThrowRangeError("Frame index out of range");
+        return false;
     }
 
-    while (!localQueue.empty()) {
-        MouseEvent event = localQueue.front();
-        localQueue.pop();
+    const CachedCursorFrame& frame = view.frames[(uint32_t)frameIndex];
+    CursorBitmapKey key = { view.hash, (uint32_t)frameIndex, rgb, (uint16_t)size, (uint8_t)(opacity * 255 + 0.5) };
+    *bitmap = addon.cursorBitmaps.Get(key, frame, view.pixels + frame.pixelOffset, cached);
+    return true;
+}
 
-        Nan::HandleScope scope;
+// renderCursor(path, options?): the frame resampled to fit a size x size box and tinted, from the
+// baked-bitmap LRU when the same variant was drawn before.
+NAN_METHOD(RenderCursor) {
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected arguments: (path, options?)");
+        return;
+    }
 
-        if ((event.type == "move" || event.type == "button") && !moveCallback.IsEmpty()) {
-            v8::Local<v8::Function> callback = New(moveCallback);
-            v8::Local<v8::Object> eventObj = New<v8::Object>();
+    std::shared_ptr<const CursorBitmap> bitmap;
+    bool cached = false;
+    if (!GetCursorBitmap(info, 0, &bitmap, &cached)) {
+        return;
+    }
 
-            Nan::Set(eventObj, Nan::New("type").ToLocalChecked(), Nan::New(event.type.c_str()).ToLocalChecked());
-            Nan::Set(eventObj, Nan::New("deviceHandle").ToLocalChecked(), Nan::New<v8::Number>((double)(uintptr_t)event.hDevice));
-            Nan::Set(eventObj, Nan::New("deviceName").ToLocalChecked(), Nan::New(event.deviceName.c_str()).ToLocalChecked());
-            Nan::Set(eventObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(event.x));
-            Nan::Set(eventObj, Nan::New("y").ToLocalChecked(), Nan::New<v8::Number>(event.y));
-            Nan::Set(eventObj, Nan::New("dx").ToLocalChecked(), Nan::New<v8::Number>(event.deltaX));
-            Nan::Set(eventObj, Nan::New("dy").ToLocalChecked(), Nan::New<v8::Number>(event.deltaY));
-            Nan::Set(eventObj, Nan::New("flags").ToLocalChecked(), Nan::New<v8::Number>(event.flags));
-            Nan::Set(eventObj, Nan::New("action").ToLocalChecked(), Nan::New(event.action.c_str()).ToLocalChecked());
+    v8::Local<v8::Object> result = New<v8::Object>();
+    Nan::Set(result, Nan::New("width").ToLocalChecked(), Nan::New<v8::Number>(bitmap->width));
+    Nan::Set(result, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>(bitmap->height));
+    Nan::Set(result, Nan::New("hotspotX").ToLocalChecked(), Nan::New<v8::Number>(bitmap->hotspotX));
+    Nan::Set(result, Nan::New("hotspotY").ToLocalChecked(), Nan::New<v8::Number>(bitmap->hotspotY));
+    Nan::Set(result, Nan::New("pixels").ToLocalChecked(),
+        Nan::CopyBuffer((const char*)bitmap->pixels.data(), (uint32_t)bitmap->pixels.size()).ToLocalChecked());
+    Nan::Set(result, Nan::New("cached").ToLocalChecked(), Nan::New<v8::Boolean>(cached));
+    info.GetReturnValue().Set(result);
+}
 
-            v8::Local<v8::Value> argv[] = { eventObj };
-            Nan::Call(callback, Nan::GetCurrentContext()->Global(), 1, argv);
+NAN_METHOD(GetCursorBitmapStats) {
+    AddonInstance& addon = Instance(info);
+    v8::Local<v8::Object> stats = New<v8::Object>();
+    Nan::Set(stats, Nan::New("simd").ToLocalChecked(), Nan::New(SimdLevelName(ActiveSimdLevel())).ToLocalChecked());
+    Nan::Set(stats, Nan::New("bitmaps").ToLocalChecked(), Nan::New<v8::Number>((double)addon.cursorBitmaps.Count()));
+    Nan::Set(stats, Nan::New("bytes").ToLocalChecked(), Nan::New<v8::Number>((double)addon.cursorBitmaps.Bytes()));
+    Nan::Set(stats, Nan::New("hits").ToLocalChecked(), Nan::New<v8::Number>((double)addon.cursorBitmaps.Hits()));
+    Nan::Set(stats, Nan::New("misses").ToLocalChecked(), Nan::New<v8::Number>((double)addon.cursorBitmaps.Misses()));
+    info.GetReturnValue().Set(stats);
+}
 
-        } else if (event.type == "device" && !deviceCallback.IsEmpty()) {
-            v8::Local<v8::Function> callback = New(deviceCallback);
-            v8::Local<v8::Object> deviceObj = New<v8::Object>();
+// configureCompositor([{ x, y, width, height }]): one offscreen surface per display, in the same
+// desktop coordinates as the cursor positions.
+NAN_METHOD(ConfigureCompositor) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsArray()) {
+        Nan::ThrowTypeError("Expected 1 argument: ([{ x, y, width, height }])");
+        return;
+    }
 
-            Nan::Set(deviceObj, Nan::New("action").ToLocalChecked(), Nan::New(event.action.c_str()).ToLocalChecked());
-            Nan::Set(deviceObj, Nan::New("handle").ToLocalChecked(), Nan::New<v8::Number>((double)(uintptr_t)event.hDevice));
-            Nan::Set(deviceObj, Nan::New("name").ToLocalChecked(), Nan::New(event.deviceName.c_str()).ToLocalChecked());
-            Nan::Set(deviceObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(event.x));
-            Nan::Set(deviceObj, Nan::New("y").ToLocalChecked(), Nan::New<v8::Number>(event.y));
+    v8::Local<v8::Array> list = v8::Local<v8::Array>::Cast(info[0]);
+    std::vector<CompositorRect> surfaces;
+    for (uint32_t i = 0; i < list->Length(); i++) {
+        v8::Local<v8::Value> value = Nan::Get(list, i).ToLocalChecked();
+        v8::Local<v8::Object> bounds = value->IsObject() ? Nan::To<v8::Object>(value).ToLocalChecked() : Nan::New<v8::Object>();
+        surfaces.push_back({ (int32_t)GetNumberOption(bounds, "x", 0), (int32_t)GetNumberOption(bounds, "y", 0),
+                             (int32_t)GetNumberOption(bounds, "width", 0), (int32_t)GetNumberOption(bounds, "height", 0) });
+    }
+    addon.compositor.SetSurfaces(surfaces);
+    info.GetReturnValue().Set(Nan::New<v8::Number>((double)addon.compositor.SurfaceCount()));
+}
+
+// setCompositorCursor(id, path, options, x, y): places the baked cursor's hotspot at (x, y).
+NAN_METHOD(SetCompositorCursor) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 5 || !info[0]->IsNumber() || !info[1]->IsString() || !info[3]->IsNumber() || !info[4]->IsNumber()) {
+        Nan::ThrowTypeError("Expected arguments: (id, path, options, x, y)");
+        return;
+    }
+
+    std::shared_ptr<const CursorBitmap> bitmap;
+    bool cached = false;
+    if (!GetCursorBitmap(info, 1, &bitmap, &cached)) {
+        return;
+    }
+    addon.compositor.SetSprite(Nan::To<uint32_t>(info[0]).FromJust(), std::move(bitmap),
+        (int32_t)std::lround(Nan::To<double>(info[3]).FromJust()), (int32_t)std::lround(Nan::To<double>(info[4]).FromJust()));
+}
+
+NAN_METHOD(RemoveCompositorCursor) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 1 argument: (id)");
+        return;
+    }
+    addon.compositor.RemoveSprite(Nan::To<uint32_t>(info[0]).FromJust());
+}
+
+// composeSurface(index, full?): repaints the surface's damage and returns the changed rects with
+// straight-alpha RGBA pixels, ready for putImageData. `full` repaints and returns the whole surface.
+NAN_METHOD(ComposeSurface) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsNumber()) {
+        Nan::ThrowTypeError("Expected arguments: (index, full?)");
+        return;
+    }
+    uint32_t index = Nan::To<uint32_t>(info[0]).FromJust();
+    if (index >= addon.compositor.SurfaceCount()) {
+        Nan::ThrowRangeError("Surface index out of range");
+        return;
+    }
+    if (info.Length() > 1 && Nan::To<bool>(info[1]).FromJust()) {
+        addon.compositor.Invalidate(index);
+    }
+
+    const std::vector<CompositorRect>& rects = addon.compositor.Compose(index);
+    v8::Local<v8::Array> result = New<v8::Array>((int)rects.size());
+    std::vector<uint8_t> pixels;
+    for (size_t i = 0; i < rects.size(); i++) {
+        const CompositorRect& rect = rects[i];
+        pixels.resize((size_t)rect.width * rect.height * 4);
+        addon.compositor.CopyRect(index, rect, pixels.data(), true);
+
+        v8::Local<v8::Object> rectObj = New<v8::Object>();
+        Nan::Set(rectObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(rect.x));
+        Nan::Set(rectObj, Nan::New("y").ToLocalChecked(), Nan::New<v8::Number>(rect.y));
+        Nan::Set(rectObj, Nan::New("width").ToLocalChecked(), Nan::New<v8::Number>(rect.width));
+        Nan::Set(rectObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>(rect.height));
+        Nan::Set(rectObj, Nan::New("pixels").ToLocalChecked(), Nan::CopyBuffer((const char*)pixels.data(), (uint32_t)pixels.size()).ToLocalChecked());
+        Nan::Set(result, (uint32_t)i, rectObj);
+    }
+    info.GetReturnValue().Set(result);
+}
 
-            v8::Local<v8::Value> argv[] = { deviceObj };
-            Nan::Call(callback, Nan::GetCurrentContext()->Global(), 1, argv);
+static void CopyTableString(char* out, size_t size, v8::Local<v8::Value> value) {
+    Nan::Utf8String text(value);
+    size_t length = std::min((size_t)text.length(), size - 1);
+    memcpy(out, *text, length);
+    out[length] = 0;
+}
+
+// createCursorTable(name?): the main process's shared cursor table; returns its name for the
+// overlays to open.
+NAN_METHOD(CreateCursorTable) {
+    AddonInstance& addon = Instance(info);
+#ifdef _WIN32
+    unsigned long pid = GetCurrentProcessId();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    std::string name = info.Length() > 0 && info[0]->IsString() ? std::string(*Nan::Utf8String(info[0])) : "orionix-cursors-" + std::to_string(pid);
+    if (const char* error = addon.cursorTableWriter.Create(name)) {
+        Nan::ThrowError(error);
+        return;
+    }
+    info.GetReturnValue().Set(Nan::New(name).ToLocalChecked());
+}
+
+// writeCursorState(id, { x, y, type, color, visible, focused, seq })
+NAN_METHOD(WriteCursorState) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsObject()) {
+        Nan::ThrowTypeError("Expected arguments: (id, { x, y, type, color, visible, focused, seq })");
+        return;
+    }
+
+    v8::Local<v8::Object> options = Nan::To<v8::Object>(info[1]).ToLocalChecked();
+    CursorSlotState state = {};
+    state.x = GetNumberOption(options, "x", 0);
+    state.y = GetNumberOption(options, "y", 0);
+    state.inputSeq = (uint32_t)GetNumberOption(options, "seq", 0);
+    state.color = 0xFFFFFF;
+    if (!GetColorOption(options, &state.color)) {
+        return;
+    }
+    state.flags = kCursorSlotActive;
+    if (Nan::To<bool>(Nan::Get(options, Nan::New("visible").ToLocalChecked()).ToLocalChecked()).FromJust()) state.flags |= kCursorSlotVisible;
+    if (Nan::To<bool>(Nan::Get(options, Nan::New("focused").ToLocalChecked()).ToLocalChecked()).FromJust()) state.flags |= kCursorSlotFocused;
+    CopyTableString(state.id, sizeof(state.id), info[0]);
+    v8::Local<v8::Value> type = Nan::Get(options, Nan::New("type").ToLocalChecked()).ToLocalChecked();
+    if (type->IsString()) {
+        CopyTableString(state.type, sizeof(state.type), type);
+    }
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(addon.cursorTableWriter.Write(state)));
+}
+
+NAN_METHOD(RemoveCursorState) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected 1 argument: (id)");
+        return;
+    }
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(addon.cursorTableWriter.Remove(*Nan::Utf8String(info[0]))));
+}
+
+// openCursorTable(name): maps the main process's table read-only, for the overlay renderers.
+NAN_METHOD(OpenCursorTable) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsString()) {
+        Nan::ThrowTypeError("Expected 1 argument: (name)");
+        return;
+    }
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(addon.cursorTableReader.Open(*Nan::Utf8String(info[0])) == nullptr));
+}
+
+// readCursorTable(sinceVersion?): null while the table is unchanged since `sinceVersion`, else
+// { version, cursors } with every active cursor, each read consistently.
+NAN_METHOD(ReadCursorTable) {
+    AddonInstance& addon = Instance(info);
+    if (!addon.cursorTableReader.IsOpen()) {
+        info.GetReturnValue().SetNull();
+        return;
+    }
+    uint32_t version = addon.cursorTableReader.Version();
+    if (info.Length() > 0 && info[0]->IsNumber() && Nan::To<uint32_t>(info[0]).FromJust() == version) {
+        info.GetReturnValue().SetNull();
+        return;
+    }
+
+    CursorSlotState states[kCursorTableSlots];
+    size_t count = addon.cursorTableReader.Snapshot(states, kCursorTableSlots);
+    v8::Local<v8::Array> cursors = New<v8::Array>((int)count);
+    for (size_t i = 0; i < count; i++) {
+        const CursorSlotState& state = states[i];
+        char color[8];
+        snprintf(color, sizeof(color), "#%06X", state.color & 0xFFFFFF);
+        v8::Local<v8::Object> cursor = New<v8::Object>();
+        Nan::Set(cursor, Nan::New("deviceId").ToLocalChecked(), Nan::New(state.id).ToLocalChecked());
+        Nan::Set(cursor, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(state.x));
+        Nan::Set(cursor, Nan::New("y").ToLocalChecked(), Nan::New<v8::Number>(state.y));
+        Nan::Set(cursor, Nan::New("cursorType").ToLocalChecked(), Nan::New(state.type).ToLocalChecked());
+        Nan::Set(cursor, Nan::New("color").ToLocalChecked(), Nan::New(color).ToLocalChecked());
+        Nan::Set(cursor, Nan::New("isVisible").ToLocalChecked(), Nan::New<v8::Boolean>((state.flags & kCursorSlotVisible) != 0));
+        Nan::Set(cursor, Nan::New("isActive").ToLocalChecked(), Nan::New<v8::Boolean>((state.flags & kCursorSlotFocused) != 0));
+        Nan::Set(cursor, Nan::New("seq").ToLocalChecked(), Nan::New<v8::Number>(state.inputSeq));
+        Nan::Set(cursors, (uint32_t)i, cursor);
+    }
+
+    v8::Local<v8::Object> result = New<v8::Object>();
+    Nan::Set(result, Nan::New("version").ToLocalChecked(), Nan::New<v8::Number>(version));
+    Nan::Set(result, Nan::New("cursors").ToLocalChecked(), cursors);
+    info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(GetQueueStats) {
+    AddonInstance& addon = Instance(info);
+    v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+    Nan::Set(stats, Nan::New("pending").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Queue().Size()));
+    Nan::Set(stats, Nan::New("droppedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Queue().DroppedMoves()));
+    Nan::Set(stats, Nan::New("mergedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Queue().MergedMoves()));
+    Nan::Set(stats, Nan::New("deferredEvents").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Queue().DeferredEvents()));
+    Nan::Set(stats, Nan::New("backlog").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Queue().Backlog()));
+    Nan::Set(stats, Nan::New("coalescedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Coalescer().FoldedMoves()));
+    Nan::Set(stats, Nan::New("emittedMoves").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Coalescer().EmittedMoves()));
+    Nan::Set(stats, Nan::New("cursorRepositions").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Cursor().Repositions()));
+    Nan::Set(stats, Nan::New("cursorRepositionsSkipped").ToLocalChecked(), Nan::New<v8::Number>((double)addon.pipeline.Cursor().SkippedRepositions()));
+    info.GetReturnValue().Set(stats);
+}
+
+NAN_METHOD(ReportLatency) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsNumber()) {
+        Nan::ThrowTypeError("Expected arguments: (stage, seq)");
+        return;
+    }
+
+    Nan::Utf8String name(info[0]);
+    LatencyStage stage = LatencyStage::Count;
+    for (size_t i = (size_t)LatencyStage::Dispatch; i < (size_t)LatencyStage::Count; i++) {
+        if (strcmp(*name, LatencyStageName((LatencyStage)i)) == 0) {
+            stage = (LatencyStage)i;
         }
+    }
+    if (stage == LatencyStage::Count) {
+        Nan::ThrowError("Unknown latency stage. Use 'dispatch', 'send' or 'paint'");
+        return;
+    }
 
-        count++;
+    uint32_t seq = Nan::To<uint32_t>(info[1]).FromJust();
+    info.GetReturnValue().Set(Nan::New<v8::Boolean>(addon.latencyTracker.Report(stage, seq, NowMicros())));
+}
+
+NAN_METHOD(GetLatencyStats) {
+    AddonInstance& addon = Instance(info);
+    v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+    for (size_t i = 0; i < (size_t)LatencyStage::Count; i++) {
+        const LatencyHistogram& histogram = addon.latencyTracker.Histogram((LatencyStage)i);
+        v8::Local<v8::Object> stage = Nan::New<v8::Object>();
+        Nan::Set(stage, Nan::New("count").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Count()));
+        Nan::Set(stage, Nan::New("mean").ToLocalChecked(), Nan::New<v8::Number>(histogram.Mean()));
+        Nan::Set(stage, Nan::New("p50").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Percentile(0.50)));
+        Nan::Set(stage, Nan::New("p99").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Percentile(0.99)));
+        Nan::Set(stage, Nan::New("p999").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Percentile(0.999)));
+        Nan::Set(stage, Nan::New("max").ToLocalChecked(), Nan::New<v8::Number>((double)histogram.Max()));
+        Nan::Set(stats, Nan::New(LatencyStageName((LatencyStage)i)).ToLocalChecked(), stage);
+    }
+
+    Nan::Set(stats, Nan::New("frames").ToLocalChecked(), FramePacingObject(addon.pipeline.Frames().Stats()));
+
+    if (info.Length() > 0 && Nan::To<bool>(info[0]).FromJust()) {
+        addon.latencyTracker.Reset();
+        addon.pipeline.Frames().ResetStats();
+    }
+
+    info.GetReturnValue().Set(stats);
+}
+
+NAN_METHOD(ResetLatencyStats) {
+    AddonInstance& addon = Instance(info);
+    addon.latencyTracker.Reset();
+    addon.pipeline.Frames().ResetStats();
+}
+
+NAN_METHOD(EnableBatchMode) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsFunction()) {
+        Nan::ThrowTypeError("Expected arguments: (batchCallback, maxRecords?)");
+        return;
+    }
+
+    size_t capacity = kDefaultBatchRecords;
+    if (info.Length() > 1 && info[1]->IsNumber()) {
+        capacity = (size_t)std::max(1, Nan::To<int32_t>(info[1]).FromJust());
+    }
+
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), capacity * kBatchRecordBytes);
+    addon.batchStore = buffer->GetBackingStore();
+    addon.batchBuffer.Reset(buffer);
+    addon.batchCapacity = capacity;
+    addon.batchCallback.Reset(v8::Local<v8::Function>::Cast(info[0]));
+
+    info.GetReturnValue().Set(buffer);
+}
+
+NAN_METHOD(DisableBatchMode) {
+    AddonInstance& addon = Instance(info);
+    addon.batchCallback.Reset();
+    addon.batchBuffer.Reset();
+    addon.batchStore.reset();
+    addon.batchCapacity = 0;
+}
+
+NAN_METHOD(GetDeviceSlot) {
+    AddonInstance& addon = Instance(info);
+    if (info.Length() < 1 || !info[0]->IsNumber()) {
+        Nan::ThrowTypeError("Expected 1 argument: (deviceId)");
+        return;
+    }
+
+    uint32_t id = Nan::To<uint32_t>(info[0]).FromJust();
+    if (id >= kMaxDeviceSlots) {
+        info.GetReturnValue().Set(Nan::Null());
+        return;
+    }
+
+    const DeviceSlot& slot = addon.pipeline.GetDeviceSlot(id);
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    Nan::Set(result, Nan::New("handle").ToLocalChecked(), Nan::New<v8::Number>((double)slot.handle));
+    Nan::Set(result, Nan::New("name").ToLocalChecked(), Nan::New(slot.name).ToLocalChecked());
+    info.GetReturnValue().Set(result);
+}
+
+// While input runs this is the registry snapshot kept current by arrival/removal notifications;
+// otherwise the OS is enumerated once per call.
+NAN_METHOD(GetDevices) {
+    AddonInstance& addon = Instance(info);
+    std::vector<InputDeviceInfo> deviceList = addon.inputRunning ? addon.pipeline.Registry().Snapshot() : EnumerateInputDevices();
+
+    v8::Local<v8::Array> result = New<v8::Array>();
+
+    for (size_t i = 0; i < deviceList.size(); i++) {
+        const InputDeviceInfo& device = deviceList[i];
+        v8::Local<v8::Object> deviceObj = New<v8::Object>();
+
+        Nan::Set(deviceObj, Nan::New("id").ToLocalChecked(), Nan::New<v8::Number>((double)device.id));
+        Nan::Set(deviceObj, Nan::New("name").ToLocalChecked(), Nan::New(device.name.c_str()).ToLocalChecked());
+        Nan::Set(deviceObj, Nan::New("handle").ToLocalChecked(), Nan::New<v8::Number>((double)device.handle));
+        Nan::Set(deviceObj, Nan::New("type").ToLocalChecked(), Nan::New("mouse").ToLocalChecked());
+        Nan::Set(deviceObj, Nan::New("x").ToLocalChecked(), Nan::New<v8::Number>(0));
+        SetDeviceMetadata(deviceObj, device);
+
+        Nan::Set(result, (uint32_t)i, deviceObj);
     }
 
+    info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(ProcessMessages) {
+    AddonInstance& addon = Instance(info);
+    if (!addon.inputRunning) {
+        addon.pipeline.FlushProducer();
+    }
+
+    int count = DrainEvents(addon);
+
     info.GetReturnValue().Set(Nan::New<v8::Number>(count));
 }
 
+#ifdef _WIN32
 NAN_METHOD(HideSystemCursor) {
     if (!cursorHidden) {
 
@@ -641,35 +1716,19 @@ NAN_METHOD(GetCursorState) {
     if (GetCursorInfo(&cursorInfo)) {
         v8::Local<v8::Object> result = Nan::New<v8::Object>();
 
-        std::string cursorType = "unknown";
-        HCURSOR currentCursor = cursorInfo.hCursor;
-
-        if (currentCursor == LoadCursor(NULL, IDC_ARROW)) {
-            cursorType = "arrow";
-        } else if (currentCursor == LoadCursor(NULL, IDC_IBEAM)) {
-            cursorType = "ibeam";
-        } else if (currentCursor == LoadCursor(NULL, IDC_HAND)) {
-            cursorType = "hand";
-        } else if (currentCursor == LoadCursor(NULL, IDC_WAIT)) {
-            cursorType = "wait";
-        } else if (currentCursor == LoadCursor(NULL, IDC_CROSS)) {
-            cursorType = "cross";
-        } else if (currentCursor == LoadCursor(NULL, IDC_SIZEWE)) {
-            cursorType = "resize-ew";
-        } else if (currentCursor == LoadCursor(NULL, IDC_SIZENS)) {
-            cursorType = "resize-ns";
-        } else if (currentCursor == LoadCursor(NULL, IDC_SIZENESW)) {
-            cursorType = "resize-nesw";
-        } else if (currentCursor == LoadCursor(NULL, IDC_SIZENWSE)) {
-            cursorType = "resize-nwse";
-        } else if (currentCursor == LoadCursor(NULL, IDC_NO)) {
-            cursorType = "not-allowed";
-        } else if (!cursorHidden) {
-
-            cursorType = "system";
-        } else {
-
-            cursorType = "hidden";
+        std::string cursorType;
+        switch (ClassifyCursorHandle(cursorInfo.hCursor)) {
+            case CursorType::Arrow:    cursorType = "arrow"; break;
+            case CursorType::IBeam:    cursorType = "ibeam"; break;
+            case CursorType::Hand:     cursorType = "hand"; break;
+            case CursorType::Wait:     cursorType = "wait"; break;
+            case CursorType::Cross:    cursorType = "cross"; break;
+            case CursorType::SizeWE:   cursorType = "resize-ew"; break;
+            case CursorType::SizeNS:   cursorType = "resize-ns"; break;
+            case CursorType::SizeNESW: cursorType = "resize-nesw"; break;
+            case CursorType::SizeNWSE: cursorType = "resize-nwse"; break;
+            case CursorType::No:       cursorType = "not-allowed"; break;
+            default:                   cursorType = cursorHidden ? "hidden" : "system"; break;
         }
 
         Nan::Set(result, Nan::New("type").ToLocalChecked(), Nan::New(cursorType.c_str()).ToLocalChecked());
@@ -793,56 +1852,234 @@ NAN_METHOD(KeepWindowTopMost) {
     info.GetReturnValue().Set(Nan::New<v8::Boolean>(result));
 }
 
+#endif
+
+static void CloseAsync(uv_async_t* handle) {
+    uv_close((uv_handle_t*)handle, [](uv_handle_t* closed) { delete (uv_async_t*)closed; });
+}
+
+// Runs when the instance's environment (the main thread or a worker) is torn down: threads that
+// could still signal the instance stop before its handles close and its state goes away.
+static void DestroyInstance(void* arg) {
+    AddonInstance* addon = (AddonInstance*)arg;
+    if (addon->inputRunning) {
+        addon->inputBackend->Stop();
+        addon->inputBackend.reset();
+    }
+    if (addon->cursorShapeSource) {
+        addon->cursorShapeSource->Stop();
+        addon->cursorShapeSource.reset();
+    }
+    if (addon->eventsAsync) {
+        CloseAsync(addon->eventsAsync);
+    }
+    if (addon->cursorShapeAsync) {
+        CloseAsync(addon->cursorShapeAsync);
+    }
+    if (addon->statsTimer) {
+        uv_timer_stop(addon->statsTimer);
+        uv_close((uv_handle_t*)addon->statsTimer, [](uv_handle_t* closed) { delete (uv_timer_t*)closed; });
+    }
+    addon->moveCallback.Reset();
+    addon->deviceCallback.Reset();
+    addon->batchCallback.Reset();
+    addon->batchBuffer.Reset();
+    addon->cursorShapeCallback.Reset();
+    delete addon->deliveryResource;
+    delete addon;
+}
+
 NAN_MODULE_INIT(Init) {
+    AddonInstance* addon = new AddonInstance();
+    node::AddEnvironmentCleanupHook(v8::Isolate::GetCurrent(), DestroyInstance, addon);
+    v8::Local<v8::External> data = Nan::New<v8::External>(addon);
+
     Nan::Set(target, Nan::New("setCallbacks").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetCallbacks)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetCallbacks, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("startRawInput").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StartRawInput)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StartRawInput, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("stopRawInput").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StopRawInput)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StopRawInput, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("getDevices").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetDevices)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetDevices, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("processMessages").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ProcessMessages)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ProcessMessages, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("getMessageCount").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetMessageCount)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetMessageCount, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("getStats").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetStats, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setStatsDump").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetStatsDump, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setDebugLogging").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetDebugLogging, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setOverflowPolicy").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetOverflowPolicy, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setCoalescing").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetCoalescing, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setSubscription").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetSubscription, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("clearSubscription").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ClearSubscription, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("configureFramePacing").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ConfigureFramePacing, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("reportFrame").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ReportFrame, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("configureMotion").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ConfigureMotion, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("configureMotionFilter").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ConfigureMotionFilter, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("clearMotionFilter").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ClearMotionFilter, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setDevicePosition").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetDevicePosition, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setMonitorLayout").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetMonitorLayout, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("findMonitor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(FindMonitor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("transformPoints").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(TransformPoints, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("lockCursor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(LockCursor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("unlockCursor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(UnlockCursor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setCursorRouting").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetCursorRouting, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("watchCursorShape").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(WatchCursorShape, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("unwatchCursorShape").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(UnwatchCursorShape, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("getCursorType").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetCursorType, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("loadCursors").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(LoadCursors, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("renderCursor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(RenderCursor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("getCursorBitmapStats").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetCursorBitmapStats, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("configureCompositor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ConfigureCompositor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("setCompositorCursor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetCompositorCursor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("removeCompositorCursor").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(RemoveCompositorCursor, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("composeSurface").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ComposeSurface, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("createCursorTable").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(CreateCursorTable, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("writeCursorState").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(WriteCursorState, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("removeCursorState").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(RemoveCursorState, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("openCursorTable").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(OpenCursorTable, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("readCursorTable").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ReadCursorTable, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("getQueueStats").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetQueueStats, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("reportLatency").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ReportLatency, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("getLatencyStats").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetLatencyStats, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("resetLatencyStats").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ResetLatencyStats, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("enableBatchMode").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(EnableBatchMode, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("disableBatchMode").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(DisableBatchMode, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("getDeviceSlot").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetDeviceSlot, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("startReplay").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StartReplay, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("connectInputService").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ConnectInputService, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("startTraceRecording").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StartTraceRecording, data)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("stopTraceRecording").ToLocalChecked(),
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(StopTraceRecording, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("simulateMouseMove").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SimulateMouseMove)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SimulateMouseMove, data)).ToLocalChecked());
 
+#ifdef _WIN32
     Nan::Set(target, Nan::New("setSystemCursorPos").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetSystemCursorPos)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetSystemCursorPos, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("getSystemCursorPos").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetSystemCursorPos)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetSystemCursorPos, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("hideSystemCursor").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(HideSystemCursor)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(HideSystemCursor, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("showSystemCursor").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ShowSystemCursor)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(ShowSystemCursor, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("getCursorState").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetCursorState)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(GetCursorState, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("emergencyRestoreCursors").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(EmergencyRestoreCursors)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(EmergencyRestoreCursors, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("setupShutdownHandler").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetupShutdownHandler)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetupShutdownHandler, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("setWindowTopMost").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetWindowTopMost)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(SetWindowTopMost, data)).ToLocalChecked());
 
     Nan::Set(target, Nan::New("keepWindowTopMost").ToLocalChecked(),
-        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(KeepWindowTopMost)).ToLocalChecked());
+        Nan::GetFunction(Nan::New<v8::FunctionTemplate>(KeepWindowTopMost, data)).ToLocalChecked());
+#endif
 }
 
-NODE_MODULE(Orionix_raw_input, Init)
+NAN_MODULE_WORKER_ENABLED(Orionix_raw_input, Init)
 
 
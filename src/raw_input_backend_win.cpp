@@ -0,0 +1,438 @@
+#include <windows.h>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "cursor_lock.h"
+#include "debug_log.h"
+#include "hotplug_debouncer.h"
+#include "input_backend.h"
+#include "input_pipeline.h"
+#include "raw_input_records.h"
+
+static_assert(sizeof(RAWINPUTHEADER) == RawInputHeaderSize(sizeof(void*) == 8), "raw input header layout");
+static_assert(offsetof(RAWINPUT, data) == sizeof(RAWINPUTHEADER), "raw input payload offset");
+static_assert(sizeof(RAWMOUSE) == 24, "RAWMOUSE is the same in 32-bit and 64-bit records");
+
+struct MouseDevice {
+    bool active;
+    int x, y;
+};
+
+// Raw input registration belongs to the process (one target window per usage), so only one
+// backend at a time may own it, whichever context started it.
+static std::atomic<bool> rawInputClaimed{false};
+
+std::string ReadDevicePath(HANDLE hDevice) {
+    UINT nameSize = 0;
+    GetRawInputDeviceInfoA(hDevice, RIDI_DEVICENAME, nullptr, &nameSize);
+    if (nameSize == 0) {
+        return std::string();
+    }
+
+    std::string path(nameSize, '\0');
+    UINT copied = GetRawInputDeviceInfoA(hDevice, RIDI_DEVICENAME, &path[0], &nameSize);
+    if (copied == 0 || copied == (UINT)-1) {
+        return std::string();
+    }
+    path.resize(strlen(path.c_str()));
+    return path;
+}
+
+class RawInputBackend : public InputBackend {
+public:
+    explicit RawInputBackend(InputPipeline& pipeline) : pipeline(pipeline) {}
+
+    const char* Start() override {
+        if (rawInputClaimed.exchange(true)) {
+            return "Raw input is already running in another context";
+        }
+
+        wakeEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        if (!wakeEvent) {
+            rawInputClaimed.store(false);
+            return "Failed to create wakeup event";
+        }
+        stopRequested = false;
+
+        std::promise<const char*> ready;
+        std::future<const char*> result = ready.get_future();
+        inputThread = std::thread([this, &ready]() { InputThreadMain(&ready); });
+
+        const char* error = result.get();
+        if (error) {
+            inputThread.join();
+            CloseHandle(wakeEvent);
+            wakeEvent = nullptr;
+            rawInputClaimed.store(false);
+        }
+        return error;
+    }
+
+    // A flag and an event rather than posted messages: PostThreadMessage fails once the thread's
+    // queue holds 10000 messages, and a lost WM_QUIT would hang the join.
+    void Stop() override {
+        stopRequested = true;
+        SetEvent(wakeEvent);
+        inputThread.join();
+        CloseHandle(wakeEvent);
+        wakeEvent = nullptr;
+        rawInputClaimed.store(false);
+    }
+
+    // Every wakeup ends in FlushProducer.
+    void RequestFlush() override {
+        SetEvent(wakeEvent);
+    }
+
+    void InjectMove(uint64_t handle, int dx, int dy) override {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            injected.push_back({ handle, dx, dy });
+        }
+        SetEvent(wakeEvent);
+    }
+
+private:
+    struct Injection {
+        uint64_t handle;
+        int dx, dy;
+    };
+
+    // Input thread from here on.
+
+    // Parses the device path once and records the device in the registry.
+    uint32_t RegisterRawDevice(HANDLE hDevice) {
+        std::string path = ReadDevicePath(hDevice);
+        return pipeline.RegisterDevice((uint64_t)(uintptr_t)hDevice, path.empty() ? "Unknown Device" : "", path, ParseDevicePath(path));
+    }
+
+    // Announces a registered device once per connection.
+    void ActivateDevice(uint32_t id) {
+        if (id == kInvalidDeviceId) {
+            return;
+        }
+        MouseDevice& device = devices[id];
+        if (device.active) {
+            return;
+        }
+        device.active = true;
+        device.x = GetSystemMetrics(SM_CXSCREEN) / 2;
+        device.y = GetSystemMetrics(SM_CYSCREEN) / 2;
+
+        pipeline.IngestEvent(MakeEvent(id, EventType::Device, EventAction::Added, device.x, device.y, 0, 0, 0));
+    }
+
+    // Only mice reach here: the raw input registration is for the generic mouse usage.
+    void SettleArrivals() {
+        hotplug.TakeSettled(NowMicros(), [this](uint64_t handle) {
+            ActivateDevice(RegisterRawDevice((HANDLE)(uintptr_t)handle));
+        });
+    }
+
+    static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        RawInputBackend* backend = (RawInputBackend*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+        if (backend) {
+            backend->HandleMessage(msg, wParam, lParam);
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
+    void HandleRawMouse(HANDLE hDevice, const RAWMOUSE& mouse) {
+        uint32_t id;
+        if (!pipeline.LookupDevice((uint64_t)(uintptr_t)hDevice, &id) || !devices[id].active) {
+            id = RegisterRawDevice(hDevice);
+            if (id == kInvalidDeviceId) {
+                return;
+            }
+        }
+
+        // Normally announced on arrival already; input can beat the settle window.
+        ActivateDevice(id);
+        MouseDevice& device = devices[id];
+
+        USHORT buttonFlags = mouse.usButtonFlags;
+
+        if (buttonFlags != 0) {
+            DEBUG_LOG("[C++] ButtonFlags = 0x%04X, Device = %p\n", buttonFlags, hDevice);
+        }
+
+        auto pushButton = [&](EventAction action) {
+            pipeline.IngestEvent(MakeEvent(id, EventType::Button, action, device.x, device.y, 0, 0, buttonFlags));
+        };
+
+        if (buttonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)   pushButton(EventAction::LeftDown);
+        if (buttonFlags & RI_MOUSE_LEFT_BUTTON_UP)     pushButton(EventAction::LeftUp);
+        if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)  pushButton(EventAction::RightDown);
+        if (buttonFlags & RI_MOUSE_RIGHT_BUTTON_UP)    pushButton(EventAction::RightUp);
+        if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN) pushButton(EventAction::MiddleDown);
+        if (buttonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)   pushButton(EventAction::MiddleUp);
+
+        if (mouse.lLastX != 0 || mouse.lLastY != 0) {
+            // With the motion engine on, positions are per device and GetCursorPos is not needed.
+            POINT cursorPos;
+            if (!pipeline.Motion().Enabled() && GetCursorPos(&cursorPos)) {
+                device.x = cursorPos.x;
+                device.y = cursorPos.y;
+            } else {
+                device.x += mouse.lLastX;
+                device.y += mouse.lLastY;
+
+                device.x = std::max(0, std::min(device.x, GetSystemMetrics(SM_CXSCREEN) - 1));
+                device.y = std::max(0, std::min(device.y, (GetSystemMetrics(SM_CYSCREEN) - 1)));
+            }
+
+            pipeline.IngestEvent(MakeEvent(id, EventType::Move, EventAction::None, device.x, device.y,
+                mouse.lLastX, mouse.lLastY, mouse.usFlags));
+        }
+    }
+
+    // Takes every queued raw input report in as few GetRawInputBuffer calls as the buffer allows,
+    // instead of one WM_INPUT dispatch and GetRawInputData call per report. Reports read here
+    // never reach the window procedure.
+    void ReadRawInputBuffer() {
+        for (;;) {
+            UINT size = (UINT)(sizeof(rawBuffer));
+            UINT count = GetRawInputBuffer((RAWINPUT*)rawBuffer, &size, sizeof(RAWINPUTHEADER));
+            pipeline.CountRead();
+            if (count == 0 || count == (UINT)-1) {
+                return;
+            }
+            pipeline.CountMessages(count);
+
+            // A 32-bit process on 64-bit Windows gets 64-bit records here (not from GetRawInputData).
+            RawInputRecords records(rawBuffer, sizeof(rawBuffer), sizeof(void*) == 8 || wow64);
+            RawInputRecord record;
+            for (UINT i = 0; i < count && records.Next(&record); i++) {
+                if (record.type == RIM_TYPEMOUSE && record.dataSize >= sizeof(RAWMOUSE)) {
+                    RAWMOUSE mouse;
+                    memcpy(&mouse, record.data, sizeof(mouse));
+                    HandleRawMouse((HANDLE)(uintptr_t)record.device, mouse);
+                }
+            }
+        }
+    }
+
+    void HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
+        switch (msg) {
+            case WM_INPUT: {
+                // Reports that arrived after the last buffered read. Only mice are registered, so
+                // one RAWINPUT always fits.
+                RAWINPUT raw;
+                UINT size = sizeof(raw);
+                UINT copied = GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER));
+                pipeline.CountRead();
+                if (copied != (UINT)-1 && copied >= sizeof(RAWINPUTHEADER) && raw.header.dwType == RIM_TYPEMOUSE) {
+                    pipeline.CountMessages(1);
+                    HandleRawMouse(raw.header.hDevice, raw.data.mouse);
+                }
+                break;
+            }
+            case WM_INPUT_DEVICE_CHANGE: {
+                HANDLE hDevice = (HANDLE)lParam;
+                if (wParam == GIDC_ARRIVAL) {
+                    hotplug.Arrived((uint64_t)(uintptr_t)hDevice, NowMicros());
+                } else if (wParam == GIDC_REMOVAL) {
+                    hotplug.Removed((uint64_t)(uintptr_t)hDevice);
+                    uint32_t deviceId;
+                    if (pipeline.LookupDevice((uint64_t)(uintptr_t)hDevice, &deviceId) && devices[deviceId].active) {
+                        devices[deviceId].active = false;
+                        pipeline.Registry().Remove(deviceId);
+                        pipeline.IngestEvent(MakeEvent(deviceId, EventType::Device, EventAction::Removed, 0, 0, 0, 0, 0));
+                        pipeline.ReleaseDevice(deviceId);
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    void RunCommands() {
+        std::vector<Injection> pending;
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            pending.swap(injected);
+        }
+        for (const Injection& injection : pending) {
+            uint32_t deviceId = pipeline.InternDevice(injection.handle, "Simulated Mouse");
+            pipeline.IngestEvent(MakeEvent(deviceId, EventType::Move, EventAction::None,
+                500 + injection.dx, 500 + injection.dy, injection.dx, injection.dy, 0));
+        }
+    }
+
+    const char* CreateRawInputWindow() {
+        WNDCLASSA wc = {};
+        wc.lpfnWndProc = WndProc;
+        wc.hInstance = GetModuleHandle(nullptr);
+        wc.lpszClassName = "OrionixRawInput";
+
+        if (!RegisterClassA(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
+            return "Failed to register window class";
+        }
+
+        hiddenWindow = CreateWindowExA(
+            0,
+            "OrionixRawInput",
+            "Hidden",
+            WS_POPUP,
+            -32000, -32000, 1, 1,
+            nullptr,
+            nullptr,
+            GetModuleHandle(nullptr),
+            nullptr
+        );
+
+        if (!hiddenWindow) {
+            return "Failed to create hidden window";
+        }
+        SetWindowLongPtr(hiddenWindow, GWLP_USERDATA, (LONG_PTR)this);
+
+        RAWINPUTDEVICE rid[1];
+        rid[0].usUsagePage = 0x01;
+        rid[0].usUsage = 0x02;
+        rid[0].dwFlags = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY;
+        rid[0].hwndTarget = hiddenWindow;
+
+        if (!RegisterRawInputDevices(rid, 1, sizeof(rid[0]))) {
+            DestroyWindow(hiddenWindow);
+            hiddenWindow = nullptr;
+            return "Failed to register raw input devices";
+        }
+
+        return nullptr;
+    }
+
+    void DestroyRawInputWindow() {
+        RAWINPUTDEVICE rid[1];
+        rid[0].usUsagePage = 0x01;
+        rid[0].usUsage = 0x02;
+        rid[0].dwFlags = RIDEV_REMOVE;
+        rid[0].hwndTarget = nullptr;
+
+        RegisterRawInputDevices(rid, 1, sizeof(rid[0]));
+
+        if (hiddenWindow) {
+            DestroyWindow(hiddenWindow);
+            hiddenWindow = nullptr;
+        }
+
+        for (MouseDevice& device : devices) {
+            device.active = false;
+        }
+        pipeline.Registry().Clear();
+    }
+
+    DWORD ProducerWaitTimeout() {
+        int64_t wait = pipeline.ProducerWaitMicros();
+        int64_t settle = hotplug.WaitMicros(NowMicros());
+        if (settle >= 0) {
+            wait = wait < 0 ? settle : std::min(wait, settle);
+        }
+        return wait < 0 ? INFINITE : (DWORD)((wait + 999) / 1000);
+    }
+
+    // Owns the hidden window and its message queue. Blocks while idle, reads the queued raw input
+    // in bulk on each wakeup and only wakes the JS thread once per batch of queued events.
+    void InputThreadMain(std::promise<const char*>* ready) {
+        MSG msg;
+        const char* error = CreateRawInputWindow();
+        ready->set_value(error);
+        if (error) {
+            return;
+        }
+
+#ifndef _WIN64
+        BOOL isWow64 = FALSE;
+        wow64 = IsWow64Process(GetCurrentProcess(), &isWow64) && isWow64;
+#endif
+
+        while (!stopRequested) {
+            // MWMO_INPUTAVAILABLE: also return for input that an earlier PeekMessage already saw.
+            DWORD wait = MsgWaitForMultipleObjectsEx(1, &wakeEvent, ProducerWaitTimeout(), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+            if (wait == WAIT_FAILED) {
+                break;
+            }
+
+            if (wait != WAIT_TIMEOUT) {
+                RunCommands();
+                ReadRawInputBuffer();
+                while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                    TranslateMessage(&msg);
+                    DispatchMessage(&msg);
+                }
+            }
+
+            SettleArrivals();
+            pipeline.FlushProducer();
+            pipeline.WakeConsumer();
+        }
+
+        DestroyRawInputWindow();
+    }
+
+    InputPipeline& pipeline;
+    std::thread inputThread;
+    HANDLE wakeEvent = nullptr;
+    std::atomic<bool> stopRequested{false};
+    std::mutex commandMutex;
+    std::vector<Injection> injected;
+    HWND hiddenWindow = nullptr;
+    HotplugDebouncer hotplug;
+    bool wow64 = false;
+    // GetRawInputBuffer needs pointer-aligned records; 16 KB holds a few hundred mouse reports.
+    uint64_t rawBuffer[2048];
+    // Indexed by the dense device id from the registry.
+    MouseDevice devices[kMaxDeviceSlots] = {};
+};
+
+std::unique_ptr<InputBackend> CreateInputBackend(InputPipeline& pipeline) {
+    return std::unique_ptr<InputBackend>(new RawInputBackend(pipeline));
+}
+
+class SystemCursorSink : public CursorSink {
+public:
+    void MoveTo(int32_t x, int32_t y) override {
+        int left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+        int top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+        x = std::max(left, std::min(x, left + GetSystemMetrics(SM_CXVIRTUALSCREEN) - 1));
+        y = std::max(top, std::min(y, top + GetSystemMetrics(SM_CYVIRTUALSCREEN) - 1));
+        SetCursorPos(x, y);
+    }
+};
+
+std::unique_ptr<CursorSink> CreateSystemCursorSink() {
+    return std::unique_ptr<CursorSink>(new SystemCursorSink());
+}
+
+std::vector<InputDeviceInfo> EnumerateInputDevices() {
+    std::vector<InputDeviceInfo> result;
+
+    UINT numDevices;
+    if (GetRawInputDeviceList(nullptr, &numDevices, sizeof(RAWINPUTDEVICELIST)) != 0 || numDevices == 0) {
+        return result;
+    }
+
+    std::vector<RAWINPUTDEVICELIST> deviceList(numDevices);
+    if (GetRawInputDeviceList(&deviceList[0], &numDevices, sizeof(RAWINPUTDEVICELIST)) == (UINT)-1) {
+        return result;
+    }
+
+    for (UINT i = 0; i < numDevices; i++) {
+        if (deviceList[i].dwType == RIM_TYPEMOUSE) {
+            InputDeviceInfo device;
+            device.id = (uint32_t)result.size();
+            device.handle = (uint64_t)(uintptr_t)deviceList[i].hDevice;
+            device.path = ReadDevicePath(deviceList[i].hDevice);
+            device.identity = ParseDevicePath(device.path);
+            device.name = device.path.empty() ? "Unknown Device" : DescribeDevice(device.identity);
+            result.push_back(device);
+        }
+    }
+
+    return result;
+}
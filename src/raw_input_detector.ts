@@ -1,80 +1,82 @@
+import { spawn } from 'child_process';
 import { EventEmitter } from 'events';
+import * as fs from 'fs';
 import * as path from 'path';
-import { ImprovedUSBMonitor } from './improved_usb_monitor';
-import { DeviceChangeData, MouseDevice, RawInputModuleInterface } from './types';
+import { Worker } from 'worker_threads';
+import { DeviceChangeData, InputWorkerMessage, MouseDevice, RawInputModuleInterface } from './types';
+
+const BATCH_RECORD_INT32S = 10;
+const BATCH_RECORD_FLOAT64S = BATCH_RECORD_INT32S / 2;
+const EVENT_TYPE_NAMES = ['move', 'button', 'device'];
+const EVENT_ACTION_NAMES = ['', 'left-down', 'left-up', 'right-down', 'right-up', 'middle-down', 'middle-up', 'added', 'removed'];
+const WORKER_BATCH_RECORDS = 256;
+// kMoveFlagSettle in src/motion_filter.h.
+const MOVE_FLAG_SETTLE = 0x8000;
+
+export const INPUT_DAEMON_PATH = path
+  .join(__dirname, '..', 'build', 'Release', process.platform === 'win32' ? 'orionix_input_daemon.exe' : 'orionix_input_daemon')
+  .replace(`app.asar${path.sep}`, `app.asar.unpacked${path.sep}`);
+
+// With `service`, attaches to the input daemon. A daemon that is not running yet is started
+// detached for the next launch, and this one reads the devices itself meanwhile.
+export function startInputEngine(rawInputModule: RawInputModuleInterface, service: boolean): boolean {
+  if (service && rawInputModule.connectInputService) {
+    try {
+      return rawInputModule.connectInputService();
+    } catch {
+      try {
+        if (fs.existsSync(INPUT_DAEMON_PATH)) {
+          spawn(INPUT_DAEMON_PATH, [], { detached: true, stdio: 'ignore', windowsHide: true }).unref();
+        }
+      } catch (error) {
+        console.warn("Démarrage du service d'entrée impossible:", error);
+      }
+    }
+  }
+  return rawInputModule.startRawInput();
+}
 
 export class RawInputMouseDetector extends EventEmitter {
   private isActive: boolean = false;
   private devices: Map<string, MouseDevice> = new Map();
-  private messageProcessInterval: NodeJS.Timeout | null = null;
-  private lastMoveTimestamp: number = Date.now();
-  private currentPollingInterval: number = 16;
+  private batchInts: Int32Array | null = null;
+  private batchFloats: Float64Array | null = null;
+  private deviceSlots: Map<number, { handle: number; name: string }> = new Map();
+  private worker: Worker | null = null;
+  private workerDevices: any[] = [];
+  private workerCalls: Map<number, { resolve: (value: any) => void; reject: (error: Error) => void }> = new Map();
+  private nextWorkerCall = 1;
 
   public rawInputModule: RawInputModuleInterface | null = null;
+  public readonly modulePath: string = path.join(__dirname, '..', 'build', 'Release', 'Orionix_raw_input.node');
 
-  private usbMonitor: ImprovedUSBMonitor;
-
-  constructor() {
-    super();
-    this.usbMonitor = new ImprovedUSBMonitor();
-    this.setupUSBMonitorEvents();
-  }
-
-  private setupUSBMonitorEvents(): void {
-    this.usbMonitor.on('mouseDisconnected', (data: { deviceId: string; name: string }) => {
-      this.removeAllInactiveDevices();
-    });
-
-    this.usbMonitor.on('mouseConnected', (data: { deviceId: string; name: string }) => {});
-  }
-
-  private removeAllInactiveDevices(): void {
-    const devicesToRemove = Array.from(this.devices.keys());
-
-    for (const rawDeviceId of devicesToRemove) {
-      const device = this.devices.get(rawDeviceId);
-      if (device) {
-        this.devices.delete(rawDeviceId);
-        this.emit('deviceRemoved', device);
-      }
-    }
-  }
-
-  public start(): boolean {
+  // With `worker`, the input engine runs in a worker_thread on its own addon instance and this
+  // thread only decodes the batches it posts. `service` is passed to startInputEngine.
+  public start(options: { worker?: boolean; service?: boolean } = {}): boolean {
     if (this.isActive) return true;
 
     try {
-      const modulePath = path.join(__dirname, '..', 'build', 'Release', 'Orionix_raw_input.node');
-      this.rawInputModule = require(modulePath) as RawInputModuleInterface;
+      const rawInputModule = require(this.modulePath) as RawInputModuleInterface;
+      if (options.worker) {
+        return this.startWorker(rawInputModule, !!options.service);
+      }
+      this.rawInputModule = rawInputModule;
 
       this.rawInputModule.setCallbacks(this.handleMouseMove.bind(this), this.handleDeviceChange.bind(this));
 
-      const success = this.rawInputModule.startRawInput();
+      if (this.rawInputModule.enableBatchMode) {
+        const buffer = this.rawInputModule.enableBatchMode(this.handleBatch.bind(this));
+        this.batchInts = new Int32Array(buffer);
+        this.batchFloats = new Float64Array(buffer);
+      }
+
+      const success = startInputEngine(this.rawInputModule, !!options.service);
       if (!success) {
         return false;
       }
 
       this.isActive = true;
 
-      this.usbMonitor.start();
-
-      const tick = () => {
-        if (!this.rawInputModule) return;
-        this.rawInputModule.processMessages();
-
-        const idleFor = Date.now() - this.lastMoveTimestamp;
-        const targetInterval = idleFor > 500 ? 64 : 16;
-
-        if (targetInterval !== this.currentPollingInterval) {
-          this.currentPollingInterval = targetInterval;
-          if (this.messageProcessInterval) {
-            clearInterval(this.messageProcessInterval);
-          }
-          this.messageProcessInterval = setInterval(tick, this.currentPollingInterval);
-        }
-      };
-
-      this.messageProcessInterval = setInterval(tick, this.currentPollingInterval);
 
       this.emit('started');
       return true;
@@ -88,18 +90,26 @@ export class RawInputMouseDetector extends EventEmitter {
 
     this.isActive = false;
 
-    this.usbMonitor.stop();
-
-    if (this.messageProcessInterval) {
-      clearInterval(this.messageProcessInterval);
-      this.messageProcessInterval = null;
-    }
 
-    if (this.rawInputModule) {
+    if (this.worker) {
+      this.worker.postMessage({ type: 'stop' });
+      this.worker = null;
+      this.rawInputModule = null;
+      this.workerDevices = [];
+      for (const call of this.workerCalls.values()) {
+        call.reject(new Error('Input worker stopped'));
+      }
+      this.workerCalls.clear();
+    } else if (this.rawInputModule) {
       this.rawInputModule.stopRawInput();
+      this.rawInputModule.disableBatchMode?.();
       this.rawInputModule = null;
     }
 
+    this.batchInts = null;
+    this.batchFloats = null;
+    this.deviceSlots.clear();
+
     this.devices.clear();
     this.emit('stopped');
   }
@@ -108,9 +118,146 @@ export class RawInputMouseDetector extends EventEmitter {
     return this.isActive;
   }
 
-  private handleMouseMove(moveData: any): void {
-    this.lastMoveTimestamp = Date.now();
+  private getDeviceSlot(deviceId: number): { handle: number; name: string } {
+    let slot = this.deviceSlots.get(deviceId);
+    if (!slot) {
+      slot = this.rawInputModule?.getDeviceSlot?.(deviceId) ?? { handle: deviceId, name: '' };
+      this.deviceSlots.set(deviceId, slot);
+    }
+    return slot;
+  }
+
+  // Engine calls go to the worker's addon instance; the rest (system cursor, cursor bitmaps,
+  // compositor, cursor table) stays on this thread's instance, which never starts input itself.
+  // Forwards never wait for the worker, and only the ones whose answer this thread can work out
+  // (subscription mask, layout size) return one. Whether lockCursor or configureMotion took is
+  // asked through callEngine instead.
+  private startWorker(mainModule: RawInputModuleInterface, service: boolean): boolean {
+    const worker = new Worker(path.join(__dirname, 'input_worker.js'), {
+      workerData: { modulePath: this.modulePath, batchRecords: WORKER_BATCH_RECORDS, service },
+    });
+    worker.on('message', (message: InputWorkerMessage) => this.handleWorkerMessage(message));
+    worker.on('error', (error) => this.handleWorkerMessage({ type: 'error', message: String(error) }));
+    worker.on('exit', () => {
+      if (this.worker === worker) this.stop();
+    });
+
+    const forward =
+      (method: string, result: (...args: any[]) => any = () => undefined) =>
+      (...args: any[]): any => {
+        worker.postMessage({ type: 'call', method, args });
+        return result(...args);
+      };
+
+    this.worker = worker;
+    this.rawInputModule = {
+      ...mainModule,
+      getDevices: () => this.workerDevices,
+      getDeviceSlot: (deviceId: number) => this.deviceSlots.get(deviceId) ?? null,
+      configureMotion: forward('configureMotion'),
+      configureMotionFilter: forward('configureMotionFilter'),
+      clearMotionFilter: forward('clearMotionFilter'),
+      setDevicePosition: forward('setDevicePosition'),
+      setSubscription: forward('setSubscription', (classes: string[]) =>
+        classes.reduce((mask, name) => mask | (name === 'move' ? 1 : name === 'button' ? 2 : name === 'device' ? 4 : 0), 0)
+      ),
+      clearSubscription: forward('clearSubscription'),
+      setMonitorLayout: forward('setMonitorLayout', (monitors) => mainModule.setMonitorLayout?.(monitors) ?? monitors.length),
+      lockCursor: forward('lockCursor'),
+      unlockCursor: forward('unlockCursor'),
+      setCursorRouting: forward('setCursorRouting'),
+      setOverflowPolicy: forward('setOverflowPolicy'),
+      setCoalescing: forward('setCoalescing'),
+      configureFramePacing: forward('configureFramePacing'),
+      reportFrame: forward('reportFrame'),
+      reportLatency: forward('reportLatency'),
+      resetLatencyStats: forward('resetLatencyStats'),
+      setStatsDump: forward('setStatsDump'),
+      getLatencyStats: undefined,
+      getStats: undefined,
+      getQueueStats: undefined,
+    };
+
+    this.isActive = true;
+    this.emit('started');
+    return true;
+  }
+
+  private handleWorkerMessage(message: InputWorkerMessage): void {
+    if (message.type === 'batch') {
+      for (const [deviceId, handle, name] of message.slots) {
+        this.deviceSlots.set(deviceId, { handle, name });
+      }
+      if (message.devices) {
+        this.workerDevices = message.devices;
+      }
+      this.decodeBatch(new Int32Array(message.records), new Float64Array(message.records), message.count);
+    } else if (message.type === 'result') {
+      const call = this.workerCalls.get(message.id);
+      this.workerCalls.delete(message.id);
+      if (message.error) {
+        call?.reject(new Error(message.error));
+      } else {
+        call?.resolve(message.value);
+      }
+    } else if (message.type === 'error') {
+      console.warn('Input worker:', message.message);
+      this.stop();
+    }
+  }
+
+  // Value-returning engine queries, wherever the engine runs.
+  public callEngine<T>(method: keyof RawInputModuleInterface, ...args: unknown[]): Promise<T> {
+    if (this.worker) {
+      const id = this.nextWorkerCall++;
+      this.worker.postMessage({ type: 'call', id, method, args });
+      return new Promise<T>((resolve, reject) => this.workerCalls.set(id, { resolve, reject }));
+    }
+    const fn = this.rawInputModule?.[method] as ((...args: unknown[]) => T) | undefined;
+    return fn ? Promise.resolve(fn(...args)) : Promise.reject(new Error(`${method} is not available`));
+  }
+
+  private handleBatch(count: number): void {
+    if (this.batchInts && this.batchFloats) {
+      this.decodeBatch(this.batchInts, this.batchFloats, count);
+    }
+  }
+
+  private decodeBatch(ints: Int32Array, floats: Float64Array, count: number): void {
+    for (let i = 0; i < count; i++) {
+      const base = i * BATCH_RECORD_INT32S;
+      const slot = this.getDeviceSlot(ints[base]);
+      const type = EVENT_TYPE_NAMES[ints[base + 1] & 0xff];
+      const action = EVENT_ACTION_NAMES[ints[base + 1] >> 8];
+
+      if (type === 'device') {
+        this.handleDeviceChange({
+          handle: slot.handle,
+          name: slot.name,
+          x: ints[base + 2],
+          y: ints[base + 3],
+          action: action as DeviceChangeData['action'],
+        });
+        continue;
+      }
 
+      this.handleMouseMove({
+        type,
+        deviceHandle: slot.handle,
+        deviceName: slot.name,
+        x: ints[base + 2],
+        y: ints[base + 3],
+        dx: ints[base + 4],
+        dy: ints[base + 5],
+        flags: ints[base + 6],
+        action,
+        seq: ints[base + 7],
+        timestamp: floats[i * BATCH_RECORD_FLOAT64S + 4],
+      });
+    }
+  }
+
+  private handleMouseMove(moveData: any): void {
     if (moveData?.type === 'button') {
     }
 
@@ -139,7 +286,9 @@ export class RawInputMouseDetector extends EventEmitter {
       return;
     }
 
-    if ((actualData.dx === 0 && actualData.dy === 0) || (actualData.dx === undefined && actualData.dy === undefined)) {
+    // A settle move carries no motion but puts a filtered cursor back on its true position.
+    const settled = ((actualData.flags ?? 0) & MOVE_FLAG_SETTLE) !== 0;
+    if (!settled && ((actualData.dx === 0 && actualData.dy === 0) || (actualData.dx === undefined && actualData.dy === undefined))) {
       return;
     }
 
@@ -193,7 +342,9 @@ export class RawInputMouseDetector extends EventEmitter {
       dx: actualData.dx || 0,
       dy: actualData.dy || 0,
       timestamp: Date.now(),
+      seq: actualData.seq,
       isRawInput: true,
+      settled,
       type: actualData.type,
     };
 
@@ -205,6 +356,11 @@ export class RawInputMouseDetector extends EventEmitter {
 
     if (deviceData.action === 'added') {
       if (!this.devices.has(deviceKey)) {
+        // Batch records carry only the slot; the registry has the rest.
+        const info =
+          deviceData.vendorId === undefined
+            ? this.rawInputModule?.getDevices().find((d) => d.handle === deviceData.handle)
+            : deviceData;
         const device: MouseDevice = {
           id: deviceKey,
           handle: deviceData.handle,
@@ -213,6 +369,11 @@ export class RawInputMouseDetector extends EventEmitter {
           y: deviceData.y || 0,
           connected: true,
           lastSeen: Date.now(),
+          vendorId: info?.vendorId,
+          productId: info?.productId,
+          bus: info?.bus,
+          kind: info?.kind,
+          path: info?.path,
         };
 
         this.devices.set(deviceKey, device);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Header of a GetRawInputBuffer record: dwType and dwSize, then hDevice and wParam at pointer
+// width. 64-bit records (x64, and a 32-bit process under WOW64) start on 8-byte boundaries,
+// native 32-bit ones on 4-byte boundaries.
+constexpr size_t RawInputHeaderSize(bool wide) {
+    return wide ? 24 : 16;
+}
+
+struct RawInputRecord {
+    uint32_t type;
+    uint64_t device;
+    // Payload after the header, dwSize minus the header long.
+    const uint8_t* data;
+    size_t dataSize;
+};
+
+// Walks the records of one GetRawInputBuffer call without <windows.h>. NEXTRAWINPUTBLOCK is
+// compiled for the process's own layout, so a 32-bit build under WOW64 steps to the wrong
+// record after any whose size is not a multiple of 8. The buffer must be 8-byte aligned.
+class RawInputRecords {
+public:
+    RawInputRecords(const void* buffer, size_t size, bool wide)
+        : buffer_((const uint8_t*)buffer), size_(size), wide_(wide) {}
+
+    // False at the end of the buffer, or at a record whose dwSize is smaller than its header or
+    // runs past the buffer; nothing after such a record can be located.
+    bool Next(RawInputRecord* record) {
+        const size_t headerSize = RawInputHeaderSize(wide_);
+        if (offset_ > size_ || size_ - offset_ < headerSize) {
+            return false;
+        }
+        const uint8_t* p = buffer_ + offset_;
+        uint32_t recordSize;
+        memcpy(&record->type, p, 4);
+        memcpy(&recordSize, p + 4, 4);
+        if (recordSize < headerSize || recordSize > size_ - offset_) {
+            return false;
+        }
+        // Little-endian: the low half of a 64-bit handle is where a 32-bit one sits.
+        record->device = 0;
+        memcpy(&record->device, p + 8, wide_ ? 8 : 4);
+        record->data = p + headerSize;
+        record->dataSize = recordSize - headerSize;
+
+        const size_t align = wide_ ? 8 : 4;
+        offset_ += (recordSize + align - 1) & ~(align - 1);
+        return true;
+    }
+
+private:
+    const uint8_t* buffer_;
+    size_t size_;
+    size_t offset_ = 0;
+    bool wide_;
+};
@@ -12,6 +12,10 @@ class OrionixRenderer {
   private frameRequestId: any = null;
   private highPrecisionMode: boolean = true;
   private systemCursorSize: number = 32;
+  private cursorHotspots: Record<string, { hotspotX: number; hotspotY: number; width: number; height: number }> = {};
+  private compositorCanvas: HTMLCanvasElement | null = null;
+  private cursorTable: any = null;
+  private cursorTableVersion: number = 0;
 
   private screenOffsetX: number = 0;
   private screenOffsetY: number = 0;
@@ -94,6 +98,9 @@ class OrionixRenderer {
         'cursors-config-changed': () => this.reloadCursorMappings(),
         'system-cursor-size': (size: number) => this.handleSystemCursorSize(size),
         'screen-info': (d: any) => this.handleScreenInfo(d),
+        'cursor-hotspots': (d: any) => (this.cursorHotspots = d || {}),
+        'compositor-frame': (d: any[]) => this.drawCompositorFrame(d),
+        'cursor-table': (d: { name: string; modulePath: string }) => this.openCursorTable(d),
       };
 
       for (const [evt, fn] of Object.entries(handlers)) {
@@ -378,6 +385,9 @@ class OrionixRenderer {
     if (!this.highPrecisionMode) return;
 
     const loop = (): void => {
+      if (this.cursorTable) {
+        this.readCursorTable();
+      }
       if (this.pendingUpdates.size > 0) {
         this.processPendingUpdates();
       }
@@ -386,6 +396,30 @@ class OrionixRenderer {
     this.frameRequestId = requestAnimationFrame(loop);
   }
 
+  // Maps the main process's shared cursor table; once open, positions are read from it each
+  // frame and main stops sending them over IPC. On any failure the overlay stays on IPC.
+  private openCursorTable(d: { name: string; modulePath: string }): void {
+    try {
+      const addon = require(d.modulePath);
+      if (!addon.openCursorTable || !addon.openCursorTable(d.name)) return;
+      this.cursorTable = addon;
+      this.cursorTableVersion = 0;
+      const { ipcRenderer } = require('electron');
+      ipcRenderer.send('cursor-table-ready');
+    } catch (err) {
+      this.cursorTable = null;
+    }
+  }
+
+  private readCursorTable(): void {
+    const snapshot = this.cursorTable.readCursorTable(this.cursorTableVersion);
+    if (!snapshot) return;
+    this.cursorTableVersion = snapshot.version;
+    snapshot.cursors.forEach((c: any) => {
+      if (c.isVisible) this.updateCursorPositionInstant(c);
+    });
+  }
+
   private handleHighPrecisionUpdate(d: any): void {
     if (d.isActive) {
       this.updateCursorPositionInstant(d);
@@ -456,7 +490,12 @@ class OrionixRenderer {
         help: [-1 * sizeScale, -1 * sizeScale, baseSize, baseSize],
         default: [0, 0, baseSize, baseSize],
       };
-      return curOffsets[cursorKey] || [0, 0, baseSize, baseSize];
+      const offsets = curOffsets[cursorKey] || [0, 0, baseSize, baseSize];
+      const hotspot = this.cursorHotspots[cursorKey];
+      if (hotspot) {
+        return [(-hotspot.hotspotX * offsets[2]) / hotspot.width, (-hotspot.hotspotY * offsets[3]) / hotspot.height, offsets[2], offsets[3]];
+      }
+      return offsets;
     }
   }
 
@@ -511,7 +550,7 @@ class OrionixRenderer {
 
     try {
       const { ipcRenderer } = require('electron');
-      ipcRenderer.send('cursor:htmlPos', { deviceHandle, x: virtualX, y: virtualY });
+      ipcRenderer.send('cursor:htmlPos', { deviceHandle, x: virtualX, y: virtualY, seq: d.seq });
     } catch (e) {}
   }
 
@@ -690,6 +729,35 @@ class OrionixRenderer {
     });
   }
 
+  // Frames from the native compositor replace the DOM cursors: each rect is an already composed,
+  // straight-alpha region of this display's surface.
+  private drawCompositorFrame(rects: { x: number; y: number; width: number; height: number; pixels: Uint8Array }[]): void {
+    if (!this.compositorCanvas) {
+      const canvas = document.createElement('canvas');
+      canvas.id = 'compositor-canvas';
+      canvas.width = window.innerWidth;
+      canvas.height = window.innerHeight;
+      Object.assign(canvas.style, {
+        position: 'fixed',
+        left: '0',
+        top: '0',
+        width: `${canvas.width}px`,
+        height: `${canvas.height}px`,
+        pointerEvents: 'none',
+      });
+      document.body.appendChild(canvas);
+      this.cursorsContainer.style.display = 'none';
+      this.compositorCanvas = canvas;
+    }
+
+    const context = this.compositorCanvas.getContext('2d');
+    if (!context) return;
+    for (const rect of rects) {
+      const pixels = new Uint8ClampedArray(rect.pixels.buffer, rect.pixels.byteOffset, rect.pixels.byteLength);
+      context.putImageData(new ImageData(pixels, rect.width, rect.height), rect.x, rect.y);
+    }
+  }
+
   private handleSettingsUpdate(settings: any): void {
     this.config = { ...this.config, ...settings };
     this.updateInfoPanel();
@@ -0,0 +1,343 @@
+#include "shared_event_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+static const char kRingMagic[8] = { 'O', 'R', 'X', 'E', 'V', 'R', 'G', 0 };
+static const int kMaxReadAttempts = 64;
+#ifdef _WIN32
+static const int64_t kPollMicros = 500;
+#endif
+
+static_assert(sizeof(ServiceEvent) % 8 == 0 && sizeof(ServiceDevice) % 8 == 0, "records are copied as 64-bit words");
+static_assert((kEventRingCapacity & (kEventRingCapacity - 1)) == 0, "ring capacity must be a power of two");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+static uint64_t NewInstance() {
+    std::random_device random;
+    uint64_t instance = ((uint64_t)random() << 32) ^ random();
+    instance ^= (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    return instance ? instance : 1;
+}
+
+const char* SharedEventRing::Create(const std::string& name) {
+    Close();
+#ifdef _WIN32
+    std::string fullName = "Local\\" + name;
+    mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)sizeof(Layout), fullName.c_str());
+    if (!mapping_) {
+        return "Failed to create event ring";
+    }
+    layout_ = (Layout*)MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Layout));
+#else
+    std::string fullName = "/" + name;
+    shm_unlink(fullName.c_str());
+    int fd = shm_open(fullName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return "Failed to create event ring";
+    }
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, sizeof(Layout)) == 0) {
+        mapped = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(fullName.c_str());
+        return "Failed to map event ring";
+    }
+    layout_ = (Layout*)mapped;
+#endif
+    if (!layout_) {
+        Close();
+        return "Failed to map event ring";
+    }
+
+    name_ = name;
+    owner_ = true;
+    memset((void*)layout_, 0, sizeof(Layout));
+    layout_->header.version = kEventRingVersion;
+    layout_->header.capacity = (uint32_t)kEventRingCapacity;
+    layout_->header.recordSize = (uint32_t)sizeof(Record);
+    layout_->header.deviceSlots = (uint32_t)kServiceDeviceSlots;
+    layout_->header.instance.store(NewInstance(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(layout_->header.magic, kRingMagic, sizeof(kRingMagic));
+    return nullptr;
+}
+
+const char* SharedEventRing::Open(const std::string& name) {
+    Close();
+#ifdef _WIN32
+    std::string fullName = "Local\\" + name;
+    mapping_ = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, fullName.c_str());
+    if (!mapping_) {
+        return "Input service not running";
+    }
+    layout_ = (Layout*)MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Layout));
+#else
+    std::string fullName = "/" + name;
+    int fd = shm_open(fullName.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return "Input service not running";
+    }
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Layout)) {
+        mapped = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    layout_ = mapped == MAP_FAILED ? nullptr : (Layout*)mapped;
+#endif
+    if (!layout_) {
+        Close();
+        return "Failed to map event ring";
+    }
+
+    const Header& header = layout_->header;
+    if (memcmp(header.magic, kRingMagic, sizeof(kRingMagic)) != 0 || header.version != kEventRingVersion ||
+        header.capacity != kEventRingCapacity || header.recordSize != sizeof(Record) ||
+        header.deviceSlots != kServiceDeviceSlots) {
+        Close();
+        return "Incompatible event ring";
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    name_ = name;
+    return nullptr;
+}
+
+void SharedEventRing::Close() {
+#ifdef _WIN32
+    if (layout_) UnmapViewOfFile(layout_);
+    if (mapping_) CloseHandle(mapping_);
+    if (timer_) CloseHandle(timer_);
+    mapping_ = nullptr;
+    timer_ = nullptr;
+#else
+    if (layout_) munmap((void*)layout_, sizeof(Layout));
+    if (owner_) shm_unlink(("/" + name_).c_str());
+#endif
+    layout_ = nullptr;
+    owner_ = false;
+    name_.clear();
+    memset(handles_, 0, sizeof(handles_));
+}
+
+void SharedEventRing::Publish(const ServiceEvent& event) {
+    uint64_t words[kEventWords];
+    memcpy(words, &event, sizeof(words));
+
+    Cursor& cursor = layout_->cursor;
+    const uint64_t position = cursor.head.load(std::memory_order_relaxed);
+    Record& record = layout_->records[position & (kEventRingCapacity - 1)];
+    record.seq.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kEventWords; i++) {
+        record.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    record.seq.store(2 * position + 2, std::memory_order_release);
+    cursor.head.store(position + 1, std::memory_order_release);
+}
+
+void SharedEventRing::Notify() {
+    // Pairs with the fence in Wait: either the waiter sees the new head or this sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (layout_->cursor.waiters.load(std::memory_order_relaxed) != 0) {
+        Wake();
+    }
+}
+
+void SharedEventRing::Wake() {
+    if (!layout_) {
+        return;
+    }
+    layout_->cursor.signal.fetch_add(1, std::memory_order_release);
+#ifndef _WIN32
+    syscall(SYS_futex, (uint32_t*)&layout_->cursor.signal, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+bool SharedEventRing::WriteDevice(const ServiceDevice& device) {
+    if (!owner_ || device.handle == 0) {
+        return false;
+    }
+    size_t index = kServiceDeviceSlots;
+    for (size_t i = 0; i < kServiceDeviceSlots; i++) {
+        if (handles_[i] == device.handle) {
+            index = i;
+            break;
+        }
+        if (index == kServiceDeviceSlots && handles_[i] == 0) {
+            index = i;
+        }
+    }
+    // Full: an inactive entry only names a handle, so it is the one to give up.
+    for (size_t i = 0; index == kServiceDeviceSlots && i < kServiceDeviceSlots; i++) {
+        ServiceDevice existing;
+        if (ReadDevice(layout_->devices[i], &existing) && !existing.active) {
+            index = i;
+        }
+    }
+    if (index == kServiceDeviceSlots) {
+        return false;
+    }
+    handles_[index] = device.handle;
+
+    uint64_t words[kDeviceWords];
+    memcpy(words, &device, sizeof(words));
+    DeviceSlot& slot = layout_->devices[index];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kDeviceWords; i++) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(seq + 2, std::memory_order_release);
+    return true;
+}
+
+void SharedEventRing::Heartbeat(int64_t now) {
+    layout_->header.heartbeat.store(now, std::memory_order_release);
+}
+
+uint64_t SharedEventRing::Instance() const {
+    return layout_ ? layout_->header.instance.load(std::memory_order_acquire) : 0;
+}
+
+int64_t SharedEventRing::LastHeartbeat() const {
+    return layout_ ? layout_->header.heartbeat.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedEventRing::Alive(int64_t now) const {
+    return layout_ && now - LastHeartbeat() < kServiceTimeoutMicros;
+}
+
+uint64_t SharedEventRing::Head() const {
+    return layout_ ? layout_->cursor.head.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedEventRing::Read(uint64_t position, ServiceEvent* event) const {
+    const Record& record = layout_->records[position & (kEventRingCapacity - 1)];
+    const uint64_t expected = 2 * position + 2;
+    if (record.seq.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+    uint64_t words[kEventWords];
+    for (size_t i = 0; i < kEventWords; i++) {
+        words[i] = record.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (record.seq.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+    memcpy(event, words, sizeof(words));
+    return true;
+}
+
+bool SharedEventRing::ReadDevice(const DeviceSlot& slot, ServiceDevice* device) const {
+    uint64_t words[kDeviceWords];
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before != 0 && (before & 1) == 0) {
+            for (size_t i = 0; i < kDeviceWords; i++) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                memcpy(device, words, sizeof(words));
+                device->name[sizeof(device->name) - 1] = 0;
+                device->path[sizeof(device->path) - 1] = 0;
+                return true;
+            }
+        } else if (before == 0) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool SharedEventRing::FindDevice(uint64_t handle, ServiceDevice* device) const {
+    for (size_t i = 0; layout_ && i < kServiceDeviceSlots; i++) {
+        if (ReadDevice(layout_->devices[i], device) && device->handle == handle) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t SharedEventRing::Devices(ServiceDevice* out, size_t capacity) const {
+    size_t count = 0;
+    for (size_t i = 0; layout_ && i < kServiceDeviceSlots && count < capacity; i++) {
+        if (ReadDevice(layout_->devices[i], &out[count]) && out[count].active) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void SharedEventRing::Wait(uint64_t seen, int64_t timeoutMicros) {
+    if (!layout_ || timeoutMicros <= 0) {
+        return;
+    }
+    Cursor& cursor = layout_->cursor;
+#ifdef _WIN32
+    // Named events wake one waiter or need resetting by someone, so with any number of clients
+    // the ring is polled; the high-resolution timer keeps each poll near 500 us.
+    if (!timer_) {
+        timer_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer_) {
+            timer_ = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+        }
+    }
+    // Timed against the clock: without the high-resolution timer (before Windows 10 1803) a poll
+    // sleeps a whole scheduler tick, about 15.6 ms.
+    const uint32_t signal = cursor.signal.load(std::memory_order_acquire);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutMicros);
+    for (;;) {
+        if (cursor.head.load(std::memory_order_acquire) != seen || cursor.signal.load(std::memory_order_acquire) != signal) {
+            return;
+        }
+        const int64_t remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return;
+        }
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG)std::min(kPollMicros, remaining) * 10;
+        if (timer_ && SetWaitableTimer(timer_, &due, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(timer_, INFINITE);
+        } else {
+            Sleep(1);
+        }
+    }
+#else
+    // Read the word before the head: a Wake in between changes it and FUTEX_WAIT returns at once.
+    cursor.waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const uint32_t signal = cursor.signal.load(std::memory_order_acquire);
+    if (cursor.head.load(std::memory_order_acquire) == seen) {
+        timespec timeout;
+        timeout.tv_sec = (time_t)(timeoutMicros / 1000000);
+        timeout.tv_nsec = (long)(timeoutMicros % 1000000) * 1000;
+        syscall(SYS_futex, (uint32_t*)&cursor.signal, FUTEX_WAIT, signal, &timeout, nullptr, 0);
+    }
+    cursor.waiters.fetch_sub(1, std::memory_order_relaxed);
+#endif
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "event_ring.h"
+
+const uint32_t kEventRingVersion = 1;
+const size_t kEventRingCapacity = 16384;
+const size_t kServiceDeviceSlots = 64;
+// A daemon whose heartbeat is older than this counts as gone.
+const int64_t kServiceTimeoutMicros = 1000000;
+
+// One published event. The handle travels with it so clients map devices without sharing the
+// daemon's dense ids.
+struct ServiceEvent {
+    MouseEvent event;
+    uint64_t handle;
+};
+
+// One device as the daemon knows it. Inactive entries only name a handle that produced events
+// without being announced, e.g. an injected device.
+struct ServiceDevice {
+    uint64_t handle;
+    uint16_t vendorId;
+    uint16_t productId;
+    int16_t interfaceNumber;
+    uint8_t bus;           // DeviceBus
+    uint8_t kind;          // DeviceKind
+    uint32_t active;
+    uint32_t reserved;
+    char name[128];        // NUL-terminated
+    char path[256];        // NUL-terminated
+};
+
+// Named shared memory published by the input daemon (input_service.h): a broadcast ring of events
+// and a device table. Every record and device slot is a seqlock, as in CursorStateTable, so the
+// single writer never waits for anyone: each client keeps its own read position, and a client
+// that falls a whole ring behind loses the overwritten records instead of stalling the daemon.
+// Clients map the segment read-write only to wait on and signal its wake word.
+class SharedEventRing {
+public:
+    SharedEventRing() {}
+    SharedEventRing(const SharedEventRing&) = delete;
+    SharedEventRing& operator=(const SharedEventRing&) = delete;
+    ~SharedEventRing() { Close(); }
+
+    // Daemon: creates the named segment, replacing a stale one, and removes it on Close. Windows
+    // keeps a mapping alive while any client holds it, so there the stale segment is reset in
+    // place; clients see the new Instance() either way.
+    const char* Create(const std::string& name);
+    // Client: maps an existing segment.
+    const char* Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return layout_ != nullptr; }
+    const std::string& Name() const { return name_; }
+
+    // Daemon side. Publish makes one event visible; Notify wakes waiting clients and costs one
+    // load while none waits, so it can follow every Publish.
+    void Publish(const ServiceEvent& event);
+    void Notify();
+    // Claims a slot by handle on first write; false when every slot is taken.
+    bool WriteDevice(const ServiceDevice& device);
+    void Heartbeat(int64_t now);
+
+    // Client side.
+    // Random per Create: a different value after reopening means the daemon restarted.
+    uint64_t Instance() const;
+    int64_t LastHeartbeat() const;
+    bool Alive(int64_t now) const;
+    // Events published since the segment was created.
+    uint64_t Head() const;
+    // Copies the event at `position`; false once the writer has lapped it.
+    bool Read(uint64_t position, ServiceEvent* event) const;
+    bool FindDevice(uint64_t handle, ServiceDevice* device) const;
+    // Copies every active device, each one consistent.
+    size_t Devices(ServiceDevice* out, size_t capacity) const;
+    // Returns once Head() moves past `seen`, Wake is called or the timeout passes. Linux blocks
+    // on a futex in the segment; Windows polls every 500 us.
+    void Wait(uint64_t seen, int64_t timeoutMicros);
+    // Wakes every waiter, in any process.
+    void Wake();
+
+private:
+    static const size_t kEventWords = sizeof(ServiceEvent) / 8;
+    static const size_t kDeviceWords = sizeof(ServiceDevice) / 8;
+
+    struct alignas(64) Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t recordSize;
+        uint32_t deviceSlots;
+        std::atomic<uint64_t> instance;
+        std::atomic<int64_t> heartbeat;
+    };
+
+    struct alignas(64) Cursor {
+        std::atomic<uint64_t> head;
+        std::atomic<uint32_t> signal;   // futex word, bumped by Notify and Wake
+        std::atomic<uint32_t> waiters;  // clients inside Wait
+    };
+
+    struct alignas(64) DeviceSlot {
+        std::atomic<uint32_t> seq;
+        uint32_t reserved;
+        std::atomic<uint64_t> words[kDeviceWords];
+    };
+
+    // seq is 2 * position + 2 once the record at `position` is complete, odd while it is written.
+    struct Record {
+        std::atomic<uint64_t> seq;
+        std::atomic<uint64_t> words[kEventWords];
+    };
+
+    struct Layout {
+        Header header;
+        Cursor cursor;
+        DeviceSlot devices[kServiceDeviceSlots];
+        Record records[kEventRingCapacity];
+    };
+
+    bool ReadDevice(const DeviceSlot& slot, ServiceDevice* device) const;
+
+    std::string name_;
+    bool owner_ = false;
+    Layout* layout_ = nullptr;
+    uint64_t handles_[kServiceDeviceSlots] = {};   // daemon only: slot owners
+#ifdef _WIN32
+    HANDLE mapping_ = nullptr;
+    HANDLE timer_ = nullptr;
+#endif
+};
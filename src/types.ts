@@ -7,6 +7,105 @@ export interface MouseDevice {
   connected: boolean;
   lastSeen: number;
   totalMovement?: number;
+  vendorId?: number;
+  productId?: number;
+  bus?: string;
+  kind?: string;
+  path?: string;
+}
+
+export interface MotionOptions {
+  enabled: boolean;
+  gain: number;
+  acceleration: boolean;
+  accelThreshold?: number;
+  accelSlope?: number;
+  accelMax?: number;
+  bounds: { x: number; y: number; width: number; height: number };
+  origin: { x: number; y: number };
+}
+
+// Per-device filters applied to the native engine's positions (see src/motion_filter.h).
+export interface MotionFilterOptions {
+  smoothing: boolean;
+  prediction: boolean;
+  minCutoff?: number;
+  beta?: number;
+  derivativeCutoff?: number;
+  refreshHz?: number;
+  predictMs?: number;
+  processNoise?: number;
+  measurementNoise?: number;
+}
+
+// Frame pacing for setCoalescing('frame'). Without phaseMs the schedule follows reportFrame().
+export interface FramePacingOptions {
+  refreshHz: number;
+  phaseMs?: number;
+  leadMs?: number;
+}
+
+export interface FramePacingStats {
+  count: number;
+  missed: number;
+  jitterMean: number;
+  jitterMax: number;
+  period: number;
+  locked: boolean;
+}
+
+export interface DrainStats {
+  count: number;
+  mean: number;
+  p50: number;
+  p99: number;
+  max: number;
+}
+
+// getStats(): hot-path counters of the native pipeline since it was created.
+export interface InputStats {
+  messages: number;
+  reads: number;
+  serviceLost: number;
+  rejectedDevices: number;
+  rejectedEvents: number;
+  events: { move: number; button: number; device: number; settle: number; unsubscribed: number };
+  queue: {
+    pending: number;
+    highWater: number;
+    coalescedMoves: number;
+    emittedMoves: number;
+    droppedMoves: number;
+    mergedMoves: number;
+    deferredEvents: number;
+    backlog: number;
+  };
+  drains: { events: DrainStats; micros: DrainStats };
+  // Unlike getLatencyStats().frames, never reset.
+  frames: FramePacingStats;
+  devices: { id: number; handle: number; name: string; moves: number; buttons: number }[];
+}
+
+export type EventClass = 'move' | 'button' | 'device';
+
+export interface MonitorLayoutEntry {
+  id: number;
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+  scaleFactor: number;
+  physicalX?: number;
+  physicalY?: number;
+}
+
+export interface LatencyStageStats {
+  count: number;
+  mean: number;
+  p50: number;
+  p99: number;
+  p999: number;
+  max: number;
 }
 
 export interface MouseMoveData {
@@ -18,9 +117,11 @@ export interface MouseMoveData {
   dx?: number;
   dy?: number;
   timestamp: number;
+  seq?: number;
   isRawInput?: boolean;
   isPrimary?: boolean;
   isActive?: boolean;
+  settled?: boolean;
 }
 
 export interface CursorData {
@@ -59,6 +160,16 @@ export interface AppConfig {
   cursorSpeed: number;
   acceleration: boolean;
   overlayDebug: boolean;
+  nativeCompositor?: boolean;
+  inputWorker?: boolean;
+  // Attach to orionix_input_daemon, starting it if needed, so input survives app restarts.
+  inputService?: boolean;
+  motionSmoothing?: boolean;
+  motionPrediction?: boolean;
+  framePacing?: boolean;
+  // Rewritten every statsDumpIntervalMs with getStats('text'), relative to the user data folder.
+  statsDumpPath?: string;
+  statsDumpIntervalMs?: number;
 }
 
 export interface DeviceChangeData {
@@ -67,6 +178,11 @@ export interface DeviceChangeData {
   x?: number;
   y?: number;
   action: 'added' | 'removed';
+  vendorId?: number;
+  productId?: number;
+  bus?: string;
+  kind?: string;
+  path?: string;
 }
 
 export interface CursorTypeChangeData {
@@ -87,12 +203,135 @@ export interface CursorInstantUpdateData {
   cursors: CursorData[];
 }
 
+export interface CursorFrameData {
+  width: number;
+  height: number;
+  hotspotX: number;
+  hotspotY: number;
+  pixels: Buffer;
+}
+
+export interface CursorImageData {
+  path: string;
+  error?: string;
+  cached?: boolean;
+  frames?: CursorFrameData[];
+  steps?: { frame: number; durationMs: number }[];
+}
+
+export interface CursorLoadResult {
+  cursors: CursorImageData[];
+  cacheHits: number;
+  decoded: number;
+  cacheError?: string;
+}
+
+export interface CursorBitmapData extends CursorFrameData {
+  cached: boolean;
+}
+
+export interface CursorBitmapOptions {
+  size?: number;
+  color?: string;
+  opacity?: number;
+  frame?: number;
+}
+
+export interface CompositorRectData {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+  pixels: Buffer;
+}
+
+export interface CursorTableEntry {
+  deviceId: string;
+  x: number;
+  y: number;
+  cursorType: string;
+  color: string;
+  isVisible: boolean;
+  isActive: boolean;
+  seq: number;
+}
+
+// Main thread -> input worker (src/input_worker.ts). A call with an id is answered by a 'result'.
+export type InputWorkerRequest = { type: 'call'; id?: number; method: string; args: unknown[] } | { type: 'stop' };
+
+// Input worker -> main thread. A batch carries `count` transferred 40-byte records, the slots
+// first seen in it as [deviceId, handle, name], and the device list when a device came or went.
+export type InputWorkerMessage =
+  | { type: 'started' }
+  | { type: 'error'; message: string }
+  | { type: 'batch'; count: number; records: ArrayBuffer; slots: [number, number, string][]; devices?: any[] }
+  | { type: 'result'; id: number; value?: unknown; error?: string };
+
 export interface RawInputModuleInterface {
   setCallbacks(onMouseMove: (data: any) => void, onDeviceChange: (data: DeviceChangeData) => void): void;
   startRawInput(): boolean;
   stopRawInput(): void;
   processMessages(): void;
   getDevices(): any[];
+  setOverflowPolicy?(policy: 'drop' | 'merge'): boolean;
+  setCoalescing?(mode: 'off' | 'window' | 'drain' | 'frame', windowMs?: number): boolean;
+  configureFramePacing?(options: FramePacingOptions): void;
+  reportFrame?(): void;
+  getQueueStats?(): {
+    pending: number;
+    droppedMoves: number;
+    mergedMoves: number;
+    deferredEvents: number;
+    backlog: number;
+    coalescedMoves: number;
+    emittedMoves: number;
+    cursorRepositions: number;
+    cursorRepositionsSkipped: number;
+  };
+  enableBatchMode?(onBatch: (count: number) => void, maxRecords?: number): ArrayBuffer;
+  disableBatchMode?(): void;
+  getDeviceSlot?(deviceId: number): { handle: number; name: string } | null;
+  configureMotion?(options: MotionOptions): boolean;
+  configureMotionFilter?(options: MotionFilterOptions, deviceHandle?: number): boolean;
+  clearMotionFilter?(deviceHandle: number): void;
+  setDevicePosition?(deviceHandle: number, x: number, y: number): void;
+  setSubscription?(classes: EventClass[], deviceHandle?: number): number;
+  clearSubscription?(deviceHandle: number): void;
+  setMonitorLayout?(monitors: MonitorLayoutEntry[]): number;
+  findMonitor?(x: number, y: number): number | null;
+  transformPoints?(points: Int32Array, direction: 'toPhysical' | 'toLogical'): number;
+  lockCursor?(ownerHandle: number, x: number, y: number): boolean;
+  unlockCursor?(): void;
+  setCursorRouting?(enabled: boolean): void;
+  watchCursorShape?(onCursorTypeChange: (cursorType: string) => void): boolean;
+  unwatchCursorShape?(): void;
+  getCursorType?(): string | null;
+  loadCursors?(paths: string[], cachePath: string): CursorLoadResult;
+  renderCursor?(path: string, options?: CursorBitmapOptions): CursorBitmapData;
+  getCursorBitmapStats?(): { simd: 'scalar' | 'sse2' | 'avx2'; bitmaps: number; bytes: number; hits: number; misses: number };
+  configureCompositor?(surfaces: { x: number; y: number; width: number; height: number }[]): number;
+  setCompositorCursor?(id: number, path: string, options: CursorBitmapOptions, x: number, y: number): void;
+  removeCompositorCursor?(id: number): void;
+  composeSurface?(index: number, full?: boolean): CompositorRectData[];
+  createCursorTable?(name?: string): string;
+  writeCursorState?(
+    id: string,
+    state: { x: number; y: number; type: string; color: string; visible: boolean; focused: boolean; seq?: number }
+  ): boolean;
+  removeCursorState?(id: string): boolean;
+  openCursorTable?(name: string): boolean;
+  readCursorTable?(sinceVersion?: number): { version: number; cursors: CursorTableEntry[] } | null;
+  reportLatency?(stage: 'dispatch' | 'send' | 'paint', seq: number): boolean;
+  getLatencyStats?(reset?: boolean): Record<'queue' | 'dispatch' | 'send' | 'paint', LatencyStageStats> & { frames: FramePacingStats };
+  resetLatencyStats?(): void;
+  getStats?(): InputStats;
+  getStats?(format: 'text'): string;
+  setStatsDump?(path: string | null, intervalMs?: number): void;
+  setDebugLogging?(enabled: boolean): boolean;
+  startTraceRecording?(tracePath: string): boolean;
+  stopTraceRecording?(): { records: number; dropped: number };
+  startReplay?(tracePath: string, realtime?: boolean): boolean;
+  connectInputService?(name?: string): boolean;
   setSystemCursorPos?(x: number, y: number): void;
   getSystemCursorPos?(): { x: number; y: number };
   setWindowTopMost?(hwnd: Buffer): boolean;